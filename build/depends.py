@@ -568,6 +568,7 @@ class MixxxCore(Feature):
 
                    "engine/engineworker.cpp",
                    "engine/engineworkerscheduler.cpp",
+                   "engine/realtimeworkerpool.cpp",
                    "engine/enginebuffer.cpp",
                    "engine/enginebufferscale.cpp",
                    "engine/enginebufferscaledummy.cpp",
@@ -589,6 +590,8 @@ class MixxxCore(Feature):
                    "engine/enginevumeter.cpp",
                    "engine/enginesidechaincompressor.cpp",
                    "engine/sidechain/enginesidechain.cpp",
+                   "engine/sidechain/encoderbus.cpp",
+                   "engine/sidechain/sidechainworkerthread.cpp",
                    "engine/enginexfader.cpp",
                    "engine/enginemicrophone.cpp",
                    "engine/enginedeck.cpp",
@@ -608,10 +611,12 @@ class MixxxCore(Feature):
                    "engine/enginetalkoverducking.cpp",
                    "cachingreader.cpp",
                    "cachingreaderworker.cpp",
+                   "cachingreaderchunkpool.cpp",
 
                    "analyserrg.cpp",
                    "analyserqueue.cpp",
                    "analyserwaveform.cpp",
+                   "analyserwaveformkernel.cpp",
                    "analyserkey.cpp",
 
                    "controllers/controller.cpp",
@@ -717,6 +722,7 @@ class MixxxCore(Feature):
                    "library/basesqltablemodel.cpp",
                    "library/basetrackcache.cpp",
                    "library/columncache.cpp",
+                   "library/trackindex.cpp",
                    "library/librarytablemodel.cpp",
                    "library/searchquery.cpp",
                    "library/searchqueryparser.cpp",
@@ -829,6 +835,7 @@ class MixxxCore(Feature):
                    "waveform/renderers/glslwaveformrenderersignal.cpp",
                    "waveform/renderers/glvsynctestrenderer.cpp",
                    "waveform/renderers/glwaveformrendererrgb.cpp",
+                   "waveform/renderers/glwaveformvertexcache.cpp",
 
                    "waveform/renderers/waveformsignalcolors.cpp",
 
@@ -851,6 +858,7 @@ class MixxxCore(Feature):
                    "waveform/widgets/glslwaveformwidget.cpp",
 
                    "waveform/widgets/glrgbwaveformwidget.cpp",
+                   "waveform/widgets/glbenchmarkwaveformwidget.cpp",
 
                    "skin/imginvert.cpp",
                    "skin/imgloader.cpp",
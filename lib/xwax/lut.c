@@ -22,12 +22,7 @@
 
 #include "lut.h"
 
-/* The number of bits to form the hash, which governs the overall size
- * of the hash lookup table, and hence the amount of chaining */
-
-#define HASH_BITS 16
-
-#define HASH(timecode) ((timecode) & ((1 << HASH_BITS) - 1))
+#define HASH(timecode) ((timecode) & (LUT_HASHES - 1))
 #define NO_SLOT ((unsigned)-1)
 
 
@@ -39,7 +34,7 @@ int lut_init(struct lut *lut, int nslots)
     int n, hashes;
     size_t bytes;
 
-    hashes = 1 << HASH_BITS;
+    hashes = LUT_HASHES;
     bytes = sizeof(struct slot) * nslots + sizeof(slot_no_t) * hashes;
 
     fprintf(stderr, "Lookup table has %d hashes to %d slots"
@@ -62,13 +57,31 @@ int lut_init(struct lut *lut, int nslots)
         lut->table[n] = NO_SLOT;
 
     lut->avail = 0;
+    lut->external = 0;
 
     return 0;
 }
 
 
+/* Initialise a hash lookup table from memory which was filled by
+ * lut_init() and lut_push() before, e.g. a copy kept in a file. The
+ * memory must stay valid until the table is no longer used */
+
+void lut_init_external(struct lut *lut, struct slot *slot,
+                       slot_no_t *table, slot_no_t avail)
+{
+    lut->slot = slot;
+    lut->table = table;
+    lut->avail = avail;
+    lut->external = 1;
+}
+
+
 void lut_clear(struct lut *lut)
 {
+    if (lut->external)
+        return;
+
     free(lut->table);
     free(lut->slot);
 }
@@ -199,7 +199,7 @@ static inline bits_t rev(bits_t current, struct timecode_def *def)
  * Return: -1 if not enough memory could be allocated, otherwise 0
  */
 
-static int build_lookup(struct timecode_def *def)
+int timecoder_build_lookup(struct timecode_def *def)
 {
     unsigned int n;
     bits_t current;
@@ -235,12 +235,13 @@ static int build_lookup(struct timecode_def *def)
 }
 
 /*
- * Find a timecode definition by name
+ * Find a timecode definition by name, without building its lookup
+ * table. The caller can fill in def->lut and set def->lookup itself
  *
  * Return: pointer to timecode definition, or NULL if not found
  */
 
-struct timecode_def* timecoder_find_definition(const char *name)
+struct timecode_def* timecoder_match_definition(const char *name)
 {
     struct timecode_def *def, *end;
 
@@ -257,7 +258,25 @@ struct timecode_def* timecoder_find_definition(const char *name)
             return NULL;
     }
 
-    if (build_lookup(def) == -1)
+    return def;
+}
+
+/*
+ * Find a timecode definition by name, and build its lookup table
+ *
+ * Return: pointer to timecode definition, or NULL if not found or
+ * there is not enough memory for the lookup table
+ */
+
+struct timecode_def* timecoder_find_definition(const char *name)
+{
+    struct timecode_def *def;
+
+    def = timecoder_match_definition(name);
+    if (def == NULL)
+        return NULL;
+
+    if (timecoder_build_lookup(def) == -1)
         return NULL;
 
     return def;
@@ -276,6 +295,7 @@ void timecoder_free_lookup(void) {
     while (def < end) {
         if (def->lookup)
             lut_clear(&def->lut);
+        def->lookup = false;
         def++;
     }
 }
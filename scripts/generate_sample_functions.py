@@ -34,6 +34,20 @@ def write_channelmixer_autogen(output, num_channels):
     output.append('// SEE scripts/generate_sample_functions.py           //')
     output.append('////////////////////////////////////////////////////////')
     output.append('')
+    output.append('namespace {')
+    output.append('')
+    output.append('// Registered at startup so the callback never allocates for them.')
+    for ramping in (False, True):
+        variant = 'Ramping' if ramping else ''
+        output.append('const StatKey kMixChannels%sStatKeys[] = {' % variant)
+        for i in xrange(num_channels+1):
+            output.append('    StatKey("EngineMaster::mixChannels%(variant)s_%(i)dactive"),' %
+                          {'variant': variant, 'i': i})
+        output.append('    StatKey("EngineMaster::mixChannels%s_manyactive")' % variant)
+        output.append('};')
+    output.append('')
+    output.append('}  // namespace')
+    output.append('')
     output.append('// static')
 
     def write_mixchannels(ramping, output):
@@ -53,14 +67,13 @@ def write_channelmixer_autogen(output, num_channels):
 
         write('int totalActive = activeChannels->size();', depth=1)
 
+        stat_keys = 'kMixChannels%sStatKeys' % ('Ramping' if ramping else '')
         write('if (totalActive == 0) {', depth=1)
-        write('ScopedTimer t("EngineMaster::mixChannels%(variant)s_0active");' %
-              {'variant': 'Ramping' if ramping else ''}, depth=2)
+        write('ScopedTimer t(%s[0]);' % stat_keys, depth=2)
         write('SampleUtil::clear(pOutput, iBufferSize);', depth=2)
         for i in xrange(1, num_channels+1):
             write('} else if (totalActive == %d) {' % i, depth=1)
-            write('ScopedTimer t("EngineMaster::mixChannels%(variant)s_%(i)dactive");' %
-                  {'variant': 'Ramping' if ramping else '', 'i': i}, depth=2)
+            write('ScopedTimer t(%s[%d]);' % (stat_keys, i), depth=2)
             if ramping:
                 write('CSAMPLE_GAIN oldGain[%(i)d];' % {'i': i}, depth=2)
             write('CSAMPLE_GAIN newGain[%(i)d];' % {'i': i}, depth=2)
@@ -100,8 +113,7 @@ def write_channelmixer_autogen(output, num_channels):
                 output.extend(hanging_indent(call_prefix, arg_groups, ',', ');', depth=2))
 
         write('} else {', depth=1)
-        write('ScopedTimer t("EngineMaster::mixChannels%(variant)s_%%1active", activeChannels->size());' %
-              {'variant': 'Ramping' if ramping else ''}, depth=2)
+        write('ScopedTimer t(%s[%d]);' % (stat_keys, num_channels + 1), depth=2)
         write('// Set pOutput to all 0s', depth=2)
         write('SampleUtil::clear(pOutput, iBufferSize);', depth=2)
         write('for (int i = 0; i < activeChannels->size(); ++i) {', depth=2)
@@ -2,13 +2,13 @@
 
 #include <QtDebug>
 #include <QMutexLocker>
+#include <QThreadPool>
 
 #include "trackinfoobject.h"
 #include "playerinfo.h"
 #include "analyserqueue.h"
 #include "soundsourceproxy.h"
 #include "playerinfo.h"
-#include "sampleutil.h"
 #include "util/timer.h"
 #include "library/trackcollection.h"
 #include "analyserwaveform.h"
@@ -16,8 +16,11 @@
 #include "analyserbeats.h"
 #include "analyserkey.h"
 #include "vamp/vampanalyser.h"
+#include "util/assert.h"
 #include "util/compatibility.h"
 #include "util/event.h"
+#include "util/fifo.h"
+#include "util/math.h"
 #include "util/trace.h"
 
 // Measured in 0.1%,
@@ -31,17 +34,127 @@
 // 8192 seems to do fine.
 const int kAnalysisBlockSize = 8192;
 
-AnalyserQueue::AnalyserQueue(TrackCollection* pTrackCollection)
+// The number of blocks in the shared block pool and therefore the maximum
+// number of blocks any analyser can fall behind the decoder. Must be a power
+// of 2 since it is also the size of the per-worker FIFOs.
+const int kAnalysisBlockCount = 16;
+
+// static
+QThreadPool* AnalyserQueue::s_pSharedThreadPool = NULL;
+// static
+int AnalyserQueue::s_iSharedThreadPoolUsers = 0;
+
+// Runs one Analyser on the thread pool of its AnalyserQueue. The AnalyserQueue
+// thread decodes each block once and hands it to every AnalyserWorker through
+// a lock-free FIFO, so the analysers of a track run in parallel instead of one
+// after the other. A worker is scheduled on the pool only while it has blocks
+// queued and is never run by two pool threads at once, so its analyser still
+// sees the blocks one after the other. initialise(), finalise() and cleanup()
+// are still called from the AnalyserQueue thread, but never while the worker
+// has blocks queued.
+class AnalyserWorker : public QRunnable {
+  public:
+    AnalyserWorker(AnalyserQueue* pQueue, Analyser* pAnalyser)
+            : m_pQueue(pQueue),
+              m_pAnalyser(pAnalyser),
+              m_blockFIFO(kAnalysisBlockCount),
+              m_scheduled(0) {
+        setAutoDelete(false);
+    }
+
+    // Never blocks since there are at most kAnalysisBlockCount blocks in
+    // flight.
+    void enqueue(AnalyserQueue::AnalysisBlock* pBlock) {
+        m_blockFIFO.writeBlocking(&pBlock, 1);
+        if (m_scheduled.testAndSetOrdered(0, 1)) {
+            m_pQueue->m_pThreadPool->start(this);
+        }
+    }
+
+  protected:
+    void run() {
+        AnalyserQueue* pQueue = m_pQueue;
+        QThread::currentThread()->setPriority(
+                load_atomic(pQueue->m_aiThrottled) ?
+                QThread::IdlePriority : QThread::LowPriority);
+        for (;;) {
+            AnalyserQueue::AnalysisBlock* pBlock = NULL;
+            if (m_blockFIFO.read(&pBlock, 1) != 1) {
+                // Only reached if enqueue() scheduled us for a block that an
+                // earlier run already processed.
+                m_scheduled.fetchAndStoreOrdered(0);
+                if (m_blockFIFO.readAvailable() == 0 ||
+                        !m_scheduled.testAndSetOrdered(0, 1)) {
+                    return;
+                }
+                continue;
+            }
+            if (!load_atomic(pQueue->m_discardBlocks)) {
+                m_pAnalyser->process(pBlock->samples, pBlock->length);
+            }
+            if (m_blockFIFO.readAvailable() == 0) {
+                m_scheduled.fetchAndStoreOrdered(0);
+                if (m_blockFIFO.readAvailable() == 0 ||
+                        !m_scheduled.testAndSetOrdered(0, 1)) {
+                    // Releasing the last block lets the AnalyserQueue delete
+                    // this worker, so don't touch it afterwards.
+                    pQueue->releaseBlock(pBlock);
+                    return;
+                }
+            }
+            pQueue->releaseBlock(pBlock);
+        }
+    }
+
+  private:
+    AnalyserQueue* m_pQueue;
+    Analyser* m_pAnalyser;
+    FIFO<AnalyserQueue::AnalysisBlock*> m_blockFIFO;
+    // Set while the worker is queued or running on the pool.
+    QAtomicInt m_scheduled;
+};
+
+AnalyserQueue::AnalyserQueue(TrackCollection* pTrackCollection,
+                             bool bSharedThreadPool)
         : m_aq(),
+          m_pThreadPool(NULL),
+          m_bSharedThreadPool(bSharedThreadPool),
           m_exit(false),
           m_aiCheckPriorities(false),
-          m_pSamplesPCM(new SAMPLE[kAnalysisBlockSize]),
-          m_pSamples(new CSAMPLE[kAnalysisBlockSize]),
+          m_aiThrottled(0),
+          m_bThrottleApplied(false),
+          m_pSamples(new CSAMPLE[kAnalysisBlockSize * kAnalysisBlockCount]),
+          m_semaFreeBlocks(kAnalysisBlockCount),
+          m_discardBlocks(0),
           m_tioq(),
+          m_bBusy(false),
           m_qm(),
           m_qwait(),
           m_queue_size(0) {
     Q_UNUSED(pTrackCollection);
+    if (m_bSharedThreadPool) {
+        // Running one thread per analyser in every queue would start cores x
+        // analysers threads when the library is analysed with one queue per
+        // core.
+        if (s_pSharedThreadPool == NULL) {
+            s_pSharedThreadPool = new QThreadPool();
+            s_pSharedThreadPool->setMaxThreadCount(
+                    math_max(1, QThread::idealThreadCount()));
+        }
+        ++s_iSharedThreadPoolUsers;
+        m_pThreadPool = s_pSharedThreadPool;
+    } else {
+        // Sized by addAnalyser() so that every worker has a thread.
+        m_pThreadPool = new QThreadPool();
+        m_pThreadPool->setMaxThreadCount(1);
+    }
+    for (int i = 0; i < kAnalysisBlockCount; ++i) {
+        AnalysisBlock* pBlock = new AnalysisBlock;
+        pBlock->samples = m_pSamples + i * kAnalysisBlockSize;
+        pBlock->length = 0;
+        pBlock->pendingWorkers.fetchAndStoreRelaxed(0);
+        m_blocks.append(pBlock);
+    }
     connect(this, SIGNAL(updateProgress()),
             this, SLOT(slotUpdateProgress()));
 }
@@ -50,6 +163,15 @@ AnalyserQueue::~AnalyserQueue() {
     stop();
     m_progressInfo.sema.release();
     wait(); //Wait until thread has actually stopped before proceeding.
+    stopWorkers();
+
+    if (!m_bSharedThreadPool) {
+        delete m_pThreadPool;
+    } else if (--s_iSharedThreadPoolUsers == 0) {
+        delete s_pSharedThreadPool;
+        s_pSharedThreadPool = NULL;
+    }
+    m_pThreadPool = NULL;
 
     QListIterator<Analyser*> it(m_aq);
     while (it.hasNext()) {
@@ -59,12 +181,69 @@ AnalyserQueue::~AnalyserQueue() {
     }
     //qDebug() << "AnalyserQueue::~AnalyserQueue()";
 
-    delete [] m_pSamplesPCM;
+    qDeleteAll(m_blocks);
     delete [] m_pSamples;
 }
 
 void AnalyserQueue::addAnalyser(Analyser* an) {
     m_aq.push_back(an);
+    if (!m_bSharedThreadPool) {
+        m_pThreadPool->setMaxThreadCount(m_aq.size());
+    }
+}
+
+void AnalyserQueue::startWorkers() {
+    for (int i = 0; i < m_aq.size(); ++i) {
+        m_workers.append(new AnalyserWorker(this, m_aq[i]));
+    }
+}
+
+void AnalyserQueue::stopWorkers() {
+    // A worker is done with the pool once it released its last block.
+    waitForWorkers();
+    qDeleteAll(m_workers);
+    m_workers.clear();
+}
+
+// This is called from the AnalyserQueue thread
+AnalyserQueue::AnalysisBlock* AnalyserQueue::takeFreeBlock() {
+    m_semaFreeBlocks.acquire();
+    // The semaphore guarantees that at least one block is free. Only this
+    // thread hands out blocks, so it is still free when we return it.
+    foreach (AnalysisBlock* pBlock, m_blocks) {
+        if (load_atomic(pBlock->pendingWorkers) == 0) {
+            return pBlock;
+        }
+    }
+    DEBUG_ASSERT(false);
+    return NULL;
+}
+
+// This is called from the AnalyserQueue thread
+void AnalyserQueue::returnUnusedBlock(AnalysisBlock* pBlock) {
+    Q_UNUSED(pBlock);
+    m_semaFreeBlocks.release();
+}
+
+// This is called from the AnalyserQueue thread
+void AnalyserQueue::fanOutBlock(AnalysisBlock* pBlock) {
+    pBlock->pendingWorkers.fetchAndStoreOrdered(m_workers.size());
+    foreach (AnalyserWorker* pWorker, m_workers) {
+        pWorker->enqueue(pBlock);
+    }
+}
+
+// This is called from the AnalyserWorker threads
+void AnalyserQueue::releaseBlock(AnalysisBlock* pBlock) {
+    if (!pBlock->pendingWorkers.deref()) {
+        m_semaFreeBlocks.release();
+    }
+}
+
+// This is called from the AnalyserQueue thread
+void AnalyserQueue::waitForWorkers() {
+    m_semaFreeBlocks.acquire(kAnalysisBlockCount);
+    m_semaFreeBlocks.release(kAnalysisBlockCount);
 }
 
 // This is called from the AnalyserQueue thread
@@ -116,6 +295,7 @@ bool AnalyserQueue::isLoadedTrackWaiting(TrackPointer tio) {
 // This is called from the AnalyserQueue thread
 TrackPointer AnalyserQueue::dequeueNextBlocking() {
     m_qm.lock();
+    m_bBusy = false;
     if (m_tioq.isEmpty()) {
         Event::end("AnalyserQueue process");
         m_qwait.wait(&m_qm);
@@ -148,6 +328,7 @@ TrackPointer AnalyserQueue::dequeueNextBlocking() {
     if (!pLoadTrack && !m_tioq.isEmpty()) {
         pLoadTrack = m_tioq.dequeue();
     }
+    m_bBusy = !pLoadTrack.isNull();
 
     m_qm.unlock();
 
@@ -173,8 +354,14 @@ bool AnalyserQueue::doAnalysis(TrackPointer tio, const Mixxx::SoundSourcePointer
     int progress; // progress in 0 ... 100
 
     do {
+        const bool throttled = load_atomic(m_aiThrottled);
+        if (throttled != m_bThrottleApplied) {
+            applyThrottle(throttled);
+        }
+
         ScopedTimer t("AnalyserQueue::doAnalysis block");
-        read = pSoundSource->read(kAnalysisBlockSize, m_pSamplesPCM);
+        AnalysisBlock* pBlock = takeFreeBlock();
+        read = pSoundSource->readFloat(kAnalysisBlockSize, pBlock->samples);
 
         // To compare apples to apples, let's only look at blocks that are the
         // full block size.
@@ -184,6 +371,7 @@ bool AnalyserQueue::doAnalysis(TrackPointer tio, const Mixxx::SoundSourcePointer
 
         // Safety net in case something later barfs on 0 sample input
         if (read == 0) {
+            returnUnusedBlock(pBlock);
             t.cancel();
             break;
         }
@@ -197,16 +385,11 @@ bool AnalyserQueue::doAnalysis(TrackPointer tio, const Mixxx::SoundSourcePointer
             dieflag = true;
         }
 
-        SampleUtil::convertS16ToFloat32(m_pSamples, m_pSamplesPCM, read);
-
-        QListIterator<Analyser*> it(m_aq);
-
-        while (it.hasNext()) {
-            Analyser* an =  it.next();
-            //qDebug() << typeid(*an).name() << ".process()";
-            an->process(m_pSamples, read);
-            //qDebug() << "Done " << typeid(*an).name() << ".process()";
-        }
+        // Every analyser processes the block on its own worker. The workers
+        // fall behind by at most kAnalysisBlockCount blocks before
+        // takeFreeBlock() blocks.
+        pBlock->length = read;
+        fanOutBlock(pBlock);
 
         // emit progress updates
         // During the doAnalysis function it goes only to 100% - FINALIZE_PERCENT
@@ -252,9 +435,52 @@ bool AnalyserQueue::doAnalysis(TrackPointer tio, const Mixxx::SoundSourcePointer
         }
     } while(read == kAnalysisBlockSize && !dieflag);
 
+    // The analysers must be done with all blocks before they are finalised or
+    // cleaned up. A cancelled track is analysed again later, so don't bother
+    // processing the blocks that are still queued.
+    if (cancelled) {
+        m_discardBlocks.fetchAndStoreOrdered(1);
+    }
+    waitForWorkers();
+    m_discardBlocks.fetchAndStoreOrdered(0);
+
     return !cancelled; //don't return !dieflag or we might reanalyze over and over
 }
 
+// This is called from the AnalyserQueue thread
+void AnalyserQueue::applyThrottle(bool throttled) {
+    QThread::Priority priority =
+            throttled ? QThread::IdlePriority : QThread::LowPriority;
+    // The workers pick the priority up the next time they are scheduled.
+    setPriority(priority);
+    m_bThrottleApplied = throttled;
+}
+
+// This is called from the AnalyserQueue thread
+void AnalyserQueue::finishTrack() {
+    m_qm.lock();
+    m_bBusy = false;
+    m_queue_size = m_tioq.size();
+    m_qm.unlock();
+    if (m_queue_size == 0) {
+        emit(queueEmpty()); // emit asynchrony for no deadlock
+    }
+}
+
+void AnalyserQueue::setThrottled(bool throttled) {
+    m_aiThrottled = throttled ? 1 : 0;
+}
+
+int AnalyserQueue::queuedTrackCount() {
+    QMutexLocker locker(&m_qm);
+    return m_tioq.size();
+}
+
+bool AnalyserQueue::isIdle() {
+    QMutexLocker locker(&m_qm);
+    return m_tioq.isEmpty() && !m_bBusy;
+}
+
 void AnalyserQueue::stop() {
     m_exit = true;
     m_qm.lock();
@@ -270,6 +496,8 @@ void AnalyserQueue::run() {
     if (m_aq.size() == 0)
         return;
 
+    startWorkers();
+
     m_progressInfo.current_track = TrackPointer();
     m_progressInfo.track_progress = 0;
     m_progressInfo.queue_size = 0;
@@ -303,6 +531,8 @@ void AnalyserQueue::run() {
         Mixxx::SoundSourcePointer pSoundSource(soundSourceProxy.open());
         if (pSoundSource.isNull()) {
             qWarning() << "Failed to open file for analyzing:" << nextTrack->getLocation();
+            emitTrackFailed(nextTrack);
+            finishTrack();
             continue;
         }
 
@@ -311,6 +541,8 @@ void AnalyserQueue::run() {
 
         if (iNumSamples == 0 || iSampleRate == 0) {
             qWarning() << "Skipping invalid file:" << nextTrack->getLocation();
+            emitTrackFailed(nextTrack);
+            finishTrack();
             continue;
         }
 
@@ -354,16 +586,21 @@ void AnalyserQueue::run() {
             qDebug() << "Skipping track analysis because no analyzer initialized.";
         }
 
-        m_qm.lock();
-        m_queue_size = m_tioq.size();
-        m_qm.unlock();
-        if (m_queue_size == 0) {
-            emit(queueEmpty()); // emit asynchrony for no deadlock
-        }
+        finishTrack();
     }
     emit(queueEmpty()); // emit in case of exit;
 }
 
+// This is called from the AnalyserQueue thread
+void AnalyserQueue::emitTrackFailed(TrackPointer tio) {
+    // The track is done as far as the requestor is concerned, it must not
+    // wait for it forever.
+    m_qm.lock();
+    m_queue_size = m_tioq.size();
+    m_qm.unlock();
+    emitUpdateProgress(tio, 1000); // 100%
+}
+
 // This is called from the AnalyserQueue thread
 void AnalyserQueue::emitUpdateProgress(TrackPointer tio, int progress) {
     if (!m_exit) {
@@ -418,7 +655,9 @@ void AnalyserQueue::queueAnalyseTrack(TrackPointer tio) {
 // static
 AnalyserQueue* AnalyserQueue::createDefaultAnalyserQueue(
         ConfigObject<ConfigValue>* pConfig, TrackCollection* pTrackCollection) {
-    AnalyserQueue* ret = new AnalyserQueue(pTrackCollection);
+    // The deck's queue has threads of its own, so a track loaded into a deck
+    // is never stuck behind a batch analysis of the library.
+    AnalyserQueue* ret = new AnalyserQueue(pTrackCollection, false);
 
     ret->addAnalyser(new AnalyserWaveform(pConfig));
     ret->addAnalyser(new AnalyserGain(pConfig));
@@ -433,7 +672,7 @@ AnalyserQueue* AnalyserQueue::createDefaultAnalyserQueue(
 // static
 AnalyserQueue* AnalyserQueue::createAnalysisFeatureAnalyserQueue(
         ConfigObject<ConfigValue>* pConfig, TrackCollection* pTrackCollection) {
-    AnalyserQueue* ret = new AnalyserQueue(pTrackCollection);
+    AnalyserQueue* ret = new AnalyserQueue(pTrackCollection, true);
 
     ret->addAnalyser(new AnalyserGain(pConfig));
     VampAnalyser::initializePluginPaths();
@@ -1,9 +1,11 @@
 #ifndef ANALYSERQUEUE_H
 #define ANALYSERQUEUE_H
 
+#include <QAtomicInt>
 #include <QList>
 #include <QThread>
 #include <QQueue>
+#include <QVector>
 #include <QWaitCondition>
 #include <QSemaphore>
 
@@ -12,17 +14,32 @@
 #include "soundsource.h"
 #include "trackinfoobject.h"
 
+class QThreadPool;
 class TrackCollection;
+class AnalyserWorker;
 
 class AnalyserQueue : public QThread {
     Q_OBJECT
 
   public:
-    AnalyserQueue(TrackCollection* pTrackCollection);
+    // The analysers of all queues with bSharedThreadPool set share one thread
+    // pool. The other queues have a pool of their own. Construct and delete
+    // queues from the GUI thread only.
+    AnalyserQueue(TrackCollection* pTrackCollection, bool bSharedThreadPool);
     virtual ~AnalyserQueue();
     void stop();
     void queueAnalyseTrack(TrackPointer tio);
 
+    // Returns the number of tracks waiting to be analysed, not counting the
+    // one in progress.
+    int queuedTrackCount();
+    // Returns true if the queue neither analyses a track nor has one waiting.
+    bool isIdle();
+
+    // Drops the analysis threads to idle priority while throttled, e.g. while
+    // a deck is playing. Takes effect at the next block.
+    void setThrottled(bool throttled);
+
     static AnalyserQueue* createDefaultAnalyserQueue(
             ConfigObject<ConfigValue>* pConfig, TrackCollection* pTrackCollection);
     static AnalyserQueue* createAnalysisFeatureAnalyserQueue(
@@ -52,22 +69,77 @@ class AnalyserQueue : public QThread {
         QSemaphore sema;
     };
 
+    // A block of decoded samples. Every block is shared read-only by all
+    // analyser workers and goes back to the pool once the last of them has
+    // processed it.
+    struct AnalysisBlock {
+        CSAMPLE* samples;
+        int length;
+        QAtomicInt pendingWorkers;
+    };
+
     void addAnalyser(Analyser* an);
 
+    // Creates one AnalyserWorker per analyser. Called from the AnalyserQueue
+    // thread.
+    void startWorkers();
+    void stopWorkers();
+
+    // Waits until a block is free and returns it. This is the backpressure
+    // that keeps the decoder from running ahead of the slowest analyser.
+    AnalysisBlock* takeFreeBlock();
+    // Puts a block that was taken but not handed to the workers back.
+    void returnUnusedBlock(AnalysisBlock* pBlock);
+    // Hands a block to every worker.
+    void fanOutBlock(AnalysisBlock* pBlock);
+    // Called by the workers once they are done with a block.
+    void releaseBlock(AnalysisBlock* pBlock);
+    // Waits until the workers have processed every block handed to them.
+    void waitForWorkers();
+
     QList<Analyser*> m_aq;
+    QList<AnalyserWorker*> m_workers;
+    // The threads the workers run on.
+    QThreadPool* m_pThreadPool;
+    bool m_bSharedThreadPool;
+
+    // The pool of the queues that share one, and the number of those queues.
+    // Deleted with the last of them.
+    static QThreadPool* s_pSharedThreadPool;
+    static int s_iSharedThreadPoolUsers;
 
     bool isLoadedTrackWaiting(TrackPointer tio);
     TrackPointer dequeueNextBlocking();
     bool doAnalysis(TrackPointer tio, const Mixxx::SoundSourcePointer& pSoundSource);
+    // Marks the current track as done and emits queueEmpty() if there is no
+    // other track waiting.
+    void finishTrack();
+    // Reports a track that could not be analysed as finished.
+    void emitTrackFailed(TrackPointer tio);
+    void applyThrottle(bool throttled);
     void emitUpdateProgress(TrackPointer tio, int progress);
 
     bool m_exit;
     QAtomicInt m_aiCheckPriorities;
-    SAMPLE* m_pSamplesPCM;
+    QAtomicInt m_aiThrottled;
+    // Only touched by the AnalyserQueue thread.
+    bool m_bThrottleApplied;
+
+    // The block pool. m_semaFreeBlocks counts the blocks that no worker is
+    // using anymore.
     CSAMPLE* m_pSamples;
+    QVector<AnalysisBlock*> m_blocks;
+    QSemaphore m_semaFreeBlocks;
+    // Set while a cancelled analysis drains, the workers skip the remaining
+    // blocks instead of processing them.
+    QAtomicInt m_discardBlocks;
+
+    friend class AnalyserWorker;
 
-    // The processing queue and associated mutex
+    // The processing queue and associated mutex. m_bBusy is set while a track
+    // taken from the queue is being analysed.
     QQueue<TrackPointer> m_tioq;
+    bool m_bBusy;
     QMutex m_qm;
     QWaitCondition m_qwait;
     struct progress_info m_progressInfo;
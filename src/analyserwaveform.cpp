@@ -1,9 +1,10 @@
 #include <QImage>
 #include <QtDebug>
 #include <QTime>
-#include <QtDebug>
+#include <limits>
 
 #include "analyserwaveform.h"
+#include "analyserwaveformkernel.h"
 #include "engine/engineobject.h"
 #include "engine/enginefilterbutterworth8.h"
 #include "engine/enginefilterbessel4.h"
@@ -12,14 +13,45 @@
 #include "trackinfoobject.h"
 #include "waveform/waveformfactory.h"
 
+namespace {
+
+// Returns the first position after iPosition at which a stride of the given
+// length ends. A stride ends at every position for which
+// fmod(position, length) < 1, this has to stay exactly the same test that was
+// once done for every frame or stored waveforms would change.
+int nextStrideEnd(int iPosition, double length) {
+    if (!(length > 0.0)) {
+        // fmod() is NaN, so a stride never ends.
+        return std::numeric_limits<int>::max();
+    }
+    int candidate = iPosition + 1;
+    if (fmod(candidate, length) < 1) {
+        return candidate;
+    }
+    // Start just before the estimated end and walk forward. If the estimate
+    // is off because of rounding, this only makes the walk longer.
+    const double stridesDone = floor(iPosition / length);
+    candidate = math_max(candidate,
+            static_cast<int>(floor((stridesDone + 1) * length)) - 1);
+    while (!(fmod(candidate, length) < 1)) {
+        ++candidate;
+    }
+    return candidate;
+}
+
+}  // namespace
+
 AnalyserWaveform::AnalyserWaveform(ConfigObject<ConfigValue>* pConfig) :
         m_skipProcessing(false),
         m_waveformData(NULL),
         m_waveformSummaryData(NULL),
         m_stride(0, 0),
         m_currentStride(0),
-        m_currentSummaryStride(0) {
-    qDebug() << "AnalyserWaveform::AnalyserWaveform()";
+        m_currentSummaryStride(0),
+        m_nextStrideEnd(0),
+        m_nextSummaryStrideEnd(0) {
+    qDebug() << "AnalyserWaveform::AnalyserWaveform() using the"
+             << AnalyserWaveformKernel::implementationName() << "kernel";
 
     m_filter[0] = 0;
     m_filter[1] = 0;
@@ -95,6 +127,8 @@ bool AnalyserWaveform::initialise(TrackPointer tio, int sampleRate, int totalSam
 
         m_currentStride = 0;
         m_currentSummaryStride = 0;
+        m_nextStrideEnd = nextStrideEnd(0, m_stride.m_length);
+        m_nextSummaryStrideEnd = nextStrideEnd(0, m_stride.m_averageLength);
 
         //debug
         //m_waveform->dump();
@@ -122,6 +156,11 @@ bool AnalyserWaveform::loadStored(TrackPointer tio) const {
         QList<AnalysisDao::AnalysisInfo> analyses =
                 m_analysisDao->getAnalysesForTrack(trackId);
 
+        // Analyses in a format that is converted, used if there is no
+        // analysis of the current version.
+        const AnalysisDao::AnalysisInfo* pConvertWaveform = NULL;
+        const AnalysisDao::AnalysisInfo* pConvertWavesummary = NULL;
+
         QListIterator<AnalysisDao::AnalysisInfo> it(analyses);
         while (it.hasNext()) {
             const AnalysisDao::AnalysisInfo& analysis = it.next();
@@ -132,7 +171,11 @@ bool AnalyserWaveform::loadStored(TrackPointer tio) const {
                 if (missingWaveform && vc == WaveformFactory::VC_USE) {
                     pLoadedTrackWaveform = ConstWaveformPointer(
                             WaveformFactory::loadWaveformFromAnalysis(analysis));
-                    missingWaveform = false;
+                    missingWaveform = pLoadedTrackWaveform.isNull();
+                } else if (vc == WaveformFactory::VC_CONVERT) {
+                    if (pConvertWaveform == NULL) {
+                        pConvertWaveform = &analysis;
+                    }
                 } else if (vc != WaveformFactory::VC_KEEP) {
                     // remove all other Analysis except that one we should keep
                     m_analysisDao->deleteAnalysis(analysis.analysisId);
@@ -142,13 +185,42 @@ bool AnalyserWaveform::loadStored(TrackPointer tio) const {
                 if (missingWavesummary && vc == WaveformFactory::VC_USE) {
                     pLoadedTrackWaveformSummary = ConstWaveformPointer(
                             WaveformFactory::loadWaveformFromAnalysis(analysis));
-                    missingWavesummary = false;
+                    missingWavesummary = pLoadedTrackWaveformSummary.isNull();
+                } else if (vc == WaveformFactory::VC_CONVERT) {
+                    if (pConvertWavesummary == NULL) {
+                        pConvertWavesummary = &analysis;
+                    }
                 } else if (vc != WaveformFactory::VC_KEEP) {
                     // remove all other Analysis except that one we should keep
                     m_analysisDao->deleteAnalysis(analysis.analysisId);
                 }
             }
         }
+
+        // The converted waveforms are saved in the current format with the
+        // track. The old analyses are kept for older Mixxx versions.
+        if (missingWaveform && pConvertWaveform != NULL) {
+            Waveform* pWaveform =
+                    WaveformFactory::loadWaveformFromAnalysis(*pConvertWaveform);
+            pWaveform->setId(-1);
+            pWaveform->setVersion(WaveformFactory::currentWaveformVersion());
+            pWaveform->setDescription(
+                    WaveformFactory::currentWaveformDescription());
+            pWaveform->setDirty(true);
+            pLoadedTrackWaveform = ConstWaveformPointer(pWaveform);
+            missingWaveform = false;
+        }
+        if (missingWavesummary && pConvertWavesummary != NULL) {
+            Waveform* pWaveform =
+                    WaveformFactory::loadWaveformFromAnalysis(*pConvertWavesummary);
+            pWaveform->setId(-1);
+            pWaveform->setVersion(WaveformFactory::currentWaveformSummaryVersion());
+            pWaveform->setDescription(
+                    WaveformFactory::currentWaveformSummaryDescription());
+            pWaveform->setDirty(true);
+            pLoadedTrackWaveformSummary = ConstWaveformPointer(pWaveform);
+            missingWavesummary = false;
+        }
     }
 
     // If we don't need to calculate the waveform/wavesummary, skip.
@@ -202,37 +274,50 @@ void AnalyserWaveform::process(const CSAMPLE* buffer, const int bufferLength) {
     m_filter[High]->process(buffer, &m_buffers[High][0], bufferLength);
 
 
-    for (int i = 0; i < bufferLength; i+=2) {
+    const CSAMPLE* const pBuffers[AnalyserWaveformKernel::kStreamCount] = {
+            buffer, &m_buffers[Low][0], &m_buffers[Mid][0], &m_buffers[High][0] };
+
+    // Instead of testing every frame for the end of a stride, find the frame
+    // at which the next stride or summary stride ends and take the peaks of
+    // all frames up to there in one go.
+    int i = 0;
+    while (i < bufferLength) {
+        if (m_nextStrideEnd <= m_stride.m_position) {
+            m_nextStrideEnd = nextStrideEnd(m_stride.m_position,
+                                            m_stride.m_length);
+        }
+        if (m_nextSummaryStrideEnd <= m_stride.m_position) {
+            m_nextSummaryStrideEnd = nextStrideEnd(m_stride.m_position,
+                                                   m_stride.m_averageLength);
+        }
+        const int framesToEvent = math_min(m_nextStrideEnd,
+                m_nextSummaryStrideEnd) - m_stride.m_position;
+        const int frames = math_min(framesToEvent, (bufferLength - i) / 2);
+        if (frames <= 0) {
+            break;
+        }
+
         // Take max value, not average of data
-        CSAMPLE cover[2] = { fabs(buffer[i]), fabs(buffer[i + 1]) };
-        CSAMPLE clow[2] =  { fabs(m_buffers[Low][i]), fabs(m_buffers[Low][i + 1]) };
-        CSAMPLE cmid[2] =  { fabs(m_buffers[Mid][i]), fabs(m_buffers[Mid][i + 1]) };
-        CSAMPLE chigh[2] = { fabs(m_buffers[High][i]), fabs(m_buffers[High][i + 1]) };
-
-        // This is for if you want to experiment with averaging instead of
-        // maxing.
-        // m_stride.m_overallData[Right] += buffer[i]*buffer[i];
-        // m_stride.m_overallData[Left] += buffer[i + 1]*buffer[i + 1];
-        // m_stride.m_filteredData[Right][Low] += m_buffers[Low][i]*m_buffers[Low][i];
-        // m_stride.m_filteredData[Left][Low] += m_buffers[Low][i + 1]*m_buffers[Low][i + 1];
-        // m_stride.m_filteredData[Right][Mid] += m_buffers[Mid][i]*m_buffers[Mid][i];
-        // m_stride.m_filteredData[Left][Mid] += m_buffers[Mid][i + 1]*m_buffers[Mid][i + 1];
-        // m_stride.m_filteredData[Right][High] += m_buffers[High][i]*m_buffers[High][i];
-        // m_stride.m_filteredData[Left][High] += m_buffers[High][i + 1]*m_buffers[High][i + 1];
+        CSAMPLE peaks[AnalyserWaveformKernel::kStreamCount][2] = {
+                { 0.0f, 0.0f }, { 0.0f, 0.0f }, { 0.0f, 0.0f }, { 0.0f, 0.0f } };
+        AnalyserWaveformKernel::accumulatePeaks(pBuffers, i, i + 2 * frames,
+                                                peaks);
+        i += 2 * frames;
+        m_stride.m_position += frames;
 
         // Record the max across this stride.
-        storeIfGreater(&m_stride.m_overallData[Left], cover[Left]);
-        storeIfGreater(&m_stride.m_overallData[Right], cover[Right]);
-        storeIfGreater(&m_stride.m_filteredData[Left][Low], clow[Left]);
-        storeIfGreater(&m_stride.m_filteredData[Right][Low], clow[Right]);
-        storeIfGreater(&m_stride.m_filteredData[Left][Mid], cmid[Left]);
-        storeIfGreater(&m_stride.m_filteredData[Right][Mid], cmid[Right]);
-        storeIfGreater(&m_stride.m_filteredData[Left][High], chigh[Left]);
-        storeIfGreater(&m_stride.m_filteredData[Right][High], chigh[Right]);
-
-        m_stride.m_position++;
-
-        if (fmod(m_stride.m_position, m_stride.m_length) < 1) {
+        for (int ch = 0; ch < ChannelCount; ++ch) {
+            storeIfGreater(&m_stride.m_overallData[ch],
+                           peaks[AnalyserWaveformKernel::kOverall][ch]);
+            storeIfGreater(&m_stride.m_filteredData[ch][Low],
+                           peaks[AnalyserWaveformKernel::kLow][ch]);
+            storeIfGreater(&m_stride.m_filteredData[ch][Mid],
+                           peaks[AnalyserWaveformKernel::kMid][ch]);
+            storeIfGreater(&m_stride.m_filteredData[ch][High],
+                           peaks[AnalyserWaveformKernel::kHigh][ch]);
+        }
+
+        if (m_stride.m_position == m_nextStrideEnd) {
             if (m_currentStride + ChannelCount > m_waveform->getDataSize()) {
                 qWarning() << "AnalyserWaveform::process - currentStride >= waveform size";
                 return;
@@ -242,7 +327,7 @@ void AnalyserWaveform::process(const CSAMPLE* buffer, const int bufferLength) {
             m_waveform->setCompletion(m_currentStride);
         }
 
-        if (fmod(m_stride.m_position, m_stride.m_averageLength) < 1) {
+        if (m_stride.m_position == m_nextSummaryStrideEnd) {
             if (m_currentSummaryStride + ChannelCount > m_waveformSummary->getDataSize()) {
                 qWarning() << "AnalyserWaveform::process - current summary stride >= waveform summary size";
                 return;
@@ -169,6 +169,9 @@ class AnalyserWaveform : public Analyser {
 
     int m_currentStride;
     int m_currentSummaryStride;
+    // The positions at which the current stride and summary stride end.
+    int m_nextStrideEnd;
+    int m_nextSummaryStrideEnd;
 
     EngineObjectConstIn* m_filter[FilterCount];
     std::vector<float> m_buffers[FilterCount];
@@ -0,0 +1,165 @@
+#include <cmath>
+
+#include "analyserwaveformkernel.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// AVX2 code is compiled with a function attribute instead of a global -mavx2
+// so the rest of Mixxx still runs on CPUs without it.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+        (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9) || \
+         defined(__clang__))
+#define ANALYSERWAVEFORMKERNEL_AVX2
+#include <immintrin.h>
+#endif
+
+namespace AnalyserWaveformKernel {
+
+namespace {
+
+typedef void (*AccumulatePeaksFunction)(const CSAMPLE* const*, int, int,
+                                        CSAMPLE (*)[2]);
+
+// Same comparison as AnalyserWaveform always used. A NaN sample never
+// replaces a peak.
+inline void storeIfGreater(CSAMPLE* pDest, CSAMPLE source) {
+    if (*pDest < source) {
+        *pDest = source;
+    }
+}
+
+void accumulatePeaksScalar(const CSAMPLE* const pBuffers[kStreamCount],
+                           int iStart, int iEnd,
+                           CSAMPLE peaks[kStreamCount][2]) {
+    for (int s = 0; s < kStreamCount; ++s) {
+        const CSAMPLE* pBuffer = pBuffers[s];
+        CSAMPLE left = peaks[s][0];
+        CSAMPLE right = peaks[s][1];
+        for (int i = iStart; i < iEnd; i += 2) {
+            storeIfGreater(&left, fabs(pBuffer[i]));
+            storeIfGreater(&right, fabs(pBuffer[i + 1]));
+        }
+        peaks[s][0] = left;
+        peaks[s][1] = right;
+    }
+}
+
+#ifdef __SSE2__
+// Each vector holds two stereo frames, so the even lanes are the left channel
+// and the odd lanes the right channel. max_ps returns its second operand if
+// either one is NaN, which keeps the storeIfGreater behaviour.
+void accumulatePeaksSse2(const CSAMPLE* const pBuffers[kStreamCount],
+                         int iStart, int iEnd,
+                         CSAMPLE peaks[kStreamCount][2]) {
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 acc[kStreamCount];
+    for (int s = 0; s < kStreamCount; ++s) {
+        acc[s] = _mm_setzero_ps();
+    }
+
+    int i = iStart;
+    for (; i + 4 <= iEnd; i += 4) {
+        for (int s = 0; s < kStreamCount; ++s) {
+            const __m128 samples = _mm_and_ps(
+                    _mm_loadu_ps(pBuffers[s] + i), absMask);
+            acc[s] = _mm_max_ps(samples, acc[s]);
+        }
+    }
+
+    for (int s = 0; s < kStreamCount; ++s) {
+        float lanes[4];
+        _mm_storeu_ps(lanes, acc[s]);
+        storeIfGreater(&peaks[s][0], lanes[0]);
+        storeIfGreater(&peaks[s][0], lanes[2]);
+        storeIfGreater(&peaks[s][1], lanes[1]);
+        storeIfGreater(&peaks[s][1], lanes[3]);
+    }
+
+    // The odd frame left over, if any.
+    if (i < iEnd) {
+        accumulatePeaksScalar(pBuffers, i, iEnd, peaks);
+    }
+}
+#endif
+
+#ifdef ANALYSERWAVEFORMKERNEL_AVX2
+__attribute__((target("avx2")))
+void accumulatePeaksAvx2(const CSAMPLE* const pBuffers[kStreamCount],
+                         int iStart, int iEnd,
+                         CSAMPLE peaks[kStreamCount][2]) {
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 acc[kStreamCount];
+    for (int s = 0; s < kStreamCount; ++s) {
+        acc[s] = _mm256_setzero_ps();
+    }
+
+    int i = iStart;
+    for (; i + 8 <= iEnd; i += 8) {
+        for (int s = 0; s < kStreamCount; ++s) {
+            const __m256 samples = _mm256_and_ps(
+                    _mm256_loadu_ps(pBuffers[s] + i), absMask);
+            acc[s] = _mm256_max_ps(samples, acc[s]);
+        }
+    }
+
+    for (int s = 0; s < kStreamCount; ++s) {
+        float lanes[8];
+        _mm256_storeu_ps(lanes, acc[s]);
+        for (int lane = 0; lane < 8; lane += 2) {
+            storeIfGreater(&peaks[s][0], lanes[lane]);
+            storeIfGreater(&peaks[s][1], lanes[lane + 1]);
+        }
+    }
+
+    // Up to three frames left over.
+    if (i < iEnd) {
+        accumulatePeaksScalar(pBuffers, i, iEnd, peaks);
+    }
+}
+#endif
+
+AccumulatePeaksFunction selectImplementation(const char** pName) {
+#ifdef ANALYSERWAVEFORMKERNEL_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        *pName = "AVX2";
+        return &accumulatePeaksAvx2;
+    }
+#endif
+#ifdef __SSE2__
+    *pName = "SSE2";
+    return &accumulatePeaksSse2;
+#else
+    *pName = "scalar";
+    return &accumulatePeaksScalar;
+#endif
+}
+
+const char* s_implementationName = "scalar";
+const AccumulatePeaksFunction s_accumulatePeaks =
+        selectImplementation(&s_implementationName);
+bool s_forceScalar = false;
+
+}  // namespace
+
+void accumulatePeaks(const CSAMPLE* const pBuffers[kStreamCount],
+                     int iStart, int iEnd,
+                     CSAMPLE peaks[kStreamCount][2]) {
+    if (s_forceScalar) {
+        accumulatePeaksScalar(pBuffers, iStart, iEnd, peaks);
+    } else {
+        (*s_accumulatePeaks)(pBuffers, iStart, iEnd, peaks);
+    }
+}
+
+const char* implementationName() {
+    return s_forceScalar ? "scalar" : s_implementationName;
+}
+
+void setForceScalar(bool forceScalar) {
+    s_forceScalar = forceScalar;
+}
+
+}  // namespace AnalyserWaveformKernel
@@ -0,0 +1,41 @@
+#ifndef ANALYSERWAVEFORMKERNEL_H
+#define ANALYSERWAVEFORMKERNEL_H
+
+#include "util/types.h"
+
+// The inner loop of AnalyserWaveform: tracks the peak (max of the absolute
+// value) of the full band signal and the three filtered bands for the left
+// and right channel of a stereo stream, all in one pass over the buffers.
+//
+// There is a plain C++ version and, on x86, an SSE2 and an AVX2 version. The
+// best one supported by the CPU is chosen once at runtime. Since the peak of a
+// set of floats does not depend on the order they are compared in, every
+// version produces exactly the same result.
+namespace AnalyserWaveformKernel {
+
+enum Stream {
+    kOverall = 0,
+    kLow,
+    kMid,
+    kHigh,
+    kStreamCount
+};
+
+// Updates peaks[stream][channel] with the peaks of the interleaved stereo
+// samples [iStart, iEnd) of each of the kStreamCount buffers. iStart and iEnd
+// must be even. Peaks are never lowered, so the caller decides when a stride
+// starts by resetting them to 0.
+void accumulatePeaks(const CSAMPLE* const pBuffers[kStreamCount],
+                     int iStart, int iEnd,
+                     CSAMPLE peaks[kStreamCount][2]);
+
+// Name of the implementation accumulatePeaks uses on this CPU, for logging.
+const char* implementationName();
+
+// Forces the plain C++ implementation. Only used by tests and benchmarks to
+// compare the vectorised versions against it.
+void setForceScalar(bool forceScalar);
+
+}  // namespace AnalyserWaveformKernel
+
+#endif /* ANALYSERWAVEFORMKERNEL_H */
@@ -3,6 +3,7 @@
 
 #include "controlobject.h"
 #include "controlobjectthread.h"
+#include "controlpushbutton.h"
 
 #include "cachingreader.h"
 #include "trackinfoobject.h"
@@ -12,10 +13,22 @@
 #include "util/math.h"
 #include "util/assert.h"
 
-// currently CachingReaderWorker::kChunkLength is 65536 (0x10000);
-// For 80 chunks we need 5242880 (0x500000) bytes (5 MiB) of Memory
-//static
-const int CachingReader::maximumChunksInMemory = 80;
+namespace {
+
+// The number of least recently used chunks that are considered when a chunk has
+// to be expired.
+const int kExpireScanLength = 8;
+
+// A reader that is over its quota (e.g. because another deck started playing)
+// gives back at most this many chunks per callback.
+const int kMaxExpiredChunksPerCallback = 8;
+
+// Registered at startup so that counting in the callback never allocates.
+const StatKey kCacheHitStatKey("CachingReader::read cache hit");
+const StatKey kCacheMissStatKey("CachingReader::read cache miss");
+const StatKey kEvictionStatKey("CachingReader::expireChunk eviction");
+
+}  // namespace
 
 CachingReader::CachingReader(QString group,
                              ConfigObject<ConfigValue>* config)
@@ -23,36 +36,29 @@ CachingReader::CachingReader(QString group,
           m_chunkReadRequestFIFO(1024),
           m_readerStatusFIFO(1024),
           m_readerStatus(INVALID),
+          m_pChunkPool(CachingReaderChunkPool::acquire(config)),
+          m_iWeight(0),
+          m_bPlaying(false),
           m_mruChunk(NULL),
           m_lruChunk(NULL),
-          m_pRawMemoryBuffer(NULL),
-          m_iTrackNumSamplesCallbackSafe(0) {
-    int rawMemoryBufferLength = CachingReaderWorker::kSamplesPerChunk * maximumChunksInMemory;
-    m_pRawMemoryBuffer = new CSAMPLE[rawMemoryBufferLength];
-
-    m_allocatedChunks.reserve(maximumChunksInMemory);
-
-    CSAMPLE* bufferStart = m_pRawMemoryBuffer;
-
-    // Divide up the allocated raw memory buffer into total_chunks
-    // chunks. Initialize each chunk to hold nothing and add it to the free
-    // list.
-    for (int i = 0; i < maximumChunksInMemory; ++i) {
-        Chunk* c = new Chunk;
-        c->chunk_number = -1;
-        c->length = 0;
-        c->data = bufferStart;
-        c->next_lru = NULL;
-        c->prev_lru = NULL;
-        c->state = Chunk::FREE;
-
-        m_chunks.push_back(c);
-        m_freeChunks.push_back(c);
-
-        bufferStart += CachingReaderWorker::kSamplesPerChunk;
-    }
+          m_iTrackNumSamplesCallbackSafe(0),
+          m_pTrackBuffer(NULL) {
+    // Reserve the whole pool so that the index never reallocates in the
+    // callback, no matter how big our share of the pool grows.
+    m_allocatedChunks.reserve(m_pChunkPool->chunkCount());
+
+    // Decode tracks loaded from now on into RAM as a whole.
+    ControlPushButton* pDecodeToRam = new ControlPushButton(
+            ConfigKey(group, "decode_to_ram"), true);
+    pDecodeToRam->setButtonMode(ControlPushButton::TOGGLE);
+    m_pDecodeToRam = pDecodeToRam;
+    // 1 while the worker opens a new track.
+    m_pTrackLoading = new ControlObject(ConfigKey(group, "track_loading"));
+    // Fraction of the track that is decoded into RAM, from 0 to 1.
+    m_pDecodeProgress = new ControlObject(ConfigKey(group, "decode_progress"));
 
     m_pWorker = new CachingReaderWorker(group,
+            m_pChunkPool,
             &m_chunkReadRequestFIFO,
             &m_readerStatusFIFO);
 
@@ -75,12 +81,36 @@ CachingReader::~CachingReader() {
 
     m_pWorker->quitWait();
     delete m_pWorker;
-    m_freeChunks.clear();
+    // process() must not wake the deleted worker.
+    m_pWorker = NULL;
+
+    // Hand every chunk back to the shared pool. Chunks that were in flight
+    // when the worker stopped are either still queued as a request or
+    // already answered by a status update.
+    process();
+    ChunkReadRequest request;
+    while (m_chunkReadRequestFIFO.read(&request, 1) == 1) {
+        if (request.trackBuffer != NULL) {
+            m_pChunkPool->freeTrackBuffer(request.trackBuffer);
+        } else if (lookupChunk(request.chunk->chunk_number) != request.chunk) {
+            releaseChunk(request.chunk);
+        }
+    }
+    foreach (Chunk* pChunk, m_allocatedChunks) {
+        releaseChunk(pChunk);
+    }
     m_allocatedChunks.clear();
     m_lruChunk = m_mruChunk = NULL;
-    qDeleteAll(m_chunks);
-    delete [] m_pRawMemoryBuffer;
-    m_pRawMemoryBuffer = NULL;
+    m_pChunkPool->freeTrackBuffer(m_pTrackBuffer);
+    m_pTrackBuffer = NULL;
+
+    setWeight(0);
+    CachingReaderChunkPool::release(m_pChunkPool);
+    m_pChunkPool = NULL;
+
+    delete m_pDecodeProgress;
+    delete m_pTrackLoading;
+    delete m_pDecodeToRam;
 }
 
 // static
@@ -135,56 +165,59 @@ Chunk* CachingReader::insertIntoLRUList(Chunk* chunk, Chunk* head) {
 
 
 void CachingReader::freeChunk(Chunk* pChunk) {
-    int removed = m_allocatedChunks.remove(pChunk->chunk_number);
-
-    // We'll tolerate not being in allocatedChunks because sometime you free a
-    // chunk right after you allocated it.
-    if (removed > 1) {
-        qDebug() << "ERROR: freeChunk free'd a chunk that was multiply-allocated.";
-    }
+    // Chunks that were orphaned by freeAllChunks while a read was in progress
+    // are neither indexed nor part of the LRU list anymore. The same chunk
+    // number may already be allocated to a chunk of the new track.
+    if (m_allocatedChunks.value(pChunk->chunk_number, NULL) == pChunk) {
+        m_allocatedChunks.remove(pChunk->chunk_number);
+
+        // If this is the LRU chunk then set its previous LRU chunk to the LRU
+        if (m_lruChunk == pChunk) {
+            m_lruChunk = pChunk->prev_lru;
+        }
 
-    // If this is the LRU chunk then set its previous LRU chunk to the LRU
-    if (m_lruChunk == pChunk) {
-        m_lruChunk = pChunk->prev_lru;
+        m_mruChunk = removeFromLRUList(pChunk, m_mruChunk);
     }
+    releaseChunk(pChunk);
+}
 
-    m_mruChunk = removeFromLRUList(pChunk, m_mruChunk);
+void CachingReader::releaseChunk(Chunk* pChunk) {
     pChunk->state = Chunk::FREE;
     pChunk->chunk_number = -1;
     pChunk->length = 0;
-    m_freeChunks.push_back(pChunk);
+    pChunk->hint_priority = 0;
+    pChunk->next_lru = NULL;
+    pChunk->prev_lru = NULL;
+    m_pChunkPool->returnChunk(pChunk);
 }
 
 void CachingReader::freeAllChunks() {
-    m_allocatedChunks.clear();
-    m_mruChunk = NULL;
-
-    for (QVector<Chunk*>::const_iterator it = m_chunks.constBegin();
-         it != m_chunks.constEnd(); ++it) {
-        Chunk* pChunk = *it;
+    for (QHash<int, Chunk*>::const_iterator it = m_allocatedChunks.constBegin();
+         it != m_allocatedChunks.constEnd(); ++it) {
+        Chunk* pChunk = it.value();
 
-        // We will receive CHUNK_READ_INVALID for all pending chunk reads which
-        // should free the chunks individually.
+        // We will receive a status update for all pending chunk reads which
+        // frees the then orphaned chunks individually.
         if (pChunk->state == Chunk::READ_IN_PROGRESS) {
-            continue;
-        }
-
-        if (pChunk->state != Chunk::FREE) {
-            pChunk->state = Chunk::FREE;
-            pChunk->chunk_number = -1;
-            pChunk->length = 0;
             pChunk->next_lru = NULL;
             pChunk->prev_lru = NULL;
-            m_freeChunks.append(pChunk);
+            continue;
         }
+        releaseChunk(pChunk);
     }
+    m_allocatedChunks.clear();
+    m_mruChunk = NULL;
+    m_lruChunk = NULL;
 }
 
 Chunk* CachingReader::allocateChunk(int chunk) {
-    if (m_freeChunks.isEmpty()) {
+    if (m_allocatedChunks.size() >= m_pChunkPool->quotaForWeight(m_iWeight)) {
+        return NULL;
+    }
+    Chunk* pChunk = m_pChunkPool->takeChunk();
+    if (pChunk == NULL) {
         return NULL;
     }
-    Chunk* pChunk = m_freeChunks.takeFirst();
     pChunk->state = Chunk::ALLOCATED;
     pChunk->chunk_number = chunk;
 
@@ -207,18 +240,56 @@ Chunk* CachingReader::allocateChunk(int chunk) {
 Chunk* CachingReader::allocateChunkExpireLRU(int chunk) {
     Chunk* pChunk = allocateChunk(chunk);
     if (pChunk == NULL) {
-        if (m_lruChunk == NULL) {
+        if (!expireChunk()) {
             qDebug() << "ERROR: No LRU chunk to free in allocateChunkExpireLRU.";
             return NULL;
         }
-        //qDebug() << "Expiring LRU" << m_lruChunk << m_lruChunk->chunk_number;
-        freeChunk(m_lruChunk);
         pChunk = allocateChunk(chunk);
     }
     //qDebug() << "allocateChunkExpireLRU" << chunk << pChunk;
     return pChunk;
 }
 
+bool CachingReader::expireChunk() {
+    // Among the few least recently used chunks, expire the one that was last
+    // hinted with the least important priority. Ties go to the least recently
+    // used one. Chunks that are being read by the worker can not be freed.
+    Chunk* pVictim = NULL;
+    int scanned = 0;
+    for (Chunk* pChunk = m_lruChunk;
+         pChunk != NULL && scanned < kExpireScanLength;
+         pChunk = pChunk->prev_lru, ++scanned) {
+        if (pChunk->state == Chunk::READ_IN_PROGRESS) {
+            continue;
+        }
+        if (pVictim == NULL || pChunk->hint_priority > pVictim->hint_priority) {
+            pVictim = pChunk;
+        }
+    }
+    if (pVictim == NULL) {
+        return false;
+    }
+    //qDebug() << "Expiring" << pVictim << pVictim->chunk_number;
+    freeChunk(pVictim);
+    Counter(kEvictionStatKey)++;
+    return true;
+}
+
+void CachingReader::setWeight(int weight) {
+    if (weight != m_iWeight) {
+        m_pChunkPool->adjustWeight(weight - m_iWeight);
+        m_iWeight = weight;
+    }
+}
+
+void CachingReader::setPlaying(bool playing) {
+    m_bPlaying = playing;
+    if (m_readerStatus == TRACK_LOADED) {
+        setWeight(playing ? CachingReaderChunkPool::kPlayingWeight :
+                  CachingReaderChunkPool::kIdleWeight);
+    }
+}
+
 Chunk* CachingReader::lookupChunk(int chunk_number) {
     // Defaults to NULL if it's not in the hash.
     Chunk* chunk = m_allocatedChunks.value(chunk_number, NULL);
@@ -248,6 +319,33 @@ Chunk* CachingReader::lookupChunkAndFreshen(int chunk_number) {
     return pChunk;
 }
 
+int CachingReader::trackBufferDecodedSamples() const {
+    if (m_pTrackBuffer == NULL) {
+        return 0;
+    }
+    // Pairs with the release in CachingReaderWorker::decodeTrackBufferSlice.
+    return m_pTrackBuffer->decodedSamples.fetchAndAddAcquire(0);
+}
+
+void CachingReader::releaseTrackBuffer() {
+    if (m_pTrackBuffer == NULL) {
+        return;
+    }
+    if (m_pWorker == NULL) {
+        // Called from the destructor, nobody reads the requests anymore.
+        m_pChunkPool->freeTrackBuffer(m_pTrackBuffer);
+        m_pTrackBuffer = NULL;
+        return;
+    }
+    ChunkReadRequest request;
+    request.trackBuffer = m_pTrackBuffer;
+    if (m_chunkReadRequestFIFO.write(&request, 1) != 1) {
+        qDebug() << "ERROR: Could not return the track buffer to the worker.";
+    }
+    m_pTrackBuffer = NULL;
+    m_pWorker->workReady();
+}
+
 void CachingReader::newTrack(TrackPointer pTrack) {
     m_pWorker->newTrack(pTrack);
     m_pWorker->workReady();
@@ -259,11 +357,19 @@ void CachingReader::process() {
         // qDebug() << "Got ReaderStatusUpdate:" << status.status
         //          << (status.chunk ? status.chunk->chunk_number : -1);
         if (status.status == TRACK_NOT_LOADED) {
+            freeAllChunks();
+            releaseTrackBuffer();
             m_readerStatus = status.status;
+            setWeight(0);
         } else if (status.status == TRACK_LOADED) {
             freeAllChunks();
+            releaseTrackBuffer();
             m_readerStatus = status.status;
             m_iTrackNumSamplesCallbackSafe = status.trackNumSamples;
+            setPlaying(m_bPlaying);
+        } else if (status.status == TRACK_BUFFER_READY) {
+            DEBUG_ASSERT(m_pTrackBuffer == NULL);
+            m_pTrackBuffer = status.trackBuffer;
         } else if (status.status == CHUNK_READ_SUCCESS) {
             Chunk* pChunk = status.chunk;
 
@@ -277,6 +383,12 @@ void CachingReader::process() {
             // After a read success the state ought to be READ_IN_PROGRESS.
             DEBUG_ASSERT(pChunk->state == Chunk::READ_IN_PROGRESS);
 
+            // The chunk was orphaned by a track change while it was read.
+            if (lookupChunk(pChunk->chunk_number) != pChunk) {
+                freeChunk(pChunk);
+                continue;
+            }
+
             // Switch state to READ.
             pChunk->state = Chunk::READ;
         } else if (status.status == CHUNK_READ_EOF) {
@@ -350,6 +462,13 @@ int CachingReader::read(int sample, int num_samples, CSAMPLE* buffer) {
         }
     }
 
+    // If the whole range is already decoded into RAM, this is just a copy.
+    const int decoded_samples = trackBufferDecodedSamples();
+    if (sample + num_samples <= decoded_samples) {
+        SampleUtil::copy(buffer, m_pTrackBuffer->data + sample, num_samples);
+        return zerosWritten + num_samples;
+    }
+
     int start_sample = math_min(m_iTrackNumSamplesCallbackSafe,
                                 sample);
     int start_chunk = chunkForSample(start_sample);
@@ -367,6 +486,7 @@ int CachingReader::read(int sample, int num_samples, CSAMPLE* buffer) {
         return 0;
     }
 
+    int hits = 0;
     for (int chunk_num = start_chunk; chunk_num <= end_chunk; chunk_num++) {
         Chunk* current = lookupChunkAndFreshen(chunk_num);
 
@@ -378,9 +498,10 @@ int CachingReader::read(int sample, int num_samples, CSAMPLE* buffer) {
 
             // Something is wrong. Break out of the loop, that should fill the
             // samples requested with zeroes.
-            Counter("CachingReader::read cache miss")++;
+            Counter(kCacheMissStatKey)++;
             break;
         }
+        ++hits;
 
         int chunk_start_sample = CachingReaderWorker::sampleForChunk(chunk_num);
         int chunk_offset = current_sample - chunk_start_sample;
@@ -446,6 +567,10 @@ int CachingReader::read(int sample, int num_samples, CSAMPLE* buffer) {
         samples_remaining -= samples_to_read;
     }
 
+    if (hits > 0) {
+        Counter(kCacheHitStatKey) += hits;
+    }
+
     // If we didn't supply all the samples requested, that probably means we're
     // at the end of the file, or something is wrong. Provide zeroes and pretend
     // all is well. The caller can't be bothered to check how long the file is.
@@ -477,6 +602,19 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
     // that for stereo samples.
     const int default_samples = 2048;
 
+    // Give chunks back to the pool if we hold more than our share, e.g.
+    // because another deck started playing.
+    const int quota = m_pChunkPool->quotaForWeight(m_iWeight);
+    for (int i = 0; i < kMaxExpiredChunksPerCallback &&
+                 m_allocatedChunks.size() > quota; ++i) {
+        if (!expireChunk()) {
+            break;
+        }
+    }
+
+    // Hints that are entirely covered by the TrackBuffer need no chunks.
+    const int decoded_samples = trackBufferDecodedSamples();
+
     // For every chunk that the hints indicated, check if it is in the cache. If
     // any are not, then wake.
     bool shouldWake = false;
@@ -500,6 +638,9 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
             qDebug() << "ERROR: Negative hint length. Ignoring.";
             continue;
         }
+        if (hint.sample + hint.length <= decoded_samples) {
+            continue;
+        }
         int start_sample = math_clamp(hint.sample, 0,
                                       m_iTrackNumSamplesCallbackSafe);
         int start_chunk = chunkForSample(start_sample);
@@ -517,6 +658,7 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
                     continue;
                 }
                 pChunk->state = Chunk::READ_IN_PROGRESS;
+                pChunk->hint_priority = hint.priority;
                 ChunkReadRequest request;
                 request.chunk = pChunk;
                 // qDebug() << "Requesting read of chunk" << current << "into" << pChunk;
@@ -530,6 +672,7 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
                 // This will cause the chunk to be 'freshened' in the cache. The
                 // chunk will be moved to the end of the LRU list.
                 freshenChunk(pChunk);
+                pChunk->hint_priority = hint.priority;
             }
         }
     }
@@ -7,7 +7,6 @@
 #include <QtDebug>
 #include <QList>
 #include <QVector>
-#include <QLinkedList>
 #include <QHash>
 #include <QVarLengthArray>
 
@@ -17,6 +16,9 @@
 #include "engine/engineworker.h"
 #include "util/fifo.h"
 #include "cachingreaderworker.h"
+#include "cachingreaderchunkpool.h"
+
+class ControlObject;
 
 // A Hint is an indication to the CachingReader that a certain section of a
 // SoundSource will be used 'soon' and so it should be brought into memory by
@@ -27,8 +29,8 @@ typedef struct Hint {
     // If a range of samples should be present, use length to indicate that the
     // range (sample, sample+length) should be present in memory.
     int length;
-    // Currently unused -- but in the future could be used to prioritize certain
-    // hints over others. A priority of 1 is the highest priority and should be
+    // Used to prioritize certain hints over others when the reader has to
+    // evict a chunk. A priority of 1 is the highest priority and should be
     // used for samples that will be read imminently. Hints for samples that
     // have the potential to be read (i.e. a cue point) should be issued with
     // priority >10.
@@ -64,8 +66,17 @@ typedef QVarLengthArray<Hint, 512> HintVector;
 // least recently used chunks. When a chunk is "freshened" (i.e. accessed via
 // read or hinted via hintAndMaybeWake) then it is moved to the back of the
 // least-recently-used list. When a chunk needs to be allocated and there are no
-// free chunks then the least recently used chunk is free'd (see
-// allocateChunkExpireLRU).
+// free chunks then one of the least recently used chunks is free'd, preferring
+// the one with the least important Hint priority (see allocateChunkExpireLRU).
+//
+// The chunk memory itself is shared by all readers through the
+// CachingReaderChunkPool. A reader may hold up to its quota of chunks from the
+// pool, which is larger while the deck is playing (see setPlaying).
+//
+// If the decode_to_ram control of the group is enabled, the worker also
+// decodes the whole track into a TrackBuffer in the background. Reads that fall
+// into the already decoded part of the track are served straight from that
+// buffer, everything else still goes through the chunks.
 class CachingReader : public QObject {
     Q_OBJECT
 
@@ -96,7 +107,10 @@ class CachingReader : public QObject {
         m_pWorker->setScheduler(pScheduler);
     }
 
-    const static int maximumChunksInMemory;
+    // Tells the reader whether its deck is currently playing. Playing readers
+    // get a bigger share of the chunk pool. Must only be called from the
+    // engine callback.
+    void setPlaying(bool playing);
 
   signals:
     // Emitted once a new track is loaded and ready to be read from.
@@ -134,26 +148,45 @@ class CachingReader : public QObject {
     // Moves the provided chunk to the MRU position.
     void freshenChunk(Chunk* pChunk);
 
-    // Returns a Chunk to the free list
+    // Returns a Chunk to the chunk pool
     void freeChunk(Chunk* pChunk);
 
-    // Returns all allocated chunks to the free list
+    // Resets a chunk that is neither indexed nor in the LRU list and returns it
+    // to the chunk pool.
+    void releaseChunk(Chunk* pChunk);
+
+    // Returns all allocated chunks to the chunk pool
     void freeAllChunks();
 
-    // Gets a chunk from the free list. Returns NULL if none available.
+    // Gets a chunk from the chunk pool. Returns NULL if none available or if
+    // this reader already holds its quota of chunks.
     Chunk* allocateChunk(int chunk);
 
-    // Gets a chunk from the free list, frees the LRU Chunk if none available.
+    // Gets a chunk from the chunk pool, expires a chunk of this reader (see
+    // expireChunk) if none available.
     Chunk* allocateChunkExpireLRU(int chunk);
 
-    ReaderStatus m_readerStatus;
+    // Frees one of the least recently used chunks that is not being read by
+    // the worker, preferring the one with the highest hint_priority. Returns
+    // false if there is no such chunk.
+    bool expireChunk();
+
+    // Updates the weight of this reader in the chunk pool.
+    void setWeight(int weight);
 
-    // Keeps track of all Chunks we've allocated.
-    QVector<Chunk*> m_chunks;
+    // Returns the number of samples at the start of the track that are
+    // decoded into the TrackBuffer, 0 if there is none.
+    int trackBufferDecodedSamples() const;
 
-    // List of free chunks. Linked list so that we have constant time insertions
-    // and deletions. Iteration is not necessary.
-    QLinkedList<Chunk*> m_freeChunks;
+    // Hands the TrackBuffer back to the worker to be freed.
+    void releaseTrackBuffer();
+
+    ReaderStatus m_readerStatus;
+
+    // The chunk pool shared by all readers.
+    CachingReaderChunkPool* m_pChunkPool;
+    int m_iWeight;
+    bool m_bPlaying;
 
     // Keeps track of what Chunks we've allocated and indexes them based on what
     // chunk number they are allocated to.
@@ -163,11 +196,15 @@ class CachingReader : public QObject {
     Chunk* m_mruChunk;
     Chunk* m_lruChunk;
 
-    // The raw memory buffer which is divided up into chunks.
-    CSAMPLE* m_pRawMemoryBuffer;
-
     int m_iTrackNumSamplesCallbackSafe;
 
+    ControlObject* m_pDecodeToRam;
+    ControlObject* m_pTrackLoading;
+    ControlObject* m_pDecodeProgress;
+
+    // The whole track decoded into RAM, if decode_to_ram is enabled.
+    TrackBuffer* m_pTrackBuffer;
+
     CachingReaderWorker* m_pWorker;
 };
 
@@ -0,0 +1,213 @@
+#include <QtDebug>
+
+#include "cachingreaderchunkpool.h"
+#include "util/assert.h"
+#include "util/compatibility.h"
+#include "util/math.h"
+
+namespace {
+
+// currently CachingReaderWorker::kChunkLength is 65536 (0x10000), so every MiB
+// of budget holds 16 chunks. The default of 128 MiB is roughly 6 minutes of
+// 44.1 kHz stereo audio spread across all readers.
+const int kDefaultBudgetMiB = 128;
+// The old fixed per-reader cache was 80 chunks (5 MiB). Never go below that
+// for a single deck.
+const int kMinimumBudgetMiB = 5;
+const int kMaximumBudgetMiB = 4096;
+
+// The budget for decks that decode the whole track into RAM. 1 GiB is enough
+// for four 10 minute tracks at 48 kHz.
+const int kDefaultTrackBufferBudgetMiB = 1024;
+const int kMaximumTrackBufferBudgetMiB = 16384;
+
+int chunksForMiB(int mib) {
+    return static_cast<int>(static_cast<qint64>(mib) * 1024 * 1024 /
+                            CachingReaderWorker::kChunkLength);
+}
+
+int budgetFromConfig(ConfigObject<ConfigValue>* pConfig, const ConfigKey& key,
+                     int defaultMiB, int minimumMiB, int maximumMiB) {
+    if (pConfig == NULL) {
+        return defaultMiB;
+    }
+    bool ok = false;
+    int configuredMiB = pConfig->getValueString(key).toInt(&ok);
+    if (!ok) {
+        return defaultMiB;
+    }
+    return math_clamp(configuredMiB, minimumMiB, maximumMiB);
+}
+
+// SoundTouch reads up to 2 chunks ahead of the play position, plus a chunk for
+// each of the loop in and out points and the slip position. A reader is always
+// allowed to hold this many chunks, regardless of its share of the budget.
+const int kMinimumChunksPerReader = 16;
+
+}  // namespace
+
+const int CachingReaderChunkPool::kIdleWeight = 1;
+const int CachingReaderChunkPool::kPlayingWeight = 4;
+
+CachingReaderChunkPool* CachingReaderChunkPool::s_pInstance = NULL;
+int CachingReaderChunkPool::s_iRefCount = 0;
+
+// static
+CachingReaderChunkPool* CachingReaderChunkPool::acquire(
+        ConfigObject<ConfigValue>* pConfig) {
+    if (s_pInstance == NULL) {
+        int budgetMiB = budgetFromConfig(
+                pConfig, ConfigKey("[Master]", "CachingReaderMemoryMiB"),
+                kDefaultBudgetMiB, kMinimumBudgetMiB, kMaximumBudgetMiB);
+        int trackBufferBudgetMiB = budgetFromConfig(
+                pConfig, ConfigKey("[Master]", "DecodeToRamMemoryMiB"),
+                kDefaultTrackBufferBudgetMiB, 0, kMaximumTrackBufferBudgetMiB);
+        s_pInstance = new CachingReaderChunkPool(budgetMiB,
+                                                 trackBufferBudgetMiB);
+    }
+    ++s_iRefCount;
+    return s_pInstance;
+}
+
+// static
+void CachingReaderChunkPool::release(CachingReaderChunkPool* pPool) {
+    DEBUG_ASSERT_AND_HANDLE(pPool == s_pInstance && s_iRefCount > 0) {
+        return;
+    }
+    if (--s_iRefCount == 0) {
+        delete s_pInstance;
+        s_pInstance = NULL;
+    }
+}
+
+CachingReaderChunkPool::CachingReaderChunkPool(int budgetMiB,
+                                               int trackBufferBudgetMiB)
+        : m_pRawMemoryBuffer(NULL),
+          m_iFreeChunks(0),
+          m_lock(0),
+          m_totalWeight(0),
+          m_iTrackBufferBudgetChunks(chunksForMiB(trackBufferBudgetMiB)),
+          m_trackBufferChunksInUse(0) {
+    const int chunkCount = chunksForMiB(budgetMiB);
+    m_pRawMemoryBuffer =
+            new CSAMPLE[CachingReaderWorker::kSamplesPerChunk * chunkCount];
+
+    m_chunks.reserve(chunkCount);
+    m_freeChunks.resize(chunkCount);
+
+    // Divide up the allocated raw memory buffer into chunkCount chunks.
+    // Initialize each chunk to hold nothing and add it to the free list.
+    CSAMPLE* bufferStart = m_pRawMemoryBuffer;
+    for (int i = 0; i < chunkCount; ++i) {
+        Chunk* c = new Chunk;
+        c->chunk_number = -1;
+        c->length = 0;
+        c->data = bufferStart;
+        c->next_lru = NULL;
+        c->prev_lru = NULL;
+        c->hint_priority = 0;
+        c->state = Chunk::FREE;
+
+        m_chunks.push_back(c);
+        m_freeChunks[m_iFreeChunks++] = c;
+
+        bufferStart += CachingReaderWorker::kSamplesPerChunk;
+    }
+    qDebug() << "CachingReaderChunkPool allocated" << chunkCount
+             << "chunks (" << budgetMiB << "MiB )";
+}
+
+CachingReaderChunkPool::~CachingReaderChunkPool() {
+    if (load_atomic(m_trackBufferChunksInUse) != 0) {
+        qWarning() << "CachingReaderChunkPool destroyed with track buffers in use";
+    }
+    if (m_iFreeChunks != m_chunks.size()) {
+        qWarning() << "CachingReaderChunkPool destroyed with"
+                   << m_chunks.size() - m_iFreeChunks << "chunks in use";
+    }
+    qDeleteAll(m_chunks);
+    m_chunks.clear();
+    delete [] m_pRawMemoryBuffer;
+    m_pRawMemoryBuffer = NULL;
+}
+
+void CachingReaderChunkPool::lock() {
+    while (!m_lock.testAndSetAcquire(0, 1)) {
+    }
+}
+
+void CachingReaderChunkPool::unlock() {
+    m_lock.fetchAndStoreRelease(0);
+}
+
+Chunk* CachingReaderChunkPool::takeChunk() {
+    Chunk* pChunk = NULL;
+    lock();
+    if (m_iFreeChunks > 0) {
+        pChunk = m_freeChunks[--m_iFreeChunks];
+    }
+    unlock();
+    return pChunk;
+}
+
+void CachingReaderChunkPool::returnChunk(Chunk* pChunk) {
+    DEBUG_ASSERT(pChunk->state == Chunk::FREE);
+    lock();
+    DEBUG_ASSERT_AND_HANDLE(m_iFreeChunks < m_freeChunks.size()) {
+        unlock();
+        return;
+    }
+    m_freeChunks[m_iFreeChunks++] = pChunk;
+    unlock();
+}
+
+TrackBuffer* CachingReaderChunkPool::allocateTrackBuffer(int length) {
+    if (length <= 0) {
+        return NULL;
+    }
+    const int chunks = (length + CachingReaderWorker::kSamplesPerChunk - 1) /
+            CachingReaderWorker::kSamplesPerChunk;
+
+    // Reserve our part of the budget before allocating anything.
+    for (;;) {
+        const int inUse = load_atomic(m_trackBufferChunksInUse);
+        if (inUse + chunks > m_iTrackBufferBudgetChunks) {
+            qDebug() << "CachingReaderChunkPool: track buffer budget exhausted,"
+                     << "not decoding" << length << "samples into RAM";
+            return NULL;
+        }
+        if (m_trackBufferChunksInUse.testAndSetOrdered(inUse, inUse + chunks)) {
+            break;
+        }
+    }
+
+    TrackBuffer* pTrackBuffer = new TrackBuffer;
+    pTrackBuffer->data = new CSAMPLE[length];
+    pTrackBuffer->length = length;
+    pTrackBuffer->reservedChunks = chunks;
+    pTrackBuffer->decodedSamples.fetchAndStoreRelease(0);
+    return pTrackBuffer;
+}
+
+void CachingReaderChunkPool::freeTrackBuffer(TrackBuffer* pTrackBuffer) {
+    if (pTrackBuffer == NULL) {
+        return;
+    }
+    m_trackBufferChunksInUse.fetchAndAddOrdered(-pTrackBuffer->reservedChunks);
+    delete [] pTrackBuffer->data;
+    delete pTrackBuffer;
+}
+
+void CachingReaderChunkPool::adjustWeight(int delta) {
+    m_totalWeight.fetchAndAddOrdered(delta);
+}
+
+int CachingReaderChunkPool::quotaForWeight(int weight) const {
+    const int totalWeight = load_atomic(m_totalWeight);
+    if (weight <= 0 || totalWeight <= 0) {
+        return kMinimumChunksPerReader;
+    }
+    const int share = static_cast<int>(
+            static_cast<qint64>(m_chunks.size()) * weight / totalWeight);
+    return math_max(kMinimumChunksPerReader, share);
+}
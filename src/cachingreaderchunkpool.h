@@ -0,0 +1,90 @@
+#ifndef CACHINGREADERCHUNKPOOL_H
+#define CACHINGREADERCHUNKPOOL_H
+
+#include <QAtomicInt>
+#include <QVector>
+
+#include "configobject.h"
+#include "cachingreaderworker.h"
+#include "util.h"
+
+// CachingReaderChunkPool owns the memory for the decoded chunks of every
+// CachingReader in the process (decks, samplers and preview decks). The pool
+// is sized by a memory budget instead of a fixed number of chunks per reader,
+// so a single deck can keep much more of a track in memory than before.
+//
+// Every reader holds a weight in the pool: 0 without a track, kIdleWeight with
+// a loaded track and kPlayingWeight while playing. The number of chunks a
+// reader may hold (its quota) is its share of the total weight, so playing
+// decks grow at the expense of idle ones. Readers that are over their quota
+// give chunks back on the next callback (see CachingReader::hintAndMaybeWake).
+//
+// takeChunk and returnChunk are called from the engine callback, possibly from
+// several threads at once if channels are processed in parallel, so they are
+// guarded by a spin lock that is only ever held for a couple of instructions.
+//
+// The pool also bounds the memory used by decks that decode their whole track
+// into RAM. TrackBuffers have a separate budget since they are allocated and
+// freed by the reader workers, never in the callback.
+class CachingReaderChunkPool {
+  public:
+    static const int kIdleWeight;
+    static const int kPlayingWeight;
+
+    // Returns the shared pool, creating it with the budget from the config on
+    // first use. Each call must be balanced by a call to release(). Must only
+    // be called from the main thread.
+    static CachingReaderChunkPool* acquire(ConfigObject<ConfigValue>* pConfig);
+    static void release(CachingReaderChunkPool* pPool);
+
+    int chunkCount() const {
+        return m_chunks.size();
+    }
+
+    // Takes a FREE chunk out of the pool. Returns NULL if the pool is empty.
+    Chunk* takeChunk();
+    // Hands a chunk back to the pool. The chunk must be in the FREE state.
+    void returnChunk(Chunk* pChunk);
+
+    // Allocates a TrackBuffer for length samples if the track buffer budget
+    // allows it, otherwise returns NULL. Must not be called from the engine
+    // callback.
+    TrackBuffer* allocateTrackBuffer(int length);
+    // Frees a TrackBuffer and gives its memory back to the budget. Must not be
+    // called from the engine callback.
+    void freeTrackBuffer(TrackBuffer* pTrackBuffer);
+
+    // Adds delta to the total weight of all readers.
+    void adjustWeight(int delta);
+    // Returns the number of chunks a reader with the given weight may hold.
+    int quotaForWeight(int weight) const;
+
+  private:
+    CachingReaderChunkPool(int budgetMiB, int trackBufferBudgetMiB);
+    virtual ~CachingReaderChunkPool();
+
+    void lock();
+    void unlock();
+
+    // The raw memory buffer which is divided up into chunks.
+    CSAMPLE* m_pRawMemoryBuffer;
+    // All chunks of the pool.
+    QVector<Chunk*> m_chunks;
+    // Stack of free chunks. It is sized once to hold every chunk so it never
+    // reallocates; m_iFreeChunks is the number of valid entries.
+    QVector<Chunk*> m_freeChunks;
+    int m_iFreeChunks;
+    QAtomicInt m_lock;
+    QAtomicInt m_totalWeight;
+
+    // TrackBuffer memory is accounted for in units of chunks.
+    const int m_iTrackBufferBudgetChunks;
+    QAtomicInt m_trackBufferChunksInUse;
+
+    static CachingReaderChunkPool* s_pInstance;
+    static int s_iRefCount;
+
+    DISALLOW_COPY_AND_ASSIGN(CachingReaderChunkPool);
+};
+
+#endif /* CACHINGREADERCHUNKPOOL_H */
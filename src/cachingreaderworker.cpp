@@ -2,12 +2,13 @@
 #include <QFileInfo>
 
 #include "controlobject.h"
+#include "controlobjectslave.h"
 #include "controlobjectthread.h"
 
 #include "cachingreaderworker.h"
+#include "cachingreaderchunkpool.h"
 #include "trackinfoobject.h"
 #include "soundsourceproxy.h"
-#include "sampleutil.h"
 #include "util/compatibility.h"
 #include "util/event.h"
 #include "util/math.h"
@@ -27,20 +28,25 @@ const int CachingReaderWorker::kSamplesPerChunk = CHUNK_LENGTH / sizeof(CSAMPLE)
 
 
 CachingReaderWorker::CachingReaderWorker(QString group,
+        CachingReaderChunkPool* pChunkPool,
         FIFO<ChunkReadRequest>* pChunkReadRequestFIFO,
         FIFO<ReaderStatusUpdate>* pReaderStatusFIFO)
         : m_group(group),
           m_tag(QString("CachingReaderWorker %1").arg(m_group)),
           m_pChunkReadRequestFIFO(pChunkReadRequestFIFO),
           m_pReaderStatusFIFO(pReaderStatusFIFO),
+          m_pChunkPool(pChunkPool),
+          m_pTrackBuffer(NULL),
           m_iTrackNumSamples(0),
-          m_pSample(NULL),
           m_stop(0) {
-    m_pSample = new SAMPLE[kSamplesPerChunk];
+    // These controls are created by the CachingReader.
+    m_pDecodeToRam = new ControlObjectSlave(group, "decode_to_ram");
+    m_pTrackLoading = ControlObject::getControl(ConfigKey(group, "track_loading"));
+    m_pDecodeProgress = ControlObject::getControl(ConfigKey(group, "decode_progress"));
 }
 
 CachingReaderWorker::~CachingReaderWorker() {
-    delete [] m_pSample;
+    delete m_pDecodeToRam;
 }
 
 void CachingReaderWorker::processChunkReadRequest(ChunkReadRequest* request,
@@ -66,9 +72,11 @@ void CachingReaderWorker::processChunkReadRequest(ChunkReadRequest* request,
         return;
     }
 
+    // Decode straight into the chunk.
+    CSAMPLE* buffer = request->chunk->data;
     m_pCurrentSoundSource->seek(sample_position);
-    int samples_read = m_pCurrentSoundSource->read(samples_to_read,
-                                                   m_pSample);
+    int samples_read = m_pCurrentSoundSource->readFloat(samples_to_read,
+                                                        buffer);
 
     // If we've run out of music, the SoundSource can return 0 samples.
     // Remember that SoundSourc->getLength() (which is m_iTrackNumSamples) can
@@ -78,14 +86,36 @@ void CachingReaderWorker::processChunkReadRequest(ChunkReadRequest* request,
         return;
     }
 
-    CSAMPLE* buffer = request->chunk->data;
-    //qDebug() << "Reading into " << buffer;
-    SampleUtil::convertS16ToFloat32(buffer, m_pSample, samples_read);
-
     update->status = CHUNK_READ_SUCCESS;
     update->chunk->length = samples_read;
 }
 
+void CachingReaderWorker::decodeTrackBufferSlice() {
+    const int decoded = load_atomic(m_pTrackBuffer->decodedSamples);
+    const int samples_to_read = math_min(kSamplesPerChunk,
+                                         m_pTrackBuffer->length - decoded);
+    int samples_read = 0;
+    if (samples_to_read > 0 && m_pCurrentSoundSource) {
+        m_pCurrentSoundSource->seek(decoded);
+        samples_read = m_pCurrentSoundSource->readFloat(
+                samples_to_read, m_pTrackBuffer->data + decoded);
+    }
+
+    if (samples_read <= 0) {
+        // Done, or the SoundSource lied to us about the length of the track.
+        // Anything beyond what we got is served by the chunk path.
+        m_pDecodeProgress->set(1.0);
+        m_pTrackBuffer = NULL;
+        return;
+    }
+
+    // Publishing the new decoded length is the release point for the samples
+    // written above.
+    m_pTrackBuffer->decodedSamples.fetchAndStoreRelease(decoded + samples_read);
+    m_pDecodeProgress->set(
+            static_cast<double>(decoded + samples_read) / m_pTrackBuffer->length);
+}
+
 // WARNING: Always called from a different thread (GUI)
 void CachingReaderWorker::newTrack(TrackPointer pTrack) {
     m_newTrackMutex.lock();
@@ -110,9 +140,18 @@ void CachingReaderWorker::run() {
             m_newTrackMutex.unlock();
             loadTrack(pLoadTrack);
         } else if (m_pChunkReadRequestFIFO->read(&request, 1) == 1) {
+            if (request.trackBuffer != NULL) {
+                // The reader is done with a TrackBuffer of a previous track.
+                m_pChunkPool->freeTrackBuffer(request.trackBuffer);
+                continue;
+            }
             // Read the requested chunks.
             processChunkReadRequest(&request, &status);
             m_pReaderStatusFIFO->writeBlocking(&status, 1);
+        } else if (m_pTrackBuffer != NULL) {
+            // Fill the whole track buffer whenever there is nothing more
+            // urgent to do.
+            decodeTrackBufferSlice();
         } else {
             Event::end(m_tag);
             m_semaRun.acquire();
@@ -145,6 +184,7 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
 
     // Emit that a new track is loading, stops the current track
     emit(trackLoading());
+    m_pTrackLoading->set(1.0);
 
     ReaderStatusUpdate status;
     status.status = TRACK_NOT_LOADED;
@@ -154,6 +194,11 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
     m_pCurrentSoundSource.clear();
     m_iTrackNumSamples = 0;
 
+    // The buffer of the previous track belongs to the reader, which returns
+    // it once it sees the status update for this track.
+    m_pTrackBuffer = NULL;
+    m_pDecodeProgress->set(0.0);
+
     QString filename = pTrack->getLocation();
 
     if (filename.isEmpty() || !pTrack->exists()) {
@@ -161,6 +206,7 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
         qDebug() << m_group << "CachingReaderWorker::loadTrack() load failed for\""
                  << filename << "\", unlocked reader lock";
         m_pReaderStatusFIFO->writeBlocking(&status, 1);
+        m_pTrackLoading->set(0.0);
         emit(trackLoadFailed(
             pTrack, QString("The file '%1' could not be found.").arg(filename)));
         return;
@@ -172,6 +218,7 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
         qDebug() << m_group << "CachingReaderWorker::loadTrack() load failed for\""
                  << filename << "\", file invalid, unlocked reader lock";
         m_pReaderStatusFIFO->writeBlocking(&status, 1);
+        m_pTrackLoading->set(0.0);
         emit(trackLoadFailed(
             pTrack, QString("The file '%1' could not be loaded.").arg(filename)));
         return;
@@ -184,12 +231,29 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
     // Clear the chunks to read list.
     ChunkReadRequest request;
     while (m_pChunkReadRequestFIFO->read(&request, 1) == 1) {
+        if (request.trackBuffer != NULL) {
+            m_pChunkPool->freeTrackBuffer(request.trackBuffer);
+            continue;
+        }
         qDebug() << "Skipping read request for " << request.chunk->chunk_number;
         status.status = CHUNK_READ_INVALID;
         status.chunk = request.chunk;
         m_pReaderStatusFIFO->writeBlocking(&status, 1);
     }
 
+    // Decode the whole track into RAM in the background if the deck asks for
+    // it and the budget allows. The reader owns the buffer from here on.
+    if (m_pDecodeToRam->get() > 0.0) {
+        m_pTrackBuffer = m_pChunkPool->allocateTrackBuffer(m_iTrackNumSamples);
+        if (m_pTrackBuffer != NULL) {
+            status.status = TRACK_BUFFER_READY;
+            status.chunk = NULL;
+            status.trackBuffer = m_pTrackBuffer;
+            m_pReaderStatusFIFO->writeBlocking(&status, 1);
+        }
+    }
+    m_pTrackLoading->set(0.0);
+
     // Emit that the track has been loaded
     emit(trackLoaded(pTrack, m_pCurrentSoundSource->getSampleRate(), m_iTrackNumSamples));
 }
@@ -24,6 +24,9 @@ typedef struct Chunk {
     CSAMPLE* data;
     Chunk* prev_lru;
     Chunk* next_lru;
+    // The priority of the most recent Hint that covered this chunk. Used by
+    // CachingReader to pick which chunk to evict.
+    int hint_priority;
 
     enum State {
         FREE,
@@ -34,10 +37,24 @@ typedef struct Chunk {
     State state;
 } Chunk;
 
+// A TrackBuffer holds a whole track that is decoded into RAM in the background
+// (see the decode_to_ram control). The buffer is filled from the start, the
+// first decodedSamples samples of data are ready to be read.
+typedef struct TrackBuffer {
+    CSAMPLE* data;
+    int length;
+    // The number of chunks this buffer accounts for in the chunk pool.
+    int reservedChunks;
+    QAtomicInt decodedSamples;
+} TrackBuffer;
+
+// A ChunkReadRequest either asks the worker to read a chunk or hands a
+// TrackBuffer that the reader no longer uses back to the worker to be freed.
 typedef struct ChunkReadRequest {
     Chunk* chunk;
+    TrackBuffer* trackBuffer;
 
-    ChunkReadRequest() { chunk = NULL; }
+    ChunkReadRequest() { chunk = NULL; trackBuffer = NULL; }
 } ChunkReadRequest;
 
 enum ReaderStatus {
@@ -46,26 +63,34 @@ enum ReaderStatus {
     TRACK_LOADED,
     CHUNK_READ_SUCCESS,
     CHUNK_READ_EOF,
-    CHUNK_READ_INVALID
+    CHUNK_READ_INVALID,
+    TRACK_BUFFER_READY
 };
 
 typedef struct ReaderStatusUpdate {
     ReaderStatus status;
     Chunk* chunk;
+    TrackBuffer* trackBuffer;
     int trackNumSamples;
     ReaderStatusUpdate() {
         status = INVALID;
         chunk = NULL;
+        trackBuffer = NULL;
         trackNumSamples = 0;
     }
 } ReaderStatusUpdate;
 
+class CachingReaderChunkPool;
+class ControlObject;
+class ControlObjectSlave;
+
 class CachingReaderWorker : public EngineWorker {
     Q_OBJECT
 
   public:
     // Construct a CachingReader with the given group.
     CachingReaderWorker(QString group,
+            CachingReaderChunkPool* pChunkPool,
             FIFO<ChunkReadRequest>* pChunkReadRequestFIFO,
             FIFO<ReaderStatusUpdate>* pReaderStatusFIFO);
     virtual ~CachingReaderWorker();
@@ -117,12 +142,25 @@ class CachingReaderWorker : public EngineWorker {
     void processChunkReadRequest(ChunkReadRequest* request,
                                  ReaderStatusUpdate* update);
 
+    // Decodes the next slice of the current TrackBuffer. Chunk read requests
+    // are served in between slices so seeks stay responsive.
+    void decodeTrackBufferSlice();
+
+    // Used to hand out TrackBuffers and to free them once the reader returns
+    // them.
+    CachingReaderChunkPool* m_pChunkPool;
+    // The TrackBuffer of the current track while it is being decoded. Once the
+    // track changes, ownership is with the reader until it returns the buffer.
+    TrackBuffer* m_pTrackBuffer;
+
+    ControlObjectSlave* m_pDecodeToRam;
+    ControlObject* m_pTrackLoading;
+    ControlObject* m_pDecodeProgress;
+
     // The current sound source of the track loaded
     Mixxx::SoundSourcePointer m_pCurrentSoundSource;
     int m_iTrackNumSamples;
 
-    // Temporary buffer for reading from SoundSources
-    SAMPLE* m_pSample;
     QAtomicInt m_stop;
 };
 
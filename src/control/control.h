@@ -5,6 +5,7 @@
 #include <QMutex>
 #include <QString>
 #include <QObject>
+#include <QAtomicInt>
 #include <QAtomicPointer>
 
 #include "control/controlbehavior.h"
@@ -68,6 +69,12 @@ class ControlDoublePrivate : public QObject {
     inline double get() const {
         return m_value.getValue();
     }
+    // Returns a number that changes whenever the value changes. Lets a reader
+    // that polls, like the GuiTick delivery of ControlObjectSlave, tell if
+    // the value changed since it last looked without receiving a signal.
+    inline int changeCount() {
+        return m_changeCount.fetchAndAddAcquire(0);
+    }
     // Resets the control value to its default.
     void reset();
 
@@ -155,6 +162,8 @@ class ControlDoublePrivate : public QObject {
 
     // The control value.
     ControlValueAtomic<double> m_value;
+    // Incremented after every change of m_value.
+    QAtomicInt m_changeCount;
     // The default control value.
     ControlValueAtomic<double> m_defaultValue;
 
@@ -164,6 +164,11 @@ void ControllerEngine::gracefulShutdown() {
     // Clear the Script Value cache
     m_scriptValueCache.clear();
 
+    // Free the control handles given to scripts before the control object
+    // threads they refer to.
+    qDeleteAll(m_controlHandles);
+    m_controlHandles.clear();
+
     // Free all the control object threads
     QList<ConfigKey> keys = m_controlCache.keys();
     QList<ConfigKey>::iterator it = keys.begin();
@@ -647,10 +652,15 @@ void ControllerEngine::setValue(QString group, QString name, double newValue) {
     ControlObjectThread* cot = getControlObjectThread(group, name);
 
     if (cot != NULL) {
-        ControlObject* pControl = ControlObject::getControl(cot->getKey());
-        if (pControl && !m_st.ignore(pControl, cot->getParameterForValue(newValue))) {
-            cot->slotSet(newValue);
-        }
+        setControlValue(cot, newValue);
+    }
+}
+
+void ControllerEngine::setControlValue(ControlObjectThread* cot,
+                                       double newValue) {
+    ControlObject* pControl = cot->getCreatorCO();
+    if (pControl && !m_st.ignore(pControl, cot->getParameterForValue(newValue))) {
+        cot->slotSet(newValue);
     }
 }
 
@@ -755,6 +765,33 @@ double ControllerEngine::getDefaultParameter(QString group, QString name) {
     return cot->getParameterForValue(cot->getDefault());
 }
 
+/* -------- ------------------------------------------------------
+   Purpose: Returns a handle to a Mixxx control (for scripts)
+   Input:   Control group (e.g. [Channel1]), Key name (e.g. [filterHigh])
+   Output:  A ControllerEngineControl or null if the control does not exist
+   -------- ------------------------------------------------------ */
+QScriptValue ControllerEngine::getControl(QString group, QString name) {
+    if (m_pEngine == NULL) {
+        return QScriptValue();
+    }
+
+    ConfigKey key(group, name);
+    ControllerEngineControl* pHandle = m_controlHandles.value(key, NULL);
+    if (pHandle == NULL) {
+        ControlObjectThread* cot = getControlObjectThread(group, name);
+        if (cot == NULL) {
+            qWarning() << "ControllerEngine: Unknown control" << group << name
+                       << ", returning null";
+            return QScriptValue(QScriptValue::NullValue);
+        }
+        pHandle = new ControllerEngineControl(this, cot);
+        m_controlHandles.insert(key, pHandle);
+    }
+    // The handle is owned by this engine so scripts calling getControl
+    // repeatedly always get the same one.
+    return m_pEngine->newQObject(pHandle, QScriptEngine::QtOwnership);
+}
+
 /* -------- ------------------------------------------------------
    Purpose: qDebugs script output so it ends up in mixxx.log
    Input:   String to log
@@ -912,6 +949,73 @@ void ControllerEngineConnectionScriptValue::disconnect() {
     conn.ce->disconnectControl(conn);
 }
 
+ControllerEngineControl::ControllerEngineControl(ControllerEngine* pEngine,
+                                                 ControlObjectThread* pControl)
+        : QObject(pEngine),
+          m_pEngine(pEngine),
+          m_pControl(pControl) {
+}
+
+QString ControllerEngineControl::readGroup() const {
+    return m_pControl->getKey().group;
+}
+
+QString ControllerEngineControl::readName() const {
+    return m_pControl->getKey().item;
+}
+
+double ControllerEngineControl::getValue() {
+    return m_pControl->get();
+}
+
+void ControllerEngineControl::setValue(double newValue) {
+    if (isnan(newValue)) {
+        qWarning() << "ControllerEngine: script setting [" << readGroup()
+                   << "," << readName() << "] to NotANumber, ignoring.";
+        return;
+    }
+    m_pEngine->setControlValue(m_pControl, newValue);
+}
+
+double ControllerEngineControl::getParameter() {
+    return m_pControl->getParameter();
+}
+
+void ControllerEngineControl::setParameter(double newParameter) {
+    if (isnan(newParameter)) {
+        qWarning() << "ControllerEngine: script setting [" << readGroup()
+                   << "," << readName() << "] to NotANumber, ignoring.";
+        return;
+    }
+    // TODO(XXX): support soft takeover.
+    m_pControl->setParameter(newParameter);
+}
+
+double ControllerEngineControl::getParameterForValue(double value) {
+    if (isnan(value)) {
+        qWarning() << "ControllerEngine: script setting [" << readGroup()
+                   << "," << readName() << "] to NotANumber, ignoring.";
+        return 0.0;
+    }
+    return m_pControl->getParameterForValue(value);
+}
+
+void ControllerEngineControl::reset() {
+    m_pControl->reset();
+}
+
+double ControllerEngineControl::getDefaultValue() {
+    return m_pControl->getDefault();
+}
+
+double ControllerEngineControl::getDefaultParameter() {
+    return m_pControl->getParameterForValue(m_pControl->getDefault());
+}
+
+void ControllerEngineControl::trigger() {
+    m_pControl->emitValueChanged();
+}
+
 /**-------- ------------------------------------------------------
    Purpose: Receives valueChanged() slots from ControlObjects, and
    fires off the appropriate script function.
@@ -53,6 +53,36 @@ class ControllerEngineConnectionScriptValue : public QObject {
    ControllerEngineConnection conn;
 };
 
+// Script handle for one control, returned by engine.getControl(group, name).
+// The control is looked up once when the handle is created, so scripts that
+// access a control thousands of times per second (e.g. jog wheels on high
+// resolution controllers) do not build and hash a ConfigKey on every call.
+class ControllerEngineControl : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QString group READ readGroup)
+    Q_PROPERTY(QString name READ readName)
+  public:
+    ControllerEngineControl(ControllerEngine* pEngine,
+                            ControlObjectThread* pControl);
+    QString readGroup() const;
+    QString readName() const;
+
+    // Same as the engine methods of the same name.
+    Q_INVOKABLE double getValue();
+    Q_INVOKABLE void setValue(double newValue);
+    Q_INVOKABLE double getParameter();
+    Q_INVOKABLE void setParameter(double newParameter);
+    Q_INVOKABLE double getParameterForValue(double value);
+    Q_INVOKABLE void reset();
+    Q_INVOKABLE double getDefaultValue();
+    Q_INVOKABLE double getDefaultParameter();
+    Q_INVOKABLE void trigger();
+
+  private:
+    ControllerEngine* m_pEngine;
+    ControlObjectThread* m_pControl;
+};
+
 /* comparison function for ControllerEngineConnection */
 inline bool operator==(const ControllerEngineConnection &c1, const ControllerEngineConnection &c2) {
     return c1.id == c2.id && c1.key.group == c2.key.group && c1.key.item == c2.key.item;
@@ -94,6 +124,9 @@ class ControllerEngine : public QObject {
     Q_INVOKABLE void reset(QString group, QString name);
     Q_INVOKABLE double getDefaultValue(QString group, QString name);
     Q_INVOKABLE double getDefaultParameter(QString group, QString name);
+    // Returns a ControllerEngineControl for the control or null if it does
+    // not exist.
+    Q_INVOKABLE QScriptValue getControl(QString group, QString name);
     Q_INVOKABLE QScriptValue connectControl(QString group, QString name,
                                     QScriptValue function, bool disconnect = false);
     // Called indirectly by the objects returned by connectControl
@@ -161,6 +194,8 @@ class ControllerEngine : public QObject {
     QScriptEngine *m_pEngine;
 
     ControlObjectThread* getControlObjectThread(QString group, QString name);
+    // Sets cot to newValue unless soft takeover ignores it.
+    void setControlValue(ControlObjectThread* cot, double newValue);
 
     // Scratching functions & variables
     void scratchProcess(int timerId);
@@ -175,6 +210,7 @@ class ControllerEngine : public QObject {
     QList<QString> m_scriptFunctionPrefixes;
     QMap<QString,QStringList> m_scriptErrors;
     QHash<ConfigKey, ControlObjectThread*> m_controlCache;
+    QHash<ConfigKey, ControllerEngineControl*> m_controlHandles;
     struct TimerInfo {
         QScriptValue callback;
         QScriptValue context;
@@ -195,6 +231,8 @@ class ControllerEngine : public QObject {
     // Filesystem watcher for script auto-reload
     QFileSystemWatcher m_scriptWatcher;
     QList<QString> m_lastScriptPaths;
+
+    friend class ControllerEngineControl;
 };
 
 #endif
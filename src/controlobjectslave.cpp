@@ -3,24 +3,33 @@
 
 #include "controlobjectslave.h"
 #include "control/control.h"
+#include "waveform/guitick.h"
 
 ControlObjectSlave::ControlObjectSlave(QObject* pParent)
         : QObject(pParent),
-          m_pControl(NULL) {
+          m_pControl(NULL),
+          m_bGuiTickSubscribed(false),
+          m_iGuiTickChangeCount(0) {
 }
 
 ControlObjectSlave::ControlObjectSlave(const QString& g, const QString& i, QObject* pParent)
-        : QObject(pParent) {
+        : QObject(pParent),
+          m_bGuiTickSubscribed(false),
+          m_iGuiTickChangeCount(0) {
     initialize(ConfigKey(g, i));
 }
 
 ControlObjectSlave::ControlObjectSlave(const char* g, const char* i, QObject* pParent)
-        : QObject(pParent) {
+        : QObject(pParent),
+          m_bGuiTickSubscribed(false),
+          m_iGuiTickChangeCount(0) {
     initialize(ConfigKey(g, i));
 }
 
 ControlObjectSlave::ControlObjectSlave(const ConfigKey& key, QObject* pParent)
-        : QObject(pParent) {
+        : QObject(pParent),
+          m_bGuiTickSubscribed(false),
+          m_iGuiTickChangeCount(0) {
     initialize(key);
 }
 
@@ -33,6 +42,9 @@ void ControlObjectSlave::initialize(const ConfigKey& key) {
 }
 
 ControlObjectSlave::~ControlObjectSlave() {
+    if (m_bGuiTickSubscribed) {
+        GuiTick::removeTickSubscriber(this);
+    }
 }
 
 bool ControlObjectSlave::connectValueChanged(const QObject* receiver,
@@ -57,3 +69,20 @@ bool ControlObjectSlave::connectValueChanged(
         const char* method, Qt::ConnectionType type) {
     return connectValueChanged(parent(), method, type);
 }
+
+bool ControlObjectSlave::connectValueChangedOnGuiTick(const QObject* receiver,
+                                                      const char* method) {
+    if (!m_pControl) {
+        return false;
+    }
+    // GuiTick emits valueChanged(double) on the GUI thread, so the receiver
+    // is called directly.
+    bool ret = connect((QObject*)this, SIGNAL(valueChanged(double)),
+                       receiver, method, Qt::DirectConnection);
+    if (ret && !m_bGuiTickSubscribed) {
+        m_bGuiTickSubscribed = true;
+        m_iGuiTickChangeCount = m_pControl->changeCount();
+        GuiTick::addTickSubscriber(this);
+    }
+    return ret;
+}
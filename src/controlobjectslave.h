@@ -33,6 +33,25 @@ class ControlObjectSlave : public QObject {
     bool connectValueChanged(
             const char* method, Qt::ConnectionType type = Qt::AutoConnection);
 
+    // Like connectValueChanged(), but the receiver gets only the latest value,
+    // at most once per GuiTick, however often the value changed in between.
+    // Meant for widgets showing controls the engine changes on every callback.
+    // Must be called on the GUI thread, where the receiver is called. Unlike
+    // connectValueChanged(), changes made through this object are delivered.
+    // Do not use both on the same object.
+    bool connectValueChangedOnGuiTick(const QObject* receiver,
+                                      const char* method);
+
+    // Called by GuiTick. Emits valueChanged(double) if the value changed since
+    // the last call.
+    void deliverGuiTickChange() {
+        int changeCount = m_pControl->changeCount();
+        if (changeCount != m_iGuiTickChangeCount) {
+            m_iGuiTickChangeCount = changeCount;
+            emitValueChanged();
+        }
+    }
+
     // Called from update();
     inline void emitValueChanged() {
         emit(valueChanged(get()));
@@ -108,6 +127,10 @@ class ControlObjectSlave : public QObject {
     ConfigKey m_key;
     // Pointer to connected control.
     QSharedPointer<ControlDoublePrivate> m_pControl;
+    // Whether this is delivered by GuiTick, and the change count of the
+    // control at the last delivery.
+    bool m_bGuiTickSubscribed;
+    int m_iGuiTickChangeCount;
 };
 
 #endif // CONTROLOBJECTSLAVE_H
@@ -47,6 +47,11 @@ class ControlObjectThread : public QObject {
     }
 
     inline ConfigKey getKey() const { return m_key; }
+    // Returns the ControlObject that created the control or NULL if it was
+    // deleted. Unlike ControlObject::getControl() this needs no lookup.
+    inline ControlObject* getCreatorCO() const {
+        return m_pControl ? m_pControl->getCreatorCO() : NULL;
+    }
     inline bool valid() const { return m_pControl != NULL; }
 
     // Returns the value of the object. Thread safe, non-blocking.
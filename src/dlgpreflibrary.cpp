@@ -40,6 +40,10 @@ DlgPrefLibrary::DlgPrefLibrary(QWidget * parent,
     setupUi(this);
     slotUpdate();
     checkbox_ID3_sync->setVisible(false);
+#ifndef __LINUX__
+    // The library scanner only watches directories on Linux.
+    checkBox_watch_directories->setVisible(false);
+#endif
 
     connect(this, SIGNAL(requestAddDir(QString)),
             m_pLibrary, SLOT(slotRequestAddDir(QString)));
@@ -135,6 +139,7 @@ void DlgPrefLibrary::slotExtraPlugins() {
 
 void DlgPrefLibrary::slotResetToDefaults() {
     checkBox_library_scan->setChecked(false);
+    checkBox_watch_directories->setChecked(false);
     checkbox_ID3_sync->setChecked(false);
     checkBox_use_relative_path->setChecked(false);
     checkBox_show_rhythmbox->setChecked(true);
@@ -152,6 +157,8 @@ void DlgPrefLibrary::slotUpdate() {
     initialiseDirList();
     checkBox_library_scan->setChecked((bool)m_pconfig->getValueString(
             ConfigKey("[Library]","RescanOnStartup")).toInt());
+    checkBox_watch_directories->setChecked((bool)m_pconfig->getValueString(
+            ConfigKey("[Library]","WatchDirectories")).toInt());
     checkbox_ID3_sync->setChecked((bool)m_pconfig->getValueString(
             ConfigKey("[Library]","WriteAudioTags")).toInt());
     checkBox_use_relative_path->setChecked((bool)m_pconfig->getValueString(
@@ -285,6 +292,8 @@ void DlgPrefLibrary::slotRelocateDir() {
 void DlgPrefLibrary::slotApply() {
     m_pconfig->set(ConfigKey("[Library]","RescanOnStartup"),
                 ConfigValue((int)checkBox_library_scan->isChecked()));
+    m_pconfig->set(ConfigKey("[Library]","WatchDirectories"),
+                ConfigValue((int)checkBox_watch_directories->isChecked()));
     m_pconfig->set(ConfigKey("[Library]","WriteAudioTags"),
                 ConfigValue((int)checkbox_ID3_sync->isChecked()));
     m_pconfig->set(ConfigKey("[Library]","UseRelativePathOnExport"),
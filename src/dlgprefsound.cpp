@@ -79,6 +79,11 @@ DlgPrefSound::DlgPrefSound(QWidget* pParent, SoundManager* pSoundManager,
     }
     keylockComboBox->setCurrentIndex(EngineBuffer::RUBBERBAND);
 
+    channelProcessingComboBox->clear();
+    channelProcessingComboBox->addItem(tr("Serial"));
+    channelProcessingComboBox->addItem(tr("Parallel (experimental)"));
+    channelProcessingComboBox->setCurrentIndex(0);
+
     initializePaths();
     loadSettings();
 
@@ -92,6 +97,8 @@ DlgPrefSound::DlgPrefSound(QWidget* pParent, SoundManager* pSoundManager,
             this, SLOT(settingChanged()));
     connect(keylockComboBox, SIGNAL(currentIndexChanged(int)),
             this, SLOT(settingChanged()));
+    connect(channelProcessingComboBox, SIGNAL(currentIndexChanged(int)),
+            this, SLOT(settingChanged()));
 
     connect(queryButton, SIGNAL(clicked()),
             this, SLOT(queryClicked()));
@@ -148,6 +155,11 @@ DlgPrefSound::DlgPrefSound(QWidget* pParent, SoundManager* pSoundManager,
     m_pKeylockEngine =
             new ControlObjectSlave("[Master]", "keylock_engine", this);
 
+    m_pParallelProcessing =
+            new ControlObjectSlave("[Master]", "parallel_processing", this);
+    channelProcessingComboBox->setCurrentIndex(
+            m_pParallelProcessing->get() ? 1 : 0);
+
     connect(headDelaySpinBox, SIGNAL(valueChanged(double)),
             this, SLOT(headDelayChanged(double)));
     connect(masterDelaySpinBox, SIGNAL(valueChanged(double)),
@@ -193,6 +205,7 @@ void DlgPrefSound::slotApply() {
     }
 
     m_pKeylockEngine->set(keylockComboBox->currentIndex());
+    m_pParallelProcessing->set(channelProcessingComboBox->currentIndex());
 
     m_config.clearInputs();
     m_config.clearOutputs();
@@ -527,6 +540,9 @@ void DlgPrefSound::slotResetToDefaults() {
     keylockComboBox->setCurrentIndex(EngineBuffer::RUBBERBAND);
     m_pKeylockEngine->set(EngineBuffer::RUBBERBAND);
 
+    channelProcessingComboBox->setCurrentIndex(0);
+    m_pParallelProcessing->set(0.0);
+
     masterMixComboBox->setCurrentIndex(1);
     m_pMasterEnabled->set(1.0);
 
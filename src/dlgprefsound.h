@@ -96,6 +96,7 @@ class DlgPrefSound : public DlgPreferencePage, public Ui::DlgPrefSoundDlg  {
     ControlObjectSlave* m_pHeadDelay;
     ControlObjectSlave* m_pMasterDelay;
     ControlObjectSlave* m_pKeylockEngine;
+    ControlObjectSlave* m_pParallelProcessing;
     ControlObjectSlave* m_pMasterEnabled;
     ControlObjectSlave* m_pMasterMonoMixdown;
     ControlObjectSlave* m_pMasterTalkoverMix;
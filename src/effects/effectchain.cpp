@@ -48,6 +48,15 @@ void EffectChain::addToEngine(EngineEffectRack* pRack, int iIndex) {
     }
 }
 
+void EffectChain::registerChannel(const ChannelHandleAndGroup& handle_group) {
+    for (int i = 0; i < m_effects.size(); ++i) {
+        EffectPointer pEffect = m_effects[i];
+        if (pEffect) {
+            pEffect->registerChannel(handle_group);
+        }
+    }
+}
+
 void EffectChain::removeFromEngine(EngineEffectRack* pRack, int iIndex) {
     // Order doesn't matter when removing.
     for (int i = 0; i < m_effects.size(); ++i) {
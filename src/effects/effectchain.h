@@ -28,6 +28,7 @@ class EffectChain : public QObject {
     void addToEngine(EngineEffectRack* pRack, int iIndex);
     void removeFromEngine(EngineEffectRack* pRack, int iIndex);
     void updateEngineState();
+    void registerChannel(const ChannelHandleAndGroup& handle_group);
 
     // The ID of an EffectChain is a unique ID given to it to help associate it
     // with the preset from which it was loaded.
@@ -5,12 +5,21 @@
 #include <QHash>
 #include <QPair>
 
+#include "sampleutil.h"
 #include "util/types.h"
 #include "engine/effects/groupfeaturestate.h"
 #include "engine/channelhandle.h"
 
 class EngineEffect;
 
+// The state an EffectProcessor keeps for one channel. Channel states are only
+// ever created and deleted in the main thread so the engine never allocates
+// while processing effects.
+class EffectChannelState {
+  public:
+    virtual ~EffectChannelState() { }
+};
+
 class EffectProcessor {
   public:
     enum EnableState {
@@ -23,9 +32,28 @@ class EffectProcessor {
 
     virtual ~EffectProcessor() { }
 
+    // Called in the main thread before the processor is handed to the engine.
+    // Creates the state of every channel registered so far.
     virtual void initialize(
             const QSet<ChannelHandleAndGroup>& registeredChannels) = 0;
 
+    // Called in the main thread for channels that are registered after the
+    // processor was handed to the engine. Returns NULL if the processor keeps
+    // no per-channel state.
+    virtual EffectChannelState* createChannelState() {
+        return NULL;
+    }
+
+    // Called in the engine thread to store a state made by
+    // createChannelState(). Returns false if handle already has a state, in
+    // which case pState still belongs to the caller.
+    virtual bool addChannelState(const ChannelHandle& handle,
+                                 EffectChannelState* pState) {
+        Q_UNUSED(handle);
+        Q_UNUSED(pState);
+        return false;
+    }
+
     // Take a buffer of numSamples samples of audio from a channel, provided as
     // pInput, process the buffer according to Effect-specific logic, and output
     // it to the buffer pOutput. If pInput is equal to pOutput, then the
@@ -44,12 +72,17 @@ class EffectProcessor {
 };
 
 // Helper class for automatically fetching channel state parameters upon receipt
-// of a channel-specific process call.
+// of a channel-specific process call. The state of every channel is created in
+// the main thread by initialize() or createChannelState(), so process() only
+// looks it up. A channel without a state is passed through unprocessed.
 template <typename T>
 class PerChannelEffectProcessor : public EffectProcessor {
+    struct ChannelState : public EffectChannelState {
+        T state;
+    };
     struct ChannelStateHolder {
         ChannelStateHolder() : state(NULL) { }
-        T* state;
+        ChannelState* state;
     };
   public:
     PerChannelEffectProcessor() {
@@ -58,7 +91,7 @@ class PerChannelEffectProcessor : public EffectProcessor {
         for (typename ChannelHandleMap<ChannelStateHolder>::iterator it =
                      m_channelState.begin();
              it != m_channelState.end(); ++it) {
-            T* pState = it->state;
+            ChannelState* pState = it->state;
             delete pState;
         }
         m_channelState.clear();
@@ -67,19 +100,45 @@ class PerChannelEffectProcessor : public EffectProcessor {
     virtual void initialize(
             const QSet<ChannelHandleAndGroup>& registeredChannels) {
         foreach (const ChannelHandleAndGroup& channel, registeredChannels) {
-            getOrCreateChannelState(channel.handle());
+            ChannelStateHolder& holder = m_channelState[channel.handle()];
+            if (holder.state == NULL) {
+                holder.state = new ChannelState();
+            }
         }
     }
 
+    virtual EffectChannelState* createChannelState() {
+        return new ChannelState();
+    }
+
+    virtual bool addChannelState(const ChannelHandle& handle,
+                                 EffectChannelState* pState) {
+        // ChannelHandleMap keeps the first 256 channels inline, so this does
+        // not allocate either.
+        ChannelStateHolder& holder = m_channelState[handle];
+        if (holder.state != NULL || !handle.valid()) {
+            return false;
+        }
+        holder.state = static_cast<ChannelState*>(pState);
+        return true;
+    }
+
     virtual void process(const ChannelHandle& handle,
                          const CSAMPLE* pInput, CSAMPLE* pOutput,
                          const unsigned int numSamples,
                          const unsigned int sampleRate,
                          const EffectProcessor::EnableState enableState,
                          const GroupFeatureState& groupFeatures) {
-        T* pState = getOrCreateChannelState(handle);
-        processChannel(handle, pState, pInput, pOutput, numSamples, sampleRate,
-                       enableState, groupFeatures);
+        ChannelState* pState = m_channelState.at(handle).state;
+        if (pState == NULL) {
+            // The state of a newly registered channel has not arrived yet.
+            if (pInput != pOutput) {
+                SampleUtil::copy(pOutput, pInput, numSamples);
+            }
+            return;
+        }
+        processChannel(handle, &pState->state, pInput, pOutput, numSamples,
+                       sampleRate, enableState, groupFeatures);
     }
 
     virtual void processChannel(const ChannelHandle& handle,
@@ -91,14 +150,6 @@ class PerChannelEffectProcessor : public EffectProcessor {
                                 const GroupFeatureState& groupFeatures) = 0;
 
   private:
-    inline T* getOrCreateChannelState(const ChannelHandle& handle) {
-        ChannelStateHolder& holder = m_channelState[handle];
-        if (holder.state == NULL) {
-            holder.state = new T();
-        }
-        return holder.state;
-    }
-
     ChannelHandleMap<ChannelStateHolder> m_channelState;
 };
 
@@ -7,11 +7,26 @@
 #include "engine/effects/engineeffect.h"
 #include "engine/effects/engineeffectrack.h"
 #include "engine/effects/engineeffectchain.h"
+#include "sampleutil.h"
 #include "util/assert.h"
+#include "util/defs.h"
 
 const char* kEqualizerRackName = "[EqualizerChain]";
 const char* kQuickEffectRackName = "[QuickEffectChain]";
 
+namespace {
+
+// Frees what a request carries to the engine if the engine did not take it.
+void freeUndeliveredData(EffectsRequest* request) {
+    if (request->type == EffectsRequest::ADD_EFFECT_CHANNEL_STATE) {
+        delete request->AddEffectChannelState.pState;
+    } else if (request->type == EffectsRequest::REGISTER_CHANNEL) {
+        SampleUtil::free(request->RegisterChannel.pScratchBuffer);
+    }
+}
+
+}  // namespace
+
 EffectsManager::EffectsManager(QObject* pParent, ConfigObject<ConfigValue>* pConfig)
         : QObject(pParent),
           m_pEffectChainManager(new EffectChainManager(pConfig, this)),
@@ -41,6 +56,8 @@ EffectsManager::~EffectsManager() {
     }
     for (QHash<qint64, EffectsRequest*>::iterator it = m_activeRequests.begin();
          it != m_activeRequests.end();) {
+        // All responses were processed above, so the engine never saw these.
+        freeUndeliveredData(it.value());
         delete it.value();
         it = m_activeRequests.erase(it);
     }
@@ -63,6 +80,16 @@ void EffectsManager::addEffectsBackend(EffectsBackend* pBackend) {
 }
 
 void EffectsManager::registerChannel(const ChannelHandleAndGroup& handle_group) {
+    if (!registeredChannels().contains(handle_group)) {
+        // The effects of the channel may run concurrently with those of other
+        // channels, so each channel needs a scratch buffer of its own.
+        EffectsRequest* request = new EffectsRequest();
+        request->type = EffectsRequest::REGISTER_CHANNEL;
+        request->channel = handle_group.handle();
+        request->RegisterChannel.pScratchBuffer =
+                SampleUtil::alloc(MAX_BUFFER_LEN);
+        writeRequest(request);
+    }
     m_pEffectChainManager->registerChannel(handle_group);
 }
 
@@ -278,11 +305,13 @@ bool EffectsManager::writeRequest(EffectsRequest* request) {
             //qDebug() << debugString() << "delete" << request->RemoveEffectRack.pRack;
             delete request->RemoveEffectRack.pRack;
         }
+        freeUndeliveredData(request);
         delete request;
         return false;
     }
 
     if (m_pRequestPipe.isNull()) {
+        freeUndeliveredData(request);
         delete request;
         return false;
     }
@@ -297,6 +326,7 @@ bool EffectsManager::writeRequest(EffectsRequest* request) {
         m_activeRequests[request->request_id] = request;
         return true;
     }
+    freeUndeliveredData(request);
     delete request;
     return false;
 }
@@ -324,6 +354,7 @@ void EffectsManager::processEffectsResponses() {
             if (!response.success) {
                 qWarning() << debugString() << "WARNING: Failed EffectsRequest"
                            << "type" << pRequest->type;
+                freeUndeliveredData(pRequest);
             } else {
                 //qDebug() << debugString() << "EffectsRequest Success"
                 //           << "type" << pRequest->type;
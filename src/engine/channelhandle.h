@@ -157,8 +157,10 @@ class ChannelHandleMap {
     typedef typename QVarLengthArray<T, kMaxExpectedGroups>::const_iterator const_iterator;
     typedef typename QVarLengthArray<T, kMaxExpectedGroups>::iterator iterator;
 
+    // Returns a default constructed T for handles that were never inserted.
+    // Unlike operator[], this never grows the map.
     const T& at(const ChannelHandle& handle) const {
-        if (!handle.valid()) {
+        if (!handle.valid() || handle.handle() >= m_data.size()) {
             return m_dummy;
         }
         return m_data.at(handle.handle());
@@ -81,12 +81,36 @@ bool EngineEffect::processEffectsRequest(const EffectsRequest& message,
             }
             pResponsePipe->writeMessages(&response, 1);
             return true;
+        case EffectsRequest::ADD_EFFECT_CHANNEL_STATE:
+            if (kEffectDebugOutput) {
+                qDebug() << debugString() << "ADD_EFFECT_CHANNEL_STATE"
+                         << message.channel;
+            }
+            response.success = m_pProcessor->addChannelState(
+                message.channel, message.AddEffectChannelState.pState);
+            if (!response.success) {
+                response.status = EffectsResponse::INVALID_REQUEST;
+            }
+            pResponsePipe->writeMessages(&response, 1);
+            return true;
         default:
             break;
     }
     return false;
 }
 
+void EngineEffect::onCallbackStart() {
+    if (m_enableState == EffectProcessor::DISABLING) {
+        m_enableState = EffectProcessor::DISABLED;
+    } else if (m_enableState == EffectProcessor::ENABLING) {
+        m_enableState = EffectProcessor::ENABLED;
+    }
+}
+
+EffectChannelState* EngineEffect::createChannelState() {
+    return m_pProcessor->createChannelState();
+}
+
 void EngineEffect::process(const ChannelHandle& handle,
                            const CSAMPLE* pInput, CSAMPLE* pOutput,
                            const unsigned int numSamples,
@@ -118,10 +142,4 @@ void EngineEffect::process(const ChannelHandle& handle,
                     numSamples);
         }
     }
-
-    if (m_enableState == EffectProcessor::DISABLING) {
-        m_enableState = EffectProcessor::DISABLED;
-    } else if (m_enableState == EffectProcessor::ENABLING) {
-        m_enableState = EffectProcessor::ENABLED;
-    }
 }
@@ -35,6 +35,17 @@ class EngineEffect : public EffectsRequestHandler {
         const EffectsRequest& message,
         EffectsResponsePipe* pResponsePipe);
 
+    // Called in the main thread to create the state of a channel registered
+    // after this effect was created. The state is handed to the engine with
+    // an ADD_EFFECT_CHANNEL_STATE request. Returns NULL if the effect keeps
+    // no per-channel state.
+    EffectChannelState* createChannelState();
+
+    // Finishes the enable or disable ramp of the effect once all channels had
+    // a callback to ramp in.
+    void onCallbackStart();
+
+    // May be called concurrently for different channels.
     void process(const ChannelHandle& handle,
                  const CSAMPLE* pInput, CSAMPLE* pOutput,
                  const unsigned int numSamples,
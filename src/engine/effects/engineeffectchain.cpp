@@ -8,14 +8,12 @@ EngineEffectChain::EngineEffectChain(const QString& id)
         : m_id(id),
           m_enableState(EffectProcessor::ENABLED),
           m_insertionType(EffectChain::INSERT),
-          m_dMix(0),
-          m_pBuffer(SampleUtil::alloc(MAX_BUFFER_LEN)) {
+          m_dMix(0) {
     // Try to prevent memory allocation.
     m_effects.reserve(256);
 }
 
 EngineEffectChain::~EngineEffectChain() {
-    SampleUtil::free(m_pBuffer);
 }
 
 bool EngineEffectChain::addEffect(EngineEffect* pEffect, int iIndex) {
@@ -149,19 +147,30 @@ EngineEffectChain::ChannelStatus& EngineEffectChain::getChannelStatus(
     return m_channelStatus[handle];
 }
 
+void EngineEffectChain::onCallbackStart() {
+    if (m_enableState == EffectProcessor::DISABLING) {
+        m_enableState = EffectProcessor::DISABLED;
+    } else if (m_enableState == EffectProcessor::ENABLING) {
+        m_enableState = EffectProcessor::ENABLED;
+    }
+}
+
 void EngineEffectChain::process(const ChannelHandle& handle,
                                 CSAMPLE* pInOut,
+                                CSAMPLE* pScratch,
                                 const unsigned int numSamples,
                                 const unsigned int sampleRate,
                                 const GroupFeatureState& groupFeatures) {
-    ChannelStatus& channel_info = getChannelStatus(handle);
-
+    // Channels only get a ChannelStatus through ENABLE_EFFECT_CHAIN_FOR_CHANNEL
+    // or DISABLE_EFFECT_CHAIN_FOR_CHANNEL. Looking it up with at() does not
+    // grow m_channelStatus, which other channels may be reading concurrently.
     if (m_enableState == EffectProcessor::DISABLED
-            || channel_info.enable_state == EffectProcessor::DISABLED) {
+            || m_channelStatus.at(handle).enable_state == EffectProcessor::DISABLED) {
         // If the chain is not enabled and the channel is not enabled and we are not
         // ramping out then do nothing.
         return;
     }
+    ChannelStatus& channel_info = m_channelStatus[handle];
 
     EffectProcessor::EnableState effectiveEnableState = channel_info.enable_state;
 
@@ -193,7 +202,7 @@ void EngineEffectChain::process(const ChannelHandle& handle,
             // Fully dry, no ramp, insert optimization. No action is needed
         } else {
             // Clear scratch buffer.
-            SampleUtil::clear(m_pBuffer, numSamples);
+            SampleUtil::clear(pScratch, numSamples);
 
             // Chain each effect
             bool anyProcessed = false;
@@ -202,8 +211,8 @@ void EngineEffectChain::process(const ChannelHandle& handle,
                 if (pEffect == NULL || !pEffect->enabled()) {
                     continue;
                 }
-                const CSAMPLE* pIntermediateInput = (i == 0) ? pInOut : m_pBuffer;
-                CSAMPLE* pIntermediateOutput = m_pBuffer;
+                const CSAMPLE* pIntermediateInput = (i == 0) ? pInOut : pScratch;
+                CSAMPLE* pIntermediateOutput = pScratch;
                 pEffect->process(handle, pIntermediateInput, pIntermediateOutput,
                                  numSamples, sampleRate,
                                  effectiveEnableState, groupFeatures);
@@ -211,17 +220,17 @@ void EngineEffectChain::process(const ChannelHandle& handle,
             }
 
             if (anyProcessed) {
-                // m_pBuffer now contains the fully wet output.
+                // pScratch now contains the fully wet output.
                 // TODO(rryan): benchmark applyGain followed by addWithGain versus
                 // copy2WithGain.
                 SampleUtil::copy2WithRampingGain(
                     pInOut, pInOut, 1.0 - wet_gain_old, 1.0 - wet_gain,
-                    m_pBuffer, wet_gain_old, wet_gain, numSamples);
+                    pScratch, wet_gain_old, wet_gain, numSamples);
             }
         }
     } else { // SEND mode: output = input + effect(input) * wet
         // Clear scratch buffer.
-        SampleUtil::applyGain(m_pBuffer, 0.0, numSamples);
+        SampleUtil::applyGain(pScratch, 0.0, numSamples);
 
         // Chain each effect
         bool anyProcessed = false;
@@ -230,8 +239,8 @@ void EngineEffectChain::process(const ChannelHandle& handle,
             if (pEffect == NULL || !pEffect->enabled()) {
                 continue;
             }
-            const CSAMPLE* pIntermediateInput = (i == 0) ? pInOut : m_pBuffer;
-            CSAMPLE* pIntermediateOutput = m_pBuffer;
+            const CSAMPLE* pIntermediateInput = (i == 0) ? pInOut : pScratch;
+            CSAMPLE* pIntermediateOutput = pScratch;
             pEffect->process(handle, pIntermediateInput,
                              pIntermediateOutput, numSamples, sampleRate,
                              effectiveEnableState, groupFeatures);
@@ -239,8 +248,8 @@ void EngineEffectChain::process(const ChannelHandle& handle,
         }
 
         if (anyProcessed) {
-            // m_pBuffer now contains the fully wet output.
-            SampleUtil::addWithRampingGain(pInOut, m_pBuffer,
+            // pScratch now contains the fully wet output.
+            SampleUtil::addWithRampingGain(pInOut, pScratch,
                                            wet_gain_old, wet_gain, numSamples);
         }
     }
@@ -248,12 +257,6 @@ void EngineEffectChain::process(const ChannelHandle& handle,
     // Update ChannelStatus with the latest values.
     channel_info.old_gain = wet_gain;
 
-    if (m_enableState == EffectProcessor::DISABLING) {
-        m_enableState = EffectProcessor::DISABLED;
-    } else if (m_enableState == EffectProcessor::ENABLING) {
-        m_enableState = EffectProcessor::ENABLED;
-    }
-
     if (channel_info.enable_state == EffectProcessor::DISABLING) {
         channel_info.enable_state = EffectProcessor::DISABLED;
     } else if (channel_info.enable_state == EffectProcessor::ENABLING) {
@@ -23,8 +23,15 @@ class EngineEffectChain : public EffectsRequestHandler {
         const EffectsRequest& message,
         EffectsResponsePipe* pResponsePipe);
 
+    // Finishes the enable or disable ramp of the chain once all channels had
+    // a callback to ramp in.
+    void onCallbackStart();
+
+    // May be called concurrently for different channels. pScratch is a
+    // buffer of at least numSamples samples that belongs to the channel.
     void process(const ChannelHandle& handle,
                  CSAMPLE* pInOut,
+                 CSAMPLE* pScratch,
                  const unsigned int numSamples,
                  const unsigned int sampleRate,
                  const GroupFeatureState& groupFeatures);
@@ -64,7 +71,6 @@ class EngineEffectChain : public EffectsRequestHandler {
     EffectChain::InsertionType m_insertionType;
     CSAMPLE m_dMix;
     QList<EngineEffect*> m_effects;
-    CSAMPLE* m_pBuffer;
     ChannelHandleMap<ChannelStatus> m_channelStatus;
 
     DISALLOW_COPY_AND_ASSIGN(EngineEffectChain);
@@ -44,12 +44,14 @@ bool EngineEffectRack::processEffectsRequest(const EffectsRequest& message,
 
 void EngineEffectRack::process(const ChannelHandle& handle,
                                CSAMPLE* pInOut,
+                               CSAMPLE* pScratch,
                                const unsigned int numSamples,
                                const unsigned int sampleRate,
                                const GroupFeatureState& groupFeatures) {
     foreach (EngineEffectChain* pChain, m_chains) {
         if (pChain != NULL) {
-            pChain->process(handle, pInOut, numSamples, sampleRate, groupFeatures);
+            pChain->process(handle, pInOut, pScratch, numSamples, sampleRate,
+                            groupFeatures);
         }
     }
 }
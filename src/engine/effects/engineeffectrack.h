@@ -20,6 +20,7 @@ class EngineEffectRack : public EffectsRequestHandler {
 
     void process(const ChannelHandle& handle,
                  CSAMPLE* pInOut,
+                 CSAMPLE* pScratch,
                  const unsigned int numSamples,
                  const unsigned int sampleRate,
                  const GroupFeatureState& groupFeatures);
@@ -3,6 +3,7 @@
 #include "engine/effects/engineeffectrack.h"
 #include "engine/effects/engineeffectchain.h"
 #include "engine/effects/engineeffect.h"
+#include "sampleutil.h"
 
 EngineEffectsManager::EngineEffectsManager(EffectsResponsePipe* pResponsePipe)
         : m_pResponsePipe(pResponsePipe) {
@@ -13,9 +14,23 @@ EngineEffectsManager::EngineEffectsManager(EffectsResponsePipe* pResponsePipe)
 }
 
 EngineEffectsManager::~EngineEffectsManager() {
+    for (ChannelHandleMap<ScratchBuffer>::iterator it =
+                 m_scratchBuffers.begin();
+         it != m_scratchBuffers.end(); ++it) {
+        SampleUtil::free(it->pBuffer);
+    }
 }
 
 void EngineEffectsManager::onCallbackStart() {
+    // Every channel has seen the ramps started in the last callback, so they
+    // can end before new requests start others.
+    foreach (EngineEffectChain* pChain, m_chains) {
+        pChain->onCallbackStart();
+    }
+    foreach (EngineEffect* pEffect, m_effects) {
+        pEffect->onCallbackStart();
+    }
+
     EffectsRequest* request = NULL;
     while (m_pResponsePipe->readMessages(&request, 1) > 0) {
         EffectsResponse response(*request);
@@ -23,6 +38,7 @@ void EngineEffectsManager::onCallbackStart() {
         switch (request->type) {
             case EffectsRequest::ADD_EFFECT_RACK:
             case EffectsRequest::REMOVE_EFFECT_RACK:
+            case EffectsRequest::REGISTER_CHANNEL:
                 if (processEffectsRequest(*request, m_pResponsePipe.data())) {
                     processed = true;
                 }
@@ -98,6 +114,7 @@ void EngineEffectsManager::onCallbackStart() {
                 break;
             case EffectsRequest::SET_EFFECT_PARAMETERS:
             case EffectsRequest::SET_PARAMETER_PARAMETERS:
+            case EffectsRequest::ADD_EFFECT_CHANNEL_STATE:
                 if (!m_effects.contains(request->pTargetEffect)) {
                     if (kEffectDebugOutput) {
                         qDebug() << debugString()
@@ -135,8 +152,13 @@ void EngineEffectsManager::process(const ChannelHandle& handle,
                                    const unsigned int numSamples,
                                    const unsigned int sampleRate,
                                    const GroupFeatureState& groupFeatures) {
+    CSAMPLE* pScratch = m_scratchBuffers.at(handle).pBuffer;
+    if (pScratch == NULL) {
+        return;
+    }
     foreach (EngineEffectRack* pRack, m_racks) {
-        pRack->process(handle, pInOut, numSamples, sampleRate, groupFeatures);
+        pRack->process(handle, pInOut, pScratch, numSamples, sampleRate,
+                       groupFeatures);
     }
 }
 
@@ -156,6 +178,21 @@ bool EngineEffectsManager::removeEffectRack(EngineEffectRack* pRack) {
     return m_racks.removeAll(pRack) > 0;
 }
 
+bool EngineEffectsManager::registerChannel(const ChannelHandle& handle,
+                                           CSAMPLE* pScratchBuffer) {
+    if (!handle.valid() || m_scratchBuffers.at(handle).pBuffer != NULL) {
+        if (kEffectDebugOutput) {
+            qDebug() << debugString() << "WARNING: channel already registered:"
+                     << handle;
+        }
+        return false;
+    }
+    // ChannelHandleMap keeps the first 256 channels inline, so this does not
+    // allocate.
+    m_scratchBuffers[handle].pBuffer = pScratchBuffer;
+    return true;
+}
+
 bool EngineEffectsManager::processEffectsRequest(const EffectsRequest& message,
                                                  EffectsResponsePipe* pResponsePipe) {
     EffectsResponse response(message);
@@ -174,6 +211,14 @@ bool EngineEffectsManager::processEffectsRequest(const EffectsRequest& message,
             }
             response.success = removeEffectRack(message.RemoveEffectRack.pRack);
             break;
+        case EffectsRequest::REGISTER_CHANNEL:
+            if (kEffectDebugOutput) {
+                qDebug() << debugString() << "REGISTER_CHANNEL"
+                         << message.channel;
+            }
+            response.success = registerChannel(
+                message.channel, message.RegisterChannel.pScratchBuffer);
+            break;
         default:
             return false;
     }
@@ -27,6 +27,12 @@ class EngineEffectsManager : public EffectsRequestHandler {
     // represented as stereo interleaved samples. There are numSamples total
     // samples, so numSamples/2 left channel samples and numSamples/2 right
     // channel samples.
+    //
+    // May be called concurrently for different channels, e.g. from the
+    // workers of EngineMaster's RealtimeWorkerPool. Each channel has its own
+    // scratch buffer and effect state, and all state shared between channels
+    // is only changed in onCallbackStart(). Channels whose REGISTER_CHANNEL
+    // request has not arrived yet are left unprocessed.
     virtual void process(const ChannelHandle& handle,
                          CSAMPLE* pInOut,
                          const unsigned int numSamples,
@@ -38,17 +44,26 @@ class EngineEffectsManager : public EffectsRequestHandler {
         EffectsResponsePipe* pResponsePipe);
 
   private:
+    struct ScratchBuffer {
+        ScratchBuffer() : pBuffer(NULL) { }
+        CSAMPLE* pBuffer;
+    };
+
     QString debugString() const {
         return QString("EngineEffectsManager");
     }
 
     bool addEffectRack(EngineEffectRack* pRack);
     bool removeEffectRack(EngineEffectRack* pRack);
+    bool registerChannel(const ChannelHandle& handle, CSAMPLE* pScratchBuffer);
 
     QScopedPointer<EffectsResponsePipe> m_pResponsePipe;
     QList<EngineEffectRack*> m_racks;
     QList<EngineEffectChain*> m_chains;
     QList<EngineEffect*> m_effects;
+    // The scratch buffer every chain uses for the channel. Allocated in the
+    // main thread and sent with REGISTER_CHANNEL.
+    ChannelHandleMap<ScratchBuffer> m_scratchBuffers;
 };
 
 
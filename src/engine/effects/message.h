@@ -6,6 +6,7 @@
 #include <QtGlobal>
 
 #include "util/fifo.h"
+#include "util/types.h"
 #include "effects/effectchain.h"
 
 const bool kEffectDebugOutput = false;
@@ -13,12 +14,14 @@ const bool kEffectDebugOutput = false;
 class EngineEffectRack;
 class EngineEffectChain;
 class EngineEffect;
+class EffectChannelState;
 
 struct EffectsRequest {
     enum MessageType {
         // Messages for EngineEffectsManager
         ADD_EFFECT_RACK = 0,
         REMOVE_EFFECT_RACK,
+        REGISTER_CHANNEL,
 
         // Messages for EngineEffectRack
         ADD_CHAIN_TO_RACK,
@@ -34,6 +37,7 @@ struct EffectsRequest {
         // Messages for EngineEffect
         SET_EFFECT_PARAMETERS,
         SET_PARAMETER_PARAMETERS,
+        ADD_EFFECT_CHANNEL_STATE,
 
         // Must come last.
         NUM_REQUEST_TYPES
@@ -52,6 +56,7 @@ struct EffectsRequest {
 #define CLEAR_STRUCT(x) memset(&x, 0, sizeof(x));
         CLEAR_STRUCT(AddEffectRack);
         CLEAR_STRUCT(RemoveEffectRack);
+        CLEAR_STRUCT(RegisterChannel);
         CLEAR_STRUCT(AddChainToRack);
         CLEAR_STRUCT(RemoveChainFromRack);
         CLEAR_STRUCT(AddEffectToChain);
@@ -59,6 +64,7 @@ struct EffectsRequest {
         CLEAR_STRUCT(SetEffectChainParameters);
         CLEAR_STRUCT(SetEffectParameters);
         CLEAR_STRUCT(SetParameterParameters);
+        CLEAR_STRUCT(AddEffectChannelState);
 #undef CLEAR_STRUCT
     }
 
@@ -80,6 +86,7 @@ struct EffectsRequest {
         EngineEffectChain* pTargetChain;
         // Used by:
         // - SET_EFFECT_PARAMETER
+        // - ADD_EFFECT_CHANNEL_STATE
         EngineEffect* pTargetEffect;
     };
 
@@ -91,6 +98,12 @@ struct EffectsRequest {
         struct {
             EngineEffectRack* pRack;
         } RemoveEffectRack;
+        struct {
+            // A MAX_BUFFER_LEN buffer allocated in the main thread. Owned by
+            // the EngineEffectsManager if the request succeeds, otherwise
+            // freed by the main thread.
+            CSAMPLE* pScratchBuffer;
+        } RegisterChannel;
         struct {
             EngineEffectChain* pChain;
             int iIndex;
@@ -118,13 +131,19 @@ struct EffectsRequest {
         struct {
             int iParameter;
         } SetParameterParameters;
+        struct {
+            // Created in the main thread. Owned by the effect if the request
+            // succeeds, otherwise deleted by the main thread.
+            EffectChannelState* pState;
+        } AddEffectChannelState;
     };
 
     ////////////////////////////////////////////////////////////////////////////
     // Message-specific, non-POD values that can't be part of the above union.
     ////////////////////////////////////////////////////////////////////////////
 
-    // Used by ENABLE_EFFECT_CHAIN_FOR_CHANNEL and DISABLE_EFFECT_CHAIN_FOR_CHANNEL.
+    // Used by REGISTER_CHANNEL, ENABLE_EFFECT_CHAIN_FOR_CHANNEL,
+    // DISABLE_EFFECT_CHAIN_FOR_CHANNEL and ADD_EFFECT_CHANNEL_STATE.
     ChannelHandle channel;
 
     // Used by SET_EFFECT_PARAMETER.
@@ -62,6 +62,8 @@
 
 const double kLinearScalerElipsis = 1.00058; // 2^(0.01/12): changes < 1 cent allows a linear scaler
 const int kSamplesPerFrame = 2; // Engine buffer uses Stereo frames only
+// Registered at startup so the callback never allocates for it.
+const StatKey kProcessPauseLockStatKey("EngineBuffer::process_pauselock");
 
 EngineBuffer::EngineBuffer(QString group, ConfigObject<ConfigValue>* _config,
                            EngineChannel* pChannel, EngineMaster* pMixingEngine)
@@ -756,7 +758,7 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
 
     bool bTrackLoading = load_atomic(m_iTrackLoading) != 0;
     if (!bTrackLoading && m_pause.tryLock()) {
-        ScopedTimer t("EngineBuffer::process_pauselock");
+        ScopedTimer t(kProcessPauseLockStatKey);
 
         double baserate = 0.0;
         if (sample_rate > 0) {
@@ -1013,6 +1015,8 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
     }
 
     if (!bTrackLoading) {
+        // Playing decks get a bigger share of the reader chunk pool.
+        m_pReader->setPlaying(!bCurBufferPaused);
         // Give the Reader hints as to which chunks of the current song we
         // really care about. It will try very hard to keep these in memory
         hintReader(rate);
@@ -47,6 +47,18 @@
 
 
 
+namespace {
+
+// Registered at startup so the callback never allocates for them.
+const StatKey kProcessChannelsStatKey("EngineMaster::processChannels");
+const StatKey kProcessChannelsParallelStatKey(
+        "EngineMaster::processChannels_parallel");
+const StatKey kProcessChannelsSerialStatKey(
+        "EngineMaster::processChannels_serial");
+const TraceKey kProcessTraceKey("EngineMaster::process");
+
+}  // namespace
+
 EngineMaster::EngineMaster(ConfigObject<ConfigValue>* _config,
                            const char* group,
                            EffectsManager* pEffectsManager,
@@ -54,6 +66,8 @@ EngineMaster::EngineMaster(ConfigObject<ConfigValue>* _config,
                            bool bRampingGain)
         : m_pEngineEffectsManager(pEffectsManager ? pEffectsManager->getEngineEffectsManager() : NULL),
           m_bRampingGain(bRampingGain),
+          m_channelProcessTask(this),
+          m_busEffectsTask(this),
           m_masterGainOld(0.0),
           m_headphoneMasterGainOld(0.0),
           m_headphoneGainOld(1.0),
@@ -67,6 +81,7 @@ EngineMaster::EngineMaster(ConfigObject<ConfigValue>* _config,
     m_bBusOutputConnected[EngineChannel::RIGHT] = false;
     m_pWorkerScheduler = new EngineWorkerScheduler(this);
     m_pWorkerScheduler->start(QThread::HighPriority);
+    m_pChannelWorkerPool = new RealtimeWorkerPool();
 
     if (pEffectsManager) {
         pEffectsManager->registerChannel(m_masterHandle);
@@ -172,6 +187,13 @@ EngineMaster::EngineMaster(ConfigObject<ConfigValue>* _config,
     m_pKeylockEngine->set(_config->getValueString(
             ConfigKey(group, "keylock_engine")).toDouble());
 
+    // Process independent channels on m_pChannelWorkerPool. Off by default so
+    // the serial path stays the reference for timing comparisons.
+    m_pParallelProcessing = new ControlObject(
+            ConfigKey(group, "parallel_processing"), true, false, true);
+    m_pParallelProcessing->set(_config->getValueString(
+            ConfigKey(group, "parallel_processing"), "0").toDouble());
+
     m_pMasterEnabled = new ControlObject(ConfigKey(group, "enabled"),
             true, false, true);  // persist = true
     m_pMasterMonoMixdown = new ControlObject(ConfigKey(group, "mono_mixdown"),
@@ -187,6 +209,7 @@ EngineMaster::EngineMaster(ConfigObject<ConfigValue>* _config,
 EngineMaster::~EngineMaster() {
     qDebug() << "in ~EngineMaster()";
     delete m_pKeylockEngine;
+    delete m_pParallelProcessing;
     delete m_pCrossfader;
     delete m_pBalance;
     delete m_pHeadMix;
@@ -226,6 +249,7 @@ EngineMaster::~EngineMaster() {
     }
 
     delete m_pWorkerScheduler;
+    delete m_pChannelWorkerPool;
 
     for (int i = 0; i < m_channels.size(); ++i) {
         ChannelInfo* pChannelInfo = m_channels[i];
@@ -253,7 +277,7 @@ void EngineMaster::processChannels(int iBufferSize) {
     m_activeTalkoverChannels.clear();
     m_activeChannels.clear();
 
-    ScopedTimer timer("EngineMaster::processChannels");
+    ScopedTimer timer(kProcessChannelsStatKey);
     EngineChannel* pMasterChannel = m_pMasterSync->getMaster();
     // Reserve the first place for the master channel which
     // should be processed first
@@ -325,11 +349,29 @@ void EngineMaster::processChannels(int iBufferSize) {
     }
 
     // Now that the list is built and ordered, do the processing.
-    for (int i = activeChannelsStartIndex;
-             i < m_activeChannels.size(); ++i) {
-        ChannelInfo* pChannelInfo = m_activeChannels[i];
-        EngineChannel* pChannel = pChannelInfo->m_pChannel;
-        pChannel->process(pChannelInfo->m_pBuffer, iBufferSize);
+    if (m_pParallelProcessing->toBool() &&
+            m_pChannelWorkerPool->workerCount() > 0) {
+        ScopedTimer timer(kProcessChannelsParallelStatKey);
+        int firstIndex = activeChannelsStartIndex;
+        if (firstIndex == 0) {
+            // The sync master has to be done before any of its followers
+            // start, so it runs alone on the callback thread.
+            ChannelInfo* pChannelInfo = m_activeChannels[0];
+            pChannelInfo->m_pChannel->process(pChannelInfo->m_pBuffer,
+                                              iBufferSize);
+            firstIndex = 1;
+        }
+        m_channelProcessTask.prepare(firstIndex, iBufferSize);
+        m_pChannelWorkerPool->parallelFor(&m_channelProcessTask,
+                                          m_activeChannels.size() - firstIndex);
+    } else {
+        ScopedTimer timer(kProcessChannelsSerialStatKey);
+        for (int i = activeChannelsStartIndex;
+                 i < m_activeChannels.size(); ++i) {
+            ChannelInfo* pChannelInfo = m_activeChannels[i];
+            EngineChannel* pChannel = pChannelInfo->m_pChannel;
+            pChannel->process(pChannelInfo->m_pBuffer, iBufferSize);
+        }
     }
 
     // After all the engines have been processed, trigger post-processing
@@ -342,13 +384,30 @@ void EngineMaster::processChannels(int iBufferSize) {
     }
 }
 
+void EngineMaster::ChannelProcessTask::runItem(int index) {
+    ChannelInfo* pChannelInfo = m_pMaster->m_activeChannels[m_firstIndex + index];
+    pChannelInfo->m_pChannel->process(pChannelInfo->m_pBuffer, m_iBufferSize);
+}
+
+void EngineMaster::BusEffectsTask::runItem(int index) {
+    const ChannelHandleAndGroup* pHandle = &m_pMaster->m_busCenterHandle;
+    if (index == EngineChannel::LEFT) {
+        pHandle = &m_pMaster->m_busLeftHandle;
+    } else if (index == EngineChannel::RIGHT) {
+        pHandle = &m_pMaster->m_busRightHandle;
+    }
+    m_pMaster->m_pEngineEffectsManager->process(
+            pHandle->handle(), m_pMaster->m_pOutputBusBuffers[index],
+            m_iBufferSize, m_iSampleRate, m_features);
+}
+
 void EngineMaster::process(const int iBufferSize) {
     static bool haveSetName = false;
     if (!haveSetName) {
         QThread::currentThread()->setObjectName("Engine");
         haveSetName = true;
     }
-    Trace t("EngineMaster::process");
+    Trace t(kProcessTraceKey);
 
     bool masterEnabled = m_pMasterEnabled->get();
     bool headphoneEnabled = m_pHeadphoneEnabled->get();
@@ -444,16 +503,14 @@ void EngineMaster::process(const int iBufferSize) {
 
     // Process master channel effects
     if (m_pEngineEffectsManager) {
-        GroupFeatureState busFeatures;
-        m_pEngineEffectsManager->process(m_busLeftHandle.handle(),
-                                         m_pOutputBusBuffers[EngineChannel::LEFT],
-                                         iBufferSize, iSampleRate, busFeatures);
-        m_pEngineEffectsManager->process(m_busCenterHandle.handle(),
-                                         m_pOutputBusBuffers[EngineChannel::CENTER],
-                                         iBufferSize, iSampleRate, busFeatures);
-        m_pEngineEffectsManager->process(m_busRightHandle.handle(),
-                                         m_pOutputBusBuffers[EngineChannel::RIGHT],
-                                         iBufferSize, iSampleRate, busFeatures);
+        m_busEffectsTask.prepare(iBufferSize, iSampleRate);
+        if (m_pParallelProcessing->toBool()) {
+            m_pChannelWorkerPool->parallelFor(&m_busEffectsTask, 3);
+        } else {
+            for (int o = EngineChannel::LEFT; o <= EngineChannel::RIGHT; o++) {
+                m_busEffectsTask.runItem(o);
+            }
+        }
     }
 
     if (masterEnabled) {
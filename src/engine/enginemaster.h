@@ -26,6 +26,8 @@
 #include "engine/engineobject.h"
 #include "engine/enginechannel.h"
 #include "engine/channelhandle.h"
+#include "engine/effects/groupfeaturestate.h"
+#include "engine/realtimeworkerpool.h"
 #include "soundmanagerutil.h"
 #include "recording/recordingmanager.h"
 
@@ -253,6 +255,48 @@ class EngineMaster : public QObject, public AudioSource {
     };
 
   private:
+    // Runs EngineChannel::process for a range of m_activeChannels. Used to
+    // hand the channels to m_pChannelWorkerPool in parallel mode.
+    class ChannelProcessTask : public RealtimeTask {
+      public:
+        ChannelProcessTask(EngineMaster* pMaster)
+                : m_pMaster(pMaster),
+                  m_firstIndex(0),
+                  m_iBufferSize(0) {
+        }
+        void prepare(int firstIndex, int iBufferSize) {
+            m_firstIndex = firstIndex;
+            m_iBufferSize = iBufferSize;
+        }
+        virtual void runItem(int index);
+      private:
+        EngineMaster* m_pMaster;
+        int m_firstIndex;
+        int m_iBufferSize;
+    };
+
+    // Runs the effects of the three output busses. The busses are mixed from
+    // different channels and have their own effect state, so in parallel mode
+    // they are handed to m_pChannelWorkerPool together.
+    class BusEffectsTask : public RealtimeTask {
+      public:
+        BusEffectsTask(EngineMaster* pMaster)
+                : m_pMaster(pMaster),
+                  m_iBufferSize(0),
+                  m_iSampleRate(0) {
+        }
+        void prepare(int iBufferSize, unsigned int iSampleRate) {
+            m_iBufferSize = iBufferSize;
+            m_iSampleRate = iSampleRate;
+        }
+        virtual void runItem(int index);
+      private:
+        EngineMaster* m_pMaster;
+        int m_iBufferSize;
+        unsigned int m_iSampleRate;
+        GroupFeatureState m_features;
+    };
+
     void mixChannels(unsigned int channelBitvector, unsigned int maxChannels,
                      CSAMPLE* pOutput, unsigned int iBufferSize, GainCalculator* pGainCalculator);
 
@@ -260,7 +304,8 @@ class EngineMaster : public QObject, public AudioSource {
     // first and all others are processed after. Populates m_activeChannels,
     // m_activeBusChannels, m_activeHeadphoneChannels, and
     // m_activeTalkoverChannels with each channel that is active for the
-    // respective output.
+    // respective output. If [Master],parallel_processing is enabled, all
+    // channels but the sync master are spread across m_pChannelWorkerPool.
     void processChannels(int iBufferSize);
 
     ChannelHandleFactory m_channelHandleFactory;
@@ -291,6 +336,13 @@ class EngineMaster : public QObject, public AudioSource {
     EngineWorkerScheduler* m_pWorkerScheduler;
     EngineSync* m_pMasterSync;
 
+    // Pre-spawned threads for processing channels in parallel. The threads
+    // are created in the constructor so that nothing is allocated when
+    // switching modes while the callback is running.
+    RealtimeWorkerPool* m_pChannelWorkerPool;
+    ChannelProcessTask m_channelProcessTask;
+    BusEffectsTask m_busEffectsTask;
+
     ControlObject* m_pMasterGain;
     ControlObject* m_pHeadGain;
     ControlObject* m_pMasterSampleRate;
@@ -316,6 +368,7 @@ class EngineMaster : public QObject, public AudioSource {
     ControlPushButton* m_pXFaderReverse;
     ControlPushButton* m_pHeadSplitEnabled;
     ControlObject* m_pKeylockEngine;
+    ControlObject* m_pParallelProcessing;
 
     PflGainCalculator m_headphoneGain;
     TalkoverGainCalculator m_talkoverGain;
@@ -8,7 +8,8 @@
 #include "util/event.h"
 
 EngineWorkerScheduler::EngineWorkerScheduler(QObject* pParent)
-        : m_bWakeScheduler(false),
+        : m_bWakeScheduler(0),
+          m_writeLock(0),
           m_scheduleFIFO(MAX_ENGINE_WORKERS),
           m_bQuit(false) {
     Q_UNUSED(pParent);
@@ -22,20 +23,22 @@ EngineWorkerScheduler::~EngineWorkerScheduler() {
 
 void EngineWorkerScheduler::workerReady(EngineWorker* pWorker) {
     if (pWorker) {
+        while (!m_writeLock.testAndSetAcquire(0, 1)) {
+        }
         // If the write fails, we really can't do much since we should not block
         // in this slot. Write the address of the variable pWorker, since it is
         // a 1-element array.
         m_scheduleFIFO.write(&pWorker, 1);
-        m_bWakeScheduler = true;
+        m_writeLock.fetchAndStoreRelease(0);
+        m_bWakeScheduler.fetchAndStoreRelease(1);
     }
 }
 
 void EngineWorkerScheduler::runWorkers() {
     // Wake the scheduler if we have written a worker-ready message to the
-    // scheduler. There is no race condition in accessing this boolean because
-    // both workerReady and runWorkers are called from the callback thread.
-    if (m_bWakeScheduler) {
-        m_bWakeScheduler = false;
+    // scheduler. runWorkers is called from the callback thread after all
+    // channels were processed.
+    if (m_bWakeScheduler.fetchAndStoreAcquire(0)) {
         m_waitCondition.wakeAll();
     }
 }
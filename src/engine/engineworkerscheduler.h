@@ -1,6 +1,7 @@
 #ifndef ENGINEWORKERSCHEDULER_H
 #define ENGINEWORKERSCHEDULER_H
 
+#include <QAtomicInt>
 #include <QMutex>
 #include <QThreadPool>
 #include <QWaitCondition>
@@ -20,6 +21,8 @@ class EngineWorkerScheduler : public QThread {
     virtual ~EngineWorkerScheduler();
 
     void runWorkers();
+    // Safe to call from several threads at once, e.g. from the channels that
+    // EngineMaster processes in parallel. Never blocks.
     void workerReady(EngineWorker* worker);
 
   protected:
@@ -27,9 +30,13 @@ class EngineWorkerScheduler : public QThread {
 
   private:
     // Indicates whether workerReady has been called since the last time
-    // runWorkers was run. This should only be touched from the engine callback.
-    bool m_bWakeScheduler;
+    // runWorkers was run.
+    QAtomicInt m_bWakeScheduler;
 
+    // m_scheduleFIFO has a single writer. m_writeLock makes the writers of
+    // the engine threads take turns. It is held for a few instructions only,
+    // so it is spun on instead of blocking.
+    QAtomicInt m_writeLock;
     FIFO<EngineWorker*> m_scheduleFIFO;
     QWaitCondition m_waitCondition;
     QMutex m_mutex;
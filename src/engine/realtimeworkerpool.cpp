@@ -0,0 +1,171 @@
+#include <QtDebug>
+
+#include "engine/realtimeworkerpool.h"
+#include "util/compatibility.h"
+#include "util/math.h"
+
+namespace {
+
+// The current job is published as a single atomic word so that a worker always
+// sees a consistent (slot, count, next index) triple:
+//
+//   bit  24     : task slot (m_pTasks[0] or m_pTasks[1])
+//   bits 16..23 : number of items in the job
+//   bits  0..15 : next unclaimed item index
+//
+// A worker that wakes up late keeps incrementing the index of an already
+// finished job, which is harmless since it is then >= the item count. The
+// task of the running job can not be overwritten while any of its items is
+// unclaimed because the caller only publishes a new job after the old one was
+// joined and it alternates between the two task slots.
+const int kIndexBits = 16;
+const int kIndexMask = (1 << kIndexBits) - 1;
+const int kCountMask = 0xff;
+const int kSlotShift = 24;
+const int kMaxItemsPerJob = kCountMask;
+const int kMaxWorkers = 16;
+
+// How often the caller polls the claimed items before it sleeps. Items are a
+// channel each, so this is far longer than an item takes on a running worker.
+const int kJoinSpinCount = 50000;
+// The number of jobs run inline after the caller had to sleep for a worker. At
+// typical latencies this is about a second.
+const int kInlineJobsAfterLateJoin = 256;
+
+inline int packJob(int slot, int count) {
+    return (slot << kSlotShift) | (count << kIndexBits);
+}
+
+}  // namespace
+
+class RealtimeWorkerThread : public QThread {
+  public:
+    RealtimeWorkerThread(RealtimeWorkerPool* pPool, int index)
+            : m_pPool(pPool) {
+        setObjectName(QString("RealtimeWorker %1").arg(index));
+    }
+
+  protected:
+    void run() {
+        m_pPool->workerLoop();
+    }
+
+  private:
+    RealtimeWorkerPool* m_pPool;
+};
+
+RealtimeWorkerPool::RealtimeWorkerPool(int numWorkers,
+                                       QThread::Priority priority)
+        : m_bQuit(false),
+          m_slot(0),
+          m_job(packJob(0, 0)),
+          m_pendingItems(0),
+          m_inlineJobs(0) {
+    m_pTasks[0] = NULL;
+    m_pTasks[1] = NULL;
+    if (numWorkers < 0) {
+        numWorkers = QThread::idealThreadCount() - 1;
+    }
+    numWorkers = math_clamp(numWorkers, 0, kMaxWorkers);
+    for (int i = 0; i < numWorkers; ++i) {
+        RealtimeWorkerThread* pWorker = new RealtimeWorkerThread(this, i);
+        m_workers.append(pWorker);
+        pWorker->start(priority);
+    }
+    qDebug() << "RealtimeWorkerPool started" << numWorkers << "workers";
+}
+
+RealtimeWorkerPool::~RealtimeWorkerPool() {
+    m_bQuit = true;
+    m_semaWork.release(m_workers.size());
+    foreach (RealtimeWorkerThread* pWorker, m_workers) {
+        pWorker->wait();
+        delete pWorker;
+    }
+}
+
+void RealtimeWorkerPool::parallelFor(RealtimeTask* pTask, int count) {
+    if (count <= 0) {
+        return;
+    }
+
+    // Items beyond what fits into one job word are run on the calling thread.
+    // This never happens for the engine use case (kPreallocatedChannels).
+    while (count > kMaxItemsPerJob) {
+        pTask->runItem(--count);
+    }
+
+    if (count == 1 || m_workers.isEmpty() || m_inlineJobs > 0) {
+        if (m_inlineJobs > 0) {
+            --m_inlineJobs;
+        }
+        for (int i = 0; i < count; ++i) {
+            pTask->runItem(i);
+        }
+        return;
+    }
+
+    m_slot ^= 1;
+    m_pTasks[m_slot] = pTask;
+    m_pendingItems.fetchAndStoreOrdered(count);
+    // Publishing the job word is the release point for the writes above.
+    m_job.fetchAndStoreOrdered(packJob(m_slot, count));
+
+    // Wake at most as many workers as there are items left for them. The
+    // calling thread takes part in the work, so it never waits for a worker to
+    // be scheduled.
+    m_semaWork.release(math_min(count - 1, m_workers.size()));
+    const int processed = drainItems(false);
+    joinWorkers(count - processed);
+}
+
+void RealtimeWorkerPool::joinWorkers(int numItems) {
+    if (numItems <= 0) {
+        return;
+    }
+    // Only the items that were claimed by a worker can still be running at
+    // this point. Spin first since the remaining work is at most one item per
+    // worker.
+    bool late = true;
+    for (int i = 0; i < kJoinSpinCount; ++i) {
+        if (load_atomic(m_pendingItems) <= 0) {
+            late = false;
+            break;
+        }
+    }
+    if (late) {
+        m_inlineJobs = kInlineJobsAfterLateJoin;
+    }
+    // Workers release before they count an item as finished, so this only
+    // blocks if the worker is late.
+    m_semaDone.acquire(numItems);
+}
+
+int RealtimeWorkerPool::drainItems(bool bWorker) {
+    int processed = 0;
+    for (;;) {
+        const int job = m_job.fetchAndAddOrdered(1);
+        const int index = job & kIndexMask;
+        const int count = (job >> kIndexBits) & kCountMask;
+        if (index >= count) {
+            break;
+        }
+        m_pTasks[job >> kSlotShift]->runItem(index);
+        ++processed;
+        if (bWorker) {
+            m_semaDone.release();
+        }
+        m_pendingItems.fetchAndAddOrdered(-1);
+    }
+    return processed;
+}
+
+void RealtimeWorkerPool::workerLoop() {
+    for (;;) {
+        m_semaWork.acquire();
+        if (m_bQuit) {
+            return;
+        }
+        drainItems(true);
+    }
+}
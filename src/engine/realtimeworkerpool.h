@@ -0,0 +1,86 @@
+#ifndef REALTIMEWORKERPOOL_H
+#define REALTIMEWORKERPOOL_H
+
+#include <QAtomicInt>
+#include <QList>
+#include <QSemaphore>
+#include <QThread>
+
+#include "util.h"
+
+// A unit of work that can be split into independent items. runItem() is called
+// exactly once for every index in [0, count) passed to
+// RealtimeWorkerPool::parallelFor, possibly from different threads and in any
+// order.
+class RealtimeTask {
+  public:
+    virtual ~RealtimeTask() {}
+    virtual void runItem(int index) = 0;
+};
+
+class RealtimeWorkerThread;
+
+// RealtimeWorkerPool is a fixed set of threads that is spawned once (off the
+// callback thread) and then used to fork/join work from the audio callback.
+//
+// The calling thread always takes part in the work itself: items are claimed
+// through an atomic counter, and the caller only waits for items that a worker
+// has already claimed and is currently running. If no worker wakes up in time,
+// the caller simply processes every item itself so the worst case is the
+// serial path plus a handful of atomic operations.
+//
+// The caller spins for the claimed items only for a bounded time. A worker that
+// takes longer was most likely descheduled, so the caller then sleeps until it
+// is done, which gives the worker its CPU back, and runs the items of the next
+// jobs inline until the workers can be trusted again.
+//
+// parallelFor must only be called from one thread at a time (the engine
+// callback thread).
+class RealtimeWorkerPool {
+  public:
+    // Creates a pool with numWorkers helper threads. Pass a negative value to
+    // use one less than QThread::idealThreadCount() (the caller is the extra
+    // thread).
+    explicit RealtimeWorkerPool(int numWorkers = -1,
+                                QThread::Priority priority = QThread::TimeCriticalPriority);
+    virtual ~RealtimeWorkerPool();
+
+    int workerCount() const {
+        return m_workers.size();
+    }
+
+    // Runs pTask->runItem(i) for every i in [0, count) and returns once all
+    // items are done.
+    void parallelFor(RealtimeTask* pTask, int count);
+
+  private:
+    // Claims and runs items of the current job until none are left. Returns
+    // the number of items this thread has processed. Workers release
+    // m_semaDone for each of their items.
+    int drainItems(bool bWorker);
+    // Waits until the workers have finished the numItems items they claimed.
+    void joinWorkers(int numItems);
+    void workerLoop();
+
+    QList<RealtimeWorkerThread*> m_workers;
+    QSemaphore m_semaWork;
+    volatile bool m_bQuit;
+
+    // The current job. See the comment on the job word layout in the .cpp
+    // file. m_slot and m_pTasks are only written by the calling thread.
+    int m_slot;
+    RealtimeTask* volatile m_pTasks[2];
+    QAtomicInt m_job;
+    // Number of items of the current job that have not finished yet.
+    QAtomicInt m_pendingItems;
+    // Released once for every item a worker finished.
+    QSemaphore m_semaDone;
+    // The number of jobs that are still run inline after a late join. Only
+    // used by the calling thread.
+    int m_inlineJobs;
+
+    friend class RealtimeWorkerThread;
+    DISALLOW_COPY_AND_ASSIGN(RealtimeWorkerPool);
+};
+
+#endif /* REALTIMEWORKERPOOL_H */
@@ -0,0 +1,340 @@
+#include <QtDebug>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QSemaphore>
+#include <string.h>
+
+#include "engine/sidechain/encoderbus.h"
+#include "encoder/encoder.h"
+#include "encoder/encodermp3.h"
+#include "encoder/encodervorbis.h"
+#ifdef __FFMPEGFILE__
+#include "encoder/encoderffmpegmp3.h"
+#include "encoder/encoderffmpegvorbis.h"
+#endif
+#include "util/compatibility.h"
+#include "util/math.h"
+
+namespace {
+
+// About 6 seconds of a 320 kbit/s stream.
+const int kSubscriptionBufferBytes = 1 << 18;
+
+// Ogg streams begin with the pages of the codec headers. Their granule
+// position is 0, while every page with audio has a positive one.
+bool isOggHeaderPage(const unsigned char* header, int headerLen) {
+    if (headerLen < 14 || memcmp(header, "OggS", 4) != 0) {
+        return false;
+    }
+    for (int i = 6; i < 14; ++i) {
+        if (header[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+char* dataOrNull(QByteArray* pArray) {
+    return pArray->isEmpty() ? NULL : pArray->data();
+}
+
+// Copies len bytes to offset in the two write regions of a ring buffer, which
+// act as one region of size1 bytes followed by the second one.
+void copyToWriteRegions(const unsigned char* pSource, int len, int offset,
+                        unsigned char* pData1, int size1,
+                        unsigned char* pData2) {
+    const int len1 = math_max(0, math_min(len, size1 - offset));
+    if (len1 > 0) {
+        memcpy(pData1 + offset, pSource, len1);
+    }
+    if (len > len1) {
+        memcpy(pData2 + math_max(0, offset - size1), pSource + len1,
+               len - len1);
+    }
+}
+
+}  // namespace
+
+bool EncoderBus::Settings::operator==(const Settings& other) const {
+    return format == other.format &&
+            bitrate == other.bitrate &&
+            samplerate == other.samplerate &&
+            useFfmpeg == other.useFfmpeg &&
+            artist == other.artist &&
+            title == other.title &&
+            album == other.album;
+}
+
+// An encoder and the subscriptions it fans out to.
+class EncoderBus::SharedEncoder : public EncoderCallback {
+  public:
+    explicit SharedEncoder(const Settings& settings)
+            : m_settings(settings),
+              m_pEncoder(NULL),
+              m_bStreamHeaderComplete(false) {
+    }
+    virtual ~SharedEncoder() {
+        delete m_pEncoder;
+    }
+
+    bool init() {
+        if (m_settings.format == Settings::MP3) {
+#ifdef __FFMPEGFILE__
+            if (m_settings.useFfmpeg) {
+                m_pEncoder = new EncoderFfmpegMp3(this);
+            }
+#endif
+            if (m_pEncoder == NULL) {
+                m_pEncoder = new EncoderMp3(this);
+            }
+        } else {
+#ifdef __FFMPEGFILE__
+            if (m_settings.useFfmpeg) {
+                m_pEncoder = new EncoderFfmpegVorbis(this);
+            }
+#endif
+            if (m_pEncoder == NULL) {
+                m_pEncoder = new EncoderVorbis(this);
+            }
+        }
+        // The encoders keep the pointers, m_settings outlives them.
+        m_pEncoder->updateMetaData(dataOrNull(&m_settings.artist),
+                                   dataOrNull(&m_settings.title),
+                                   dataOrNull(&m_settings.album));
+        return m_pEncoder->initEncoder(m_settings.bitrate,
+                                       m_settings.samplerate) >= 0;
+    }
+
+    const Settings& settings() const {
+        return m_settings;
+    }
+    Encoder* encoder() const {
+        return m_pEncoder;
+    }
+    const QByteArray& streamHeader() const {
+        return m_streamHeader;
+    }
+    QList<EncoderBusSubscription*>& subscriptions() {
+        return m_subscriptions;
+    }
+
+    void write(unsigned char* header, unsigned char* body,
+               int headerLen, int bodyLen) {
+        // Keep the header pages for the sinks that subscribe later.
+        if (!m_bStreamHeaderComplete) {
+            if (isOggHeaderPage(header, headerLen)) {
+                m_streamHeader.append(reinterpret_cast<const char*>(header),
+                                      headerLen);
+                m_streamHeader.append(reinterpret_cast<const char*>(body),
+                                      bodyLen);
+            } else {
+                m_bStreamHeaderComplete = true;
+            }
+        }
+        foreach (EncoderBusSubscription* pSubscription, m_subscriptions) {
+            pSubscription->write(header, headerLen, body, bodyLen);
+        }
+    }
+
+  private:
+    Settings m_settings;
+    Encoder* m_pEncoder;
+    QList<EncoderBusSubscription*> m_subscriptions;
+    QByteArray m_streamHeader;
+    bool m_bStreamHeaderComplete;
+};
+
+// Encodes a buffer with one encoder on the encode pool and releases pDone
+// once it is done.
+class EncoderBus::EncodeTask : public QRunnable {
+  public:
+    EncodeTask(SharedEncoder* pEncoder, const CSAMPLE* pBuffer,
+               int iBufferSize, QSemaphore* pDone)
+            : m_pEncoder(pEncoder),
+              m_pBuffer(pBuffer),
+              m_iBufferSize(iBufferSize),
+              m_pDone(pDone) {
+    }
+    void run() {
+        QThread::currentThread()->setPriority(QThread::HighPriority);
+        encode(m_pEncoder, m_pBuffer, m_iBufferSize);
+        m_pDone->release();
+    }
+
+    static void encode(SharedEncoder* pEncoder, const CSAMPLE* pBuffer,
+                       int iBufferSize) {
+        // Calls SharedEncoder::write with the compressed data.
+        pEncoder->encoder()->encodeBuffer(pBuffer, iBufferSize);
+    }
+
+  private:
+    SharedEncoder* m_pEncoder;
+    const CSAMPLE* m_pBuffer;
+    const int m_iBufferSize;
+    QSemaphore* m_pDone;
+};
+
+EncoderBus::EncoderBus() {
+    m_encodePool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+EncoderBus::~EncoderBus() {
+    QMutexLocker locker(&m_mutex);
+    if (!m_encoders.isEmpty()) {
+        qWarning() << "EncoderBus: destroyed with" << m_encoders.size()
+                   << "encoders running";
+    }
+    qDeleteAll(m_encoders);
+}
+
+EncoderBusSubscription* EncoderBus::subscribe(const Settings& settings,
+                                              OverflowPolicy policy) {
+    QMutexLocker locker(&m_mutex);
+    SharedEncoder* pEncoder = NULL;
+    foreach (SharedEncoder* pRunning, m_encoders) {
+        if (pRunning->settings() == settings) {
+            pEncoder = pRunning;
+            break;
+        }
+    }
+    if (pEncoder == NULL) {
+        pEncoder = new SharedEncoder(settings);
+        if (!pEncoder->init()) {
+            delete pEncoder;
+            return NULL;
+        }
+        m_encoders.append(pEncoder);
+    }
+
+    // MP3 frames and Ogg pages after the headers decode without the data
+    // before them, so a late sink gets a valid stream.
+    const QByteArray& streamHeader = pEncoder->streamHeader();
+    EncoderBusSubscription* pSubscription =
+            new EncoderBusSubscription(policy, streamHeader);
+    if (!streamHeader.isEmpty()) {
+        pSubscription->write(
+                NULL, 0,
+                reinterpret_cast<const unsigned char*>(streamHeader.constData()),
+                streamHeader.size());
+    }
+    pEncoder->subscriptions().append(pSubscription);
+    return pSubscription;
+}
+
+void EncoderBus::unsubscribe(EncoderBusSubscription* pSubscription) {
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < m_encoders.size(); ++i) {
+        SharedEncoder* pEncoder = m_encoders[i];
+        if (!pEncoder->subscriptions().contains(pSubscription)) {
+            continue;
+        }
+        if (pEncoder->subscriptions().size() == 1) {
+            pEncoder->encoder()->flush();
+            m_encoders.removeAt(i);
+            delete pEncoder;
+        } else {
+            pEncoder->subscriptions().removeAll(pSubscription);
+        }
+        return;
+    }
+}
+
+int EncoderBus::encoderCount() const {
+    QMutexLocker locker(&m_mutex);
+    return m_encoders.size();
+}
+
+void EncoderBus::process(const CSAMPLE* pBuffer, const int iBufferSize) {
+    QMutexLocker locker(&m_mutex);
+    if (m_encoders.isEmpty()) {
+        return;
+    }
+    // Every encoder writes to its own subscriptions only. This thread encodes
+    // with the first one and then sleeps until the pool is done with the
+    // others.
+    QSemaphore done;
+    for (int i = 1; i < m_encoders.size(); ++i) {
+        m_encodePool.start(new EncodeTask(m_encoders[i], pBuffer, iBufferSize,
+                                          &done));
+    }
+    EncodeTask::encode(m_encoders[0], pBuffer, iBufferSize);
+    done.acquire(m_encoders.size() - 1);
+}
+
+EncoderBusSubscription::EncoderBusSubscription(
+        SideChainWorker::OverflowPolicy policy,
+        const QByteArray& streamHeader)
+        : m_overflowPolicy(policy),
+          m_fifo(kSubscriptionBufferBytes),
+          m_iOverflows(0),
+          m_iDroppedBytes(0),
+          m_streamHeader(streamHeader),
+          m_iSeenOverflows(0),
+          m_iStreamHeaderDrained(0) {
+}
+
+int EncoderBusSubscription::droppedBytes() const {
+    return load_atomic(m_iDroppedBytes);
+}
+
+int EncoderBusSubscription::bufferedBytes() const {
+    return m_fifo.readAvailable();
+}
+
+void EncoderBusSubscription::write(const unsigned char* header, int headerLen,
+                                   const unsigned char* body, int bodyLen) {
+    const int size = headerLen + bodyLen;
+    // Publish the page at once, so the reader never drops half of it.
+    unsigned char* pData1;
+    ring_buffer_size_t size1;
+    unsigned char* pData2;
+    ring_buffer_size_t size2;
+    if (m_fifo.aquireWriteRegions(size, &pData1, &size1,
+                                  &pData2, &size2) < size) {
+        m_iDroppedBytes.fetchAndAddRelaxed(size);
+        m_iOverflows.fetchAndAddRelease(1);
+        return;
+    }
+    copyToWriteRegions(header, headerLen, 0, pData1, size1, pData2);
+    copyToWriteRegions(body, bodyLen, headerLen, pData1, size1, pData2);
+    m_fifo.releaseWriteRegions(size);
+}
+
+void EncoderBusSubscription::drain(EncoderCallback* pCallback) {
+    if (m_overflowPolicy == SideChainWorker::DROP_OLDEST) {
+        int overflows = m_iOverflows.fetchAndAddAcquire(0);
+        if (overflows != m_iSeenOverflows) {
+            m_iSeenOverflows = overflows;
+            // Only whole pages are buffered, so the next data starts a page.
+            int backlog = m_fifo.readAvailable();
+            m_fifo.releaseReadRegions(backlog);
+            // A sink that has not got all header pages yet, e.g. a stream
+            // that took long to connect, can not decode the stream without
+            // them. They are at the front of the backlog, so they are passed
+            // on in place of it.
+            const int headerLeft = m_streamHeader.size() - m_iStreamHeaderDrained;
+            if (headerLeft > 0) {
+                pCallback->write(NULL,
+                        reinterpret_cast<unsigned char*>(const_cast<char*>(
+                                m_streamHeader.constData() +
+                                m_iStreamHeaderDrained)),
+                        0, headerLeft);
+                m_iStreamHeaderDrained = m_streamHeader.size();
+                backlog -= headerLeft;
+            }
+            m_iDroppedBytes.fetchAndAddRelaxed(backlog);
+        }
+    }
+
+    int available = m_fifo.readAvailable();
+    if (available <= 0) {
+        return;
+    }
+    m_readBuffer.resize(available);
+    unsigned char* pData = reinterpret_cast<unsigned char*>(m_readBuffer.data());
+    int read = m_fifo.read(pData, available);
+    m_iStreamHeaderDrained = math_min(m_streamHeader.size(),
+                                      m_iStreamHeaderDrained + read);
+    pCallback->write(NULL, pData, 0, read);
+}
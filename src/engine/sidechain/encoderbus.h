@@ -0,0 +1,131 @@
+#ifndef ENCODERBUS_H
+#define ENCODERBUS_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QThreadPool>
+
+#include "encoder/encodercallback.h"
+#include "engine/sidechain/sidechainworker.h"
+#include "util/fifo.h"
+#include "util/types.h"
+
+class Encoder;
+class EncoderBusSubscription;
+
+// Encodes the sidechain audio once per distinct encoder setting and fans the
+// compressed data out to every sink that subscribed to that setting, e.g.
+// EngineRecord and EngineShoutcast when they record and stream the same
+// format and bitrate.
+//
+// Different settings are encoded in parallel, e.g. for streams of several
+// bitrates. The bus runs on its own sidechain thread and never waits for a
+// sink. Each subscription buffers the compressed data until its sink drains
+// it on the sink's own thread, so a stalled stream still can not delay the
+// recording.
+class EncoderBus : public SideChainWorker {
+  public:
+    struct Settings {
+        enum Format {
+            MP3,
+            OGG_VORBIS
+        };
+
+        Settings()
+                : format(MP3),
+                  bitrate(0),
+                  samplerate(0),
+                  useFfmpeg(false) {
+        }
+        bool operator==(const Settings& other) const;
+
+        Format format;
+        int bitrate;
+        int samplerate;
+        // Use the FFmpeg encoders of __FFMPEGFILE__ builds instead of LAME
+        // and libvorbis.
+        bool useFfmpeg;
+        // Written into the stream by the encoder, if not empty.
+        QByteArray artist;
+        QByteArray title;
+        QByteArray album;
+    };
+
+    EncoderBus();
+    virtual ~EncoderBus();
+
+    // Thread-safe. Returns a subscription to the encoder for settings,
+    // starting the encoder if no other sink uses it yet, or NULL if the
+    // encoder could not be started. A sink that subscribes to a running Ogg
+    // encoder gets the header pages of the stream first. policy says which
+    // data the subscription drops when its sink falls behind.
+    EncoderBusSubscription* subscribe(const Settings& settings,
+                                      OverflowPolicy policy);
+    // Thread-safe. Stops fanning out to pSubscription. The last subscriber of
+    // an encoder gets what the encoder flushes. The caller drains
+    // pSubscription a last time and deletes it.
+    void unsubscribe(EncoderBusSubscription* pSubscription);
+
+    // The number of encoders running.
+    int encoderCount() const;
+
+    void process(const CSAMPLE* pBuffer, const int iBufferSize);
+    void shutdown() {
+    }
+    QString name() const {
+        return "EncoderBus";
+    }
+
+  private:
+    class SharedEncoder;
+    class EncodeTask;
+
+    // Protects m_encoders and everything they own.
+    mutable QMutex m_mutex;
+    QList<SharedEncoder*> m_encoders;
+    // Runs all but the first encoder while more than one encoder runs. Only
+    // used by process(), which blocks until the pool is done.
+    QThreadPool m_encodePool;
+};
+
+// The compressed data of one shared encoder for one sink. Written by the
+// EncoderBus, read by the sink.
+class EncoderBusSubscription {
+  public:
+    // Passes the data encoded since the last call to pCallback. Must be
+    // called from a single thread, typically the one of the sink.
+    void drain(EncoderCallback* pCallback);
+
+    // The number of bytes that were dropped because the sink fell behind.
+    int droppedBytes() const;
+    // The number of bytes waiting for the next drain.
+    int bufferedBytes() const;
+
+  private:
+    friend class EncoderBus;
+
+    // streamHeader are the Ogg header pages the subscription starts with, if
+    // any.
+    EncoderBusSubscription(SideChainWorker::OverflowPolicy policy,
+                           const QByteArray& streamHeader);
+
+    // Buffers header followed by body, or drops both if they do not fit.
+    void write(const unsigned char* header, int headerLen,
+               const unsigned char* body, int bodyLen);
+
+    const SideChainWorker::OverflowPolicy m_overflowPolicy;
+    FIFO<unsigned char> m_fifo;
+    QAtomicInt m_iOverflows;
+    QAtomicInt m_iDroppedBytes;
+    // Not changed after construction.
+    const QByteArray m_streamHeader;
+    // Only used by the reader.
+    int m_iSeenOverflows;
+    // The number of bytes of m_streamHeader passed to the sink so far.
+    int m_iStreamHeaderDrained;
+    QByteArray m_readBuffer;
+};
+
+#endif /* ENCODERBUS_H */
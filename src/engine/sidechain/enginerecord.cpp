@@ -21,15 +21,7 @@
 #include "controlobject.h"
 #include "controlobjectslave.h"
 #include "encoder/encoder.h"
-
-#ifdef __FFMPEGFILE__
-#include "encoder/encoderffmpegmp3.h"
-#include "encoder/encoderffmpegvorbis.h"
-#else
-#include "encoder/encodermp3.h"
-#include "encoder/encodervorbis.h"
-#endif
-
+#include "engine/sidechain/encoderbus.h"
 #include "errordialoghandler.h"
 #include "playerinfo.h"
 #include "recording/defs_recording.h"
@@ -37,9 +29,11 @@
 
 const int kMetaDataLifeTimeout = 16;
 
-EngineRecord::EngineRecord(ConfigObject<ConfigValue>* _config)
+EngineRecord::EngineRecord(ConfigObject<ConfigValue>* _config,
+                           EncoderBus* pEncoderBus)
         : m_pConfig(_config),
-          m_pEncoder(NULL),
+          m_pEncoderBus(pEncoderBus),
+          m_pEncoderSubscription(NULL),
           m_pSndfile(NULL),
           m_frames(0),
           m_recordedDuration(0),
@@ -61,6 +55,7 @@ EngineRecord::EngineRecord(ConfigObject<ConfigValue>* _config)
 EngineRecord::~EngineRecord() {
     closeCueFile();
     closeFile();
+    unsubscribeEncoder();
     delete m_pRecReady;
     delete m_pSamplerate;
 }
@@ -78,24 +73,25 @@ void EngineRecord::updateFromPreferences() {
     m_bCueIsEnabled = m_pConfig->getValueString(ConfigKey(RECORDING_PREF_KEY, "CueEnabled")).toInt();
     m_sampleRate = m_pSamplerate->get();
 
-    // Delete m_pEncoder if it has been initialized (with maybe) different bitrate.
-    if (m_pEncoder) {
-        delete m_pEncoder;
-        m_pEncoder = NULL;
-    }
+    // Drop the subscription if it has been initialized (with maybe) different
+    // bitrate.
+    unsubscribeEncoder();
 
-    if (m_encoding == ENCODING_MP3) {
+    // A stream of the same format and bitrate shares the encoder.
+    EncoderBus::Settings settings;
+    settings.samplerate = m_sampleRate;
 #ifdef __FFMPEGFILE__
-        m_pEncoder = new EncoderFfmpegMp3(this);
-#else
-        m_pEncoder = new EncoderMp3(this);
+    settings.useFfmpeg = true;
 #endif
-        m_pEncoder->updateMetaData(m_baAuthor.data(),m_baTitle.data(),m_baAlbum.data());
+    settings.artist = m_baAuthor;
+    settings.title = m_baTitle;
+    settings.album = m_baAlbum;
 
-        if(m_pEncoder->initEncoder(Encoder::convertToBitrate(m_MP3quality.toInt()),
-                                   m_sampleRate) < 0) {
-            delete m_pEncoder;
-            m_pEncoder = NULL;
+    if (m_encoding == ENCODING_MP3) {
+        settings.format = EncoderBus::Settings::MP3;
+        settings.bitrate = Encoder::convertToBitrate(m_MP3quality.toInt());
+        m_pEncoderSubscription = m_pEncoderBus->subscribe(settings, DROP_NEWEST);
+        if (m_pEncoderSubscription == NULL) {
 #ifdef __FFMPEGFILE__
             qDebug() << "MP3 recording is not supported. FFMPEG mp3 could not be initialized";
 #else
@@ -103,17 +99,10 @@ void EngineRecord::updateFromPreferences() {
 #endif
         }
     } else if (m_encoding == ENCODING_OGG) {
-#ifdef __FFMPEGFILE__
-        m_pEncoder = new EncoderFfmpegVorbis(this);
-#else
-        m_pEncoder = new EncoderVorbis(this);
-#endif
-        m_pEncoder->updateMetaData(m_baAuthor.data(),m_baTitle.data(),m_baAlbum.data());
-
-        if (m_pEncoder->initEncoder(Encoder::convertToBitrate(m_OGGquality.toInt()),
-                                   m_sampleRate) < 0) {
-            delete m_pEncoder;
-            m_pEncoder = NULL;
+        settings.format = EncoderBus::Settings::OGG_VORBIS;
+        settings.bitrate = Encoder::convertToBitrate(m_OGGquality.toInt());
+        m_pEncoderSubscription = m_pEncoderBus->subscribe(settings, DROP_NEWEST);
+        if (m_pEncoderSubscription == NULL) {
 #ifdef __FFMPEGFILE__
             qDebug() << "OGG recording is not supported. FFMPEG OGG/Vorbis could not be initialized";
 #else
@@ -121,7 +110,15 @@ void EngineRecord::updateFromPreferences() {
 #endif
         }
     }
-    // If we use WAVE OR AIFF the encoder will be NULL at all times.
+    // If we use WAVE OR AIFF the subscription will be NULL at all times.
+}
+
+void EngineRecord::unsubscribeEncoder() {
+    if (m_pEncoderSubscription) {
+        m_pEncoderBus->unsubscribe(m_pEncoderSubscription);
+        delete m_pEncoderSubscription;
+        m_pEncoderSubscription = NULL;
+    }
 }
 
 bool EngineRecord::metaDataHasChanged()
@@ -186,6 +183,7 @@ void EngineRecord::process(const CSAMPLE* pBuffer, const int iBufferSize) {
                 m_cueTrack = 0;
             }
         } else {  // Maybe the encoder could not be initialized
+            unsubscribeEncoder();
             qDebug("Setting record flag to: OFF");
             m_pRecReady->slotSet(RECORD_OFF);
             emit(isRecording(false));
@@ -198,10 +196,10 @@ void EngineRecord::process(const CSAMPLE* pBuffer, const int iBufferSize) {
                 emit(bytesRecorded(iBufferSize * 2));
             }
         } else {
-            if (m_pEncoder) {
-                // Compress audio. Encoder will call method 'write()' below to
-                // write a file stream
-                m_pEncoder->encodeBuffer(pBuffer, iBufferSize);
+            if (m_pEncoderSubscription) {
+                // The EncoderBus compressed the audio of earlier calls. Calls
+                // method 'write()' below to write a file stream
+                m_pEncoderSubscription->drain(this);
             }
         }
 
@@ -325,7 +323,7 @@ bool EngineRecord::openFile() {
         }
     } else {
         // We can use a QFile to write compressed audio.
-        if (m_pEncoder) {
+        if (m_pEncoderSubscription) {
             m_file.setFileName(m_fileName);
             if (!m_file.open(QIODevice::WriteOnly)) {
                 qDebug() << "Could not write:" << m_fileName;
@@ -394,11 +392,13 @@ void EngineRecord::closeFile() {
             m_pSndfile = NULL;
         }
     } else if (m_file.handle() != -1) {
-        // Close QFile and encoder, if open.
-        if (m_pEncoder) {
-            m_pEncoder->flush();
-            delete m_pEncoder;
-            m_pEncoder = NULL;
+        // Close QFile and encoder, if open. If no other sink uses the
+        // encoder, it is flushed into the subscription.
+        if (m_pEncoderSubscription) {
+            m_pEncoderBus->unsubscribe(m_pEncoderSubscription);
+            m_pEncoderSubscription->drain(this);
+            delete m_pEncoderSubscription;
+            m_pEncoderSubscription = NULL;
         }
         m_file.close();
     }
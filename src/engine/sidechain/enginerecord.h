@@ -35,16 +35,20 @@
 
 class ConfigKey;
 class ControlObjectSlave;
-class Encoder;
+class EncoderBus;
+class EncoderBusSubscription;
 
 class EngineRecord : public QObject, public EncoderCallback, public SideChainWorker {
     Q_OBJECT
   public:
-    EngineRecord(ConfigObject<ConfigValue>* _config);
+    EngineRecord(ConfigObject<ConfigValue>* _config, EncoderBus* pEncoderBus);
     virtual ~EngineRecord();
 
     void process(const CSAMPLE* pBuffer, const int iBufferSize);
     void shutdown() {}
+    QString name() const {
+        return "EngineRecord";
+    }
 
     // writes compressed audio to file 
     void write(unsigned char *header, unsigned char *body, int headerLen, int bodyLen);
@@ -65,6 +69,7 @@ class EngineRecord : public QObject, public EncoderCallback, public SideChainWor
 
   private:
     int getActiveTracks();
+    void unsubscribeEncoder();
 
     // Check if the metadata has changed since the previous check. We also check
     // when was the last check performed to avoid using too much CPU and as well
@@ -74,7 +79,9 @@ class EngineRecord : public QObject, public EncoderCallback, public SideChainWor
     void writeCueLine();
 
     ConfigObject<ConfigValue>* m_pConfig;
-    Encoder* m_pEncoder;
+    EncoderBus* m_pEncoderBus;
+    // The compressed audio for MP3 and OGG recordings.
+    EncoderBusSubscription* m_pEncoderSubscription;
     QByteArray m_OGGquality;
     QByteArray m_MP3quality;
     QByteArray m_encoding;
@@ -16,6 +16,8 @@
  ***************************************************************************/
 
 #include <QtDebug>
+#include <QMutex>
+#include <QMutexLocker>
 
 #include <signal.h>
 
@@ -31,17 +33,26 @@
 #include "engine/sidechain/engineshoutcast.h"
 #include "configobject.h"
 #include "playerinfo.h"
-#include "encoder/encoder.h"
-#include "encoder/encodermp3.h"
-#include "encoder/encodervorbis.h"
+#include "engine/sidechain/encoderbus.h"
 #include "shoutcast/defs_shoutcast.h"
 #include "trackinfoobject.h"
 #include "util/sleep.h"
 
 #define TIMEOUT 10
 
-EngineShoutcast::EngineShoutcast(ConfigObject<ConfigValue>* _config)
-        : m_pTextCodec(NULL),
+namespace {
+
+// libshout has global state, shared by all targets.
+QMutex s_shoutUsersMutex;
+int s_iShoutUsers = 0;
+
+}  // namespace
+
+EngineShoutcast::EngineShoutcast(ConfigObject<ConfigValue>* _config,
+                                 EncoderBus* pEncoderBus,
+                                 const QString& group)
+        : m_group(group),
+          m_pTextCodec(NULL),
           m_pMetaData(),
           m_pShout(NULL),
           m_pShoutMetaData(NULL),
@@ -49,11 +60,17 @@ EngineShoutcast::EngineShoutcast(ConfigObject<ConfigValue>* _config)
           m_iShoutStatus(0),
           m_iShoutFailures(0),
           m_pConfig(_config),
-          m_encoder(NULL),
+          m_pEncoderBus(pEncoderBus),
+          m_pEncoderSubscription(NULL),
           m_pShoutcastNeedUpdateFromPrefs(NULL),
           m_pUpdateShoutcastFromPrefs(NULL),
           m_pMasterSamplerate(new ControlObjectSlave("[Master]", "samplerate")),
-          m_pShoutcastStatus(new ControlObject(ConfigKey(SHOUTCAST_PREF_KEY, "status"))),
+          m_pShoutcastStatus(new ControlObject(ConfigKey(group, "status"))),
+          m_pThroughput(new ControlObject(ConfigKey(group, "throughput"))),
+          m_pLag(new ControlObject(ConfigKey(group, "lag"))),
+          m_iStatsSamples(0),
+          m_iStatsBytesSent(0),
+          m_iBitrate(0),
           m_bQuit(false),
           m_custom_metadata(false),
           m_firstCall(false),
@@ -62,7 +79,10 @@ EngineShoutcast::EngineShoutcast(ConfigObject<ConfigValue>* _config)
           m_protocol_is_icecast1(false),
           m_protocol_is_icecast2(false),
           m_protocol_is_shoutcast(false),
-          m_ogg_dynamic_update(false) {
+          m_ogg_dynamic_update(false),
+          m_bOnlyTarget(_config->getValueString(
+                  ConfigKey(SHOUTCAST_PREF_KEY, SHOUTCAST_TARGET_COUNT_KEY),
+                  "1").toInt() <= 1) {
 
 #ifndef __WINDOWS__
     // Ignore SIGPIPE signals that we get when the remote streaming server
@@ -72,12 +92,16 @@ EngineShoutcast::EngineShoutcast(ConfigObject<ConfigValue>* _config)
 
     m_pShoutcastStatus->set(SHOUTCAST_DISCONNECTED);
     m_pShoutcastNeedUpdateFromPrefs = new ControlObject(
-            ConfigKey(SHOUTCAST_PREF_KEY,"update_from_prefs"));
+            ConfigKey(group, "update_from_prefs"));
     m_pUpdateShoutcastFromPrefs = new ControlObjectSlave(
             m_pShoutcastNeedUpdateFromPrefs->getKey());
 
     // Initialize libshout
-    shout_init();
+    s_shoutUsersMutex.lock();
+    if (s_iShoutUsers++ == 0) {
+        shout_init();
+    }
+    s_shoutUsersMutex.unlock();
 
     if (!(m_pShout = shout_new())) {
         errorDialog(tr("Mixxx encountered a problem"), tr("Could not allocate shout_t"));
@@ -95,14 +119,16 @@ EngineShoutcast::EngineShoutcast(ConfigObject<ConfigValue>* _config)
 }
 
 EngineShoutcast::~EngineShoutcast() {
-    if (m_encoder) {
-        m_encoder->flush();
-        delete m_encoder;
+    if (m_pEncoderSubscription) {
+        m_pEncoderBus->unsubscribe(m_pEncoderSubscription);
+        delete m_pEncoderSubscription;
     }
 
     delete m_pUpdateShoutcastFromPrefs;
     delete m_pShoutcastNeedUpdateFromPrefs;
     delete m_pShoutcastStatus;
+    delete m_pThroughput;
+    delete m_pLag;
     delete m_pMasterSamplerate;
 
     if (m_pShoutMetaData) {
@@ -112,17 +138,33 @@ EngineShoutcast::~EngineShoutcast() {
         shout_close(m_pShout);
         shout_free(m_pShout);
     }
-    shout_shutdown();
+
+    QMutexLocker locker(&s_shoutUsersMutex);
+    if (--s_iShoutUsers == 0) {
+        shout_shutdown();
+    }
+}
+
+QString EngineShoutcast::getPrefValue(const char* key) const {
+    QString value = m_pConfig->getValueString(ConfigKey(m_group, key));
+    if (value.isEmpty() && m_group != SHOUTCAST_PREF_KEY) {
+        value = m_pConfig->getValueString(ConfigKey(SHOUTCAST_PREF_KEY, key));
+    }
+    return value;
 }
 
 bool EngineShoutcast::serverDisconnect() {
-    if (m_encoder) {
-        m_encoder->flush();
-        delete m_encoder;
-        m_encoder = NULL;
+    if (m_pEncoderSubscription) {
+        // Send what the encoder flushes if no other sink uses it.
+        m_pEncoderBus->unsubscribe(m_pEncoderSubscription);
+        m_pEncoderSubscription->drain(this);
+        delete m_pEncoderSubscription;
+        m_pEncoderSubscription = NULL;
     }
 
     m_pShoutcastStatus->set(SHOUTCAST_DISCONNECTED);
+    m_pThroughput->set(0.0);
+    m_pLag->set(0.0);
 
     if (m_pShout) {
         shout_close(m_pShout);
@@ -162,7 +204,7 @@ void EngineShoutcast::updateFromPreferences() {
     // Convert a bunch of QStrings to QByteArrays so we can get regular C char*
     // strings to pass to libshout.
 
-    QString codec = m_pConfig->getValueString(ConfigKey(SHOUTCAST_PREF_KEY, "metadata_charset"));
+    QString codec = getPrefValue("metadata_charset");
     QByteArray baCodec = codec.toLatin1();
     m_pTextCodec = QTextCodec::codecForName(baCodec);
     if (!m_pTextCodec) {
@@ -174,51 +216,33 @@ void EngineShoutcast::updateFromPreferences() {
     shout_metadata_add(m_pShoutMetaData, "charset",  baCodec.constData());
 
     // Host, server type, port, mountpoint, login, password should be latin1.
-    QByteArray baHost = m_pConfig->getValueString(
-            ConfigKey(SHOUTCAST_PREF_KEY, "host")).toLatin1();
-    QByteArray baServerType = m_pConfig->getValueString(
-            ConfigKey(SHOUTCAST_PREF_KEY, "servertype")).toLatin1();
-    QByteArray baPort = m_pConfig->getValueString(
-            ConfigKey(SHOUTCAST_PREF_KEY, "port")).toLatin1();
-    QByteArray baMountPoint = m_pConfig->getValueString(
-            ConfigKey(SHOUTCAST_PREF_KEY, "mountpoint")).toLatin1();
-    QByteArray baLogin = m_pConfig->getValueString(
-            ConfigKey(SHOUTCAST_PREF_KEY, "login")).toLatin1();
-    QByteArray baPassword = m_pConfig->getValueString(
-            ConfigKey(SHOUTCAST_PREF_KEY, "password")).toLatin1();
-    QByteArray baFormat = m_pConfig->getValueString(
-            ConfigKey(SHOUTCAST_PREF_KEY, "format")).toLatin1();
-    QByteArray baBitrate = m_pConfig->getValueString(
-            ConfigKey(SHOUTCAST_PREF_KEY, "bitrate")).toLatin1();
+    QByteArray baHost = getPrefValue("host").toLatin1();
+    QByteArray baServerType = getPrefValue("servertype").toLatin1();
+    QByteArray baPort = getPrefValue("port").toLatin1();
+    QByteArray baMountPoint = getPrefValue("mountpoint").toLatin1();
+    QByteArray baLogin = getPrefValue("login").toLatin1();
+    QByteArray baPassword = getPrefValue("password").toLatin1();
+    QByteArray baFormat = getPrefValue("format").toLatin1();
+    QByteArray baBitrate = getPrefValue("bitrate").toLatin1();
 
     // Encode metadata like stream name, website, desc, genre, title/author with
     // the chosen TextCodec.
-    QByteArray baStreamName = encodeString(m_pConfig->getValueString(
-            ConfigKey(SHOUTCAST_PREF_KEY, "stream_name")));
-    QByteArray baStreamWebsite = encodeString(m_pConfig->getValueString(
-            ConfigKey(SHOUTCAST_PREF_KEY, "stream_website")));
-    QByteArray baStreamDesc = encodeString(m_pConfig->getValueString(
-            ConfigKey(SHOUTCAST_PREF_KEY, "stream_desc")));
-    QByteArray baStreamGenre = encodeString(m_pConfig->getValueString(
-            ConfigKey(SHOUTCAST_PREF_KEY, "stream_genre")));
+    QByteArray baStreamName = encodeString(getPrefValue("stream_name"));
+    QByteArray baStreamWebsite = encodeString(getPrefValue("stream_website"));
+    QByteArray baStreamDesc = encodeString(getPrefValue("stream_desc"));
+    QByteArray baStreamGenre = encodeString(getPrefValue("stream_genre"));
 
     // Whether the stream is public.
-    bool streamPublic = m_pConfig->getValueString(
-            ConfigKey(SHOUTCAST_PREF_KEY, "stream_public")).toInt() > 0;
+    bool streamPublic = getPrefValue("stream_public").toInt() > 0;
 
     // Dynamic Ogg metadata update
-    m_ogg_dynamic_update = (bool)m_pConfig->getValueString(
-            ConfigKey(SHOUTCAST_PREF_KEY,"ogg_dynamicupdate")).toInt();
+    m_ogg_dynamic_update = (bool)getPrefValue("ogg_dynamicupdate").toInt();
 
-    m_custom_metadata = (bool)m_pConfig->getValueString(
-            ConfigKey(SHOUTCAST_PREF_KEY, "enable_metadata")).toInt();
-    m_customTitle = m_pConfig->getValueString(
-            ConfigKey(SHOUTCAST_PREF_KEY, "custom_title"));
-    m_customArtist = m_pConfig->getValueString(
-            ConfigKey(SHOUTCAST_PREF_KEY, "custom_artist"));
+    m_custom_metadata = (bool)getPrefValue("enable_metadata").toInt();
+    m_customTitle = getPrefValue("custom_title");
+    m_customArtist = getPrefValue("custom_artist");
 
-    m_metadataFormat = m_pConfig->getValueString(
-            ConfigKey(SHOUTCAST_PREF_KEY, "metadata_format"));
+    m_metadataFormat = getPrefValue("metadata_format");
 
     int format;
     int protocol;
@@ -345,28 +369,36 @@ void EngineShoutcast::updateFromPreferences() {
         return;
     }
 
-    // Initialize m_encoder
-    if (m_encoder) {
-        // delete m_encoder if it has been initalized (with maybe) different bitrate
-        delete m_encoder;
-        m_encoder = NULL;
+    // Subscribe to the encoder, which a recording of the same format and
+    // bitrate may already use.
+    if (m_pEncoderSubscription) {
+        // drop the subscription if it has been initalized (with maybe)
+        // different bitrate
+        m_pEncoderBus->unsubscribe(m_pEncoderSubscription);
+        delete m_pEncoderSubscription;
+        m_pEncoderSubscription = NULL;
     }
 
+    EncoderBus::Settings settings;
     if (m_format_is_mp3) {
-        m_encoder = new EncoderMp3(this);
+        settings.format = EncoderBus::Settings::MP3;
     } else if (m_format_is_ov) {
-        m_encoder = new EncoderVorbis(this);
+        settings.format = EncoderBus::Settings::OGG_VORBIS;
     } else {
         qDebug() << "**** Unknown Encoder Format";
         return;
     }
+    settings.bitrate = iBitrate;
+    settings.samplerate = iMasterSamplerate;
+    m_iBitrate = iBitrate;
 
-    if (m_encoder->initEncoder(iBitrate, iMasterSamplerate) < 0) {
+    // Listeners should hear the live mix, so the stream skips what it could
+    // not send in time.
+    m_pEncoderSubscription = m_pEncoderBus->subscribe(settings, DROP_OLDEST);
+    if (m_pEncoderSubscription == NULL) {
         //e.g., if lame is not found
-        //init m_encoder itself will display a message box
+        //init the encoder itself will display a message box
         qDebug() << "**** Encoder init failed";
-        delete m_encoder;
-        m_encoder = NULL;
     }
 }
 
@@ -388,14 +420,13 @@ bool EngineShoutcast::serverConnect() {
     //If static metadata is available, we only need to send metadata one time
     m_firstCall = false;
 
-    /*Check if m_encoder is initalized
-     * Encoder is initalized in updateFromPreferences which is called always before serverConnect()
-     * If m_encoder is NULL, then we propably want to use MP3 streaming, however, lame could not be found
+    /*Check if m_pEncoderSubscription is initalized
+     * It is initalized in updateFromPreferences which is called always before serverConnect()
+     * If it is NULL, then we propably want to use MP3 streaming, however, lame could not be found
      * It does not make sense to connect
      */
-    if (m_encoder == NULL) {
-        m_pConfig->set(ConfigKey(SHOUTCAST_PREF_KEY,"enabled"),ConfigValue("0"));
-        m_pShoutcastStatus->set(SHOUTCAST_DISCONNECTED);
+    if (m_pEncoderSubscription == NULL) {
+        connectFailed();
         return false;
     }
     const int iMaxTries = 3;
@@ -419,8 +450,7 @@ bool EngineShoutcast::serverConnect() {
     if (m_iShoutFailures == iMaxTries) {
         if (m_pShout)
             shout_close(m_pShout);
-        m_pConfig->set(ConfigKey(SHOUTCAST_PREF_KEY,"enabled"),ConfigValue("0"));
-        m_pShoutcastStatus->set(SHOUTCAST_DISCONNECTED);
+        connectFailed();
         return false;
     }
     if (m_bQuit) {
@@ -443,16 +473,27 @@ bool EngineShoutcast::serverConnect() {
         m_pShoutcastStatus->set(SHOUTCAST_CONNECTED);
         return true;
     }
-    //otherwise disable shoutcast in preferences
-    m_pConfig->set(ConfigKey(SHOUTCAST_PREF_KEY,"enabled"),ConfigValue("0"));
+    //otherwise give up on this target
     if (m_pShout) {
         shout_close(m_pShout);
         //errorDialog(tr("Mixxx could not connect to the server"), tr("Please check your connection to the Internet and verify that your username and password are correct."));
     }
-    m_pShoutcastStatus->set(SHOUTCAST_DISCONNECTED);
+    connectFailed();
     return false;
 }
 
+void EngineShoutcast::connectFailed() {
+    if (m_bOnlyTarget) {
+        // Nothing streams anymore, so uncheck streaming in the menu and the
+        // preferences.
+        m_pConfig->set(ConfigKey(SHOUTCAST_PREF_KEY,"enabled"),ConfigValue("0"));
+        m_pShoutcastStatus->set(SHOUTCAST_DISCONNECTED);
+    } else {
+        // The other targets keep streaming.
+        m_pShoutcastStatus->set(SHOUTCAST_FAILURE);
+    }
+}
+
 void EngineShoutcast::write(unsigned char *header, unsigned char *body,
                             int headerLen, int bodyLen) {
     int ret;
@@ -494,6 +535,7 @@ void EngineShoutcast::write(unsigned char *header, unsigned char *body,
             return;
         } else {
             //qDebug() << "yea I kinda sent footer";
+            m_iStatsBytesSent += headerLen + bodyLen;
         }
         if (shout_queuelen(m_pShout) > 0) {
             qDebug() << "DEBUG: queue length:" << (int)shout_queuelen(m_pShout);
@@ -505,6 +547,9 @@ void EngineShoutcast::write(unsigned char *header, unsigned char *body,
 }
 
 void EngineShoutcast::process(const CSAMPLE* pBuffer, const int iBufferSize) {
+    // The EncoderBus encodes the samples.
+    Q_UNUSED(pBuffer);
+
     //Check to see if Shoutcast is enabled, and pass the samples off to be broadcast if necessary.
     bool prefEnabled = (m_pConfig->getValueString(ConfigKey(SHOUTCAST_PREF_KEY,"enabled")).toInt() == 1);
 
@@ -514,6 +559,10 @@ void EngineShoutcast::process(const CSAMPLE* pBuffer, const int iBufferSize) {
             serverDisconnect();
             infoDialog(tr("Mixxx has successfully disconnected from the streaming server"), "");
         }
+        // Try a target that failed again once streaming is enabled again.
+        if (m_pShoutcastStatus->get() == SHOUTCAST_FAILURE) {
+            m_pShoutcastStatus->set(SHOUTCAST_DISCONNECTED);
+        }
         return;
     }
 
@@ -525,6 +574,12 @@ void EngineShoutcast::process(const CSAMPLE* pBuffer, const int iBufferSize) {
     // If we aren't connected or the user has changed their preferences,
     // disconnect, update from prefs, and reconnect.
     if (!connected || m_pUpdateShoutcastFromPrefs->get() > 0.0) {
+        // Don't retry a target that failed to connect before its preferences
+        // change.
+        if (!connected && m_pShoutcastStatus->get() == SHOUTCAST_FAILURE &&
+                m_pUpdateShoutcastFromPrefs->get() <= 0.0) {
+            return;
+        }
         if (connected) {
             serverDisconnect();
         }
@@ -544,10 +599,12 @@ void EngineShoutcast::process(const CSAMPLE* pBuffer, const int iBufferSize) {
     if (m_iShoutStatus != SHOUTERR_CONNECTED)
         return;
 
-    // If we are connected, encode the samples.
-    if (iBufferSize > 0 && m_encoder) {
-        m_encoder->encodeBuffer(pBuffer, iBufferSize);
+    // If we are connected, send the samples the EncoderBus encoded since the
+    // last call.
+    if (m_pEncoderSubscription) {
+        m_pEncoderSubscription->drain(this);
     }
+    updateStats(iBufferSize);
 
     // Check if track metadata has changed and if so, update.
     if (metaDataHasChanged()) {
@@ -555,6 +612,31 @@ void EngineShoutcast::process(const CSAMPLE* pBuffer, const int iBufferSize) {
     }
 }
 
+void EngineShoutcast::updateStats(int iBufferSize) {
+    // Averaged over a second of audio, the sidechain delivers it in chunks
+    // of about half a second.
+    m_iStatsSamples += iBufferSize;
+    double samplerate = m_pMasterSamplerate->get();
+    if (samplerate <= 0) {
+        return;
+    }
+    double seconds = m_iStatsSamples / (2.0 * samplerate);
+    if (seconds < 1.0) {
+        return;
+    }
+    m_pThroughput->set(m_iStatsBytesSent * 8 / 1000.0 / seconds);
+    m_iStatsSamples = 0;
+    m_iStatsBytesSent = 0;
+
+    // What the server did not take yet waits in libshout, what this thread
+    // did not get to yet in the subscription.
+    qint64 pendingBytes = shout_queuelen(m_pShout);
+    if (m_pEncoderSubscription) {
+        pendingBytes += m_pEncoderSubscription->bufferedBytes();
+    }
+    m_pLag->set(m_iBitrate > 0 ? pendingBytes * 8 / (m_iBitrate * 1000.0) : 0.0);
+}
+
 bool EngineShoutcast::metaDataHasChanged() {
     TrackPointer pTrack;
 
@@ -28,14 +28,20 @@
 #include "controlobjectslave.h"
 #include "encoder/encodercallback.h"
 #include "engine/sidechain/sidechainworker.h"
+#include "shoutcast/defs_shoutcast.h"
 #include "errordialoghandler.h"
 #include "trackinfoobject.h"
 
 #define SHOUTCAST_DISCONNECTED 0
 #define SHOUTCAST_CONNECTING 1
 #define SHOUTCAST_CONNECTED 2
+// One of several targets could not connect. It stays off until streaming is
+// enabled again or its preferences change, while the other targets keep
+// streaming. The only target disables streaming instead.
+#define SHOUTCAST_FAILURE 3
 
-class Encoder;
+class EncoderBus;
+class EncoderBusSubscription;
 
 // Forward declare libshout structures to prevent leaking shout.h definitions
 // beyond where they are needed.
@@ -47,7 +53,9 @@ typedef struct _util_dict shout_metadata_t;
 class EngineShoutcast : public QObject, public EncoderCallback, public SideChainWorker {
     Q_OBJECT
   public:
-    EngineShoutcast(ConfigObject<ConfigValue>* _config);
+    // Streams to the target configured in group, see defs_shoutcast.h.
+    EngineShoutcast(ConfigObject<ConfigValue>* _config, EncoderBus* pEncoderBus,
+                    const QString& group = SHOUTCAST_PREF_KEY);
     virtual ~EngineShoutcast();
 
     // This is called by the Engine implementation for each sample. Encode and
@@ -58,8 +66,17 @@ class EngineShoutcast : public QObject, public EncoderCallback, public SideChain
         m_bQuit = true;
     }
 
-    // Called by the encoder in method 'encodebuffer()' to flush the stream to
-    // the server.
+    // Listeners should hear the live mix, so after a stall the stream skips
+    // what it could not send in time.
+    OverflowPolicy overflowPolicy() const {
+        return DROP_OLDEST;
+    }
+    QString name() const {
+        return "EngineShoutcast " + m_group;
+    }
+
+    // Called by the EncoderBus subscription in method 'drain()' to flush the
+    // stream to the server.
     void write(unsigned char *header, unsigned char *body,
                int headerLen, int bodyLen);
     /** connects to server **/
@@ -87,7 +104,17 @@ class EngineShoutcast : public QObject, public EncoderCallback, public SideChain
     void errorDialog(QString text, QString detailedError);
     void infoDialog(QString text, QString detailedError);
 
+    // Returns the value of key in the group of this target, or the one of the
+    // first target if the group does not set it.
+    QString getPrefValue(const char* key) const;
+    // Updates the throughput and lag controls.
+    void updateStats(int iBufferSize);
+    // Gives up on the target after it could not connect. The only target
+    // disables streaming, one of several marks itself as SHOUTCAST_FAILURE.
+    void connectFailed();
+
     QByteArray encodeString(const QString& string);
+    const QString m_group;
     QTextCodec* m_pTextCodec;
     TrackPointer m_pMetaData;
     shout_t *m_pShout;
@@ -96,11 +123,19 @@ class EngineShoutcast : public QObject, public EncoderCallback, public SideChain
     long m_iShoutStatus;
     long m_iShoutFailures;
     ConfigObject<ConfigValue>* m_pConfig;
-    Encoder *m_encoder;
+    EncoderBus* m_pEncoderBus;
+    EncoderBusSubscription* m_pEncoderSubscription;
     ControlObject* m_pShoutcastNeedUpdateFromPrefs;
     ControlObjectSlave* m_pUpdateShoutcastFromPrefs;
     ControlObjectSlave* m_pMasterSamplerate;
     ControlObject* m_pShoutcastStatus;
+    // The kbit/s sent to the server, and the seconds of the stream that were
+    // encoded but not sent yet.
+    ControlObject* m_pThroughput;
+    ControlObject* m_pLag;
+    qint64 m_iStatsSamples;
+    qint64 m_iStatsBytesSent;
+    int m_iBitrate;
     volatile bool m_bQuit;
     // static metadata according to prefereneces
     bool m_custom_metadata;
@@ -118,6 +153,8 @@ class EngineShoutcast : public QObject, public EncoderCallback, public SideChain
     bool m_protocol_is_icecast2;
     bool m_protocol_is_shoutcast;
     bool m_ogg_dynamic_update;
+    // Set if this is the only streaming target.
+    const bool m_bOnlyTarget;
 };
 
 #endif
@@ -17,18 +17,19 @@
 #ifndef ENGINESIDECHAIN_H
 #define ENGINESIDECHAIN_H
 
-#include <QThread>
+#include <QAtomicInt>
 #include <QMutex>
-#include <QWaitCondition>
-#include <QList>
 
 #include "configobject.h"
 #include "engine/sidechain/sidechainworker.h"
-#include "util/fifo.h"
 #include "util/types.h"
 
-class EngineSideChain : public QThread {
-    Q_OBJECT
+class EncoderBus;
+class SideChainWorkerThread;
+
+// Fans the master output out to the sidechain workers. Each worker has a
+// buffer and a thread of its own, see SideChainWorkerThread.
+class EngineSideChain {
   public:
     EngineSideChain(ConfigObject<ConfigValue>* pConfig);
     virtual ~EngineSideChain();
@@ -38,27 +39,27 @@ class EngineSideChain : public QThread {
     // the engine callback).
     void writeSamples(const CSAMPLE* buffer, int buffer_size);
 
-    // Thread-safe, blocking.
+    // Thread-safe, blocking. Takes ownership of pWorker and starts its thread.
     void addSideChainWorker(SideChainWorker* pWorker);
 
+    // The encoders shared by the workers. Outlives all other workers.
+    EncoderBus* getEncoderBus() const {
+        return m_pEncoderBus;
+    }
+
   private:
-    void run();
+    static const int kMaxWorkers = 8;
 
     ConfigObject<ConfigValue>* m_pConfig;
-    // Indicates that the thread should exit.
-    volatile bool m_bStopThread;
-
-    FIFO<CSAMPLE> m_sampleFifo;
-    CSAMPLE* m_pWorkBuffer;
-
-    // Provides thread safety around the wait condition below.
-    QMutex m_waitLock;
-    // Allows sleeping until we have samples to process.
-    QWaitCondition m_waitForSamples;
+    // Owned by the first worker thread.
+    EncoderBus* m_pEncoderBus;
 
-    // Sidechain workers registered with EngineSideChain.
+    // Serializes addSideChainWorker.
     QMutex m_workerLock;
-    QList<SideChainWorker*> m_workers;
+    // The threads of the sidechain workers. Only ever appended to, the writer
+    // reads the first m_iWorkerCount without a lock.
+    SideChainWorkerThread* m_workerThreads[kMaxWorkers];
+    QAtomicInt m_iWorkerCount;
 };
 
 #endif
@@ -1,14 +1,38 @@
 #ifndef SIDECHAINWORKER_H
 #define SIDECHAINWORKER_H
 
+#include <QString>
+
 #include "util/types.h"
 
 class SideChainWorker {
   public:
+    // What EngineSideChain does when a worker falls behind and its buffer
+    // overflows.
+    enum OverflowPolicy {
+        // Keep the buffered samples and drop the ones that do not fit. The
+        // worker gets everything up to the gap in order, e.g. for recording.
+        DROP_NEWEST,
+        // Also drop the buffered samples, so the worker catches up with the
+        // engine, e.g. for live streaming.
+        DROP_OLDEST
+    };
+
     SideChainWorker() { }
     virtual ~SideChainWorker() { }
+    // Called on the thread of the worker.
     virtual void process(const CSAMPLE* pBuffer, const int iBufferSize) = 0;
+    // Called from the main thread before the thread of the worker is stopped.
+    // Must make a blocking process() return soon.
     virtual void shutdown() = 0;
+
+    virtual OverflowPolicy overflowPolicy() const {
+        return DROP_NEWEST;
+    }
+    // Names the thread and the stats of the worker.
+    virtual QString name() const {
+        return "SideChainWorker";
+    }
 };
 
 #endif /* SIDECHAINWORKER_H */
@@ -0,0 +1,110 @@
+#include <QtDebug>
+#include <QMutexLocker>
+
+#include "engine/sidechain/sidechainworkerthread.h"
+#include "sampleutil.h"
+#include "util/compatibility.h"
+#include "util/trace.h"
+
+SideChainWorkerThread::SideChainWorkerThread(SideChainWorker* pWorker,
+                                             int bufferSize)
+        : m_pWorker(pWorker),
+          m_overflowPolicy(pWorker->overflowPolicy()),
+          m_iBufferSize(bufferSize),
+          m_sampleFifo(bufferSize),
+          m_pWorkBuffer(SampleUtil::alloc(bufferSize)),
+          m_bStopThread(false),
+          m_iOverflows(0),
+          m_iDroppedSamples(0),
+          m_iSeenOverflows(0),
+          m_droppedSamplesKey(pWorker->name() + " dropped samples") {
+    // We use HighPriority to prevent starvation by lower-priority processes (Qt
+    // main thread, analysis, etc.). Workers do semi-realtime tasks (write to
+    // broadcast servers), to get reliable timing it's important that this work
+    // be prioritized over the GUI and non-realtime tasks. See discussion on
+    // Bug #1270583 and Bug #1194543.
+    start(QThread::HighPriority);
+}
+
+SideChainWorkerThread::~SideChainWorkerThread() {
+    stop();
+    delete m_pWorker;
+    SampleUtil::free(m_pWorkBuffer);
+}
+
+void SideChainWorkerThread::stop() {
+    m_pWorker->shutdown();
+
+    m_waitLock.lock();
+    m_bStopThread = true;
+    m_waitForSamples.wakeAll();
+    m_waitLock.unlock();
+
+    // Wait until the thread has finished.
+    wait();
+}
+
+int SideChainWorkerThread::overflows() const {
+    return load_atomic(m_iOverflows);
+}
+
+int SideChainWorkerThread::droppedSamples() const {
+    return load_atomic(m_iDroppedSamples);
+}
+
+void SideChainWorkerThread::writeSamples(const CSAMPLE* pBuffer,
+                                         int iBufferSize) {
+    int samples_written = m_sampleFifo.write(pBuffer, iBufferSize);
+
+    if (samples_written != iBufferSize) {
+        m_iDroppedSamples.fetchAndAddRelaxed(iBufferSize - samples_written);
+        m_iOverflows.fetchAndAddRelease(1);
+        Stat::track(m_droppedSamplesKey, Stat::COUNTER,
+                    Stat::experimentFlags(Stat::COUNT | Stat::SUM),
+                    iBufferSize - samples_written);
+    }
+
+    if (m_sampleFifo.writeAvailable() < m_iBufferSize / 5) {
+        // Signal to the worker that samples are available.
+        m_waitForSamples.wakeAll();
+    }
+}
+
+void SideChainWorkerThread::maybeDropBacklog() {
+    if (m_overflowPolicy != SideChainWorker::DROP_OLDEST) {
+        return;
+    }
+    int overflows = m_iOverflows.fetchAndAddAcquire(0);
+    if (overflows == m_iSeenOverflows) {
+        return;
+    }
+    m_iSeenOverflows = overflows;
+    // Everything buffered is older than the samples the writer could not fit.
+    // The reader owns the read position, so it can skip them without a lock.
+    int backlog = m_sampleFifo.readAvailable();
+    m_sampleFifo.releaseReadRegions(backlog);
+    m_iDroppedSamples.fetchAndAddRelaxed(backlog);
+}
+
+void SideChainWorkerThread::run() {
+    setObjectName(m_pWorker->name());
+
+    while (!m_bStopThread) {
+        // Sleep until samples are available.
+        m_waitLock.lock();
+        if (!m_bStopThread) {
+            m_waitForSamples.wait(&m_waitLock);
+        }
+        m_waitLock.unlock();
+
+        maybeDropBacklog();
+        int samples_read;
+        while ((samples_read = m_sampleFifo.read(m_pWorkBuffer,
+                                                 m_iBufferSize))) {
+            Trace process("SideChainWorkerThread::process");
+            m_pWorker->process(m_pWorkBuffer, samples_read);
+            // Processing may have blocked for long enough to overflow.
+            maybeDropBacklog();
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef SIDECHAINWORKERTHREAD_H
+#define SIDECHAINWORKERTHREAD_H
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "engine/sidechain/sidechainworker.h"
+#include "util/fifo.h"
+#include "util/stat.h"
+#include "util/types.h"
+
+// Runs one SideChainWorker on a thread of its own, fed from a ring buffer of
+// its own. A worker that blocks, e.g. on a stalled network connection, only
+// ever overflows its own buffer and never delays the other workers or the
+// engine.
+class SideChainWorkerThread : public QThread {
+    Q_OBJECT
+  public:
+    // Takes ownership of pWorker and starts the thread.
+    SideChainWorkerThread(SideChainWorker* pWorker, int bufferSize);
+    // Stops the thread and deletes the worker.
+    virtual ~SideChainWorkerThread();
+
+    // Not thread-safe, wait-free. Should only be called from a single writer
+    // thread (typically the engine callback). The samples that do not fit are
+    // dropped according to the overflow policy of the worker.
+    void writeSamples(const CSAMPLE* pBuffer, int iBufferSize);
+
+    // Shuts the worker down and waits for the thread to finish.
+    void stop();
+
+    SideChainWorker* worker() const {
+        return m_pWorker;
+    }
+    // The number of times writeSamples did not fit into the buffer.
+    int overflows() const;
+    // The number of samples the worker never got.
+    int droppedSamples() const;
+
+  private:
+    void run();
+    // Drops the buffered samples if the buffer overflowed since the last
+    // call and the worker drops the oldest samples.
+    void maybeDropBacklog();
+
+    SideChainWorker* m_pWorker;
+    const SideChainWorker::OverflowPolicy m_overflowPolicy;
+    const int m_iBufferSize;
+    FIFO<CSAMPLE> m_sampleFifo;
+    CSAMPLE* m_pWorkBuffer;
+
+    // Indicates that the thread should exit.
+    volatile bool m_bStopThread;
+    // Provides thread safety around the wait condition below.
+    QMutex m_waitLock;
+    // Allows sleeping until we have samples to process.
+    QWaitCondition m_waitForSamples;
+
+    // Incremented by the writer, read by the worker thread.
+    QAtomicInt m_iOverflows;
+    QAtomicInt m_iDroppedSamples;
+    // The overflows the worker thread has seen. Only used by the worker
+    // thread.
+    int m_iSeenOverflows;
+    StatKey m_droppedSamplesKey;
+};
+
+#endif /* SIDECHAINWORKERTHREAD_H */
@@ -4,6 +4,8 @@
 
 #include <QtDebug>
 
+#include <QThread>
+
 #include "library/analysisfeature.h"
 #include "library/librarytablemodel.h"
 #include "library/trackcollection.h"
@@ -11,19 +13,33 @@
 #include "widget/wlibrary.h"
 #include "mixxxkeyboard.h"
 #include "analyserqueue.h"
+#include "playerinfo.h"
 #include "soundsourceproxy.h"
 #include "util/dnd.h"
 #include "util/debug.h"
+#include "util/math.h"
 
 const QString AnalysisFeature::m_sAnalysisViewName = QString("Analysis");
 
+namespace {
+
+// Tracks handed to each AnalyserQueue ahead of time so it can start on the
+// next one without waiting for the GUI thread.
+const int kQueuedTracksPerAnalyserQueue = 2;
+
+// Analysed tracks are written to the database in transactions of this size.
+const int kSaveBatchSize = 64;
+
+}  // namespace
+
 AnalysisFeature::AnalysisFeature(QObject* parent,
                                ConfigObject<ConfigValue>* pConfig,
                                TrackCollection* pTrackCollection) :
         LibraryFeature(parent),
         m_pConfig(pConfig),
         m_pTrackCollection(pTrackCollection),
-        m_pAnalyserQueue(NULL),
+        m_iTracksTotal(0),
+        m_iTracksFinished(0),
         m_iOldBpmEnabled(0),
         m_analysisTitleName(tr("Analyze")),
         m_pAnalysisView(NULL) {
@@ -79,11 +95,13 @@ void AnalysisFeature::bindWidget(WLibrary* libraryWidget,
             m_pAnalysisView, SLOT(analysisActive(bool)));
     connect(this, SIGNAL(trackAnalysisStarted(int)),
             m_pAnalysisView, SLOT(trackAnalysisStarted(int)));
+    connect(this, SIGNAL(trackAnalysisFinished(int)),
+            m_pAnalysisView, SLOT(trackAnalysisFinished(int)));
 
     m_pAnalysisView->installEventFilter(keyboard);
 
     // Let the DlgAnalysis know whether or not analysis is active.
-    bool bAnalysisActive = m_pAnalyserQueue != NULL;
+    bool bAnalysisActive = !m_analyserQueues.isEmpty();
     emit(analysisActive(bAnalysisActive));
 
     libraryWidget->registerView(m_sAnalysisViewName, m_pAnalysisView);
@@ -109,65 +127,159 @@ void AnalysisFeature::activate() {
 }
 
 void AnalysisFeature::analyzeTracks(QList<int> trackIds) {
-    if (m_pAnalyserQueue == NULL) {
+    if (m_analyserQueues.isEmpty()) {
         // Save the old BPM detection prefs setting (on or off)
         m_iOldBpmEnabled = m_pConfig->getValueString(ConfigKey("[BPM]","BPMDetectionEnabled")).toInt();
         // Force BPM detection to be on.
         m_pConfig->set(ConfigKey("[BPM]","BPMDetectionEnabled"), ConfigValue(1));
         // Note: this sucks... we should refactor the prefs/analyser to fix this hacky bit ^^^^.
 
-        m_pAnalyserQueue = AnalyserQueue::createAnalysisFeatureAnalyserQueue(m_pConfig, m_pTrackCollection);
+        int numQueues = m_pConfig->getValueString(
+                ConfigKey("[Library]", "AnalysisThreads")).toInt();
+        if (numQueues <= 0) {
+            numQueues = QThread::idealThreadCount();
+        }
+        numQueues = math_max(1, numQueues);
+
+        const bool throttled =
+                !PlayerInfo::instance().getCurrentPlayingTrack().isNull();
+        for (int i = 0; i < numQueues; ++i) {
+            AnalyserQueue* pQueue = AnalyserQueue::createAnalysisFeatureAnalyserQueue(
+                    m_pConfig, m_pTrackCollection);
+            pQueue->setThrottled(throttled);
 
-        connect(m_pAnalyserQueue, SIGNAL(trackProgress(int)),
-                m_pAnalysisView, SLOT(trackAnalysisProgress(int)));
-        connect(m_pAnalyserQueue, SIGNAL(trackFinished(int)),
-                this, SLOT(slotProgressUpdate(int)));
-        connect(m_pAnalyserQueue, SIGNAL(trackFinished(int)),
-                m_pAnalysisView, SLOT(trackAnalysisFinished(int)));
+            connect(pQueue, SIGNAL(trackProgress(int)),
+                    m_pAnalysisView, SLOT(trackAnalysisProgress(int)));
+            connect(pQueue, SIGNAL(trackFinished(int)),
+                    this, SLOT(slotProgressUpdate(int)));
+            connect(pQueue, SIGNAL(trackDone(TrackPointer)),
+                    this, SLOT(slotTrackDone(TrackPointer)));
+            connect(pQueue, SIGNAL(queueEmpty()),
+                    this, SLOT(slotQueueEmpty()));
+            m_analyserQueues.append(pQueue);
+        }
 
-        connect(m_pAnalyserQueue, SIGNAL(queueEmpty()),
-                this, SLOT(cleanupAnalyser()));
+        // Stay out of the way of the audio callback while a deck is playing.
+        connect(&PlayerInfo::instance(), SIGNAL(currentPlayingDeckChanged(int)),
+                this, SLOT(slotPlayingDeckChanged(int)));
+
+        m_iTracksTotal = 0;
+        m_iTracksFinished = 0;
         emit(analysisActive(true));
     }
 
-    foreach(int trackId, trackIds) {
-        TrackPointer pTrack = m_pTrackCollection->getTrackDAO().getTrack(trackId);
-        if (pTrack) {
-            //qDebug() << this << "Queueing track for analysis" << pTrack->getLocation();
-            m_pAnalyserQueue->queueAnalyseTrack(pTrack);
-        }
+    m_pendingTrackIds.append(trackIds);
+    m_iTracksTotal += trackIds.size();
+    foreach (AnalyserQueue* pQueue, m_analyserQueues) {
+        feedAnalyserQueue(pQueue);
     }
+
     if (trackIds.size() > 0) {
-        setTitleProgress(0, trackIds.size());
+        setTitleProgress(m_iTracksFinished, m_iTracksTotal);
+    }
+    emit(trackAnalysisStarted(m_iTracksTotal));
+}
+
+void AnalysisFeature::feedAnalyserQueue(AnalyserQueue* pQueue) {
+    int queued = pQueue->queuedTrackCount();
+    while (queued < kQueuedTracksPerAnalyserQueue &&
+            !m_pendingTrackIds.isEmpty()) {
+        QList<int> trackIds;
+        while (queued + trackIds.size() < kQueuedTracksPerAnalyserQueue &&
+                !m_pendingTrackIds.isEmpty()) {
+            trackIds.append(m_pendingTrackIds.takeFirst());
+        }
+        QList<TrackPointer> tracks =
+                m_pTrackCollection->getTrackDAO().getTracks(trackIds);
+        foreach (const TrackPointer& pTrack, tracks) {
+            //qDebug() << this << "Queueing track for analysis" << pTrack->getLocation();
+            pQueue->queueAnalyseTrack(pTrack);
+            ++queued;
+        }
+        // Count the tracks that are gone as done so the progress still adds
+        // up.
+        m_iTracksFinished += trackIds.size() - tracks.size();
     }
-    emit(trackAnalysisStarted(trackIds.size()));
 }
 
 void AnalysisFeature::slotProgressUpdate(int num_left) {
-    int num_tracks = m_pAnalysisView->getNumTracks();
-    if (num_left > 0) {
-        int currentTrack = num_tracks - num_left + 1;
-        setTitleProgress(currentTrack, num_tracks);
+    Q_UNUSED(num_left);
+    ++m_iTracksFinished;
+    const int tracksLeft = m_iTracksTotal - m_iTracksFinished;
+    if (tracksLeft > 0) {
+        setTitleProgress(m_iTracksFinished + 1, m_iTracksTotal);
+    }
+    emit(trackAnalysisFinished(tracksLeft));
+
+    AnalyserQueue* pQueue = qobject_cast<AnalyserQueue*>(sender());
+    if (pQueue != NULL) {
+        feedAnalyserQueue(pQueue);
+    }
+}
+
+void AnalysisFeature::slotTrackDone(TrackPointer pTrack) {
+    m_analysedTracks.append(pTrack);
+    if (m_analysedTracks.size() >= kSaveBatchSize) {
+        saveAnalysedTracks();
+    }
+}
+
+void AnalysisFeature::slotQueueEmpty() {
+    AnalyserQueue* pQueue = qobject_cast<AnalyserQueue*>(sender());
+    if (pQueue != NULL) {
+        feedAnalyserQueue(pQueue);
+    }
+    if (!m_pendingTrackIds.isEmpty()) {
+        return;
+    }
+    foreach (AnalyserQueue* pOtherQueue, m_analyserQueues) {
+        if (!pOtherQueue->isIdle()) {
+            return;
+        }
+    }
+    cleanupAnalyser();
+}
+
+void AnalysisFeature::slotPlayingDeckChanged(int deck) {
+    foreach (AnalyserQueue* pQueue, m_analyserQueues) {
+        pQueue->setThrottled(deck >= 0);
     }
 }
 
+void AnalysisFeature::saveAnalysedTracks() {
+    if (m_analysedTracks.isEmpty()) {
+        return;
+    }
+    m_pTrackCollection->getTrackDAO().saveTracks(m_analysedTracks);
+    m_analysedTracks.clear();
+}
+
 void AnalysisFeature::stopAnalysis() {
     //qDebug() << this << "stopAnalysis()";
-    if (m_pAnalyserQueue != NULL) {
-        m_pAnalyserQueue->stop();
+    m_pendingTrackIds.clear();
+    if (!m_analyserQueues.isEmpty()) {
+        cleanupAnalyser();
     }
 }
 
 void AnalysisFeature::cleanupAnalyser() {
     setTitleDefault();
     emit(analysisActive(false));
-    if (m_pAnalyserQueue != NULL) {
-        m_pAnalyserQueue->stop();
-        m_pAnalyserQueue->deleteLater();
-        m_pAnalyserQueue = NULL;
+    m_pendingTrackIds.clear();
+    if (!m_analyserQueues.isEmpty()) {
+        disconnect(&PlayerInfo::instance(), SIGNAL(currentPlayingDeckChanged(int)),
+                   this, SLOT(slotPlayingDeckChanged(int)));
+        foreach (AnalyserQueue* pQueue, m_analyserQueues) {
+            // Drop pending signals of the queue, it is gone for good.
+            disconnect(pQueue, 0, this, 0);
+            pQueue->stop();
+            pQueue->deleteLater();
+        }
+        m_analyserQueues.clear();
         // Restore old BPM detection setting for preferences...
         m_pConfig->set(ConfigKey("[BPM]","BPMDetectionEnabled"), ConfigValue(m_iOldBpmEnabled));
     }
+    saveAnalysedTracks();
 }
 
 bool AnalysisFeature::dropAccept(QList<QUrl> urls, QObject* pSource) {
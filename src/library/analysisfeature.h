@@ -42,6 +42,7 @@ class AnalysisFeature : public LibraryFeature {
   signals:
     void analysisActive(bool bActive);
     void trackAnalysisStarted(int size);
+    void trackAnalysisFinished(int tracksLeft);
 
   public slots:
     void activate();
@@ -49,6 +50,9 @@ class AnalysisFeature : public LibraryFeature {
 
   private slots:
     void slotProgressUpdate(int num_left);
+    void slotTrackDone(TrackPointer pTrack);
+    void slotQueueEmpty();
+    void slotPlayingDeckChanged(int deck);
     void stopAnalysis();
     void cleanupAnalyser();
 
@@ -62,9 +66,24 @@ class AnalysisFeature : public LibraryFeature {
     // tracks in the job
     void setTitleProgress(int trackNum, int totalNum);
 
+    // Hands tracks from m_pendingTrackIds to pQueue until it has enough work
+    // queued to never run dry between two tracks.
+    void feedAnalyserQueue(AnalyserQueue* pQueue);
+
+    // Writes the tracks in m_analysedTracks to the database.
+    void saveAnalysedTracks();
+
     ConfigObject<ConfigValue>* m_pConfig;
     TrackCollection* m_pTrackCollection;
-    AnalyserQueue* m_pAnalyserQueue;
+    // The batch analysis runs one AnalyserQueue per core. Every queue pulls
+    // the next track from m_pendingTrackIds as soon as it has room, so a
+    // queue that happens to get short tracks simply takes more of them.
+    QList<AnalyserQueue*> m_analyserQueues;
+    QList<int> m_pendingTrackIds;
+    // Analysed tracks that are not written to the database yet.
+    QList<TrackPointer> m_analysedTracks;
+    int m_iTracksTotal;
+    int m_iTracksFinished;
     // Used to temporarily enable BPM detection in the prefs before we analyse
     int m_iOldBpmEnabled;
     // The title returned by title()
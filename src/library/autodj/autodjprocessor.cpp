@@ -10,6 +10,9 @@
 #define kConfigKey "[Auto DJ]"
 const char* kTransitionPreferenceName = "Transition";
 const int kTransitionPreferenceDefault = 10;
+// The number of tracks at the top of the queue read at once when looking for
+// the next track, since missing tracks are skipped.
+const int kNextTrackCandidates = 4;
 
 static const bool sDebug = false;
 
@@ -523,20 +526,30 @@ TrackPointer AutoDJProcessor::getNextTrackFromQueue() {
     }
 
     while (true) {
-        TrackPointer nextTrack = m_pAutoDJTableModel->getTrack(
-            m_pAutoDJTableModel->index(0, 0));
+        QModelIndexList candidates;
+        int rowCount = math_min(kNextTrackCandidates,
+                                m_pAutoDJTableModel->rowCount());
+        for (int row = 0; row < rowCount; ++row) {
+            candidates.append(m_pAutoDJTableModel->index(row, 0));
+        }
+        QList<TrackPointer> tracks = m_pAutoDJTableModel->getTracks(candidates);
+        if (tracks.isEmpty()) {
+            // We're out of tracks. Return the null TrackPointer.
+            return TrackPointer();
+        }
 
-        if (nextTrack) {
+        foreach (const TrackPointer& nextTrack, tracks) {
+            QModelIndex first = m_pAutoDJTableModel->index(0, 0);
+            if (nextTrack->getId() != m_pAutoDJTableModel->getTrackId(first)) {
+                // The track at the top is not in the library, we're out of
+                // tracks.
+                return TrackPointer();
+            }
             if (nextTrack->exists()) {
                 return nextTrack;
-            } else {
-                // Remove missing song from auto DJ playlist.
-                m_pAutoDJTableModel->removeTrack(
-                        m_pAutoDJTableModel->index(0, 0));
             }
-        } else {
-            // We're out of tracks. Return the null TrackPointer.
-            return nextTrack;
+            // Remove missing song from auto DJ playlist.
+            m_pAutoDJTableModel->removeTrack(first);
         }
     }
 }
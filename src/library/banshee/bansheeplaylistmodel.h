@@ -20,6 +20,10 @@ class BansheePlaylistModel : public BaseSqlTableModel {
     void setTableModel(int playlistId);
 
     virtual TrackPointer getTrack(const QModelIndex& index) const;
+    // The rows are not library tracks, so they are looked up one by one.
+    virtual QList<TrackPointer> getTracks(const QModelIndexList& indices) const {
+        return TrackModel::getTracks(indices);
+    }
     virtual QString getTrackLocation(const QModelIndex& index) const;
     virtual bool isColumnInternal(int column);
 
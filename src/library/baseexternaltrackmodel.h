@@ -23,6 +23,10 @@ class BaseExternalTrackModel : public BaseSqlTableModel {
 
     virtual TrackModel::CapabilitiesFlags getCapabilities() const;
     TrackPointer getTrack(const QModelIndex& index) const;
+    // The rows are not library tracks, so they are looked up one by one.
+    virtual QList<TrackPointer> getTracks(const QModelIndexList& indices) const {
+        return TrackModel::getTracks(indices);
+    }
     virtual bool isColumnInternal(int column);
     Qt::ItemFlags flags(const QModelIndex &index) const;
 
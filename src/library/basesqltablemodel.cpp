@@ -22,6 +22,12 @@
 
 const bool sDebug = false;
 
+// A search is evaluated in slices of at most this many rows and returns to
+// the event loop after roughly kSearchSliceMillis, so the search box stays
+// responsive on large libraries.
+const int kSearchSliceRows = 2048;
+const int kSearchSliceMillis = 5;
+
 BaseSqlTableModel::BaseSqlTableModel(QObject* pParent,
                                      TrackCollection* pTrackCollection,
                                      const char* settingsNamespace)
@@ -32,10 +38,15 @@ BaseSqlTableModel::BaseSqlTableModel(QObject* pParent,
           m_database(pTrackCollection->getDatabase()),
           m_previewDeckGroup(PlayerManager::groupForPreviewDeck(0)),
           m_iPreviewDeckTrackId(-1),
+          m_bTableRowsValid(false),
+          m_iSearchResultsShown(0),
           m_currentSearch("") {
     m_bInitialized = false;
     m_iSortColumn = 0;
     m_eSortOrder = Qt::AscendingOrder;
+    m_searchTimer.setInterval(0);
+    connect(&m_searchTimer, SIGNAL(timeout()),
+            this, SLOT(slotContinueSearch()));
     connect(&PlayerInfo::instance(), SIGNAL(trackLoaded(QString, TrackPointer)),
             this, SLOT(trackLoaded(QString, TrackPointer)));
     connect(&m_trackDAO, SIGNAL(forceModelUpdate()),
@@ -216,6 +227,10 @@ void BaseSqlTableModel::select() {
         qDebug() << this << "select()";
     }
 
+    // Cancel any running search, its results are replaced below.
+    m_searchTimer.stop();
+    m_search = BaseTrackCache::IncrementalSearch();
+
     QTime time;
     time.start();
 
@@ -287,6 +302,14 @@ void BaseSqlTableModel::select() {
         qDebug() << "Rows actually received:" << rowInfo.size();
     }
 
+    m_tableRows = rowInfo;
+    m_tableTrackIds = trackIds;
+    m_tableRowsForTrack.clear();
+    for (int i = 0; i < m_tableRows.size(); ++i) {
+        m_tableRowsForTrack[m_tableRows[i].trackId].push_back(i);
+    }
+    m_bTableRowsValid = true;
+
     // Adjust sort column to remove table columns and add 1 to add an id column.
     int sortColumn = m_iSortColumn - m_tableColumns.size() + 1;
 
@@ -361,6 +384,10 @@ void BaseSqlTableModel::setTable(const QString& tableName,
     m_tableColumns = tableColumns;
     m_tableColumnsJoined = tableColumns.join(",");
 
+    m_searchTimer.stop();
+    m_search = BaseTrackCache::IncrementalSearch();
+    m_bTableRowsValid = false;
+
     if (m_trackSource) {
         disconnect(m_trackSource.data(), SIGNAL(tracksChanged(QSet<int>)),
                    this, SLOT(tracksChanged(QSet<int>)));
@@ -413,7 +440,97 @@ void BaseSqlTableModel::search(const QString& searchText, const QString& extraFi
         qDebug() << this << "search" << searchText;
     }
     setSearch(searchText, extraFilter);
-    select();
+    if (!startIncrementalSearch()) {
+        select();
+    }
+}
+
+bool BaseSqlTableModel::startIncrementalSearch() {
+    m_searchTimer.stop();
+
+    // Adjust sort column to remove table columns and add 1 to add an id column.
+    const int sortColumn = m_iSortColumn - m_tableColumns.size() + 1;
+
+    // Only the track source knows the order of tracks sorted by a track
+    // column, so only those can be shown as they are found. The extra filter
+    // is SQL and has to be evaluated by the database.
+    if (!m_bInitialized || !m_bTableRowsValid || !m_trackSource ||
+            sortColumn <= 0 || !m_currentSearchFilter.isEmpty()) {
+        return false;
+    }
+
+    if (!m_trackSource->startSearch(&m_search, m_tableTrackIds,
+                                    m_currentSearch, sortColumn,
+                                    m_eSortOrder)) {
+        return false;
+    }
+
+    if (!m_rowInfo.isEmpty()) {
+        beginRemoveRows(QModelIndex(), 0, m_rowInfo.size() - 1);
+        m_rowInfo.clear();
+        m_trackIdToRows.clear();
+        endRemoveRows();
+    }
+    m_iSearchResultsShown = 0;
+
+    // Search the first slice right away so the table is not empty while the
+    // view is repainted.
+    slotContinueSearch();
+    return true;
+}
+
+void BaseSqlTableModel::slotContinueSearch() {
+    QTime time;
+    time.start();
+
+    do {
+        if (!m_trackSource->continueSearch(&m_search, kSearchSliceRows)) {
+            // The track source changed since the search was started.
+            select();
+            return;
+        }
+    } while (!m_search.finished && time.elapsed() < kSearchSliceMillis);
+
+    appendSearchResults();
+
+    if (m_search.finished) {
+        m_searchTimer.stop();
+        if (sDebug) {
+            qDebug() << this << "search finished" << m_rowInfo.size();
+        }
+    } else if (!m_searchTimer.isActive()) {
+        m_searchTimer.start();
+    }
+}
+
+void BaseSqlTableModel::appendSearchResults() {
+    const QVector<int>& trackIds = m_search.matchedTrackIds;
+    if (m_iSearchResultsShown >= trackIds.size()) {
+        return;
+    }
+
+    QVector<RowInfo> rowInfo;
+    for (int i = m_iSearchResultsShown; i < trackIds.size(); ++i) {
+        // A track may be in a table more than once, e.g. in a playlist.
+        foreach (int tableRow, m_tableRowsForTrack.value(trackIds[i])) {
+            RowInfo thisRowInfo = m_tableRows[tableRow];
+            thisRowInfo.order = i;
+            rowInfo.push_back(thisRowInfo);
+        }
+    }
+    m_iSearchResultsShown = trackIds.size();
+
+    if (rowInfo.isEmpty()) {
+        return;
+    }
+
+    const int firstRow = m_rowInfo.size();
+    beginInsertRows(QModelIndex(), firstRow, firstRow + rowInfo.size() - 1);
+    for (int i = 0; i < rowInfo.size(); ++i) {
+        m_trackIdToRows[rowInfo[i].trackId].push_back(firstRow + i);
+    }
+    m_rowInfo += rowInfo;
+    endInsertRows();
 }
 
 void BaseSqlTableModel::setSort(int column, Qt::SortOrder order) {
@@ -738,6 +855,17 @@ TrackPointer BaseSqlTableModel::getTrack(const QModelIndex& index) const {
     return m_trackDAO.getTrack(getTrackId(index));
 }
 
+QList<TrackPointer> BaseSqlTableModel::getTracks(const QModelIndexList& indices) const {
+    QList<int> trackIds;
+    foreach (const QModelIndex& index, indices) {
+        int trackId = getTrackId(index);
+        if (trackId >= 0) {
+            trackIds.append(trackId);
+        }
+    }
+    return m_trackDAO.getTracks(trackIds);
+}
+
 QString BaseSqlTableModel::getTrackLocation(const QModelIndex& index) const {
     if (!index.isValid()) {
         return "";
@@ -3,6 +3,7 @@
 #define BASESQLTABLEMODEL_H
 
 #include <QHash>
+#include <QTimer>
 #include <QtSql>
 
 #include "library/basetrackcache.h"
@@ -35,6 +36,7 @@ class BaseSqlTableModel : public QAbstractTableModel, public TrackModel {
     // functions that can be implemented
     // function to reimplement for external libraries
     virtual TrackPointer getTrack(const QModelIndex& index) const;
+    virtual QList<TrackPointer> getTracks(const QModelIndexList& indices) const;
     // calls readWriteFlags() by default, reimplement this if the child calls
     // should be readOnly
     virtual Qt::ItemFlags flags(const QModelIndex &index) const;
@@ -100,6 +102,7 @@ class BaseSqlTableModel : public QAbstractTableModel, public TrackModel {
     virtual void tracksChanged(QSet<int> trackIds);
     virtual void trackLoaded(QString group, TrackPointer pTrack);
     void refreshCell(int row, int column);
+    void slotContinueSearch();
 
   private:
     // A simple helper function for initializing header title and width.  Note
@@ -113,6 +116,11 @@ class BaseSqlTableModel : public QAbstractTableModel, public TrackModel {
     // called.
     QString orderByClause() const;
     QSqlDatabase database() const;
+    // Starts filtering the rows read by the last select() for the current
+    // search. Returns false if select() has to be used instead.
+    bool startIncrementalSearch();
+    // Adds the tracks found by the running search since the last call.
+    void appendSearchResults();
 
     struct RowInfo {
         int trackId;
@@ -131,6 +139,20 @@ class BaseSqlTableModel : public QAbstractTableModel, public TrackModel {
     };
     QVector<RowInfo> m_rowInfo;
 
+    // All rows of the table in table order as read by the last select(), so
+    // search() can filter them without querying the database again.
+    QVector<RowInfo> m_tableRows;
+    QHash<int, QLinkedList<int> > m_tableRowsForTrack;
+    QSet<int> m_tableTrackIds;
+    bool m_bTableRowsValid;
+
+    // The running or last search of m_trackSource. m_searchTimer continues it
+    // from the event loop until it is finished.
+    BaseTrackCache::IncrementalSearch m_search;
+    // The number of m_search.matchedTrackIds already added to m_rowInfo.
+    int m_iSearchResultsShown;
+    QTimer m_searchTimer;
+
     QString m_tableName;
     QString m_idColumn;
     QSharedPointer<BaseTrackCache> m_trackSource;
@@ -8,6 +8,7 @@
 #include "library/trackcollection.h"
 #include "library/searchqueryparser.h"
 #include "library/queryutil.h"
+#include "util/math.h"
 
 namespace {
 
@@ -28,6 +29,7 @@ BaseTrackCache::BaseTrackCache(TrackCollection* pTrackCollection,
           m_columnCache(columns),
           m_bIndexBuilt(false),
           m_bIsCaching(isCaching),
+          m_trackIndex(m_columnCache, m_columnCount),
           m_trackDAO(pTrackCollection->getTrackDAO()),
           m_database(pTrackCollection->getDatabase()),
           m_pQueryParser(new SearchQueryParser(pTrackCollection->getDatabase())) {
@@ -83,7 +85,7 @@ void BaseTrackCache::slotTracksRemoved(QSet<int> trackIds) {
         qDebug() << this << "slotTracksRemoved" << trackIds.size();
     }
     foreach (int trackId, trackIds) {
-        m_trackInfo.remove(trackId);
+        m_trackIndex.removeTrack(trackId);
     }
 }
 
@@ -112,7 +114,7 @@ void BaseTrackCache::slotTrackClean(int trackId) {
 }
 
 bool BaseTrackCache::isCached(int trackId) const {
-    return m_trackInfo.contains(trackId);
+    return m_trackIndex.rowForTrack(trackId) >= 0;
 }
 
 void BaseTrackCache::ensureCached(int trackId) {
@@ -150,13 +152,15 @@ bool BaseTrackCache::updateIndexWithTrackpointer(TrackPointer pTrack) {
     int id = pTrack->getId();
 
     if (id > 0) {
-        // m_trackInfo[id] will insert a QVector<QVariant> into the
-        // m_trackInfo HashTable with the key "id"
-        QVector<QVariant>& record = m_trackInfo[id];
-        // prealocate memory for all columns at once
-        record.resize(numColumns);
+        // Adds a row with all values NULL if the track is not in the index.
+        const int row = m_trackIndex.insertTrack(id);
         for (int i = 0; i < numColumns; ++i) {
-            getTrackValueForColumn(pTrack, i, record[i]);
+            // Columns the track doesn't know about keep their value.
+            QVariant trackValue;
+            getTrackValueForColumn(pTrack, i, trackValue);
+            if (trackValue.isValid()) {
+                m_trackIndex.setValue(row, i, trackValue);
+            }
         }
     }
     return true;
@@ -187,13 +191,9 @@ bool BaseTrackCache::updateIndexWithQuery(const QString& queryString) {
     while (query.next()) {
         int id = query.value(idColumn).toInt();
 
-        //m_trackInfo[id] will insert a QVector<QVariant> into the
-        //m_trackInfo HashTable with the key "id"
-        QVector<QVariant>& record = m_trackInfo[id];
-        record.resize(numColumns);
-
+        const int row = m_trackIndex.insertTrack(id);
         for (int i = 0; i < numColumns; ++i) {
-            record[i] = query.value(i);
+            m_trackIndex.setValue(row, i, query.value(i));
         }
     }
 
@@ -216,7 +216,7 @@ void BaseTrackCache::buildIndex() {
     // TODO(rryan) for very large tables, it probably makes more sense to NOT
     // clear the table, and keep track of what IDs we see, then delete the ones
     // we don't see.
-    m_trackInfo.clear();
+    m_trackIndex.clear();
 
     if (!updateIndexWithQuery(queryString)) {
         qDebug() << "buildIndex failed!";
@@ -343,11 +343,9 @@ QVariant BaseTrackCache::data(int trackId, int column) const {
     // metadata. Currently the upper-levels will not delegate row-specific
     // columns to this method, but there should still be a check here I think.
     if (!result.isValid()) {
-        QHash<int, QVector<QVariant> >::const_iterator it =
-                m_trackInfo.find(trackId);
-        if (it != m_trackInfo.end()) {
-            const QVector<QVariant>& fields = it.value();
-            result = fields.value(column, result);
+        const int row = m_trackIndex.rowForTrack(trackId);
+        if (row >= 0) {
+            result = m_trackIndex.value(row, column);
         }
     }
     return result;
@@ -367,8 +365,6 @@ void BaseTrackCache::filterAndSort(const QSet<int>& trackIds,
         buildIndex();
     }
 
-    QStringList idStrings;
-
     if (sortColumn < 0 || sortColumn >= columnCount()) {
         qDebug() << "ERROR: Invalid sort column provided to BaseTrackCache::filterAndSort";
         return;
@@ -378,56 +374,28 @@ void BaseTrackCache::filterAndSort(const QSet<int>& trackIds,
     // QVector for output
     QSet<int> dirtyTracks;
     foreach (int trackId, trackIds) {
-        idStrings << QVariant(trackId).toString();
         if (m_dirtyTracks.contains(trackId)) {
             dirtyTracks.insert(trackId);
         }
     }
 
-    QScopedPointer<QueryNode> pQuery(parseQuery(
-        searchQuery, extraFilter, idStrings));
-
-    QString filter = pQuery->toSql();
-    if (!filter.isEmpty()) {
-        filter.prepend("WHERE ");
-    }
-
-    QString orderBy = orderByClause(sortColumn, sortOrder);
-    QString queryString = QString("SELECT %1 FROM %2 %3 %4")
-            .arg(m_idColumn, m_tableName, filter, orderBy);
-
-    if (sDebug) {
-        qDebug() << this << "select() executing:" << queryString;
-    }
-
-    QSqlQuery query(m_database);
-    // This causes a memory savings since QSqlCachedResult (what QtSQLite uses)
-    // won't allocate a giant in-memory table that we won't use at all.
-    query.setForwardOnly(true);
-    query.prepare(queryString);
-
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
-    }
-
-    int idColumn = query.record().indexOf(m_idColumn);
-    int rows = query.size();
-
-    if (sDebug) {
-        qDebug() << "Rows returned:" << rows;
-    }
-
-    m_trackOrder.resize(0);
-    trackToIndex->clear();
-    if (rows > 0) {
-        trackToIndex->reserve(rows);
-        m_trackOrder.reserve(rows);
-    }
-
-    while (query.next()) {
-        int id = query.value(idColumn).toInt();
-        (*trackToIndex)[id] = m_trackOrder.size();
-        m_trackOrder.push_back(id);
+    // Searching and sorting the index is much faster than asking the
+    // database, but the extra filter is an SQL expression and some search
+    // filters can only be evaluated by SQLite.
+    QScopedPointer<QueryNode> pQuery;
+    bool filteredInIndex = false;
+    if (extraFilter.isEmpty()) {
+        pQuery.reset(parseQuery(searchQuery, extraFilter, QStringList()));
+        filteredInIndex = filterAndSortInIndex(trackIds, *pQuery, sortColumn,
+                                               sortOrder, trackToIndex);
+    }
+    if (!filteredInIndex) {
+        QStringList idStrings;
+        foreach (int trackId, trackIds) {
+            idStrings << QVariant(trackId).toString();
+        }
+        pQuery.reset(parseQuery(searchQuery, extraFilter, idStrings));
+        filterAndSortInDatabase(*pQuery, sortColumn, sortOrder, trackToIndex);
     }
 
     // At this point, the original set of tracks have been divided into two
@@ -504,6 +472,214 @@ void BaseTrackCache::filterAndSort(const QSet<int>& trackIds,
     }
 }
 
+bool BaseTrackCache::filterAndSortInIndex(const QSet<int>& trackIds,
+                                          const QueryNode& query,
+                                          int sortColumn,
+                                          Qt::SortOrder sortOrder,
+                                          QHash<int, int>* trackToIndex) {
+    if (!query.canMatchIndex(m_trackIndex)) {
+        return false;
+    }
+
+    QTime timer;
+    timer.start();
+
+    // Tracks that are not in the index are not in the table either, so the
+    // database would not return them.
+    QVector<bool> requested(m_trackIndex.rowCount(), false);
+    foreach (int trackId, trackIds) {
+        const int row = m_trackIndex.rowForTrack(trackId);
+        if (row >= 0) {
+            requested[row] = true;
+        }
+    }
+
+    m_trackIndex.clearSearchCache();
+    const QVector<int>& sortedRows = m_trackIndex.sortedRows(sortColumn);
+    const int rowCount = sortedRows.size();
+
+    m_trackOrder.resize(0);
+    m_trackOrder.reserve(trackIds.size());
+    trackToIndex->clear();
+    trackToIndex->reserve(trackIds.size());
+
+    for (int i = 0; i < rowCount; ++i) {
+        const int row = sortOrder == Qt::AscendingOrder ?
+                sortedRows[i] : sortedRows[rowCount - 1 - i];
+        if (!requested[row] || !query.matchIndex(m_trackIndex, row)) {
+            continue;
+        }
+        const int trackId = m_trackIndex.trackForRow(row);
+        (*trackToIndex)[trackId] = m_trackOrder.size();
+        m_trackOrder.push_back(trackId);
+    }
+
+    if (sDebug) {
+        qDebug() << this << "filterAndSortInIndex took" << timer.elapsed()
+                 << "ms" << m_trackOrder.size();
+    }
+    return true;
+}
+
+bool BaseTrackCache::startSearch(IncrementalSearch* pSearch,
+                                 const QSet<int>& trackIds,
+                                 const QString& searchQuery,
+                                 int sortColumn, Qt::SortOrder sortOrder) {
+    if (!m_bIndexBuilt) {
+        buildIndex();
+    }
+
+    if (sortColumn < 0 || sortColumn >= columnCount()) {
+        return false;
+    }
+
+    QSharedPointer<QueryNode> pQuery(
+            parseQuery(searchQuery, QString(), QStringList()));
+    if (!pQuery->canMatchIndex(m_trackIndex)) {
+        return false;
+    }
+
+    // A query that only adds to the previous one can't match anything the
+    // previous one did not, so only its results need to be searched.
+    const bool refine = pSearch->finished &&
+            pSearch->indexGeneration == m_trackIndex.generation() &&
+            pSearch->sortColumn == sortColumn &&
+            pSearch->sortOrder == sortOrder &&
+            pSearch->trackIds == trackIds &&
+            SearchQueryParser::queryRefines(pSearch->searchQuery, searchQuery);
+
+    if (refine) {
+        pSearch->candidateRows = pSearch->matchedRows;
+        pSearch->requested.clear();
+    } else {
+        const QVector<int>& sortedRows = m_trackIndex.sortedRows(sortColumn);
+        if (sortOrder == Qt::AscendingOrder) {
+            pSearch->candidateRows = sortedRows;
+        } else {
+            const int rowCount = sortedRows.size();
+            pSearch->candidateRows.resize(rowCount);
+            for (int i = 0; i < rowCount; ++i) {
+                pSearch->candidateRows[i] = sortedRows[rowCount - 1 - i];
+            }
+        }
+        // Tracks that are not in the index are not in the table either, so
+        // the database would not return them.
+        pSearch->requested = QVector<bool>(m_trackIndex.rowCount(), false);
+        foreach (int trackId, trackIds) {
+            const int row = m_trackIndex.rowForTrack(trackId);
+            if (row >= 0) {
+                pSearch->requested[row] = true;
+            }
+        }
+    }
+
+    if (sDebug) {
+        qDebug() << this << "startSearch" << searchQuery
+                 << (refine ? "refining" : "searching")
+                 << pSearch->candidateRows.size() << "rows";
+    }
+
+    pSearch->searchQuery = searchQuery;
+    pSearch->sortColumn = sortColumn;
+    pSearch->sortOrder = sortOrder;
+    pSearch->trackIds = trackIds;
+    pSearch->pQuery = pQuery;
+    pSearch->position = 0;
+    pSearch->matchedRows.resize(0);
+    pSearch->matchedTrackIds.resize(0);
+    pSearch->indexGeneration = m_trackIndex.generation();
+    pSearch->finished = false;
+    m_trackIndex.clearSearchCache();
+    return true;
+}
+
+bool BaseTrackCache::continueSearch(IncrementalSearch* pSearch, int maxRows) {
+    if (pSearch->indexGeneration != m_trackIndex.generation()) {
+        return false;
+    }
+
+    const QueryNode& query = *pSearch->pQuery;
+    const bool checkRequested = !pSearch->requested.isEmpty();
+    const int end = math_min(pSearch->candidateRows.size(),
+                             pSearch->position + maxRows);
+    for (; pSearch->position < end; ++pSearch->position) {
+        const int row = pSearch->candidateRows[pSearch->position];
+        if (checkRequested && !pSearch->requested[row]) {
+            continue;
+        }
+        const int trackId = m_trackIndex.trackForRow(row);
+        if (trackId < 0) {
+            continue;
+        }
+
+        bool matches;
+        // The index may be out of date for tracks that are being edited.
+        // Unlike filterAndSort() they keep the position of their old value.
+        TrackPointer pTrack = m_dirtyTracks.contains(trackId) ?
+                lookupCachedTrack(trackId) : TrackPointer();
+        if (pTrack) {
+            matches = pSearch->searchQuery.isEmpty() || query.match(pTrack);
+        } else {
+            matches = query.matchIndex(m_trackIndex, row);
+        }
+        if (matches) {
+            pSearch->matchedRows.push_back(row);
+            pSearch->matchedTrackIds.push_back(trackId);
+        }
+    }
+
+    pSearch->finished = pSearch->position >= pSearch->candidateRows.size();
+    return true;
+}
+
+void BaseTrackCache::filterAndSortInDatabase(const QueryNode& query,
+                                             int sortColumn,
+                                             Qt::SortOrder sortOrder,
+                                             QHash<int, int>* trackToIndex) {
+    QString filter = query.toSql();
+    if (!filter.isEmpty()) {
+        filter.prepend("WHERE ");
+    }
+
+    QString orderBy = orderByClause(sortColumn, sortOrder);
+    QString queryString = QString("SELECT %1 FROM %2 %3 %4")
+            .arg(m_idColumn, m_tableName, filter, orderBy);
+
+    if (sDebug) {
+        qDebug() << this << "select() executing:" << queryString;
+    }
+
+    QSqlQuery sqlQuery(m_database);
+    // This causes a memory savings since QSqlCachedResult (what QtSQLite uses)
+    // won't allocate a giant in-memory table that we won't use at all.
+    sqlQuery.setForwardOnly(true);
+    sqlQuery.prepare(queryString);
+
+    if (!sqlQuery.exec()) {
+        LOG_FAILED_QUERY(sqlQuery);
+    }
+
+    int idColumn = sqlQuery.record().indexOf(m_idColumn);
+    int rows = sqlQuery.size();
+
+    if (sDebug) {
+        qDebug() << "Rows returned:" << rows;
+    }
+
+    m_trackOrder.resize(0);
+    trackToIndex->clear();
+    if (rows > 0) {
+        trackToIndex->reserve(rows);
+        m_trackOrder.reserve(rows);
+    }
+
+    while (sqlQuery.next()) {
+        int id = sqlQuery.value(idColumn).toInt();
+        (*trackToIndex)[id] = m_trackOrder.size();
+        m_trackOrder.push_back(id);
+    }
+}
+
 QueryNode* BaseTrackCache::parseQuery(QString query, QString extraFilter,
                                       QStringList idStrings) const {
     QStringList queryFragments;
@@ -594,7 +770,7 @@ int BaseTrackCache::findSortInsertionPoint(TrackPointer pTrack,
         int otherTrackId = trackIds[mid];
 
         // This should not happen, but it's a recoverable error so we should only log it.
-        if (!m_trackInfo.contains(otherTrackId)) {
+        if (!isCached(otherTrackId)) {
             qDebug() << "WARNING: track" << otherTrackId << "was not in index";
             //updateTrackInIndex(otherTrackId);
         }
@@ -7,6 +7,7 @@
 #include <QList>
 #include <QObject>
 #include <QSet>
+#include <QSharedPointer>
 #include <QHash>
 #include <QString>
 #include <QStringList>
@@ -15,6 +16,7 @@
 
 #include "library/dao/trackdao.h"
 #include "library/columncache.h"
+#include "library/trackindex.h"
 #include "trackinfoobject.h"
 #include "util.h"
 
@@ -31,6 +33,39 @@ class TrackCollection;
 class BaseTrackCache : public QObject {
     Q_OBJECT
   public:
+    // The state of a search that is evaluated a few rows at a time by
+    // continueSearch(), so it can be cancelled and its results shown before
+    // the whole library was searched.
+    struct IncrementalSearch {
+        IncrementalSearch()
+                : sortColumn(-1),
+                  sortOrder(Qt::AscendingOrder),
+                  position(0),
+                  indexGeneration(-1),
+                  finished(false) {
+        }
+
+        QString searchQuery;
+        int sortColumn;
+        Qt::SortOrder sortOrder;
+        QSet<int> trackIds;
+        QSharedPointer<QueryNode> pQuery;
+
+        // The rows of the index to test, in sort order.
+        QVector<int> candidateRows;
+        // Which rows hold one of trackIds. Empty if every candidate row does.
+        QVector<bool> requested;
+        // The number of candidate rows tested so far.
+        int position;
+
+        // The rows and tracks that matched so far, in sort order.
+        QVector<int> matchedRows;
+        QVector<int> matchedTrackIds;
+
+        int indexGeneration;
+        bool finished;
+    };
+
     BaseTrackCache(TrackCollection* pTrackCollection,
                    const QString& tableName,
                    const QString& idColumn,
@@ -54,6 +89,20 @@ class BaseTrackCache : public QObject {
                                QString query, QString extraFilter,
                                int sortColumn, Qt::SortOrder sortOrder,
                                QHash<int, int>* trackToIndex);
+
+    // Starts searching trackIds for searchQuery, sorted like filterAndSort()
+    // does. If pSearch holds a finished search of the same tracks and
+    // searchQuery only narrows its query down, just its results are searched
+    // again. Returns false if the query can't be evaluated incrementally, in
+    // which case filterAndSort() must be used.
+    bool startSearch(IncrementalSearch* pSearch, const QSet<int>& trackIds,
+                     const QString& searchQuery,
+                     int sortColumn, Qt::SortOrder sortOrder);
+    // Tests up to maxRows more rows of pSearch and appends the matches to
+    // pSearch->matchedTrackIds. Returns false if the cache changed since the
+    // search was started, in which case its results are no longer valid.
+    bool continueSearch(IncrementalSearch* pSearch, int maxRows);
+
     virtual bool isCached(int trackId) const;
     virtual void ensureCached(int trackId);
     virtual void ensureCached(QSet<int> trackIds);
@@ -81,6 +130,13 @@ class BaseTrackCache : public QObject {
 
     QueryNode* parseQuery(QString query, QString extraFilter,
                           QStringList idStrings) const;
+    bool filterAndSortInIndex(const QSet<int>& trackIds,
+                              const QueryNode& query,
+                              int sortColumn, Qt::SortOrder sortOrder,
+                              QHash<int, int>* trackToIndex);
+    void filterAndSortInDatabase(const QueryNode& query,
+                                 int sortColumn, Qt::SortOrder sortOrder,
+                                 QHash<int, int>* trackToIndex);
     QString orderByClause(int sortColumn, Qt::SortOrder sortOrder) const;
     int findSortInsertionPoint(TrackPointer pTrack,
                                const int sortColumn,
@@ -114,7 +170,7 @@ class BaseTrackCache : public QObject {
 
     bool m_bIndexBuilt;
     bool m_bIsCaching;
-    QHash<int, QVector<QVariant> > m_trackInfo;
+    TrackIndex m_trackIndex;
     TrackDAO& m_trackDAO;
     QSqlDatabase m_database;
     SearchQueryParser* m_pQueryParser;
@@ -1,6 +1,11 @@
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include <QFutureWatcher>
 #include <QPixmapCache>
 #include <QStringBuilder>
+#include <QThread>
 #include <QtConcurrentRun>
 #include <QtDebug>
 
@@ -12,23 +17,64 @@
 // their full size. If no width is specified, this is the maximum width cap.
 const int kMaxCoverWidth = 300;
 
+// The initial QPixmapCache limit is 10MB. But it is not used just by the
+// coverArt stuff, it is also used by Qt to handle other things behind the
+// scenes. So by default the budget is a bit more than that.
+const int kDefaultCacheLimitKB = 20480;
+
+// The number of covers decoded at the same time. Decoding is mostly disk and
+// TagLib bound, more threads make scrolling stutter without loading faster.
+const int kMaxRunningLoads = 2;
+
+// The number of requests that wait for a loader thread. A table scrolled
+// slowly requests a few rows at a time, so older requests are for rows that
+// are gone.
+const int kMaxPendingRequests = 64;
+
+// The disk space the thumbnails of the table may take. A thumbnail is a few
+// KB, so this holds tens of thousands of covers.
+const int kDefaultThumbnailCacheLimitKB = 100 * 1024;
+
 const bool sDebug = false;
 
-CoverArtCache::CoverArtCache() {
-    // The initial QPixmapCache limit is 10MB.
-    // But it is not used just by the coverArt stuff,
-    // it is also used by Qt to handle other things behind the scenes.
-    // Consequently coverArt cache will always have less than those
-    // 10MB available to store the pixmaps.
-    // So, we must increase this size a bit more,
-    // in order to allow CoverCache handle more covers (performance gain).
-    QPixmapCache::setCacheLimit(20480);
+CoverArtCache::CoverArtCache()
+        : m_iRunningLoads(0) {
+    QPixmapCache::setCacheLimit(kDefaultCacheLimitKB);
 }
 
 CoverArtCache::~CoverArtCache() {
     qDebug() << "~CoverArtCache()";
 }
 
+void CoverArtCache::setConfig(ConfigObject<ConfigValue>* pConfig) {
+    int cacheLimitKB = pConfig->getValueString(
+        ConfigKey("[Library]", "CoverArtCacheLimitKB"),
+        QString::number(kDefaultCacheLimitKB)).toInt();
+    if (cacheLimitKB > 0) {
+        QPixmapCache::setCacheLimit(cacheLimitKB);
+    }
+
+    m_thumbnailDirectory = QString();
+    if (pConfig->getValueString(
+            ConfigKey("[Library]", "CoverArtThumbnailCache"), "1").toInt()) {
+        QDir settingsDir(pConfig->getSettingsPath());
+        if (settingsDir.mkpath("covers")) {
+            m_thumbnailDirectory = settingsDir.filePath("covers");
+            qint64 thumbnailLimitKB = pConfig->getValueString(
+                ConfigKey("[Library]", "CoverArtThumbnailCacheLimitKB"),
+                QString::number(kDefaultThumbnailCacheLimitKB)).toLongLong();
+            if (thumbnailLimitKB > 0) {
+                QtConcurrent::run(&CoverArtCache::pruneThumbnails,
+                                  m_thumbnailDirectory,
+                                  thumbnailLimitKB * 1024);
+            }
+        } else {
+            qWarning() << "CoverArtCache: could not create thumbnail directory in"
+                       << settingsDir.path();
+        }
+    }
+}
+
 QPixmap CoverArtCache::requestCover(const CoverInfo& requestInfo,
                                     const QObject* pRequestor,
                                     int requestReference,
@@ -80,15 +126,116 @@ QPixmap CoverArtCache::requestCover(const CoverInfo& requestInfo,
     }
 
     m_runningRequests.insert(requestId);
-    QFutureWatcher<FutureResult>* watcher = new QFutureWatcher<FutureResult>(this);
-    QFuture<FutureResult> future = QtConcurrent::run(
-            this, &CoverArtCache::loadCover, requestInfo, pRequestor,
-            requestReference, desiredWidth, signalWhenDone);
-    connect(watcher, SIGNAL(finished()), this, SLOT(coverLoaded()));
-    watcher->setFuture(future);
+    Request request;
+    request.info = requestInfo;
+    request.pRequestor = pRequestor;
+    request.requestReference = requestReference;
+    request.desiredWidth = desiredWidth;
+    request.signalWhenDone = signalWhenDone;
+    queueRequest(request);
+    startLoads();
     return QPixmap();
 }
 
+void CoverArtCache::queueRequest(const Request& request) {
+    // Full size covers are for the decks and dialogs, which show one cover
+    // each, so they are loaded first and in order. Thumbnails are for the
+    // table, which paints the rows on screen last, so the newest go first.
+    int firstThumbnail = 0;
+    while (firstThumbnail < m_pendingRequests.size() &&
+            m_pendingRequests[firstThumbnail].desiredWidth == 0) {
+        ++firstThumbnail;
+    }
+    m_pendingRequests.insert(firstThumbnail, request);
+
+    while (m_pendingRequests.size() > kMaxPendingRequests) {
+        Request dropped = m_pendingRequests.takeLast();
+        m_runningRequests.remove(
+            qMakePair(dropped.pRequestor, dropped.requestReference));
+        if (dropped.signalWhenDone) {
+            emit(coverRequestDropped(dropped.pRequestor,
+                                     dropped.requestReference));
+        }
+    }
+}
+
+void CoverArtCache::cancelRequests(const QObject* pRequestor) {
+    QList<Request>::iterator it = m_pendingRequests.begin();
+    while (it != m_pendingRequests.end()) {
+        if (it->pRequestor == pRequestor) {
+            m_runningRequests.remove(
+                qMakePair(it->pRequestor, it->requestReference));
+            it = m_pendingRequests.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void CoverArtCache::startLoads() {
+    while (m_iRunningLoads < kMaxRunningLoads && !m_pendingRequests.isEmpty()) {
+        Request request = m_pendingRequests.takeFirst();
+        ++m_iRunningLoads;
+        QFutureWatcher<FutureResult>* watcher = new QFutureWatcher<FutureResult>(this);
+        QFuture<FutureResult> future = QtConcurrent::run(
+                this, &CoverArtCache::loadCover, request.info,
+                request.pRequestor, request.requestReference,
+                request.desiredWidth, request.signalWhenDone);
+        connect(watcher, SIGNAL(finished()), this, SLOT(coverLoaded()));
+        watcher->setFuture(future);
+    }
+}
+
+QString CoverArtCache::thumbnailFilePath(const CoverInfo& info,
+                                         int desiredWidth) const {
+    if (m_thumbnailDirectory.isEmpty()) {
+        return QString();
+    }
+    // The hash is a checksum of the image, which is only 16 bits. The source
+    // of the image tells covers with the same checksum apart. The covers of
+    // the tracks in a folder share one file.
+    QCryptographicHash source(QCryptographicHash::Sha1);
+    if (info.type == CoverInfo::FILE) {
+        source.addData(QFileInfo(info.trackLocation).path().toUtf8());
+        source.addData("/");
+        source.addData(info.coverLocation.toUtf8());
+    } else {
+        source.addData(info.trackLocation.toUtf8());
+    }
+    return m_thumbnailDirectory % "/" % QString::number(info.hash) % "_" %
+            QString::number(desiredWidth) % "_" %
+            QString::fromLatin1(source.result().toHex()) % ".png";
+}
+
+// static
+void CoverArtCache::pruneThumbnails(const QString& directory, qint64 maxBytes) {
+    QFileInfoList thumbnails = QDir(directory).entryInfoList(
+        QDir::Files, QDir::Time | QDir::Reversed);
+    qint64 totalBytes = 0;
+    foreach (const QFileInfo& thumbnail, thumbnails) {
+        totalBytes += thumbnail.size();
+    }
+    if (totalBytes <= maxBytes) {
+        return;
+    }
+
+    // Delete down to three quarters of the limit, so this does not run again
+    // on every start. A thumbnail that is still used is written again.
+    const qint64 targetBytes = maxBytes / 4 * 3;
+    int deleted = 0;
+    foreach (const QFileInfo& thumbnail, thumbnails) {
+        if (totalBytes <= targetBytes) {
+            break;
+        }
+        if (QFile::remove(thumbnail.filePath())) {
+            totalBytes -= thumbnail.size();
+            ++deleted;
+        }
+    }
+    qDebug() << "CoverArtCache: deleted" << deleted << "old thumbnails from"
+             << directory;
+}
+
 CoverArtCache::FutureResult CoverArtCache::loadCover(
         const CoverInfo& info,
         const QObject* pRequestor,
@@ -106,6 +253,17 @@ CoverArtCache::FutureResult CoverArtCache::loadCover(
     res.cover.info = info;
     res.desiredWidth = desiredWidth;
     res.signalWhenDone = signalWhenDone;
+
+    // A thumbnail saves decoding and scaling the full size image again.
+    QString thumbnailPath = thumbnailFilePath(info, desiredWidth);
+    if (!thumbnailPath.isEmpty()) {
+        QImage thumbnail;
+        if (QFile::exists(thumbnailPath) && thumbnail.load(thumbnailPath, "PNG")) {
+            res.cover.image = thumbnail;
+            return res;
+        }
+    }
+
     res.cover.image = CoverArtUtils::loadCover(res.cover.info);
 
     if (res.cover.image.isNull()) {
@@ -127,6 +285,20 @@ CoverArtCache::FutureResult CoverArtCache::loadCover(
                                                           kMaxCoverWidth);
     }
 
+    if (!thumbnailPath.isEmpty()) {
+        // Write to a file of this thread first, so a thumbnail is never read
+        // while it is written.
+        QString tempPath = thumbnailPath % "." %
+                QString::number(reinterpret_cast<quintptr>(
+                    QThread::currentThreadId())) % ".tmp";
+        if (res.cover.image.save(tempPath, "PNG")) {
+            QFile::remove(thumbnailPath);
+            if (!QFile::rename(tempPath, thumbnailPath)) {
+                QFile::remove(tempPath);
+            }
+        }
+    }
+
     return res;
 }
 
@@ -149,6 +321,11 @@ void CoverArtCache::coverLoaded() {
     }
     m_runningRequests.remove(qMakePair(res.pRequestor, res.requestReference));
 
+    // The future keeps the result alive as long as the watcher.
+    watcher->deleteLater();
+    --m_iRunningLoads;
+    startLoads();
+
     if (res.signalWhenDone) {
         emit(coverFound(res.pRequestor, res.requestReference,
                         res.cover.info, pixmap, false));
@@ -3,7 +3,9 @@
 
 #include <QObject>
 #include <QPixmap>
+#include <QList>
 
+#include "configobject.h"
 #include "library/coverart.h"
 #include "util/singleton.h"
 #include "trackinfoobject.h"
@@ -11,6 +13,10 @@
 class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
     Q_OBJECT
   public:
+    // Reads the memory budget of the pixmap cache and whether to keep
+    // thumbnails on disk from pConfig.
+    void setConfig(ConfigObject<ConfigValue>* pConfig);
+
     /* This method is used to request a cover art pixmap.
      *
      * @param pRequestor : an arbitrary pointer (can be any number you'd like,
@@ -23,6 +29,11 @@ class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
      *      In this way, the method will just look into CoverCache and return
      *      a Pixmap if it is already loaded in the QPixmapCache.
      *
+     * Requests that are not cached wait in a bounded queue for one of a few
+     * loader threads. Full size requests go first, then the most recent
+     * requests for thumbnails. The oldest thumbnail requests are dropped when
+     * the queue is full, which is signalled by coverRequestDropped.
+     *
      * TODO(rryan): Provide a QObject* and a SLOT to invoke directly. Why make
      * everyone filter the signals they receive?
      */
@@ -33,6 +44,11 @@ class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
                          const bool onlyCached = false,
                          const bool signalWhenDone = true);
 
+    // Drops the requests of pRequestor that did not start loading yet, e.g.
+    // because the rows they were made for scrolled out of view. They do not
+    // signal coverFound.
+    void cancelRequests(const QObject* pRequestor);
+
     // Guesses the cover art for the provided tracks by searching the tracks'
     // metadata and folders for image files. All I/O is done in a separate
     // thread.
@@ -60,26 +76,54 @@ class CoverArtCache : public QObject, public Singleton<CoverArtCache> {
   signals:
     void coverFound(const QObject* requestor, int requestReference,
                     const CoverInfo& info, QPixmap pixmap, bool fromCache);
+    // Emitted for a request that was dropped from the full queue. It does not
+    // signal coverFound, so the requestor has to request it again if it is
+    // still needed.
+    void coverRequestDropped(const QObject* requestor, int requestReference);
 
   protected:
     CoverArtCache();
     virtual ~CoverArtCache();
     friend class Singleton<CoverArtCache>;
 
-    // Load cover from path indicated in coverInfo. WARNING: This is run in a
-    // worker thread.
+    // Load cover from path indicated in coverInfo, or its thumbnail from the
+    // thumbnail directory. WARNING: This is run in a worker thread.
     FutureResult loadCover(const CoverInfo& coverInfo,
                            const QObject* pRequestor,
                            const int requestReference,
                            const int desiredWidth,
                            const bool emitSignals);
 
+    // Deletes the oldest thumbnails in directory until the thumbnails take
+    // less than maxBytes. WARNING: This is run in a worker thread.
+    static void pruneThumbnails(const QString& directory, qint64 maxBytes);
+
     // Guesses the cover art for each track.
     void guessCovers(QList<TrackPointer> tracks);
     void guessCover(TrackPointer pTrack);
 
   private:
+    struct Request {
+        CoverInfo info;
+        const QObject* pRequestor;
+        int requestReference;
+        int desiredWidth;
+        bool signalWhenDone;
+    };
+
+    void queueRequest(const Request& request);
+    void startLoads();
+    // Returns the file the cover is kept in at desiredWidth, or a null string
+    // if there is no thumbnail directory.
+    QString thumbnailFilePath(const CoverInfo& info, int desiredWidth) const;
+
+    // The requests that are queued or loading.
     QSet<QPair<const QObject*, int> > m_runningRequests;
+    // The requests waiting for a loader thread, in the order they are loaded.
+    QList<Request> m_pendingRequests;
+    int m_iRunningLoads;
+    // Set before the first request, only read by the loader threads.
+    QString m_thumbnailDirectory;
 };
 
 #endif // COVERARTCACHE_H
@@ -25,6 +25,8 @@ CoverArtDelegate::CoverArtDelegate(QObject *parent)
                                           QPixmap, bool)),
                 this, SLOT(slotCoverFound(const QObject*, int, const CoverInfo&,
                                           QPixmap, bool)));
+        connect(pCache, SIGNAL(coverRequestDropped(const QObject*, int)),
+                this, SLOT(slotCoverRequestDropped(const QObject*, int)));
     }
 
     TrackModel* pTrackModel = NULL;
@@ -58,9 +60,27 @@ CoverArtDelegate::~CoverArtDelegate() {
 void CoverArtDelegate::slotOnlyCachedCoverArt(bool b) {
     m_bOnlyCachedCover = b;
 
-    // If we can request non-cache covers now, request updates for all rows that
-    // were cache misses since the last time.
-    if (!m_bOnlyCachedCover) {
+    // The rows waiting for a cover are scrolling out of view, so the covers
+    // that did not start loading yet are not needed anymore. Rows that stay
+    // visible are cache misses and request their cover again when scrolling
+    // stops.
+    if (m_bOnlyCachedCover) {
+        CoverArtCache* pCache = CoverArtCache::instance();
+        if (pCache) {
+            pCache->cancelRequests(this);
+        }
+        // Covers that are already loading end up in the pixmap cache, the
+        // others are requested again. Either way the rows are updated when
+        // scrolling stops.
+        foreach (const QLinkedList<int>& rows, m_hashToRow) {
+            foreach (int row, rows) {
+                m_cacheMissRows.append(row);
+            }
+        }
+        m_hashToRow.clear();
+    } else {
+        // If we can request non-cache covers now, request updates for all rows
+        // that were cache misses since the last time.
         foreach (int row, m_cacheMissRows) {
             emit(coverReadyForCell(row, m_iCoverColumn));
         }
@@ -83,6 +103,19 @@ void CoverArtDelegate::slotCoverFound(const QObject* pRequestor,
     }
 }
 
+void CoverArtDelegate::slotCoverRequestDropped(const QObject* pRequestor,
+                                               int requestReference) {
+    if (pRequestor != this) {
+        return;
+    }
+    // Updating the rows requests their covers again if they are still visible.
+    // Rows that scrolled out of view are not painted and so not requested.
+    QLinkedList<int> rows = m_hashToRow.take(requestReference);
+    foreach (int row, rows) {
+        emit(coverReadyForCell(row, m_iCoverColumn));
+    }
+}
+
 void CoverArtDelegate::paint(QPainter *painter,
                              const QStyleOptionViewItem &option,
                              const QModelIndex &index) const {
@@ -39,6 +39,8 @@ class CoverArtDelegate : public QStyledItemDelegate {
                         int requestReference,
                         const CoverInfo& info,
                         QPixmap pixmap, bool fromCache);
+    void slotCoverRequestDropped(const QObject* pRequestor,
+                                 int requestReference);
 
   private:
     bool m_bOnlyCachedCover;
@@ -1,3 +1,5 @@
+#include <QFile>
+#include <QSet>
 #include <QSqlQuery>
 #include <QSqlResult>
 #include <QSqlError>
@@ -5,6 +7,7 @@
 #include <QtDebug>
 
 #include "waveform/waveform.h"
+#include "waveform/waveformfactory.h"
 #include "library/dao/analysisdao.h"
 #include "library/queryutil.h"
 
@@ -29,6 +32,7 @@ AnalysisDao::~AnalysisDao() {
 }
 
 void AnalysisDao::initialize() {
+    deleteOrphanedFiles();
 }
 
 void AnalysisDao::setDatabase(QSqlDatabase& database) {
@@ -91,8 +95,13 @@ QList<AnalysisDao::AnalysisInfo> AnalysisDao::loadAnalysesFromQuery(const int tr
         info.description = query->value(descriptionColumn).toString();
         info.version = query->value(versionColumn).toString();
         int checksum = query->value(dataChecksumColumn).toInt();
-        QString dataPath = getAnalysisStoragePath().absoluteFilePath(
-            QString::number(info.analysisId));
+        QString dataPath = getAnalysisDataPath(info.analysisId);
+        info.dataPath = dataPath;
+        if (WaveformFactory::isMappedVersion(info.version)) {
+            // Waveform::mapFile checks the file when it is used.
+            analyses.append(info);
+            continue;
+        }
         QByteArray compressedData = loadDataFromFile(dataPath);
         int file_checksum = qChecksum(compressedData.constData(),
                                       compressedData.length());
@@ -127,6 +136,70 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
     int checksum = qChecksum(compressedData.constData(),
                              compressedData.length());
 
+    if (!saveAnalysisRecord(info, checksum)) {
+        return false;
+    }
+
+    QString dataPath = getAnalysisDataPath(info->analysisId);
+    if (!saveDataToFile(dataPath, compressedData)) {
+        qDebug() << "WARNING: Couldn't save analysis data to file" << dataPath;
+        return false;
+    }
+
+    qDebug() << "AnalysisDAO saved analysis" << info->analysisId
+             << QString("%1 (%2 compressed)").arg(QString::number(info->data.length()),
+                                                  QString::number(compressedData.length()))
+             << "bytes for track"
+             << info->trackId << "in" << time.elapsed() << "ms";
+    return true;
+}
+
+bool AnalysisDao::saveMappedWaveform(AnalysisInfo* info,
+                                     const Waveform& waveform) {
+    if (!m_db.isOpen() || info == NULL) {
+        return false;
+    }
+
+    if (info->trackId == -1) {
+        qDebug() << "Can't save analysis since trackId is invalid.";
+        return false;
+    }
+    QTime time;
+    time.start();
+
+    deleteStaleFiles();
+
+    // The old file may still be mapped by a Waveform, and a mapped file can
+    // not be replaced on Windows. Every save therefore gets a new record and
+    // so a new file, and the old ones are deleted afterwards.
+    const int oldAnalysisId = info->analysisId;
+    info->analysisId = -1;
+
+    // The file is checked by Waveform::mapFile instead of a checksum, since
+    // checksumming it on every load would defeat mapping it.
+    if (!saveAnalysisRecord(info, 0)) {
+        info->analysisId = oldAnalysisId;
+        return false;
+    }
+
+    QString dataPath = getAnalysisDataPath(info->analysisId);
+    if (!saveWaveformToFile(dataPath, waveform)) {
+        qDebug() << "WARNING: Couldn't save waveform to file" << dataPath;
+        deleteAnalysis(info->analysisId);
+        info->analysisId = oldAnalysisId;
+        return false;
+    }
+    if (oldAnalysisId != -1) {
+        deleteAnalysis(oldAnalysisId);
+    }
+
+    qDebug() << "AnalysisDAO saved mapped waveform" << info->analysisId
+             << "with" << waveform.getDataSize() << "samples for track"
+             << info->trackId << "in" << time.elapsed() << "ms";
+    return true;
+}
+
+bool AnalysisDao::saveAnalysisRecord(AnalysisInfo* info, int checksum) {
     QSqlQuery query(m_db);
     if (info->analysisId == -1) {
         query.prepare(QString(
@@ -168,19 +241,6 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
             return false;
         }
     }
-
-    QString dataPath = getAnalysisStoragePath().absoluteFilePath(
-        QString::number(info->analysisId));
-    if (!saveDataToFile(dataPath, compressedData)) {
-        qDebug() << "WARNING: Couldn't save analysis data to file" << dataPath;
-        return false;
-    }
-
-    qDebug() << "AnalysisDAO saved analysis" << info->analysisId
-             << QString("%1 (%2 compressed)").arg(QString::number(info->data.length()),
-                                                  QString::number(compressedData.length()))
-             << "bytes for track"
-             << info->trackId << "in" << time.elapsed() << "ms";
     return true;
 }
 
@@ -198,9 +258,11 @@ bool AnalysisDao::deleteAnalysis(const int analysisId) {
         return false;
     }
 
-    QString dataPath = getAnalysisStoragePath().absoluteFilePath(
-        QString::number(analysisId));
-    deleteFile(dataPath);
+    QString dataPath = getAnalysisDataPath(analysisId);
+    if (!deleteFile(dataPath) && QFile::exists(dataPath)) {
+        // Still mapped by a Waveform on Windows, try again later.
+        m_staleFiles.append(dataPath);
+    }
     return true;
 }
 
@@ -262,6 +324,11 @@ QDir AnalysisDao::getAnalysisStoragePath() const {
     return dir.absolutePath().append("/");
 }
 
+QString AnalysisDao::getAnalysisDataPath(int analysisId) const {
+    return getAnalysisStoragePath().absoluteFilePath(
+        QString::number(analysisId));
+}
+
 QByteArray AnalysisDao::loadDataFromFile(const QString& filename) const {
     QFile file(filename);
     if (!file.exists()) {
@@ -315,6 +382,64 @@ bool AnalysisDao::saveDataToFile(const QString& fileName, const QByteArray& data
     return true;
 }
 
+bool AnalysisDao::saveWaveformToFile(const QString& fileName,
+                                     const Waveform& waveform) const {
+    // fileName belongs to a new analysis record, so no Waveform maps it yet.
+    // Write to a temp file first anyway, so a crash never leaves a truncated
+    // file behind.
+    QString tempFileName = fileName + ".tmp";
+    QFile tempFile(tempFileName);
+    if (!tempFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    if (!waveform.writeFile(&tempFile)) {
+        tempFile.remove();
+        return false;
+    }
+    tempFile.close();
+    QFile file(fileName);
+    if (file.exists() && !file.remove()) {
+        tempFile.remove();
+        return false;
+    }
+    return tempFile.rename(fileName);
+}
+
+void AnalysisDao::deleteStaleFiles() {
+    QMutableListIterator<QString> it(m_staleFiles);
+    while (it.hasNext()) {
+        const QString& fileName = it.next();
+        if (!QFile::exists(fileName) || QFile::remove(fileName)) {
+            it.remove();
+        }
+    }
+}
+
+void AnalysisDao::deleteOrphanedFiles() {
+    QSqlQuery query(m_db);
+    query.prepare(QString("SELECT id FROM %1").arg(s_analysisTableName));
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query) << "couldn't list analyses";
+        return;
+    }
+    QSet<QString> fileNames;
+    while (query.next()) {
+        fileNames.insert(QString::number(query.value(0).toInt()));
+    }
+
+    // Files of deleted analyses that were still mapped when they were
+    // deleted, and temp files of interrupted saves.
+    const QDir storagePath = getAnalysisStoragePath();
+    foreach (const QString& fileName, storagePath.entryList(QDir::Files)) {
+        bool isAnalysisId = false;
+        fileName.toInt(&isAnalysisId);
+        if ((isAnalysisId && !fileNames.contains(fileName)) ||
+                fileName.endsWith(".tmp")) {
+            deleteFile(storagePath.absoluteFilePath(fileName));
+        }
+    }
+}
+
 void AnalysisDao::saveTrackAnalyses(TrackInfoObject* pTrack) {
     if (!pTrack) {
         return;
@@ -337,8 +462,13 @@ void AnalysisDao::saveTrackAnalyses(TrackInfoObject* pTrack) {
     analysis.type = AnalysisDao::TYPE_WAVEFORM;
     analysis.description = pWaveform->getDescription();
     analysis.version = pWaveform->getVersion();
-    analysis.data = pWaveform->toByteArray();
-    bool success = saveAnalysis(&analysis);
+    bool success = false;
+    if (WaveformFactory::isMappedVersion(analysis.version)) {
+        success = saveMappedWaveform(&analysis, *pWaveform);
+    } else {
+        analysis.data = pWaveform->toByteArray();
+        success = saveAnalysis(&analysis);
+    }
     if (success) {
         pWaveform->setDirty(false);
     }
@@ -355,9 +485,13 @@ void AnalysisDao::saveTrackAnalyses(TrackInfoObject* pTrack) {
     analysis.type = AnalysisDao::TYPE_WAVESUMMARY;
     analysis.description = pWaveSummary->getDescription();
     analysis.version = pWaveSummary->getVersion();
-    analysis.data = pWaveSummary->toByteArray();
-
-    success = saveAnalysis(&analysis);
+    analysis.data.clear();
+    if (WaveformFactory::isMappedVersion(analysis.version)) {
+        success = saveMappedWaveform(&analysis, *pWaveSummary);
+    } else {
+        analysis.data = pWaveSummary->toByteArray();
+        success = saveAnalysis(&analysis);
+    }
     if (success) {
         pWaveSummary->setDirty(false);
     }
@@ -3,6 +3,7 @@
 
 #include <QObject>
 #include <QSqlDatabase>
+#include <QStringList>
 
 #include "configobject.h"
 #include "library/dao/dao.h"
@@ -29,7 +30,11 @@ class AnalysisDao : public DAO {
         AnalysisType type;
         QString description;
         QString version;
+        // Empty for analyses of a mapped version (see
+        // WaveformFactory::isMappedVersion), which are used straight from
+        // dataPath instead.
         QByteArray data;
+        QString dataPath;
     };
 
     AnalysisDao(QSqlDatabase& database, ConfigObject<ConfigValue>* pConfig);
@@ -45,6 +50,9 @@ class AnalysisDao : public DAO {
     QList<AnalysisInfo> getAnalysesForTrackByType(const int trackId, AnalysisType type);
     QList<AnalysisInfo> getAnalysesForTrack(const int trackId);
     bool saveAnalysis(AnalysisInfo* analysis);
+    // Saves the analysis record of info and writes waveform uncompressed with
+    // Waveform::writeFile, so that it can be memory-mapped when loaded.
+    bool saveMappedWaveform(AnalysisInfo* info, const Waveform& waveform);
     bool deleteAnalysis(const int analysisId);
     void deleteAnalysises(const QList<int>& ids);
     bool deleteAnalysesForTrack(const int trackId);
@@ -58,13 +66,25 @@ class AnalysisDao : public DAO {
     bool loadWaveform(const TrackInfoObject& tio,
                       Waveform* waveform, AnalysisType type);
     QDir getAnalysisStoragePath() const;
+    // Inserts or updates the database record of info.
+    bool saveAnalysisRecord(AnalysisInfo* info, int checksum);
+    QString getAnalysisDataPath(int analysisId) const;
     QByteArray loadDataFromFile(const QString& fileName) const;
+    bool saveWaveformToFile(const QString& fileName,
+                            const Waveform& waveform) const;
     bool saveDataToFile(const QString& fileName, const QByteArray& data) const;
     bool deleteFile(const QString& filename) const;
+    // Retries deleting the files that were still in use when their analysis
+    // was deleted.
+    void deleteStaleFiles();
+    // Deletes the files in the storage path that have no analysis record.
+    void deleteOrphanedFiles();
     QList<AnalysisInfo> loadAnalysesFromQuery(const int trackId, QSqlQuery* query);
 
     ConfigObject<ConfigValue>* m_pConfig;
     QSqlDatabase m_db;
+    // The files of deleted analyses that could not be deleted yet.
+    QStringList m_staleFiles;
 };
 
 #endif // ANALYSISDAO_H
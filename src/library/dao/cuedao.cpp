@@ -69,36 +69,54 @@ Cue* CueDAO::cueFromRow(const QSqlQuery& query) const {
 
 QList<Cue*> CueDAO::getCuesForTrack(const int trackId) const {
     //qDebug() << "CueDAO::getCuesForTrack" << QThread::currentThread() << m_database.connectionName();
-    QList<Cue*> cues;
-    // A hash from hotcue index to cue id and cue*, used to detect if more
-    // than one cue has been assigned to a single hotcue id.
-    QMap<int, QPair<int, Cue*> > dupe_hotcues;
+    return getCuesForTracks(QList<int>() << trackId).value(trackId);
+}
+
+QHash<int, QList<Cue*> > CueDAO::getCuesForTracks(const QList<int>& trackIds) const {
+    //qDebug() << "CueDAO::getCuesForTracks" << QThread::currentThread() << m_database.connectionName();
+    QHash<int, QList<Cue*> > cues;
+    if (trackIds.isEmpty()) {
+        return cues;
+    }
+
+    QStringList idList;
+    foreach (int id, trackIds) {
+        idList << QString::number(id);
+    }
+
+    // Per track, a hash from hotcue index to cue id and cue*, used to detect
+    // if more than one cue has been assigned to a single hotcue id.
+    QHash<int, QMap<int, QPair<int, Cue*> > > dupe_hotcues;
 
     QSqlQuery query(m_database);
-    query.prepare("SELECT * FROM " CUE_TABLE " WHERE track_id = :id");
-    query.bindValue(":id", trackId);
+    query.prepare(QString("SELECT * FROM " CUE_TABLE " WHERE track_id IN (%1) "
+                          "ORDER BY track_id, id").arg(idList.join(",")));
     if (query.exec()) {
         const int idColumn = query.record().indexOf("id");
+        const int trackIdColumn = query.record().indexOf("track_id");
         const int hotcueIdColumn = query.record().indexOf("hotcue");
         while (query.next()) {
             Cue* cue = NULL;
             int cueId = query.value(idColumn).toInt();
+            int trackId = query.value(trackIdColumn).toInt();
             if (m_cues.contains(cueId)) {
                 cue = m_cues[cueId];
             }
             if (cue == NULL) {
                 cue = cueFromRow(query);
             }
+            QList<Cue*>& trackCues = cues[trackId];
             int hotcueId = query.value(hotcueIdColumn).toInt();
             if (hotcueId != -1) {
-                if (dupe_hotcues.contains(hotcueId)) {
-                    m_cues.remove(dupe_hotcues[hotcueId].first);
-                    cues.removeOne(dupe_hotcues[hotcueId].second);
+                QMap<int, QPair<int, Cue*> >& trackHotcues = dupe_hotcues[trackId];
+                if (trackHotcues.contains(hotcueId)) {
+                    m_cues.remove(trackHotcues[hotcueId].first);
+                    trackCues.removeOne(trackHotcues[hotcueId].second);
                 }
-                dupe_hotcues[hotcueId] = qMakePair(cueId, cue);
+                trackHotcues[hotcueId] = qMakePair(cueId, cue);
             }
             if (cue != NULL) {
-                cues.push_back(cue);
+                trackCues.push_back(cue);
             }
         }
     } else {
@@ -4,6 +4,7 @@
 #ifndef CUEDAO_H
 #define CUEDAO_H
 
+#include <QHash>
 #include <QMap>
 #include <QSqlDatabase>
 
@@ -24,6 +25,8 @@ class CueDAO : public DAO {
     int cueCount();
     int numCuesForTrack(const int trackId);
     QList<Cue*> getCuesForTrack(const int trackId) const;
+    // Same as getCuesForTrack for each of trackIds, with a single query.
+    QHash<int, QList<Cue*> > getCuesForTracks(const QList<int>& trackIds) const;
     bool deleteCuesForTrack(const int trackId);
     bool deleteCuesForTracks(const QList<int>& ids);
     bool saveCue(Cue* cue);
@@ -186,3 +186,14 @@ QStringList LibraryHashDAO::getDeletedDirectories() {
     }
     return result;
 }
+
+bool LibraryHashDAO::hasUnverifiedDirectories() {
+    QSqlQuery query(m_database);
+    query.prepare("SELECT 1 FROM LibraryHashes "
+                  "WHERE needs_verification=1 LIMIT 1");
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return true;
+    }
+    return query.next();
+}
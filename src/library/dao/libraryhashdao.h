@@ -28,6 +28,9 @@ class LibraryHashDAO : public DAO {
     void updateDirectoryStatuses(const QStringList& dirPaths,
                                  const bool deleted, const bool verified);
     QStringList getDeletedDirectories();
+    // Returns whether a scan left directories that were never verified, e.g.
+    // because it was cancelled.
+    bool hasUnverifiedDirectories();
 
   private:
     QSqlDatabase& m_database;
@@ -288,6 +288,29 @@ void TrackDAO::saveTrack(TrackInfoObject* pTrack) {
     }
 }
 
+void TrackDAO::saveTracks(const QList<TrackPointer>& tracks) {
+    // Saving every track in its own transaction is dominated by the commits
+    // (each is an fsync) for large batches, e.g. after a batch analysis.
+    QList<TrackPointer> updatedTracks;
+    ScopedTransaction transaction(m_database);
+    foreach (const TrackPointer& pTrack, tracks) {
+        if (!pTrack || pTrack->getId() == -1 || !pTrack->isDirty()) {
+            continue;
+        }
+        if (updateTrackInTransaction(pTrack.data())) {
+            updatedTracks.append(pTrack);
+        }
+    }
+    if (updatedTracks.isEmpty() || !transaction.commit()) {
+        return;
+    }
+    foreach (const TrackPointer& pTrack, updatedTracks) {
+        pTrack->setDirty(false);
+        // Write audio meta data, if enabled in the preferences
+        writeAudioMetaData(pTrack.data());
+    }
+}
+
 void TrackDAO::slotTrackDirty(TrackInfoObject* pTrack) {
     // Should not be possible.
     DEBUG_ASSERT_AND_HANDLE(pTrack != NULL) {
@@ -533,6 +556,16 @@ void TrackDAO::addTracksFinish(bool rollback) {
     m_tracksAddedSet.clear();
 }
 
+bool TrackDAO::addTracksCommit() {
+    if (!m_pTransaction) {
+        qDebug() << "TrackDAO::addTracksCommit: no transaction in progress";
+        return false;
+    }
+    bool result = m_pTransaction->commit();
+    m_pTransaction->transaction();
+    return result;
+}
+
 bool TrackDAO::addTracksAdd(TrackInfoObject* pTrack, bool unremove) {
 
     if (!m_pQueryLibraryInsert || !m_pQueryTrackLocationInsert ||
@@ -1168,174 +1201,224 @@ struct ColumnPopulator {
     TrackPopulatorFn populator;
 };
 
+const ColumnPopulator kTrackColumns[] = {
+    // Location must be first.
+    { "track_locations.location", NULL },
+    { "artist", setTrackArtist },
+    { "title", setTrackTitle },
+    { "album", setTrackAlbum },
+    { "album_artist", setTrackAlbumArtist },
+    { "year", setTrackYear },
+    { "genre", setTrackGenre },
+    { "composer", setTrackComposer },
+    { "grouping", setTrackGrouping },
+    { "tracknumber", setTrackNumber },
+    { "filetype", setTrackFiletype },
+    { "rating", setTrackRating },
+    { "comment", setTrackComment },
+    { "url", setTrackUrl },
+    { "duration", setTrackDuration },
+    { "bitrate", setTrackBitrate },
+    { "samplerate", setTrackSampleRate },
+    { "cuepoint", setTrackCuePoint },
+    { "replaygain", setTrackReplayGain },
+    { "channels", setTrackChannels },
+    { "timesplayed", setTrackTimesPlayed },
+    { "played", setTrackPlayed },
+    { "datetime_added", setTrackDateAdded },
+    { "header_parsed", setTrackHeaderParsed },
+
+    // Beat detection columns are handled by setTrackBeats. Do not change
+    // the ordering of these columns or put other columns in between them!
+    { "bpm", setTrackBeats },
+    { "beats_version", NULL },
+    { "beats_sub_version", NULL },
+    { "beats", NULL },
+    { "bpm_lock", NULL },
+
+    // Beat detection columns are handled by setTrackKey. Do not change the
+    // ordering of these columns or put other columns in between them!
+    { "key", setTrackKey },
+    { "keys_version", NULL },
+    { "keys_sub_version", NULL },
+    { "keys", NULL },
+
+    // Cover art columns are handled by setTrackCoverInfo. Do not change the
+    // ordering of these columns or put other columns in between them!
+    { "coverart_source", setTrackCoverInfo },
+    { "coverart_type", NULL },
+    { "coverart_location", NULL },
+    { "coverart_hash", NULL }
+};
+
 }  // namespace
 
 #define ARRAYLENGTH(x) (sizeof(x) / sizeof(*x))
 
+void TrackDAO::cacheRecentTrack(const TrackPointer& pTrack) const {
+    // NOTE: Never call QCache::insert() while holding the weak-reference
+    // hash mutex. It may trigger a cache delete and trigger a deadlock.
+    TrackCacheItem* pCacheItem = new TrackCacheItem(pTrack);
+
+    // Queued connection. We are not in a rush to process cache
+    // expirations and it can produce dangerous signal loops.
+    // See: https://bugs.launchpad.net/mixxx/+bug/1365708
+    connect(pCacheItem, SIGNAL(saveTrack(TrackPointer)),
+            this, SLOT(saveTrack(TrackPointer)),
+            Qt::QueuedConnection);
+
+    m_recentTracksCache.insert(pTrack->getId(), pCacheItem);
+}
+
 TrackPointer TrackDAO::getTrackFromDB(const int id) const {
-    ScopedTimer t("TrackDAO::getTrackFromDB");
-    QSqlQuery query(m_database);
+    QHash<int, TrackPointer> tracks;
+    getTracksFromDB(QList<int>() << id, &tracks);
+    return tracks.value(id);
+}
 
-    ColumnPopulator columns[] = {
-        // Location must be first.
-        { "track_locations.location", NULL },
-        { "artist", setTrackArtist },
-        { "title", setTrackTitle },
-        { "album", setTrackAlbum },
-        { "album_artist", setTrackAlbumArtist },
-        { "year", setTrackYear },
-        { "genre", setTrackGenre },
-        { "composer", setTrackComposer },
-        { "grouping", setTrackGrouping },
-        { "tracknumber", setTrackNumber },
-        { "filetype", setTrackFiletype },
-        { "rating", setTrackRating },
-        { "comment", setTrackComment },
-        { "url", setTrackUrl },
-        { "duration", setTrackDuration },
-        { "bitrate", setTrackBitrate },
-        { "samplerate", setTrackSampleRate },
-        { "cuepoint", setTrackCuePoint },
-        { "replaygain", setTrackReplayGain },
-        { "channels", setTrackChannels },
-        { "timesplayed", setTrackTimesPlayed },
-        { "played", setTrackPlayed },
-        { "datetime_added", setTrackDateAdded },
-        { "header_parsed", setTrackHeaderParsed },
-
-        // Beat detection columns are handled by setTrackBeats. Do not change
-        // the ordering of these columns or put other columns in between them!
-        { "bpm", setTrackBeats },
-        { "beats_version", NULL },
-        { "beats_sub_version", NULL },
-        { "beats", NULL },
-        { "bpm_lock", NULL },
-
-        // Beat detection columns are handled by setTrackKey. Do not change the
-        // ordering of these columns or put other columns in between them!
-        { "key", setTrackKey },
-        { "keys_version", NULL },
-        { "keys_sub_version", NULL },
-        { "keys", NULL },
-
-        // Cover art columns are handled by setTrackCoverInfo. Do not change the
-        // ordering of these columns or put other columns in between them!
-        { "coverart_source", setTrackCoverInfo },
-        { "coverart_type", NULL },
-        { "coverart_location", NULL },
-        { "coverart_hash", NULL }
-    };
+void TrackDAO::getTracksFromDB(const QList<int>& ids,
+                               QHash<int, TrackPointer>* pTracks) const {
+    ScopedTimer t("TrackDAO::getTracksFromDB");
+    if (ids.isEmpty()) {
+        return;
+    }
+    QSqlQuery query(m_database);
+    query.setForwardOnly(true);
 
     QString columnsStr;
     int columnsSize = 0;
-    const int columnsCount = ARRAYLENGTH(columns);
+    const int columnsCount = ARRAYLENGTH(kTrackColumns);
     for (int i = 0; i < columnsCount; ++i) {
-        columnsSize += qstrlen(columns[i].name) + 1;
+        columnsSize += qstrlen(kTrackColumns[i].name) + 1;
     }
     columnsStr.reserve(columnsSize);
     for (int i = 0; i < columnsCount; ++i) {
         if (i > 0) {
             columnsStr.append(QChar(','));
         }
-        columnsStr.append(columns[i].name);
+        columnsStr.append(kTrackColumns[i].name);
     }
 
+    QStringList idList;
+    foreach (int id, ids) {
+        idList << QString::number(id);
+    }
+
+    // The id is the last column so the populators see the same column
+    // indices as kTrackColumns.
     query.prepare(QString(
-            "SELECT %1 FROM Library "
+            "SELECT %1,library.id FROM Library "
             "INNER JOIN track_locations ON library.location = track_locations.id "
-            "WHERE library.id = %2").arg(columnsStr, QString::number(id)));
+            "WHERE library.id IN (%2)").arg(columnsStr, idList.join(",")));
 
-    if (!query.exec() || !query.next()) {
+    if (!query.exec()) {
         LOG_FAILED_QUERY(query)
-                << QString("getTrack(%1)").arg(id);
-        return TrackPointer();
+                << QString("getTracks(%1)").arg(idList.join(","));
+        return;
     }
 
-    QSqlRecord queryRecord = query.record();
-    int recordCount = queryRecord.count();
-    DEBUG_ASSERT_AND_HANDLE(recordCount == columnsCount) {
-        recordCount = math_min(recordCount, columnsCount);
-    }
-
-    // Location is the first column.
-    QString location = queryRecord.value(0).toString();
-
-    TrackPointer pTrack = TrackPointer(
-            new TrackInfoObject(location, SecurityTokenPointer(),
-                                false),
-            TrackInfoObject::onTrackReferenceExpired);
-    pTrack->setId(id);
-
-    // TIO already stats the file to see if it exists, what its length is,
-    // etc. So don't bother setting it.
-
-    // For every column run its populator to fill the track in with the data.
-    bool shouldDirty = false;
-    for (int i = 0; i < recordCount; ++i) {
-        TrackPopulatorFn populator = columns[i].populator;
-        if (populator != NULL) {
-            // If any populator says the track should be dirty then we dirty it.
-            shouldDirty = (*populator)(queryRecord, i, pTrack) || shouldDirty;
+    const QHash<int, QList<Cue*> > cues = m_cueDao.getCuesForTracks(ids);
+
+    QList<TrackPointer> tracks;
+    QList<TrackPointer> dirtyTracks;
+    while (query.next()) {
+        QSqlRecord queryRecord = query.record();
+        int recordCount = queryRecord.count() - 1;
+        const int id = queryRecord.value(recordCount).toInt();
+        DEBUG_ASSERT_AND_HANDLE(recordCount == columnsCount) {
+            recordCount = math_min(recordCount, columnsCount);
+        }
+
+        // Location is the first column.
+        QString location = queryRecord.value(0).toString();
+
+        TrackPointer pTrack = TrackPointer(
+                new TrackInfoObject(location, SecurityTokenPointer(),
+                                    false),
+                TrackInfoObject::onTrackReferenceExpired);
+        pTrack->setId(id);
+
+        // TIO already stats the file to see if it exists, what its length is,
+        // etc. So don't bother setting it.
+
+        // For every column run its populator to fill the track in with the data.
+        bool shouldDirty = false;
+        for (int i = 0; i < recordCount; ++i) {
+            TrackPopulatorFn populator = kTrackColumns[i].populator;
+            if (populator != NULL) {
+                // If any populator says the track should be dirty then we dirty it.
+                shouldDirty = (*populator)(queryRecord, i, pTrack) || shouldDirty;
+            }
+        }
+
+        // Populate track cues from the cues table.
+        pTrack->setCuePoints(cues.value(id));
+
+        // Normally we will set the track as clean but sometimes when loading from
+        // the database we need to perform upkeep that ought to be written back to
+        // the database when the track is deleted.
+        pTrack->setDirty(shouldDirty);
+        if (shouldDirty) {
+            dirtyTracks.append(pTrack);
         }
+
+        // Listen to dirty and changed signals
+        connect(pTrack.data(), SIGNAL(dirty(TrackInfoObject*)),
+                this, SLOT(slotTrackDirty(TrackInfoObject*)),
+                Qt::DirectConnection);
+        connect(pTrack.data(), SIGNAL(clean(TrackInfoObject*)),
+                this, SLOT(slotTrackClean(TrackInfoObject*)),
+                Qt::DirectConnection);
+        connect(pTrack.data(), SIGNAL(changed(TrackInfoObject*)),
+                this, SLOT(slotTrackChanged(TrackInfoObject*)),
+                Qt::DirectConnection);
+        // Queued connection. We are not in a rush to process reference
+        // count expirations and it can produce dangerous signal loops.
+        // See: https://bugs.launchpad.net/mixxx/+bug/1365708
+        connect(pTrack.data(), SIGNAL(referenceExpired(TrackInfoObject*)),
+                this, SLOT(slotTrackReferenceExpired(TrackInfoObject*)),
+                Qt::QueuedConnection);
+
+        tracks.append(pTrack);
+        pTracks->insert(id, pTrack);
     }
 
-    // Populate track cues from the cues table.
-    pTrack->setCuePoints(m_cueDao.getCuesForTrack(id));
-
-    // Normally we will set the track as clean but sometimes when loading from
-    // the database we need to perform upkeep that ought to be written back to
-    // the database when the track is deleted.
-    pTrack->setDirty(shouldDirty);
-
-    // Listen to dirty and changed signals
-    connect(pTrack.data(), SIGNAL(dirty(TrackInfoObject*)),
-            this, SLOT(slotTrackDirty(TrackInfoObject*)),
-            Qt::DirectConnection);
-    connect(pTrack.data(), SIGNAL(clean(TrackInfoObject*)),
-            this, SLOT(slotTrackClean(TrackInfoObject*)),
-            Qt::DirectConnection);
-    connect(pTrack.data(), SIGNAL(changed(TrackInfoObject*)),
-            this, SLOT(slotTrackChanged(TrackInfoObject*)),
-            Qt::DirectConnection);
-    // Queued connection. We are not in a rush to process reference
-    // count expirations and it can produce dangerous signal loops.
-    // See: https://bugs.launchpad.net/mixxx/+bug/1365708
-    connect(pTrack.data(), SIGNAL(referenceExpired(TrackInfoObject*)),
-            this, SLOT(slotTrackReferenceExpired(TrackInfoObject*)),
-            Qt::QueuedConnection);
+    if (tracks.size() < ids.size()) {
+        qWarning() << "TrackDAO::getTracksFromDB:"
+                   << ids.size() - tracks.size() << "of" << ids.size()
+                   << "tracks are not in the library";
+    }
 
     m_sTracksMutex.lock();
-    // Automatic conversion to a weak pointer
-    m_sTracks[id] = pTrack;
+    foreach (const TrackPointer& pTrack, tracks) {
+        // Automatic conversion to a weak pointer
+        m_sTracks[pTrack->getId()] = pTrack;
+    }
     qDebug() << "m_sTracks.count() =" << m_sTracks.count();
     m_sTracksMutex.unlock();
-    TrackCacheItem* pCacheItem = new TrackCacheItem(pTrack);
-
-    // Queued connection. We are not in a rush to process cache
-    // expirations and it can produce dangerous signal loops.
-    // See: https://bugs.launchpad.net/mixxx/+bug/1365708
-    connect(pCacheItem, SIGNAL(saveTrack(TrackPointer)),
-            this, SLOT(saveTrack(TrackPointer)),
-            Qt::QueuedConnection);
 
-    m_recentTracksCache.insert(id, pCacheItem);
+    // Tracks before the last kRecentTracksCacheSize would be evicted by the
+    // ones after them right away.
+    for (int i = math_max(0, tracks.size() - kRecentTracksCacheSize);
+         i < tracks.size(); ++i) {
+        cacheRecentTrack(tracks[i]);
+    }
 
-    // If the track is dirty send dirty notifications after we inserted
-    // it in the cache. BaseTrackCache cares about dirty notifications
-    // and the setDirty call above happens before we connect to the
-    // track's signals.
-    if (shouldDirty) {
-        emit(trackDirty(id));
+    // If a track is dirty send dirty notifications after we inserted it in
+    // the cache. BaseTrackCache cares about dirty notifications and the
+    // setDirty call above happens before we connect to the track's signals.
+    foreach (const TrackPointer& pTrack, dirtyTracks) {
+        emit(trackDirty(pTrack->getId()));
     }
 
     // If the header hasn't been parsed, parse it but only after we set the
     // track clean and hooked it up to the track cache, because this will
     // dirty it.
-    if (!pTrack->getHeaderParsed()) {
-         pTrack->parse(false);
+    foreach (const TrackPointer& pTrack, tracks) {
+        if (!pTrack->getHeaderParsed()) {
+            pTrack->parse(false);
+        }
     }
-
-    return pTrack;
 }
 
 TrackPointer TrackDAO::getTrack(const int id, const bool cacheOnly) const {
@@ -1374,18 +1457,7 @@ TrackPointer TrackDAO::getTrack(const int id, const bool cacheOnly) const {
     // re-insert it into the recent tracks cache so that its least-recently-used
     // tracking is accurate.
     if (pTrack) {
-        // NOTE: Never call QCache::insert() while holding the weak-reference
-        // hash mutex. It may trigger a cache delete and trigger a deadlock.
-        TrackCacheItem* pCacheItem = new TrackCacheItem(pTrack);
-
-        // Queued connection. We are not in a rush to process cache
-        // expirations and it can produce dangerous signal loops.
-        // See: https://bugs.launchpad.net/mixxx/+bug/1365708
-        connect(pCacheItem, SIGNAL(saveTrack(TrackPointer)),
-                this, SLOT(saveTrack(TrackPointer)),
-                Qt::QueuedConnection);
-
-        m_recentTracksCache.insert(id, pCacheItem);
+        cacheRecentTrack(pTrack);
         return pTrack;
     } else if (cacheOnly) {
         // The caller only wanted the track if it was cached.
@@ -1397,6 +1469,64 @@ TrackPointer TrackDAO::getTrack(const int id, const bool cacheOnly) const {
     return getTrackFromDB(id);
 }
 
+QList<TrackPointer> TrackDAO::getTracks(const QList<int>& ids) const {
+    //qDebug() << "TrackDAO::getTracks" << ids.size() << QThread::currentThread() << m_database.connectionName();
+    QHash<int, TrackPointer> tracks;
+
+    // Same lookup order as getTrack: recent tracks cache, the weak-reference
+    // cache and then the database. But the weak-reference cache is locked
+    // once for all tracks and the database is queried once for all tracks.
+    foreach (int id, ids) {
+        TrackCacheItem* pTrackCacheItem = m_recentTracksCache.object(id);
+        if (pTrackCacheItem != NULL) {
+            TrackPointer pTrack = pTrackCacheItem->getTrack();
+            DEBUG_ASSERT(pTrack);
+            if (pTrack) {
+                tracks.insert(id, pTrack);
+            }
+        }
+    }
+
+    QList<TrackPointer> referencedTracks;
+    QSet<int> missingIds;
+    QMutexLocker locker(&m_sTracksMutex);
+    foreach (int id, ids) {
+        if (tracks.contains(id)) {
+            continue;
+        }
+        TrackPointer pTrack;
+        QHash<int, TrackWeakPointer>::iterator it = m_sTracks.find(id);
+        if (it != m_sTracks.end()) {
+            pTrack = it.value();
+        }
+        if (pTrack) {
+            tracks.insert(id, pTrack);
+            referencedTracks.append(pTrack);
+        } else {
+            missingIds.insert(id);
+        }
+    }
+
+    // Unlock the track cache mutex. Otherwise we can deadlock.
+    locker.unlock();
+
+    for (int i = math_max(0, referencedTracks.size() - kRecentTracksCacheSize);
+         i < referencedTracks.size(); ++i) {
+        cacheRecentTrack(referencedTracks[i]);
+    }
+
+    getTracksFromDB(missingIds.toList(), &tracks);
+
+    QList<TrackPointer> result;
+    foreach (int id, ids) {
+        TrackPointer pTrack = tracks.value(id);
+        if (pTrack) {
+            result.append(pTrack);
+        }
+    }
+    return result;
+}
+
 // Saves a track's info back to the database
 void TrackDAO::updateTrack(TrackInfoObject* pTrack) {
     DEBUG_ASSERT_AND_HANDLE(pTrack) {
@@ -1404,6 +1534,19 @@ void TrackDAO::updateTrack(TrackInfoObject* pTrack) {
     }
 
     ScopedTransaction transaction(m_database);
+    if (updateTrackInTransaction(pTrack)) {
+        transaction.commit();
+        pTrack->setDirty(false);
+    }
+}
+
+// Writes a track's info back to the database. The caller is responsible for
+// the transaction and for marking the track clean once it is committed.
+bool TrackDAO::updateTrackInTransaction(TrackInfoObject* pTrack) {
+    DEBUG_ASSERT_AND_HANDLE(pTrack) {
+        return false;
+    }
+
     // QTime time;
     // time.start();
     //qDebug() << "TrackDAO::updateTrackInDatabase" << QThread::currentThread() << m_database.connectionName();
@@ -1412,7 +1555,7 @@ void TrackDAO::updateTrack(TrackInfoObject* pTrack) {
 
     int trackId = pTrack->getId();
     DEBUG_ASSERT_AND_HANDLE(trackId >= 0) {
-        return;
+        return false;
     }
 
     QSqlQuery query(m_database);
@@ -1514,24 +1657,21 @@ void TrackDAO::updateTrack(TrackInfoObject* pTrack) {
 
     if (!query.exec()) {
         LOG_FAILED_QUERY(query);
-        return;
+        return false;
     }
 
     if (query.numRowsAffected() == 0) {
         qWarning() << "updateTrack had no effect: trackId" << trackId << "invalid";
-        return;
+        return false;
     }
 
     //qDebug() << "Update track took : " << time.elapsed() << "ms. Now updating cues";
     //time.start();
     m_analysisDao.saveTrackAnalyses(pTrack);
     m_cueDao.saveTrackCues(trackId, pTrack);
-    transaction.commit();
 
     //qDebug() << "Update track in database took: " << time.elapsed() << "ms";
-    //time.start();
-    pTrack->setDirty(false);
-    //qDebug() << "Dirtying track took: " << time.elapsed() << "ms";
+    return true;
 }
 
 // Mark all the tracks in the library as invalid.
@@ -1549,6 +1689,24 @@ void TrackDAO::invalidateTrackLocationsInLibrary() {
     }
 }
 
+void TrackDAO::invalidateTrackLocationsInDirectories(const QStringList& directories) {
+    //qDebug() << "TrackDAO::invalidateTrackLocationsInDirectories" << QThread::currentThread() << m_database.connectionName();
+
+    FieldEscaper escaper(m_database);
+    QStringList escapedDirectories = escaper.escapeStrings(directories);
+
+    QSqlQuery query(m_database);
+    query.prepare(
+        QString("UPDATE track_locations "
+                "SET needs_verification=1 "
+                "WHERE directory IN (%1)").arg(escapedDirectories.join(",")));
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query)
+                << "Couldn't mark tracks in" << directories.size()
+                << "directories as needing verification.";
+    }
+}
+
 void TrackDAO::markTrackLocationsAsVerified(const QStringList& locations) {
     //qDebug() << "TrackDAO::markTrackLocationsAsVerified" << QThread::currentThread() << m_database.connectionName();
 
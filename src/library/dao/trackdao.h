@@ -121,6 +121,9 @@ class TrackDAO : public QObject, public virtual DAO {
     int addTrack(const QFileInfo& fileInfo, bool unremove);
     void addTracksPrepare();
     bool addTracksAdd(TrackInfoObject* pTrack, bool unremove);
+    // Commits the tracks added since addTracksPrepare or the last call and
+    // starts a new transaction. The prepared queries stay valid.
+    bool addTracksCommit();
     void addTracksFinish(bool rollback=false);
     QList<int> addTracks(const QList<QFileInfo>& fileInfoList, bool unremove);
     void hideTracks(const QList<int>& ids);
@@ -130,6 +133,11 @@ class TrackDAO : public QObject, public virtual DAO {
 
     // WARNING: Only call this from the main thread instance of TrackDAO.
     TrackPointer getTrack(const int id, const bool cacheOnly=false) const;
+    // Same as getTrack for each of ids but reads all the tracks that are not
+    // cached with a single query. Returns the tracks in the order of ids,
+    // leaving out those that are not in the library.
+    // WARNING: Only call this from the main thread instance of TrackDAO.
+    QList<TrackPointer> getTracks(const QList<int>& ids) const;
 
     // Fetches trackLocation from the database or adds it. If searchForCoverArt
     // is true, searches the track and its directory for cover art via
@@ -148,6 +156,7 @@ class TrackDAO : public QObject, public virtual DAO {
     void markTrackLocationsAsVerified(const QStringList& locations);
     void markTracksInDirectoriesAsVerified(const QStringList& directories);
     void invalidateTrackLocationsInLibrary();
+    void invalidateTrackLocationsInDirectories(const QStringList& directories);
     void markUnverifiedTracksAsDeleted();
     void markTrackLocationsAsDeleted(const QString& directory);
     void detectMovedFiles(QSet<int>* tracksMovedSetNew, QSet<int>* tracksMovedSetOld);
@@ -172,6 +181,8 @@ class TrackDAO : public QObject, public virtual DAO {
     // on it. However, private parts of TrackDAO can use the raw saveTrack(TIO*)
     // call.
     void saveTrack(TrackPointer pTrack);
+    // Saves all dirty tracks of the list in a single transaction.
+    void saveTracks(const QList<TrackPointer>& tracks);
 
     // Clears the cached TrackInfoObjects, which can be useful when the
     // underlying database tables change (eg. during a library rescan,
@@ -193,8 +204,14 @@ class TrackDAO : public QObject, public virtual DAO {
     bool isTrackFormatSupported(TrackInfoObject* pTrack) const;
     void saveTrack(TrackInfoObject* pTrack);
     void updateTrack(TrackInfoObject* pTrack);
+    bool updateTrackInTransaction(TrackInfoObject* pTrack);
     void addTrack(TrackInfoObject* pTrack, bool unremove);
     TrackPointer getTrackFromDB(const int id) const;
+    // Reads the tracks with ids from the database into pTracks.
+    void getTracksFromDB(const QList<int>& ids,
+                         QHash<int, TrackPointer>* pTracks) const;
+    // Keeps a strong reference to pTrack in the recent tracks cache.
+    void cacheRecentTrack(const TrackPointer& pTrack) const;
     QString absoluteFilePath(QString location);
 
     void bindTrackToTrackLocationsInsert(TrackInfoObject* pTrack);
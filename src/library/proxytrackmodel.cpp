@@ -37,6 +37,14 @@ TrackPointer ProxyTrackModel::getTrack(const QModelIndex& index) const {
     return m_pTrackModel ? m_pTrackModel->getTrack(indexSource) : TrackPointer();
 }
 
+QList<TrackPointer> ProxyTrackModel::getTracks(const QModelIndexList& indices) const {
+    QModelIndexList indicesSource;
+    foreach (const QModelIndex& index, indices) {
+        indicesSource.append(mapToSource(index));
+    }
+    return m_pTrackModel ? m_pTrackModel->getTracks(indicesSource) : QList<TrackPointer>();
+}
+
 QString ProxyTrackModel::getTrackLocation(const QModelIndex& index) const {
     QModelIndex indexSource = mapToSource(index);
     return m_pTrackModel ? m_pTrackModel->getTrackLocation(indexSource) : QString();
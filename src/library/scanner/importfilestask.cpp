@@ -1,22 +1,28 @@
 #include "library/scanner/importfilestask.h"
 
 #include "library/scanner/libraryscanner.h"
-#include "library/coverartutils.h"
 #include "util/timer.h"
 
+namespace {
+
+// The number of tracks handed to the library scanner at once.
+const int kTrackBatchSize = 64;
+
+}  // namespace
+
 ImportFilesTask::ImportFilesTask(LibraryScanner* pScanner,
                                  const ScannerGlobalPointer scannerGlobal,
                                  const QLinkedList<QFileInfo>& filesToImport,
-                                 const QLinkedList<QFileInfo>& possibleCovers,
                                  SecurityTokenPointer pToken)
         : ScannerTask(pScanner, scannerGlobal),
           m_filesToImport(filesToImport),
-          m_possibleCovers(possibleCovers),
           m_pToken(pToken) {
 }
 
 void ImportFilesTask::run() {
     ScopedTimer timer("ImportFilesTask::run");
+    QStringList existingTracks;
+    QList<TrackPointer> newTracks;
     foreach (const QFileInfo& file, m_filesToImport) {
         // If a flag was raised telling us to cancel the library scan then stop.
         if (m_scannerGlobal->shouldCancel()) {
@@ -35,28 +41,23 @@ void ImportFilesTask::run() {
             // If the track is in the database, mark it as existing. This code gets
             // executed when other files in the same directory have changed (the
             // directory hash has changed).
-            emit(trackExists(filePath));
+            existingTracks.append(filePath);
         } else {
-            // Parse the track including cover art from metadata. This is a new
-            // (never before seen) track so it is safe to parse cover art
-            // without checking if we have cover art that is USER_SELECTED. If
-            // this changes in the future you MUST check that the cover art is
-            // not USER_SELECTED first.
-            TrackPointer pTrack = TrackPointer(
-                new TrackInfoObject(filePath, m_pToken, true, true));
-
-            // If cover art is not found in the track metadata, populate from
-            // possibleCovers.
-            if (pTrack->getCoverArt().image.isNull()) {
-                CoverArt art = CoverArtUtils::selectCoverArtForTrack(
-                    pTrack.data(), m_possibleCovers);
-                if (!art.image.isNull()) {
-                    pTrack->setCoverArt(art);
-                }
+            // Parse the track's tags but not its cover art. The cover source
+            // stays UNKNOWN, so the cover is found at the end of the scan.
+            newTracks.append(TrackPointer(
+                new TrackInfoObject(filePath, m_pToken, true, false)));
+            if (newTracks.size() >= kTrackBatchSize) {
+                emit(addNewTracks(newTracks));
+                newTracks.clear();
             }
-
-            emit(addNewTrack(pTrack));
         }
     }
+    if (!existingTracks.isEmpty()) {
+        emit(tracksExist(existingTracks));
+    }
+    if (!newTracks.isEmpty()) {
+        emit(addNewTracks(newTracks));
+    }
     setSuccess(true);
 }
@@ -10,13 +10,16 @@
 
 // Import the provided files. Successful if the scan completed without being
 // cancelled. False if the scan was cancelled part-way through.
+//
+// Only the tags of new files are parsed. Their cover art is looked up after
+// the scan by TrackDAO::detectCoverArtForUnknownTracks, so decoding images
+// does not hold up the import.
 class ImportFilesTask : public ScannerTask {
     Q_OBJECT
   public:
     ImportFilesTask(LibraryScanner* pScanner,
                     const ScannerGlobalPointer scannerGlobal,
                     const QLinkedList<QFileInfo>& filesToImport,
-                    const QLinkedList<QFileInfo>& possibleCovers,
                     SecurityTokenPointer pToken);
     virtual ~ImportFilesTask() {}
 
@@ -24,7 +27,6 @@ class ImportFilesTask : public ScannerTask {
 
   private:
     const QLinkedList<QFileInfo> m_filesToImport;
-    const QLinkedList<QFileInfo> m_possibleCovers;
     SecurityTokenPointer m_pToken;
 };
 
@@ -16,12 +16,14 @@
 ***************************************************************************/
 
 #include <QtDebug>
+#include <QFileSystemWatcher>
 
 #include "library/scanner/libraryscanner.h"
 
 #include "soundsourceproxy.h"
 #include "library/legacylibraryimporter.h"
 #include "library/scanner/recursivescandirectorytask.h"
+#include "library/scanner/importfilestask.h"
 #include "library/scanner/libraryscannerdlg.h"
 #include "library/queryutil.h"
 #include "library/coverartutils.h"
@@ -29,13 +31,26 @@
 #include "util/trace.h"
 #include "util/file.h"
 #include "util/timer.h"
+#include "util/math.h"
+#include "util/stat.h"
 #include "library/scanner/scannerutil.h"
 
-// TODO(rryan) make configurable
-const int kScannerThreadPoolSize = 1;
+// Parsing tags reads the header of every new file, which is slow on network
+// mounts. More threads than this mostly queue up on the same disk.
+const int kMaxImportThreads = 4;
+
+// The number of new tracks the scanner thread writes per transaction. Large
+// transactions keep SQLite from syncing after every insert, committing now and
+// then keeps the other connections from waiting for the whole scan.
+const int kTracksPerTransaction = 2000;
+
+// How long no watched directory must change before the changed directories
+// are rescanned. Copying an album changes its directory many times.
+const int kWatchRescanDelayMillis = 2000;
 
 LibraryScanner::LibraryScanner(QWidget* pParentWidget, TrackCollection* collection)
               : m_pCollection(collection),
+                m_tracksInTransaction(0),
                 m_libraryHashDao(m_database),
                 m_cueDao(m_database),
                 m_playlistDao(m_database),
@@ -44,7 +59,8 @@ LibraryScanner::LibraryScanner(QWidget* pParentWidget, TrackCollection* collecti
                 m_analysisDao(m_database, collection->getConfig()),
                 m_trackDao(m_database, m_cueDao, m_playlistDao,
                            m_crateDao, m_analysisDao, m_libraryHashDao,
-                           collection->getConfig()) {
+                           collection->getConfig()),
+                m_pWatcher(NULL) {
     // Don't initialize m_database here, we need to do it in run() so the DB
     // conn is in the right thread.
     qDebug() << "Starting LibraryScanner thread.";
@@ -53,17 +69,29 @@ LibraryScanner::LibraryScanner(QWidget* pParentWidget, TrackCollection* collecti
     // queue to our event loop.
     moveToThread(this);
     m_pool.moveToThread(this);
+    m_importPool.moveToThread(this);
+    m_watchTimer.moveToThread(this);
 
     unsigned static id = 0; // the id of this LibraryScanner, for debugging purposes
     setObjectName(QString("LibraryScanner %1").arg(++id));
 
-    m_pool.setMaxThreadCount(kScannerThreadPoolSize);
+    // Hashing a directory is mostly waiting on the file system to list it.
+    m_pool.setMaxThreadCount(math_max(1, QThread::idealThreadCount()));
+    m_importPool.setMaxThreadCount(
+        math_clamp(QThread::idealThreadCount(), 1, kMaxImportThreads));
+
+    qRegisterMetaType<QList<TrackPointer> >("QList<TrackPointer>");
 
     // Listen to signals from our public methods (invoked by other threads) and
     // connect them to our slots to run the command on the scanner thread.
     connect(this, SIGNAL(startScan()),
             this, SLOT(slotStartScan()));
 
+    m_watchTimer.setSingleShot(true);
+    m_watchTimer.setInterval(kWatchRescanDelayMillis);
+    connect(&m_watchTimer, SIGNAL(timeout()),
+            this, SLOT(slotStartIncrementalScan()));
+
     // Force the GUI thread's TrackInfoObject cache to be cleared when a library
     // scan is finished, because we might have modified the database directly
     // when we detected moved files, and the TIOs corresponding to the moved
@@ -104,10 +132,11 @@ LibraryScanner::~LibraryScanner() {
         cancel();
     }
 
-    // Wait for the thread pool to empty. This is important because ScannerTasks
-    // have pointers to the LibraryScanner and can cause a segfault if they run
-    // after the LibraryScanner has been destroyed.
+    // Wait for the thread pools to empty. This is important because
+    // ScannerTasks have pointers to the LibraryScanner and can cause a segfault
+    // if they run after the LibraryScanner has been destroyed.
     m_pool.waitForDone();
+    m_importPool.waitForDone();
 
     // Quit the event loop gracefully.
     quit();
@@ -161,14 +190,27 @@ void LibraryScanner::run() {
     m_analysisDao.initialize();
     m_directoryDao.initialize();
 
+#ifdef __LINUX__
+    // Watch mode is only available with inotify. The other backends of
+    // QFileSystemWatcher keep a file descriptor or handle open per directory,
+    // which a large library quickly runs out of.
+    m_pWatcher = new QFileSystemWatcher();
+    connect(m_pWatcher, SIGNAL(directoryChanged(QString)),
+            this, SLOT(slotDirectoryChanged(QString)));
+    updateWatchedDirectories();
+#endif
+
     // Start the event loop.
     qDebug() << "LibraryScanner event loop starting.";
     exec();
     qDebug() << "LibraryScanner event loop stopped.";
+
+    m_watchTimer.stop();
+    delete m_pWatcher;
+    m_pWatcher = NULL;
 }
 
-void LibraryScanner::slotStartScan() {
-    qDebug() << "LibraryScanner::slotStartScan";
+void LibraryScanner::createScannerGlobal(bool incremental) {
     QSet<QString> trackLocations = m_trackDao.getTrackLocations();
     QHash<QString, int> directoryHashes = m_libraryHashDao.getDirectoryHashes();
     QRegExp extensionFilter =
@@ -181,8 +223,17 @@ void LibraryScanner::slotStartScan() {
 
     m_scannerGlobal = ScannerGlobalPointer(
         new ScannerGlobal(trackLocations, directoryHashes, extensionFilter,
-                          coverExtensionFilter, directoryBlacklist));
+                          coverExtensionFilter, directoryBlacklist,
+                          incremental));
     m_scannerGlobal->startTimer();
+}
+
+void LibraryScanner::slotStartScan() {
+    qDebug() << "LibraryScanner::slotStartScan";
+    createScannerGlobal(false);
+
+    // Changes found while scanning are rescanned when the scan is finished.
+    m_watchTimer.stop();
 
     emit(scanStarted());
 
@@ -222,10 +273,13 @@ void LibraryScanner::slotStartScan() {
     // Start scanning the library. This prepares insertion queries in TrackDAO
     // (must be called before calling addTracksAdd) and begins a transaction.
     m_trackDao.addTracksPrepare();
+    m_tracksInTransaction = 0;
 
     // Recursivly scan each directory in the directories table.
-    QStringList dirs = m_directoryDao.getDirs();
+    queueDirectoryScans(m_directoryDao.getDirs());
+}
 
+void LibraryScanner::queueDirectoryScans(const QStringList& dirs) {
     // If there are no directories then we have nothing to do. Cleanup and
     // finish the scan immediately.
     if (dirs.isEmpty()) {
@@ -266,6 +320,16 @@ void LibraryScanner::slotFinishScan() {
         qDebug() << "Recursive scanning interrupted by the user.";
     }
 
+    // The hashes go into the same transaction as the last tracks, so a
+    // directory is never marked as unchanged before all of its tracks are
+    // committed. The hashes of a scan that did not finish are dropped, which
+    // makes the next scan look at those directories again.
+    if (bScanFinishedCleanly) {
+        saveDirectoryHashes();
+    }
+    m_newDirectoryHashes.clear();
+    m_changedDirectoryHashes.clear();
+
     // Finish adding the tracks -- rollback the transaction if the scan did not
     // finish cleanly and the user did not cancel the transaction.
     m_trackDao.addTracksFinish(!m_scannerGlobal->shouldCancel() &&
@@ -336,19 +400,136 @@ void LibraryScanner::slotFinishScan() {
     }
 
     // TODO(XXX) doesn't take into account verifyRemainingTracks.
+    qint64 elapsed = m_scannerGlobal->timerElapsed();
+    int filesImported = verifiedTracks.size() + m_scannerGlobal->numAddedTracks();
+    double filesPerSecond = elapsed > 0 ? filesImported * 1e9 / elapsed : 0.0;
     qDebug("Scan took: %lld ns. "
            "%d unchanged directories. "
            "%d changed/added directories. "
            "%d tracks verified from changed/added directories. "
-           "%d new tracks.",
-           m_scannerGlobal->timerElapsed(),
+           "%d new tracks. "
+           "%.1f files per second.",
+           elapsed,
            verifiedDirectories.size(),
            m_scannerGlobal->numScannedDirectories(),
            verifiedTracks.size(),
-           m_scannerGlobal->numAddedTracks());
+           m_scannerGlobal->numAddedTracks(),
+           filesPerSecond);
+    if (filesImported > 0) {
+        Stat::track("LibraryScanner files per second", Stat::UNSPECIFIED,
+                    Stat::experimentFlags(Stat::COUNT | Stat::AVERAGE |
+                                          Stat::MIN | Stat::MAX),
+                    filesPerSecond);
+    }
 
     emit(scanFinished());
     m_scannerGlobal.clear();
+
+    updateWatchedDirectories();
+    if (m_pWatcher != NULL && !m_changedDirectories.isEmpty()) {
+        m_watchTimer.start();
+    }
+}
+
+void LibraryScanner::slotDirectoryChanged(const QString& directoryPath) {
+    if (!watchDirectoriesEnabled()) {
+        stopWatching();
+        return;
+    }
+    m_changedDirectories.insert(directoryPath);
+    // A running scan starts the timer again when it is finished.
+    if (!m_scannerGlobal) {
+        m_watchTimer.start();
+    }
+}
+
+void LibraryScanner::slotStartIncrementalScan() {
+    if (m_scannerGlobal || m_changedDirectories.isEmpty()) {
+        return;
+    }
+    qDebug() << "LibraryScanner::slotStartIncrementalScan"
+             << m_changedDirectories.size() << "changed directories";
+
+    createScannerGlobal(true);
+    // Pairs with the scanFinished() of slotFinishScan.
+    emit(scanStarted());
+
+    // Everything in a changed directory needs verification again. A directory
+    // that is gone took the directories below it with it, even if they never
+    // reported a change themselves.
+    QStringList invalidatedDirs;
+    QStringList dirsToScan;
+    foreach (const QString& dirPath, m_changedDirectories) {
+        invalidatedDirs.append(dirPath);
+        if (QDir(dirPath).exists()) {
+            dirsToScan.append(dirPath);
+        } else {
+            invalidatedDirs.append(
+                m_scannerGlobal->subdirectoriesInDatabase(dirPath));
+        }
+    }
+    m_changedDirectories.clear();
+
+    m_libraryHashDao.updateDirectoryStatuses(invalidatedDirs, false, false);
+    m_trackDao.invalidateTrackLocationsInDirectories(invalidatedDirs);
+
+    m_trackDao.addTracksPrepare();
+    m_tracksInTransaction = 0;
+
+    // The rest of the scan is the same as a full scan. Directories that are
+    // not verified by it are marked as deleted in slotFinishScan.
+    queueDirectoryScans(dirsToScan);
+}
+
+bool LibraryScanner::watchDirectoriesEnabled() const {
+    return m_pCollection->getConfig()->getValueString(
+        ConfigKey("[Library]", "WatchDirectories")).toInt();
+}
+
+void LibraryScanner::updateWatchedDirectories() {
+    if (m_pWatcher == NULL) {
+        return;
+    }
+    if (!watchDirectoriesEnabled() ||
+            m_libraryHashDao.hasUnverifiedDirectories()) {
+        stopWatching();
+        return;
+    }
+
+    QSet<QString> directories = QSet<QString>::fromList(
+        m_libraryHashDao.getDirectoryHashes().keys());
+    QSet<QString> watchedDirectories = QSet<QString>::fromList(
+        m_pWatcher->directories());
+
+    QStringList removedDirectories = (watchedDirectories - directories).toList();
+    if (!removedDirectories.isEmpty()) {
+        m_pWatcher->removePaths(removedDirectories);
+    }
+    QStringList addedDirectories = (directories - watchedDirectories).toList();
+    if (!addedDirectories.isEmpty()) {
+        m_pWatcher->addPaths(addedDirectories);
+        int unwatched = directories.size() - m_pWatcher->directories().size();
+        if (unwatched > 0) {
+            // On Linux every directory takes an inotify watch, and there are
+            // only fs.inotify.max_user_watches of them.
+            qWarning() << "LibraryScanner: could not watch" << unwatched
+                       << "of" << directories.size() << "library directories."
+                       << "Changes in them are only found by a full rescan.";
+        }
+    }
+}
+
+void LibraryScanner::stopWatching() {
+    m_watchTimer.stop();
+    m_changedDirectories.clear();
+    if (m_pWatcher == NULL) {
+        return;
+    }
+    QStringList watchedDirectories = m_pWatcher->directories();
+    if (!watchedDirectories.isEmpty()) {
+        qDebug() << "LibraryScanner: no longer watching library directories";
+        m_pWatcher->removePaths(watchedDirectories);
+    }
 }
 
 void LibraryScanner::scan() {
@@ -388,10 +569,10 @@ void LibraryScanner::queueTask(ScannerTask* pTask) {
             this, SLOT(directoryHashed(QString, bool, int)));
     connect(pTask, SIGNAL(directoryUnchanged(QString)),
             this, SLOT(directoryUnchanged(QString)));
-    connect(pTask, SIGNAL(trackExists(QString)),
-            this, SLOT(trackExists(QString)));
-    connect(pTask, SIGNAL(addNewTrack(TrackPointer)),
-            this, SLOT(addNewTrack(TrackPointer)));
+    connect(pTask, SIGNAL(tracksExist(QStringList)),
+            this, SLOT(tracksExist(QStringList)));
+    connect(pTask, SIGNAL(addNewTracks(QList<TrackPointer>)),
+            this, SLOT(addNewTracks(QList<TrackPointer>)));
 
     // Progress signals.
     connect(pTask, SIGNAL(progressLoading(QString)),
@@ -399,7 +580,11 @@ void LibraryScanner::queueTask(ScannerTask* pTask) {
     connect(pTask, SIGNAL(progressHashing(QString)),
             this, SIGNAL(progressHashing(QString)));
 
-    m_pool.start(pTask);
+    if (qobject_cast<ImportFilesTask*>(pTask) != NULL) {
+        m_importPool.start(pTask);
+    } else {
+        m_pool.start(pTask);
+    }
 }
 
 void LibraryScanner::directoryHashed(const QString& directoryPath,
@@ -414,14 +599,28 @@ void LibraryScanner::directoryHashed(const QString& directoryPath,
         m_scannerGlobal->directoryScanned();
     }
 
+    // The import of the directory's new tracks may not even have started
+    // yet, so the hash is only saved when the scan is finished.
     if (newDirectory) {
-        m_libraryHashDao.saveDirectoryHash(directoryPath, hash);
+        m_newDirectoryHashes.insert(directoryPath, hash);
     } else {
-        m_libraryHashDao.updateDirectoryHash(directoryPath, hash, 0);
+        m_changedDirectoryHashes.insert(directoryPath, hash);
     }
     emit(progressHashing(directoryPath));
 }
 
+void LibraryScanner::saveDirectoryHashes() {
+    for (QHash<QString, int>::const_iterator it = m_newDirectoryHashes.begin();
+            it != m_newDirectoryHashes.end(); ++it) {
+        m_libraryHashDao.saveDirectoryHash(it.key(), it.value());
+    }
+    for (QHash<QString, int>::const_iterator it =
+                 m_changedDirectoryHashes.begin();
+            it != m_changedDirectoryHashes.end(); ++it) {
+        m_libraryHashDao.updateDirectoryHash(it.key(), it.value(), 0);
+    }
+}
+
 void LibraryScanner::directoryUnchanged(const QString& directoryPath) {
     ScopedTimer timer("LibraryScanner::directoryUnchanged");
     //qDebug() << "LibraryScanner::directoryUnchanged" << directoryPath;
@@ -431,27 +630,36 @@ void LibraryScanner::directoryUnchanged(const QString& directoryPath) {
     emit(progressHashing(directoryPath));
 }
 
-void LibraryScanner::trackExists(const QString& trackPath) {
-    //qDebug() << "LibraryScanner::trackExists" << trackPath;
-    ScopedTimer timer("LibraryScanner::trackExists");
+void LibraryScanner::tracksExist(const QStringList& trackPaths) {
+    //qDebug() << "LibraryScanner::tracksExist" << trackPaths;
+    ScopedTimer timer("LibraryScanner::tracksExist");
     if (m_scannerGlobal) {
-        m_scannerGlobal->addVerifiedTrack(trackPath);
+        m_scannerGlobal->addVerifiedTracks(trackPaths);
     }
 }
 
-void LibraryScanner::addNewTrack(TrackPointer pTrack) {
-    //qDebug() << "LibraryScanner::addNewTrack" << pTrack;
-    ScopedTimer timer("LibraryScanner::addNewTrack");
-    // For statistics tracking.
-    if (m_scannerGlobal) {
-        m_scannerGlobal->trackAdded();
+void LibraryScanner::addNewTracks(QList<TrackPointer> tracks) {
+    //qDebug() << "LibraryScanner::addNewTracks" << tracks.size();
+    ScopedTimer timer("LibraryScanner::addNewTracks");
+    foreach (const TrackPointer& pTrack, tracks) {
+        // For statistics tracking.
+        if (m_scannerGlobal) {
+            m_scannerGlobal->trackAdded();
+        }
+        if (m_trackDao.addTracksAdd(pTrack.data(), false)) {
+            // Successfully added. Signal the main instance of TrackDAO,
+            // that there is a new track in the database.
+            emit(trackAdded(pTrack));
+            ++m_tracksInTransaction;
+        } else {
+            qWarning() << "Track ("+pTrack->getLocation()+") could not be added";
+        }
     }
-    if (m_trackDao.addTracksAdd(pTrack.data(), false)) {
-        // Successfully added. Signal the main instance of TrackDAO,
-        // that there is a new track in the database.
-        emit(trackAdded(pTrack));
-        emit(progressLoading(pTrack->getLocation()));
-    } else {
-        qWarning() << "Track ("+pTrack->getLocation()+") could not be added";
+    if (!tracks.isEmpty()) {
+        emit(progressLoading(tracks.last()->getLocation()));
+    }
+    if (m_tracksInTransaction >= kTracksPerTransaction) {
+        m_trackDao.addTracksCommit();
+        m_tracksInTransaction = 0;
     }
 }
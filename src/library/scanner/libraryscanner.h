@@ -20,6 +20,9 @@
 
 #include <QThread>
 #include <QThreadPool>
+#include <QTimer>
+#include <QHash>
+#include <QSet>
 #include <QList>
 #include <QString>
 #include <QList>
@@ -42,6 +45,7 @@
 #include "util/sandbox.h"
 #include "trackinfoobject.h"
 
+class QFileSystemWatcher;
 class TrackCollection;
 
 class LibraryScanner : public QThread {
@@ -82,15 +86,36 @@ class LibraryScanner : public QThread {
     void slotStartScan();
     void slotFinishScan();
 
+    // Watch mode. Directories that changed are collected until none changed
+    // for a moment and then rescanned without walking the whole library.
+    void slotDirectoryChanged(const QString& directoryPath);
+    void slotStartIncrementalScan();
+
     // ScannerTask signal handlers.
     void taskDone(bool success);
     void directoryHashed(const QString& directoryPath, bool newDirectory,
                          int hash);
     void directoryUnchanged(const QString& directoryPath);
-    void trackExists(const QString& trackPath);
-    void addNewTrack(TrackPointer pTrack);
+    void tracksExist(const QStringList& trackPaths);
+    void addNewTracks(QList<TrackPointer> tracks);
 
   private:
+    // Creates the global state for a new scan from the database.
+    void createScannerGlobal(bool incremental);
+    // Queues a recursive scan task for each of dirs, or finishes the scan if
+    // there are none.
+    void queueDirectoryScans(const QStringList& dirs);
+    // Writes the hashes of the directories hashed by the scan.
+    void saveDirectoryHashes();
+
+    // Whether the library directories should be watched for changes.
+    bool watchDirectoriesEnabled() const;
+    // Watches all the directories in the database. Stops watching instead if
+    // watch mode is disabled or the last scan did not verify every directory,
+    // since an incremental scan would then mark unverified tracks as deleted.
+    void updateWatchedDirectories();
+    void stopWatching();
+
     // The library trackcollection. Do not touch this from the library scanner
     // thread.
     TrackCollection* m_pCollection;
@@ -98,9 +123,21 @@ class LibraryScanner : public QThread {
     // The library scanner thread's database connection.
     QSqlDatabase m_database;
 
-    // The pool of threads used for worker tasks.
+    // The pool of threads that list and hash directories.
     QThreadPool m_pool;
 
+    // The pool of threads that parse the tags of new files. It is bounded
+    // separately so that importing never starves the directory hashing.
+    QThreadPool m_importPool;
+
+    // The number of tracks added since the last commit.
+    int m_tracksInTransaction;
+
+    // The hashes of the new and changed directories of the scan in progress,
+    // by directory path. Saved with the last tracks in slotFinishScan.
+    QHash<QString, int> m_newDirectoryHashes;
+    QHash<QString, int> m_changedDirectoryHashes;
+
     // The library scanner thread's DAOs.
     LibraryHashDAO m_libraryHashDao;
     CueDAO m_cueDao;
@@ -112,6 +149,14 @@ class LibraryScanner : public QThread {
 
     // Global scanner state for scan currently in progress.
     ScannerGlobalPointer m_scannerGlobal;
+
+    // Watches the library directories in watch mode. Created in the scanner
+    // thread, NULL outside of run().
+    QFileSystemWatcher* m_pWatcher;
+    // The directories that changed since the last incremental scan.
+    QSet<QString> m_changedDirectories;
+    // Started on every change, starts an incremental scan when it fires.
+    QTimer m_watchTimer;
 };
 
 #endif
@@ -31,7 +31,6 @@ void RecursiveScanDirectoryTask::run() {
     QString currentFile;
     QFileInfo currentFileInfo;
     QLinkedList<QFileInfo> filesToImport;
-    QLinkedList<QFileInfo> possibleCovers;
     QLinkedList<QDir> dirsToScan;
     QStringList newHashStr;
 
@@ -39,8 +38,6 @@ void RecursiveScanDirectoryTask::run() {
     // versus slicing the extension off and checking for set/list containment.
     QRegExp supportedExtensionsRegex =
             m_scannerGlobal->supportedExtensionsRegex();
-    QRegExp supportedCoverExtensionsRegex =
-            m_scannerGlobal->supportedCoverExtensionsRegex();
 
     while (it.hasNext()) {
         currentFile = it.next();
@@ -51,8 +48,6 @@ void RecursiveScanDirectoryTask::run() {
             if (supportedExtensionsRegex.indexIn(fileName) != -1) {
                 newHashStr.append(currentFile);
                 filesToImport.append(currentFileInfo);
-            } else if (supportedCoverExtensionsRegex.indexIn(fileName) != -1) {
-                possibleCovers.append(currentFileInfo);
             }
         } else {
             // File is a directory. Add it to our list of directories to scan.
@@ -81,8 +76,7 @@ void RecursiveScanDirectoryTask::run() {
         // we return immediately.
         if (!filesToImport.isEmpty()) {
             m_pScanner->queueTask(new ImportFilesTask(m_pScanner, m_scannerGlobal,
-                                                      filesToImport, possibleCovers,
-                                                      m_pToken));
+                                                      filesToImport, m_pToken));
         }
 
         // Insert or update the hash in the database.
@@ -91,8 +85,13 @@ void RecursiveScanDirectoryTask::run() {
         emit(directoryUnchanged(dirPath));
     }
 
-    // Process all of the sub-directories.
+    // Process all of the sub-directories. An incremental scan skips the ones
+    // already in the library, they are rescanned when they change themselves.
     foreach (const QDir& nextDir, dirsToScan) {
+        if (m_scannerGlobal->isIncremental() &&
+                m_scannerGlobal->directoryHashInDatabase(nextDir.path()) != -1) {
+            continue;
+        }
         m_pScanner->queueTask(new RecursiveScanDirectoryTask(
             m_pScanner, m_scannerGlobal, nextDir, m_pToken));
     }
@@ -18,12 +18,14 @@ class ScannerGlobal {
                   const QHash<QString, int>& directoryHashes,
                   const QRegExp& supportedExtensionsMatcher,
                   const QRegExp& supportedCoverExtensionsMatcher,
-                  const QStringList& directoriesBlacklist)
+                  const QStringList& directoriesBlacklist,
+                  bool incremental)
             : m_trackLocations(trackLocations),
               m_directoryHashes(directoryHashes),
               m_supportedExtensionsMatcher(supportedExtensionsMatcher),
               m_supportedCoverExtensionsMatcher(supportedCoverExtensionsMatcher),
               m_directoriesBlacklist(directoriesBlacklist),
+              m_incremental(incremental),
               // Unless marked un-clean, we assume it will finish cleanly.
               m_scanFinishedCleanly(true),
               m_shouldCancel(false),
@@ -45,6 +47,25 @@ class ScannerGlobal {
         return m_directoryHashes.value(directoryPath, -1);
     }
 
+    // Returns the directories in the database below directoryPath.
+    QStringList subdirectoriesInDatabase(const QString& directoryPath) const {
+        const QString prefix = directoryPath + "/";
+        QStringList subdirectories;
+        for (QHash<QString, int>::const_iterator it = m_directoryHashes.constBegin();
+             it != m_directoryHashes.constEnd(); ++it) {
+            if (it.key().startsWith(prefix)) {
+                subdirectories.append(it.key());
+            }
+        }
+        return subdirectories;
+    }
+
+    // Whether only the directories that changed since the last scan are
+    // scanned, plus any directories below them that are new to the library.
+    inline bool isIncremental() const {
+        return m_incremental;
+    }
+
     inline bool directoryBlacklisted(const QString& directoryPath) const {
         return m_directoriesBlacklist.contains(directoryPath);
     }
@@ -101,6 +122,10 @@ class ScannerGlobal {
         m_verifiedTracks << trackLocation;
     }
 
+    void addVerifiedTracks(const QStringList& trackLocations) {
+        m_verifiedTracks << trackLocations;
+    }
+
     const QStringList& verifiedTracks() const {
         return m_verifiedTracks;
     }
@@ -146,6 +171,8 @@ class ScannerGlobal {
     // this has never been investigated.
     QStringList m_directoriesBlacklist;
 
+    const bool m_incremental;
+
     // The list of directories verified by the scan.
     QStringList m_verifiedDirectories;
 
@@ -3,6 +3,8 @@
 
 #include <QObject>
 #include <QRunnable>
+#include <QList>
+#include <QStringList>
 
 #include "trackinfoobject.h"
 #include "library/scanner/scannerglobal.h"
@@ -24,8 +26,10 @@ class ScannerTask : public QObject, public QRunnable {
     void directoryHashed(const QString& directoryPath, bool newDirectory,
                          int hash);
     void directoryUnchanged(const QString& directoryPath);
-    void trackExists(const QString& filePath);
-    void addNewTrack(TrackPointer pTrack);
+    // Tracks are handed to the library scanner in batches, since each
+    // emission is a queued event on the scanner thread.
+    void tracksExist(const QStringList& filePaths);
+    void addNewTracks(QList<TrackPointer> tracks);
 
     // Feedback to GUI
     void progressLoading(const QString& fileName);
@@ -3,9 +3,26 @@
 #include "library/searchquery.h"
 
 #include "library/queryutil.h"
+#include "library/trackindex.h"
 #include "track/keyutils.h"
 #include "library/dao/trackdao.h"
 
+namespace {
+
+// Numeric filters are only evaluated in memory for columns that hold numbers.
+// SQLite compares numbers in text columns (e.g. year) as text.
+bool isNumericIndexColumn(const TrackIndex& index, int column) {
+    if (column < 0) {
+        return false;
+    }
+    const TrackIndex::ColumnType type = index.columnType(column);
+    return type == TrackIndex::COLUMN_NULL ||
+            type == TrackIndex::COLUMN_INTEGER ||
+            type == TrackIndex::COLUMN_DOUBLE;
+}
+
+}  // namespace
+
 QVariant getTrackValueForColumn(const TrackPointer& pTrack, const QString& column) {
     if (column == LIBRARYTABLE_ARTIST) {
         return pTrack->getArtist();
@@ -69,6 +86,24 @@ bool AndNode::match(const TrackPointer& pTrack) const {
     return true;
 }
 
+bool AndNode::canMatchIndex(const TrackIndex& index) const {
+    foreach (const QueryNode* pNode, m_nodes) {
+        if (!pNode->canMatchIndex(index)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AndNode::matchIndex(const TrackIndex& index, int row) const {
+    foreach (const QueryNode* pNode, m_nodes) {
+        if (!pNode->matchIndex(index, row)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 QString AndNode::toSql() const {
     QStringList queryFragments;
     foreach (const QueryNode* pNode, m_nodes) {
@@ -92,6 +127,27 @@ bool OrNode::match(const TrackPointer& pTrack) const {
     return false;
 }
 
+bool OrNode::canMatchIndex(const TrackIndex& index) const {
+    foreach (const QueryNode* pNode, m_nodes) {
+        if (!pNode->canMatchIndex(index)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool OrNode::matchIndex(const TrackIndex& index, int row) const {
+    if (m_nodes.isEmpty()) {
+        return true;
+    }
+    foreach (const QueryNode* pNode, m_nodes) {
+        if (pNode->matchIndex(index, row)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 QString OrNode::toSql() const {
     QStringList queryFragments;
     foreach (const QueryNode* pNode, m_nodes) {
@@ -114,6 +170,14 @@ bool NotNode::match(const TrackPointer& pTrack) const {
     return false;
 }
 
+bool NotNode::canMatchIndex(const TrackIndex& index) const {
+    return m_pNode != NULL && m_pNode->canMatchIndex(index);
+}
+
+bool NotNode::matchIndex(const TrackIndex& index, int row) const {
+    return !m_pNode->matchIndex(index, row);
+}
+
 QString NotNode::toSql() const {
     QString sql = m_pNode->toSql();
     if (!sql.isEmpty()) {
@@ -136,6 +200,28 @@ bool TextFilterNode::match(const TrackPointer& pTrack) const {
     return false;
 }
 
+bool TextFilterNode::canMatchIndex(const TrackIndex& index) const {
+    if (m_sqlColumns.isEmpty()) {
+        return false;
+    }
+    foreach (const QString& sqlColumn, m_sqlColumns) {
+        if (index.fieldIndex(sqlColumn) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TextFilterNode::matchIndex(const TrackIndex& index, int row) const {
+    foreach (const QString& sqlColumn, m_sqlColumns) {
+        if (index.containsFolded(row, index.fieldIndex(sqlColumn),
+                                 m_foldedArgument)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 QString TextFilterNode::toSql() const {
     FieldEscaper escaper(m_database);
     QString escapedArgument = escaper.escapeString("%" + m_argument + "%");
@@ -203,6 +289,17 @@ NumericFilterNode::NumericFilterNode(const QStringList& sqlColumns)
           m_dRangeHigh(0.0) {
 }
 
+bool NumericFilterNode::matchValue(double dValue) const {
+    if (m_bOperatorQuery) {
+        return (m_operator == "=" && dValue == m_dOperatorArgument) ||
+                (m_operator == "<" && dValue < m_dOperatorArgument) ||
+                (m_operator == ">" && dValue > m_dOperatorArgument) ||
+                (m_operator == "<=" && dValue <= m_dOperatorArgument) ||
+                (m_operator == ">=" && dValue >= m_dOperatorArgument);
+    }
+    return m_bRangeQuery && dValue >= m_dRangeLow && dValue <= m_dRangeHigh;
+}
+
 bool NumericFilterNode::match(const TrackPointer& pTrack) const {
     foreach (QString sqlColumn, m_sqlColumns) {
         QVariant value = getTrackValueForColumn(pTrack, sqlColumn);
@@ -210,17 +307,31 @@ bool NumericFilterNode::match(const TrackPointer& pTrack) const {
             continue;
         }
 
-        double dValue = value.toDouble();
-        if (m_bOperatorQuery) {
-            if ((m_operator == "=" && dValue == m_dOperatorArgument) ||
-                (m_operator == "<" && dValue < m_dOperatorArgument) ||
-                (m_operator == ">" && dValue > m_dOperatorArgument) ||
-                (m_operator == "<=" && dValue <= m_dOperatorArgument) ||
-                (m_operator == ">=" && dValue >= m_dOperatorArgument)) {
-                return true;
-            }
-        } else if (m_bRangeQuery && dValue >= m_dRangeLow &&
-                   dValue <= m_dRangeHigh) {
+        if (matchValue(value.toDouble())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool NumericFilterNode::canMatchIndex(const TrackIndex& index) const {
+    // Without a valid argument toSql() filters nothing, which is left to SQL.
+    if (m_sqlColumns.isEmpty() || (!m_bOperatorQuery && !m_bRangeQuery)) {
+        return false;
+    }
+    foreach (const QString& sqlColumn, m_sqlColumns) {
+        if (!isNumericIndexColumn(index, index.fieldIndex(sqlColumn))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool NumericFilterNode::matchIndex(const TrackIndex& index, int row) const {
+    foreach (const QString& sqlColumn, m_sqlColumns) {
+        double dValue = 0.0;
+        if (index.numericValue(row, index.fieldIndex(sqlColumn), &dValue) &&
+                matchValue(dValue)) {
             return true;
         }
     }
@@ -304,6 +415,20 @@ bool KeyFilterNode::match(const TrackPointer& pTrack) const {
     return m_matchKeys.contains(pTrack->getKey());
 }
 
+bool KeyFilterNode::canMatchIndex(const TrackIndex& index) const {
+    return isNumericIndexColumn(index, index.fieldIndex(LIBRARYTABLE_KEY_ID));
+}
+
+bool KeyFilterNode::matchIndex(const TrackIndex& index, int row) const {
+    double dKey = 0.0;
+    if (!index.numericValue(row, index.fieldIndex(LIBRARYTABLE_KEY_ID), &dKey)) {
+        return false;
+    }
+    return m_matchKeys.contains(
+            static_cast<mixxx::track::io::key::ChromaticKey>(
+                    static_cast<int>(dKey)));
+}
+
 QString KeyFilterNode::toSql() const {
     QStringList searchClauses;
     foreach (mixxx::track::io::key::ChromaticKey match, m_matchKeys) {
@@ -10,6 +10,8 @@
 #include "trackinfoobject.h"
 #include "proto/keys.pb.h"
 
+class TrackIndex;
+
 QVariant getTrackValueForColumn(const TrackPointer& pTrack, const QString& column);
 
 class QueryNode {
@@ -19,6 +21,20 @@ class QueryNode {
 
     virtual bool match(const TrackPointer& pTrack) const = 0;
     virtual QString toSql() const = 0;
+
+    // Returns true if the node can be evaluated against the in-memory
+    // TrackIndex with matchIndex() instead of running its SQL.
+    virtual bool canMatchIndex(const TrackIndex& index) const {
+        Q_UNUSED(index);
+        return false;
+    }
+    // Matches the track in row of the index. Only valid if canMatchIndex()
+    // returned true for the same index.
+    virtual bool matchIndex(const TrackIndex& index, int row) const {
+        Q_UNUSED(index);
+        Q_UNUSED(row);
+        return false;
+    }
 };
 
 class GroupNode : public QueryNode {
@@ -44,6 +60,8 @@ class OrNode : public GroupNode {
 
     bool match(const TrackPointer& pTrack) const;
     QString toSql() const;
+    bool canMatchIndex(const TrackIndex& index) const;
+    bool matchIndex(const TrackIndex& index, int row) const;
 };
 
 class AndNode : public GroupNode {
@@ -52,6 +70,8 @@ class AndNode : public GroupNode {
 
     bool match(const TrackPointer& pTrack) const;
     QString toSql() const;
+    bool canMatchIndex(const TrackIndex& index) const;
+    bool matchIndex(const TrackIndex& index, int row) const;
 };
 
 class NotNode : public QueryNode {
@@ -60,6 +80,8 @@ class NotNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const;
     QString toSql() const;
+    bool canMatchIndex(const TrackIndex& index) const;
+    bool matchIndex(const TrackIndex& index, int row) const;
 
   private:
     QueryNode* m_pNode;
@@ -72,16 +94,20 @@ class TextFilterNode : public QueryNode {
                    const QString& argument)
             : m_database(database),
               m_sqlColumns(sqlColumns),
-              m_argument(argument) {
+              m_argument(argument),
+              m_foldedArgument(argument.toCaseFolded()) {
     }
 
     bool match(const TrackPointer& pTrack) const;
     QString toSql() const;
+    bool canMatchIndex(const TrackIndex& index) const;
+    bool matchIndex(const TrackIndex& index, int row) const;
 
   private:
     QSqlDatabase m_database;
     QStringList m_sqlColumns;
     QString m_argument;
+    QString m_foldedArgument;
 };
 
 class NumericFilterNode : public QueryNode {
@@ -90,10 +116,13 @@ class NumericFilterNode : public QueryNode {
     NumericFilterNode(const QStringList& sqlColumns);
     bool match(const TrackPointer& pTrack) const;
     QString toSql() const;
+    bool canMatchIndex(const TrackIndex& index) const;
+    bool matchIndex(const TrackIndex& index, int row) const;
 
   protected:
     virtual void init(QString argument);
     virtual double parse(const QString& arg, bool *ok);
+    bool matchValue(double dValue) const;
     QStringList m_sqlColumns;
     bool m_bOperatorQuery;
     QString m_operator;
@@ -117,6 +146,8 @@ class KeyFilterNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const;
     QString toSql() const;
+    bool canMatchIndex(const TrackIndex& index) const;
+    bool matchIndex(const TrackIndex& index, int row) const;
 
   private:
     QList<mixxx::track::io::key::ChromaticKey> m_matchKeys;
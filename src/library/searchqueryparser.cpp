@@ -5,6 +5,24 @@
 const char* kNegatePrefix = "-";
 const char* kFuzzyPrefix = "~";
 
+namespace {
+
+// Returns true if query only consists of search terms that are matched
+// against the search columns.
+bool isPlainTextQuery(const QString& query) {
+    foreach (const QString& token, query.split(" ")) {
+        const QString trimmed = token.trimmed();
+        if (trimmed.startsWith(kNegatePrefix) ||
+                trimmed.startsWith(kFuzzyPrefix) ||
+                trimmed.contains(':')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
 SearchQueryParser::SearchQueryParser(QSqlDatabase& database)
         : m_database(database) {
     m_textFilters << "artist"
@@ -187,6 +205,14 @@ void SearchQueryParser::parseTokens(QStringList tokens,
     }
 }
 
+// static
+bool SearchQueryParser::queryRefines(const QString& previousQuery,
+                                     const QString& query) {
+    // Extending the last term or adding terms only ever removes matches.
+    return query.startsWith(previousQuery) &&
+            isPlainTextQuery(previousQuery) && isPlainTextQuery(query);
+}
+
 QueryNode* SearchQueryParser::parseQuery(const QString& query,
                                          const QStringList& searchColumns,
                                          const QString& extraFilter) const {
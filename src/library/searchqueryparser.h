@@ -18,6 +18,13 @@ class SearchQueryParser {
                           const QStringList& searchColumns,
                           const QString& extraFilter) const;
 
+    // Returns true if every track matching query also matches previousQuery,
+    // because query only extends the plain search terms of previousQuery
+    // (e.g. "daft" -> "daft pu"). Queries using filters or negation never
+    // refine each other.
+    static bool queryRefines(const QString& previousQuery,
+                             const QString& query);
+
   private:
     void parseTokens(QStringList tokens,
                      QStringList searchColumns,
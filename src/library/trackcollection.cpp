@@ -129,6 +129,7 @@ bool TrackCollection::checkForTables() {
     m_cueDao.initialize();
     m_directoryDao.initialize();
     m_libraryHashDao.initialize();
+    m_analysisDao.initialize();
     return true;
 }
 
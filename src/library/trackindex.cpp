@@ -0,0 +1,552 @@
+#include <QtAlgorithms>
+#include <QtDebug>
+
+#include "library/trackindex.h"
+#include "util/assert.h"
+
+namespace {
+
+// Orders rows by a per-row key with NULL values first.
+template <typename T>
+class KeyLessThan {
+  public:
+    KeyLessThan(const QVector<T>& keys, const QBitArray& nulls)
+            : m_keys(keys),
+              m_nulls(nulls) {
+    }
+
+    bool operator()(int row1, int row2) const {
+        const bool null1 = m_nulls.testBit(row1);
+        const bool null2 = m_nulls.testBit(row2);
+        if (null1 || null2) {
+            return null1 && !null2;
+        }
+        return m_keys[row1] < m_keys[row2];
+    }
+
+  private:
+    const QVector<T>& m_keys;
+    const QBitArray& m_nulls;
+};
+
+class FoldedStringLessThan {
+  public:
+    explicit FoldedStringLessThan(const QVector<QString>& foldedStrings)
+            : m_foldedStrings(foldedStrings) {
+    }
+
+    bool operator()(int id1, int id2) const {
+        return QString::localeAwareCompare(m_foldedStrings[id1],
+                                           m_foldedStrings[id2]) < 0;
+    }
+
+  private:
+    const QVector<QString>& m_foldedStrings;
+};
+
+// Orders rows by the ID of their track. The row order of equal values is
+// sorted by this first, since rows are reused and say nothing about the
+// order in which tracks were added.
+class TrackIdLessThan {
+  public:
+    explicit TrackIdLessThan(const QVector<int>& rowTrackIds)
+            : m_rowTrackIds(rowTrackIds) {
+    }
+
+    bool operator()(int row1, int row2) const {
+        return m_rowTrackIds[row1] < m_rowTrackIds[row2];
+    }
+
+  private:
+    const QVector<int>& m_rowTrackIds;
+};
+
+// Columns that fell back to QVariants are compared as numbers if both values
+// are numbers and as case-insensitive strings otherwise.
+class VariantLessThan {
+  public:
+    VariantLessThan(const QVector<QVariant>& values, const QBitArray& nulls)
+            : m_values(values),
+              m_nulls(nulls) {
+    }
+
+    bool operator()(int row1, int row2) const {
+        const bool null1 = m_nulls.testBit(row1);
+        const bool null2 = m_nulls.testBit(row2);
+        if (null1 || null2) {
+            return null1 && !null2;
+        }
+        const QVariant& value1 = m_values[row1];
+        const QVariant& value2 = m_values[row2];
+        if (isNumber(value1) && isNumber(value2)) {
+            return value1.toDouble() < value2.toDouble();
+        }
+        return QString::localeAwareCompare(
+                value1.toString().toCaseFolded(),
+                value2.toString().toCaseFolded()) < 0;
+    }
+
+  private:
+    static bool isNumber(const QVariant& value) {
+        switch (value.type()) {
+            case QVariant::Bool:
+            case QVariant::Int:
+            case QVariant::UInt:
+            case QVariant::LongLong:
+            case QVariant::ULongLong:
+            case QVariant::Double:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    const QVector<QVariant>& m_values;
+    const QBitArray& m_nulls;
+};
+
+// The value of SQLite's "cast(x as integer)": the leading integer of the
+// string, 0 if there is none.
+qint64 leadingInteger(const QString& string) {
+    const QString trimmed = string.trimmed();
+    int i = 0;
+    bool negative = false;
+    if (i < trimmed.size() && (trimmed[i] == '-' || trimmed[i] == '+')) {
+        negative = trimmed[i] == '-';
+        ++i;
+    }
+    qint64 result = 0;
+    for (; i < trimmed.size() && trimmed[i].isDigit(); ++i) {
+        result = result * 10 + trimmed[i].digitValue();
+    }
+    return negative ? -result : result;
+}
+
+}  // namespace
+
+TrackIndex::TrackIndex(const ColumnCache& columnCache, int columnCount)
+        : m_columnCache(columnCache),
+          m_columns(columnCount),
+          m_pLastSearchResults(NULL),
+          m_iGeneration(0) {
+}
+
+TrackIndex::~TrackIndex() {
+}
+
+void TrackIndex::clear() {
+    m_columns.fill(Column());
+    m_rowTrackIds.clear();
+    m_trackIdToRow.clear();
+    m_freeRows.clear();
+    m_strings.clear();
+    m_foldedStrings.clear();
+    m_stringRefs.clear();
+    m_freeStringIds.clear();
+    m_stringIds.clear();
+    m_sortedRows.clear();
+    clearSearchCache();
+    ++m_iGeneration;
+}
+
+int TrackIndex::insertTrack(int trackId) {
+    QHash<int, int>::const_iterator it = m_trackIdToRow.find(trackId);
+    if (it != m_trackIdToRow.end()) {
+        return it.value();
+    }
+
+    int row;
+    if (m_freeRows.isEmpty()) {
+        row = m_rowTrackIds.size();
+        appendRow();
+    } else {
+        row = m_freeRows.back();
+        m_freeRows.pop_back();
+        for (int i = 0; i < m_columns.size(); ++i) {
+            Column& column = m_columns[i];
+            column.nulls.setBit(row);
+            if (column.type == COLUMN_VARIANT) {
+                column.variants[row] = QVariant();
+            }
+        }
+    }
+    m_rowTrackIds[row] = trackId;
+    m_trackIdToRow.insert(trackId, row);
+    // The cached orders do not contain the new row.
+    m_sortedRows.clear();
+    ++m_iGeneration;
+    return row;
+}
+
+void TrackIndex::removeTrack(int trackId) {
+    QHash<int, int>::iterator it = m_trackIdToRow.find(trackId);
+    if (it == m_trackIdToRow.end()) {
+        return;
+    }
+    const int row = it.value();
+    m_trackIdToRow.erase(it);
+    m_rowTrackIds[row] = -1;
+    for (int i = 0; i < m_columns.size(); ++i) {
+        releaseValue(&m_columns[i], row);
+        m_columns[i].nulls.setBit(row);
+    }
+    m_freeRows.push_back(row);
+    ++m_iGeneration;
+    // The cached orders still contain the row, but it no longer maps to a
+    // track so it is skipped by everyone iterating them.
+}
+
+void TrackIndex::appendRow() {
+    m_rowTrackIds.push_back(-1);
+    const int rows = m_rowTrackIds.size();
+    for (int i = 0; i < m_columns.size(); ++i) {
+        Column& column = m_columns[i];
+        column.nulls.resize(rows);
+        column.nulls.setBit(rows - 1);
+        switch (column.type) {
+            case COLUMN_INTEGER:
+                column.integers.push_back(0);
+                break;
+            case COLUMN_DOUBLE:
+                column.doubles.push_back(0.0);
+                break;
+            case COLUMN_STRING:
+                column.strings.push_back(-1);
+                break;
+            case COLUMN_VARIANT:
+                column.variants.push_back(QVariant());
+                break;
+            case COLUMN_NULL:
+                break;
+        }
+    }
+}
+
+// static
+TrackIndex::ColumnType TrackIndex::columnTypeForVariant(const QVariant& value) {
+    switch (value.type()) {
+        case QVariant::Bool:
+        case QVariant::Int:
+        case QVariant::UInt:
+        case QVariant::LongLong:
+        case QVariant::ULongLong:
+            return COLUMN_INTEGER;
+        case QVariant::Double:
+            return COLUMN_DOUBLE;
+        case QVariant::String:
+            return COLUMN_STRING;
+        default:
+            return COLUMN_VARIANT;
+    }
+}
+
+int TrackIndex::internString(const QString& string) {
+    QHash<QString, int>::const_iterator it = m_stringIds.find(string);
+    if (it != m_stringIds.end()) {
+        ++m_stringRefs[it.value()];
+        return it.value();
+    }
+    int id;
+    if (m_freeStringIds.isEmpty()) {
+        id = m_strings.size();
+        m_strings.push_back(string);
+        m_foldedStrings.push_back(string.toCaseFolded());
+        m_stringRefs.push_back(1);
+    } else {
+        id = m_freeStringIds.back();
+        m_freeStringIds.pop_back();
+        m_strings[id] = string;
+        m_foldedStrings[id] = string.toCaseFolded();
+        m_stringRefs[id] = 1;
+        // Forget what the searches found out about the previous string.
+        for (QHash<QString, QVector<char> >::iterator it = m_searchCache.begin();
+             it != m_searchCache.end(); ++it) {
+            if (id < it.value().size()) {
+                it.value()[id] = 0;
+            }
+        }
+    }
+    m_stringIds.insert(string, id);
+    return id;
+}
+
+void TrackIndex::releaseString(int id) {
+    DEBUG_ASSERT_AND_HANDLE(id >= 0 && id < m_stringRefs.size() &&
+                            m_stringRefs[id] > 0) {
+        return;
+    }
+    if (--m_stringRefs[id] > 0) {
+        return;
+    }
+    m_stringIds.remove(m_strings[id]);
+    m_strings[id] = QString();
+    m_foldedStrings[id] = QString();
+    m_freeStringIds.push_back(id);
+}
+
+void TrackIndex::releaseValue(Column* pColumn, int row) {
+    if (pColumn->type != COLUMN_STRING || pColumn->nulls.testBit(row)) {
+        return;
+    }
+    releaseString(pColumn->strings[row]);
+    pColumn->strings[row] = -1;
+}
+
+void TrackIndex::convertToVariantColumn(Column* pColumn) {
+    QVector<QVariant> variants(m_rowTrackIds.size());
+    for (int row = 0; row < variants.size(); ++row) {
+        variants[row] = columnValue(*pColumn, row);
+    }
+    if (pColumn->type == COLUMN_STRING) {
+        for (int row = 0; row < variants.size(); ++row) {
+            releaseValue(pColumn, row);
+        }
+    }
+    pColumn->variants = variants;
+    pColumn->integers.clear();
+    pColumn->doubles.clear();
+    pColumn->strings.clear();
+    pColumn->type = COLUMN_VARIANT;
+}
+
+void TrackIndex::setValue(int row, int column, const QVariant& value) {
+    DEBUG_ASSERT_AND_HANDLE(row >= 0 && row < m_rowTrackIds.size() &&
+                            column >= 0 && column < m_columns.size()) {
+        return;
+    }
+    Column& col = m_columns[column];
+    if (!m_sortedRows.isEmpty()) {
+        m_sortedRows.remove(column);
+    }
+    ++m_iGeneration;
+
+    if (value.isNull()) {
+        releaseValue(&col, row);
+        col.nulls.setBit(row);
+        if (col.type == COLUMN_VARIANT) {
+            col.variants[row] = value;
+        }
+        return;
+    }
+
+    const ColumnType type = columnTypeForVariant(value);
+    if (col.type == COLUMN_NULL) {
+        col.type = type;
+        col.variantType = value.type();
+        const int rows = m_rowTrackIds.size();
+        switch (type) {
+            case COLUMN_INTEGER:
+                col.integers.resize(rows);
+                break;
+            case COLUMN_DOUBLE:
+                col.doubles.resize(rows);
+                break;
+            case COLUMN_STRING:
+                col.strings.fill(-1, rows);
+                break;
+            default:
+                col.variants.resize(rows);
+                break;
+        }
+    } else if (col.type != type && col.type != COLUMN_VARIANT) {
+        convertToVariantColumn(&col);
+    }
+
+    const bool wasNull = col.nulls.testBit(row);
+    col.nulls.clearBit(row);
+    switch (col.type) {
+        case COLUMN_INTEGER:
+            col.integers[row] = value.toLongLong();
+            break;
+        case COLUMN_DOUBLE:
+            col.doubles[row] = value.toDouble();
+            break;
+        case COLUMN_STRING: {
+            // Intern first, so a string that is set again is not dropped.
+            const int oldId = wasNull ? -1 : col.strings[row];
+            col.strings[row] = internString(value.toString());
+            if (oldId >= 0) {
+                releaseString(oldId);
+            }
+            break;
+        }
+        default:
+            col.variants[row] = value;
+            break;
+    }
+}
+
+QVariant TrackIndex::columnValue(const Column& column, int row) const {
+    if (column.type == COLUMN_VARIANT) {
+        return column.variants[row];
+    }
+    if (column.nulls.testBit(row)) {
+        return QVariant(column.variantType);
+    }
+    switch (column.type) {
+        case COLUMN_INTEGER: {
+            QVariant result(column.integers[row]);
+            if (column.variantType != QVariant::LongLong) {
+                result.convert(column.variantType);
+            }
+            return result;
+        }
+        case COLUMN_DOUBLE:
+            return QVariant(column.doubles[row]);
+        case COLUMN_STRING:
+            return QVariant(m_strings[column.strings[row]]);
+        default:
+            return QVariant(column.variantType);
+    }
+}
+
+QVariant TrackIndex::value(int row, int column) const {
+    if (row < 0 || row >= m_rowTrackIds.size() ||
+            column < 0 || column >= m_columns.size()) {
+        return QVariant();
+    }
+    return columnValue(m_columns[column], row);
+}
+
+void TrackIndex::clearSearchCache() const {
+    m_searchCache.clear();
+    m_lastSearchArgument.clear();
+    m_pLastSearchResults = NULL;
+}
+
+bool TrackIndex::containsFolded(int row, int column,
+                                const QString& foldedArgument) const {
+    const Column& col = m_columns[column];
+    if (col.nulls.testBit(row)) {
+        return false;
+    }
+    if (col.type != COLUMN_STRING) {
+        return columnValue(col, row).toString().toCaseFolded()
+                .contains(foldedArgument);
+    }
+
+    if (m_pLastSearchResults == NULL ||
+            m_lastSearchArgument != foldedArgument) {
+        m_pLastSearchResults = &m_searchCache[foldedArgument];
+        m_lastSearchArgument = foldedArgument;
+    }
+    QVector<char>& results = *m_pLastSearchResults;
+    if (results.size() < m_strings.size()) {
+        results.resize(m_strings.size());
+    }
+
+    const int id = col.strings[row];
+    char& result = results[id];
+    if (result == 0) {
+        result = m_foldedStrings[id].contains(foldedArgument) ? 1 : 2;
+    }
+    return result == 1;
+}
+
+bool TrackIndex::numericValue(int row, int column, double* pValue) const {
+    const Column& col = m_columns[column];
+    if (col.nulls.testBit(row)) {
+        return false;
+    }
+    switch (col.type) {
+        case COLUMN_INTEGER:
+            *pValue = static_cast<double>(col.integers[row]);
+            return true;
+        case COLUMN_DOUBLE:
+            *pValue = col.doubles[row];
+            return true;
+        default:
+            return false;
+    }
+}
+
+QVector<int> TrackIndex::stringSortRanks(const Column& column) const {
+    // Sort the distinct strings of the column once instead of comparing the
+    // strings of every row.
+    QVector<int> ids;
+    QVector<bool> used(m_strings.size(), false);
+    for (int row = 0; row < column.strings.size(); ++row) {
+        const int id = column.strings[row];
+        if (m_rowTrackIds[row] < 0 || column.nulls.testBit(row) || used[id]) {
+            continue;
+        }
+        used[id] = true;
+        ids.push_back(id);
+    }
+    qSort(ids.begin(), ids.end(), FoldedStringLessThan(m_foldedStrings));
+
+    QVector<int> ranks(m_strings.size(), -1);
+    int rank = 0;
+    for (int i = 0; i < ids.size(); ++i) {
+        if (i > 0 && QString::localeAwareCompare(
+                m_foldedStrings[ids[i - 1]], m_foldedStrings[ids[i]]) != 0) {
+            ++rank;
+        }
+        ranks[ids[i]] = rank;
+    }
+    return ranks;
+}
+
+const QVector<int>& TrackIndex::sortedRows(int column) {
+    QHash<int, QVector<int> >::const_iterator it = m_sortedRows.find(column);
+    if (it != m_sortedRows.end()) {
+        return it.value();
+    }
+
+    QVector<int>& rows = m_sortedRows[column];
+    rows.reserve(m_trackIdToRow.size());
+    for (int row = 0; row < m_rowTrackIds.size(); ++row) {
+        if (m_rowTrackIds[row] >= 0) {
+            rows.push_back(row);
+        }
+    }
+    if (column < 0 || column >= m_columns.size()) {
+        return rows;
+    }
+    // The sorts below are stable, so ties end up sorted by track ID.
+    qSort(rows.begin(), rows.end(), TrackIdLessThan(m_rowTrackIds));
+
+    const Column& col = m_columns[column];
+    switch (col.type) {
+        case COLUMN_INTEGER:
+            qStableSort(rows.begin(), rows.end(),
+                        KeyLessThan<qint64>(col.integers, col.nulls));
+            break;
+        case COLUMN_DOUBLE:
+            qStableSort(rows.begin(), rows.end(),
+                        KeyLessThan<double>(col.doubles, col.nulls));
+            break;
+        case COLUMN_STRING:
+            if (column == m_columnCache.fieldIndex(
+                    ColumnCache::COLUMN_LIBRARYTABLE_TRACKNUMBER)) {
+                // Track numbers are sorted as numbers, see
+                // BaseTrackCache::orderByClause.
+                QVector<qint64> keys(m_rowTrackIds.size(), 0);
+                for (int row = 0; row < keys.size(); ++row) {
+                    if (!col.nulls.testBit(row)) {
+                        keys[row] = leadingInteger(m_strings[col.strings[row]]);
+                    }
+                }
+                qStableSort(rows.begin(), rows.end(),
+                            KeyLessThan<qint64>(keys, col.nulls));
+            } else {
+                const QVector<int> ranks = stringSortRanks(col);
+                QVector<int> keys(m_rowTrackIds.size(), -1);
+                for (int row = 0; row < keys.size(); ++row) {
+                    if (!col.nulls.testBit(row)) {
+                        keys[row] = ranks[col.strings[row]];
+                    }
+                }
+                qStableSort(rows.begin(), rows.end(),
+                            KeyLessThan<int>(keys, col.nulls));
+            }
+            break;
+        case COLUMN_VARIANT:
+            qStableSort(rows.begin(), rows.end(),
+                        VariantLessThan(col.variants, col.nulls));
+            break;
+        case COLUMN_NULL:
+            break;
+    }
+    return rows;
+}
@@ -0,0 +1,172 @@
+#ifndef TRACKINDEX_H
+#define TRACKINDEX_H
+
+#include <QBitArray>
+#include <QHash>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+#include "library/columncache.h"
+
+// TrackIndex is the in-memory table behind BaseTrackCache. Instead of a
+// QVector<QVariant> per track it stores one typed array per column:
+// integers and floating point values are stored unboxed and strings are
+// interned, so the many tracks that share an artist, album or genre share one
+// QString. A case folded copy of every interned string is kept for searching.
+// Interned strings are reference counted and dropped once no row uses them.
+//
+// The type of a column is picked by the first non-NULL value stored in it. If
+// a later value does not fit, the column falls back to storing QVariants so no
+// value is ever changed by the index.
+//
+// For every column that is sorted by, TrackIndex caches the order of all rows
+// so sorting the library again (e.g. on each key press in the search box) is a
+// single pass over that order. The cached order of a column is dropped when any
+// of its values change.
+//
+// Rows are never moved. Removing a track frees its row for the next track that
+// is added.
+class TrackIndex {
+  public:
+    enum ColumnType {
+        // No non-NULL value was stored yet.
+        COLUMN_NULL = 0,
+        COLUMN_INTEGER,
+        COLUMN_DOUBLE,
+        COLUMN_STRING,
+        COLUMN_VARIANT
+    };
+
+    TrackIndex(const ColumnCache& columnCache, int columnCount);
+    ~TrackIndex();
+
+    void clear();
+
+    // Changes every time a value, row or track is changed, so a search can
+    // tell if its results are still current.
+    int generation() const {
+        return m_iGeneration;
+    }
+
+    int columnCount() const {
+        return m_columns.size();
+    }
+    int fieldIndex(const QString& columnName) const {
+        return m_columnCache.fieldIndex(columnName);
+    }
+    ColumnType columnType(int column) const {
+        return m_columns[column].type;
+    }
+
+    // The number of rows, including free ones. Row numbers are always less
+    // than this.
+    int rowCount() const {
+        return m_rowTrackIds.size();
+    }
+    int trackCount() const {
+        return m_trackIdToRow.size();
+    }
+    // Returns the row of trackId or -1 if it is not in the index.
+    int rowForTrack(int trackId) const {
+        return m_trackIdToRow.value(trackId, -1);
+    }
+    // Returns the track ID in row or -1 if the row is free.
+    int trackForRow(int row) const {
+        return m_rowTrackIds[row];
+    }
+    // The number of distinct strings stored in string columns.
+    int stringCount() const {
+        return m_stringIds.size();
+    }
+
+    // Returns the row of trackId, adding a row with all values NULL if the
+    // track is not in the index yet.
+    int insertTrack(int trackId);
+    void removeTrack(int trackId);
+
+    void setValue(int row, int column, const QVariant& value);
+    QVariant value(int row, int column) const;
+    bool isNull(int row, int column) const {
+        return m_columns[column].nulls.testBit(row);
+    }
+
+    // Returns true if the value in row contains foldedArgument when compared
+    // case-insensitively. foldedArgument must already be case folded. NULL
+    // never matches. Results for interned strings are remembered until
+    // clearSearchCache() is called.
+    bool containsFolded(int row, int column,
+                        const QString& foldedArgument) const;
+    // Drops the remembered results of containsFolded. Must be called before
+    // every search since the index may have changed in between.
+    void clearSearchCache() const;
+
+    // Stores the value of row as a double in *pValue. Returns false if the
+    // value is NULL or the column does not hold numbers.
+    bool numericValue(int row, int column, double* pValue) const;
+
+    // Returns all rows that hold a track sorted by column in ascending order,
+    // case-insensitively and with NULL first, like the ORDER BY clause used
+    // by BaseTrackCache. Ties are sorted by track ID.
+    const QVector<int>& sortedRows(int column);
+
+  private:
+    struct Column {
+        Column()
+                : type(COLUMN_NULL),
+                  variantType(QVariant::String) {
+        }
+
+        ColumnType type;
+        // The type of QVariant returned by value(). Integers of any type are
+        // stored as qint64 and returned as the type of the first one.
+        QVariant::Type variantType;
+        QBitArray nulls;
+        QVector<qint64> integers;
+        QVector<double> doubles;
+        // Indices into m_strings.
+        QVector<int> strings;
+        QVector<QVariant> variants;
+    };
+
+    static ColumnType columnTypeForVariant(const QVariant& value);
+    QVariant columnValue(const Column& column, int row) const;
+    void appendRow();
+    void convertToVariantColumn(Column* pColumn);
+    // Returns the ID of string and adds a reference to it.
+    int internString(const QString& string);
+    // Drops a reference to the interned string id.
+    void releaseString(int id);
+    // Drops the reference of the string value of row in column, if any.
+    void releaseValue(Column* pColumn, int row);
+    QVector<int> stringSortRanks(const Column& column) const;
+
+    const ColumnCache m_columnCache;
+    QVector<Column> m_columns;
+
+    QVector<int> m_rowTrackIds;
+    QHash<int, int> m_trackIdToRow;
+    QVector<int> m_freeRows;
+
+    // The interned strings, their case folded form, the number of rows
+    // referring to them and a lookup table. IDs of dropped strings are reused.
+    QVector<QString> m_strings;
+    QVector<QString> m_foldedStrings;
+    QVector<int> m_stringRefs;
+    QVector<int> m_freeStringIds;
+    QHash<QString, int> m_stringIds;
+
+    // Per search argument and interned string: 0 unknown, 1 matches,
+    // 2 does not match.
+    mutable QHash<QString, QVector<char> > m_searchCache;
+    // The entry of m_searchCache used last, since a search tests the same
+    // argument against many rows in a row.
+    mutable QString m_lastSearchArgument;
+    mutable QVector<char>* m_pLastSearchResults;
+
+    QHash<int, QVector<int> > m_sortedRows;
+
+    int m_iGeneration;
+};
+
+#endif /* TRACKINDEX_H */
@@ -53,6 +53,19 @@ class TrackModel {
     // set.
     virtual TrackPointer getTrack(const QModelIndex& index) const = 0;
 
+    // Deserialize and return the tracks at the given QModelIndexes, leaving
+    // out the ones without a track.
+    virtual QList<TrackPointer> getTracks(const QModelIndexList& indices) const {
+        QList<TrackPointer> tracks;
+        foreach (const QModelIndex& index, indices) {
+            TrackPointer pTrack = getTrack(index);
+            if (pTrack) {
+                tracks.append(pTrack);
+            }
+        }
+        return tracks;
+    }
+
     // Gets the on-disk location of the track at the given location.
     virtual QString getTrackLocation(const QModelIndex& index) const = 0;
 
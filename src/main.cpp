@@ -260,6 +260,10 @@ int main(int argc, char * argv[])
 \n\
     --developer             Enables developer-mode. Includes extra log info,\n\
                             stats on performance, and a Developer tools menu.\n\
+\n\
+    --tracePath PATH        In developer-mode, writes all timers and traces\n\
+                            to PATH on exit as a Chrome trace (JSON) that\n\
+                            can be opened in chrome://tracing or Perfetto.\n\
 \n\
     --safeMode              Enables safe-mode. Disables OpenGL waveforms,\n\
                             and spinning vinyl widgets. Try this option if\n\
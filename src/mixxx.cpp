@@ -277,7 +277,8 @@ MixxxMainWindow::MixxxMainWindow(QApplication* pApp, const CmdlineArgs& args)
     delete pModplugPrefs; // not needed anymore
 #endif
 
-    CoverArtCache::create();
+    CoverArtCache* pCoverArtCache = CoverArtCache::create();
+    pCoverArtCache->setConfig(m_pConfig);
 
     m_pLibrary = new Library(this, m_pConfig,
                              m_pPlayerManager,
@@ -34,7 +34,8 @@ RecordingManager::RecordingManager(ConfigObject<ConfigValue>* pConfig, EngineMas
     // Register EngineRecord with the engine sidechain.
     EngineSideChain* pSidechain = pEngine->getSideChain();
     if (pSidechain) {
-        EngineRecord* pEngineRecord = new EngineRecord(m_pConfig);
+        EngineRecord* pEngineRecord = new EngineRecord(
+                m_pConfig, pSidechain->getEncoderBus());
         connect(pEngineRecord, SIGNAL(isRecording(bool)),
                 this, SLOT(slotIsRecording(bool)));
         connect(pEngineRecord, SIGNAL(bytesRecorded(int)),
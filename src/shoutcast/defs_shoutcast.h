@@ -2,6 +2,11 @@
 #define DEFS_SHOUTCAST_H
 
 #define SHOUTCAST_PREF_KEY "[Shoutcast]"
+// Number of mount points streamed to. Targets after the first one read their
+// settings from [Shoutcast2], [Shoutcast3], ... and fall back to the value in
+// [Shoutcast] for every key that is not set there.
+#define SHOUTCAST_TARGET_COUNT_KEY "target_count"
+#define SHOUTCAST_MAX_TARGETS 4
 #define SHOUTCAST_DEFAULT_PORT "8000"
 
 #define SHOUTCAST_CHANNELS_STEREO 2
@@ -4,13 +4,40 @@
 #include "engine/sidechain/engineshoutcast.h"
 #include "engine/sidechain/enginesidechain.h"
 #include "engine/enginemaster.h"
+#include "controlobjectslave.h"
+#include "util/math.h"
 
 ShoutcastManager::ShoutcastManager(ConfigObject<ConfigValue>* pConfig,
                                    EngineMaster* pEngine)
-        : m_pConfig(pConfig) {
+        : m_pConfig(pConfig),
+          m_pUpdateFromPrefs(NULL) {
     EngineSideChain* pSidechain = pEngine->getSideChain();
-    if (pSidechain) {
-        pSidechain->addSideChainWorker(new EngineShoutcast(pConfig));
+    if (!pSidechain) {
+        return;
+    }
+
+    // All targets share the sidechain feed and the encoder bus, so targets
+    // with the same format and bitrate share one encoder.
+    int targetCount = m_pConfig->getValueString(
+            ConfigKey(SHOUTCAST_PREF_KEY, SHOUTCAST_TARGET_COUNT_KEY),
+            "1").toInt();
+    targetCount = math_clamp(targetCount, 1, SHOUTCAST_MAX_TARGETS);
+    for (int i = 0; i < targetCount; ++i) {
+        QString group = i == 0 ? QString(SHOUTCAST_PREF_KEY)
+                               : QString("[Shoutcast%1]").arg(i + 1);
+        pSidechain->addSideChainWorker(new EngineShoutcast(
+                pConfig, pSidechain->getEncoderBus(), group));
+        if (i > 0) {
+            m_targetUpdateFromPrefs.append(
+                    new ControlObjectSlave(group, "update_from_prefs", this));
+        }
+    }
+
+    if (!m_targetUpdateFromPrefs.isEmpty()) {
+        m_pUpdateFromPrefs = new ControlObjectSlave(
+                SHOUTCAST_PREF_KEY, "update_from_prefs", this);
+        m_pUpdateFromPrefs->connectValueChanged(
+                SLOT(slotUpdateFromPrefs(double)));
     }
 }
 
@@ -24,6 +51,16 @@ void ShoutcastManager::setEnabled(bool value) {
                    ConfigValue(value));
 }
 
+void ShoutcastManager::slotUpdateFromPrefs(double value) {
+    // The first target resets the control once it has read the preferences.
+    if (value <= 0.0) {
+        return;
+    }
+    foreach (ControlObjectSlave* pUpdate, m_targetUpdateFromPrefs) {
+        pUpdate->set(1.0);
+    }
+}
+
 bool ShoutcastManager::isEnabled() {
     return m_pConfig->getValueString(
         ConfigKey(SHOUTCAST_PREF_KEY, "enabled")).toInt() == 1;
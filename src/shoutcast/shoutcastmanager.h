@@ -1,10 +1,12 @@
 #ifndef SHOUTCASTMANAGER_H
 #define SHOUTCASTMANAGER_H
 
+#include <QList>
 #include <QObject>
 
 #include "configobject.h"
 
+class ControlObjectSlave;
 class EngineMaster;
 
 class ShoutcastManager : public QObject {
@@ -24,8 +26,14 @@ class ShoutcastManager : public QObject {
   signals:
     void shoutcastEnabled(bool);
 
+  private slots:
+    // Passes a preferences update on to the targets after the first one.
+    void slotUpdateFromPrefs(double value);
+
   private:
     ConfigObject<ConfigValue>* m_pConfig;
+    ControlObjectSlave* m_pUpdateFromPrefs;
+    QList<ControlObjectSlave*> m_targetUpdateFromPrefs;
 };
 
 
@@ -1858,6 +1858,11 @@ void LegacySkinParser::setupConnections(QDomNode node, WBaseWidget* pWidget) {
                 emitOption |= ControlParameterWidgetConnection::EMIT_DEFAULT;
             }
 
+            // Controls the engine changes on every callback, like VU meters,
+            // only need to reach the widget once per frame.
+            bool onGuiTick = false;
+            m_pContext->hasNodeSelectBool(con, "OnGuiTick", &onGuiTick);
+
             // Connect control proxy to widget. Parented to pWidget so it is not
             // leaked.
             ControlObjectSlave* pControlWidget = new ControlObjectSlave(
@@ -1865,7 +1870,8 @@ void LegacySkinParser::setupConnections(QDomNode node, WBaseWidget* pWidget) {
             ControlParameterWidgetConnection* pConnection = new ControlParameterWidgetConnection(
                     pWidget, pControlWidget, pTransformer,
                     static_cast<ControlParameterWidgetConnection::DirectionOption>(directionOption),
-                    static_cast<ControlParameterWidgetConnection::EmitOption>(emitOption));
+                    static_cast<ControlParameterWidgetConnection::EmitOption>(emitOption),
+                    onGuiTick);
 
             // If we created this control, bind it to the
             // ControlWidgetConnection so that it is deleted when the connection
@@ -68,6 +68,21 @@ SoundDevicePortAudio::SoundDevicePortAudio(ConfigObject<ConfigValue> *config, So
     m_iNumInputChannels = m_deviceInfo->maxInputChannels;
     m_iNumOutputChannels = m_deviceInfo->maxOutputChannels;
 
+    // Register the stat keys of the callbacks now so they don't build
+    // strings on the audio thread.
+    m_callbackProcessTraceKey = TraceKey(QString(
+            "SoundDevicePortAudio::callbackProcess %1").arg(m_strInternalName));
+    m_callbackProcessDriftTraceKey = TraceKey(QString(
+            "SoundDevicePortAudio::callbackProcessDrift %1").arg(m_strInternalName));
+    m_callbackProcessClkRefTraceKey = TraceKey(QString(
+            "SoundDevicePortAudio::callbackProcessClkRef %1").arg(m_strInternalName));
+    m_inputStatKey = StatKey(QString(
+            "SoundDevicePortAudio::callbackProcess input %1").arg(m_strInternalName));
+    m_prepareStatKey = StatKey(QString(
+            "SoundDevicePortAudio::callbackProcess prepare %1").arg(m_strInternalName));
+    m_outputStatKey = StatKey(QString(
+            "SoundDevicePortAudio::callbackProcess output %1").arg(m_strInternalName));
+
     m_pMasterAudioLatencyOverloadCount = new ControlObjectSlave("[Master]", "audio_latency_overload_count");
     m_pMasterAudioLatencyUsage = new ControlObjectSlave("[Master]", "audio_latency_usage");
     m_pMasterAudioLatencyOverload  = new ControlObjectSlave("[Master]", "audio_latency_overload");
@@ -572,7 +587,7 @@ int SoundDevicePortAudio::callbackProcessDrift(const unsigned int framesPerBuffe
                                           const PaStreamCallbackTimeInfo *timeInfo,
                                           PaStreamCallbackFlags statusFlags) {
     Q_UNUSED(timeInfo);
-    Trace trace("SoundDevicePortAudio::callbackProcessDrift %1", getInternalName());
+    Trace trace(m_callbackProcessDriftTraceKey);
 
     if (statusFlags & (paOutputUnderflow | paInputOverflow)) {
         m_underflowHappend = 1;
@@ -700,7 +715,7 @@ int SoundDevicePortAudio::callbackProcess(const unsigned int framesPerBuffer,
                                           const PaStreamCallbackTimeInfo *timeInfo,
                                           PaStreamCallbackFlags statusFlags) {
     Q_UNUSED(timeInfo);
-    Trace trace("SoundDevicePortAudio::callbackProcess %1", getInternalName());
+    Trace trace(m_callbackProcessTraceKey);
 
     if (statusFlags & (paOutputUnderflow | paInputOverflow)) {
         m_underflowHappend = 1;
@@ -755,7 +770,7 @@ int SoundDevicePortAudio::callbackProcessClkRef(const unsigned int framesPerBuff
     PerformanceTimer timer;
     timer.start();
 
-    Trace trace("SoundDevicePortAudio::callbackProcessClkRef %1", getInternalName());
+    Trace trace(m_callbackProcessClkRefTraceKey);
 
     //qDebug() << "SoundDevicePortAudio::callbackProcess:" << getInternalName();
     // Turn on TimeCritical priority for the callback thread. If we are running
@@ -821,7 +836,7 @@ int SoundDevicePortAudio::callbackProcessClkRef(const unsigned int framesPerBuff
 
     // Send audio from the soundcard's input off to the SoundManager...
     if (in) {
-        ScopedTimer t("SoundDevicePortAudio::callbackProcess input %1", getInternalName());
+        ScopedTimer t(m_inputStatKey);
         composeInputBuffer(in, framesPerBuffer, 0,
                            m_inputParams.channelCount);
         m_pSoundManager->pushInputBuffers(m_audioInputs, m_framesPerBuffer);
@@ -830,12 +845,12 @@ int SoundDevicePortAudio::callbackProcessClkRef(const unsigned int framesPerBuff
     m_pSoundManager->readProcess();
 
     {
-        ScopedTimer t("SoundDevicePortAudio::callbackProcess prepare %1", getInternalName());
+        ScopedTimer t(m_prepareStatKey);
         m_pSoundManager->onDeviceOutputCallback(framesPerBuffer);
     }
 
     if (out) {
-        ScopedTimer t("SoundDevicePortAudio::callbackProcess output %1", getInternalName());
+        ScopedTimer t(m_outputStatKey);
 
         if (m_outputParams.channelCount <= 0) {
             qWarning() << "SoundDevicePortAudio::callbackProcess m_outputParams channel count is zero or less:" << m_outputParams.channelCount;
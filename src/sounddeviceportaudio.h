@@ -23,6 +23,8 @@
 #include <QString>
 
 #include "sounddevice.h"
+#include "util/stat.h"
+#include "util/trace.h"
 
 #define CPU_USAGE_UPDATE_RATE 30 // in 1/s, fits to display frame rate
 #define CPU_OVERLOAD_DURATION 500 // in ms
@@ -99,6 +101,12 @@ class SoundDevicePortAudio : public SoundDevice {
     qint64 m_nsInAudioCb;
     int m_framesSinceAudioLatencyUsageUpdate;
     int m_syncBuffers;
+    TraceKey m_callbackProcessTraceKey;
+    TraceKey m_callbackProcessDriftTraceKey;
+    TraceKey m_callbackProcessClkRefTraceKey;
+    StatKey m_inputStatKey;
+    StatKey m_prepareStatKey;
+    StatKey m_outputStatKey;
 };
 
 // Wrapper function to call SoundDevicePortAudio::callbackProcess. Used by
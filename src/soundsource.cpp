@@ -27,6 +27,13 @@ namespace Mixxx
 namespace
 {
     const float BPM_ZERO = 0.0f;
+
+    // Size of the int16 scratch buffer used by the readFloat fallback.
+    const unsigned long kReadFloatFallbackChunk = 4096;
+
+    // Same conversion as SampleUtil::convertS16ToFloat32. Not shared since
+    // not all SoundSource plugins link against SampleUtil.
+    const CSAMPLE kS16ToFloat32Factor = 0x8000;
     const float BPM_MAX = 300.0f;
 
     float parseBpmString(const QString& sBpm) {
@@ -63,6 +70,27 @@ SoundSource::SoundSource(QString qFilename)
 SoundSource::~SoundSource() {
 }
 
+unsigned SoundSource::readFloat(unsigned long size, CSAMPLE* pDestination) {
+    SAMPLE buffer[kReadFloatFallbackChunk];
+    unsigned long samplesRead = 0;
+    while (samplesRead < size) {
+        const unsigned long samplesToRead =
+                math_min(size - samplesRead, kReadFloatFallbackChunk);
+        const unsigned samplesReadChunk = read(samplesToRead, buffer);
+        // note: LOOP VECTORIZED.
+        for (unsigned i = 0; i < samplesReadChunk; ++i) {
+            pDestination[samplesRead + i] =
+                    CSAMPLE(buffer[i]) / kS16ToFloat32Factor;
+        }
+        samplesRead += samplesReadChunk;
+        if (samplesReadChunk < samplesToRead) {
+            // EOF or error
+            break;
+        }
+    }
+    return samplesRead;
+}
+
 void SoundSource::setBpmString(QString sBpm) {
     if (!sBpm.isEmpty()) {
         float fBpm = parseBpmString(sBpm);
@@ -25,7 +25,7 @@
 #include <QString>
 #include <QSharedPointer>
 
-#define MIXXX_SOUNDSOURCE_API_VERSION 6
+#define MIXXX_SOUNDSOURCE_API_VERSION 7
 /** @note SoundSource API Version history:
            1 - Mixxx 1.8.0 Beta 2
            2 - Mixxx 1.9.0 Pre (added key code)
@@ -33,6 +33,7 @@
            4 - Mixxx 1.11.0 Pre (added composer field to SoundSource)
            5 - Mixxx 1.12.0 Pre (added album artist and grouping fields to SoundSource)
            6 - Mixxx 1.13.0 (added cover art suppport)
+           7 - Mixxx 1.13.0 (added readFloat for CSAMPLE output)
   */
 
 /** Getter function to be declared by all SoundSource plugins */
@@ -59,6 +60,13 @@ public:
     virtual Result open() = 0;
     virtual long seek(long) = 0;
     virtual unsigned read(unsigned long size, const SAMPLE*) = 0;
+    // Reads up to size samples from the current position as interleaved
+    // stereo CSAMPLEs in the range [-1.0, 1.0] and returns the number of
+    // samples actually read. Shares the read position with read(). Sources
+    // that decode to float or to more than 16 bits should override this to
+    // avoid the int16 round trip. The default implementation converts the
+    // output of read().
+    virtual unsigned readFloat(unsigned long size, CSAMPLE* pDestination);
     virtual long unsigned length() = 0;
     virtual Result parseHeader() = 0;
 
@@ -41,6 +41,11 @@ static QMutex ffmpegmutex;
 #define SOUNDSOURCEFFMPEG_CACHESIZE 1000
 #define SOUNDSOURCEFFMPEG_POSDISTANCE ((1024 * 1000) / 8)
 
+// Decoded audio is cached as interleaved stereo CSAMPLEs so that readFloat
+// does not lose precision. startByte/length in the cache objects and jump
+// points count samples, m_lCacheBytePos counts bytes.
+#define SOUNDSOURCEFFMPEG_BYTESPERSAMPLE ((quint64) sizeof(CSAMPLE))
+
 SoundSourceFFmpeg::SoundSourceFFmpeg(QString filename)
     : SoundSource(filename),
     m_iAudioStream(-1),
@@ -212,8 +217,8 @@ bool SoundSourceFFmpeg::readFramesToCache(unsigned int count, qint64 offset) {
 
                         // Add to cache and store byte place to memory
                         m_SCache.append(l_SObj);
-                        l_SObj->startByte = m_lCacheBytePos / 2;
-                        l_SObj->length = l_iRet / 2;
+                        l_SObj->startByte = m_lCacheBytePos / SOUNDSOURCEFFMPEG_BYTESPERSAMPLE;
+                        l_SObj->length = l_iRet / SOUNDSOURCEFFMPEG_BYTESPERSAMPLE;
                         m_lCacheBytePos += l_iRet;
 
                         // Ogg/Opus have packages pos that have many
@@ -230,14 +235,14 @@ bool SoundSourceFFmpeg::readFramesToCache(unsigned int count, qint64 offset) {
                             struct ffmpegLocationObject  *l_SJmp = (struct ffmpegLocationObject  *)malloc(
                                     sizeof(struct ffmpegLocationObject));
                             m_lLastStoredPos = m_lCacheBytePos;
-                            l_SJmp->startByte = m_lCacheBytePos / 2;
+                            l_SJmp->startByte = m_lCacheBytePos / SOUNDSOURCEFFMPEG_BYTESPERSAMPLE;
                             l_SJmp->pos = l_SPacket.pos;
                             l_SJmp->pts = l_SPacket.pts;
                             m_SJumpPoints.append(l_SJmp);
                             m_bUnique = false;
                         }
 
-                        if (offset < 0 || (quint64) offset <= (m_lCacheBytePos / 2)) {
+                        if (offset < 0 || (quint64) offset <= (m_lCacheBytePos / SOUNDSOURCEFFMPEG_BYTESPERSAMPLE)) {
                             l_iCount --;
                         }
                     } else {
@@ -323,7 +328,7 @@ bool SoundSourceFFmpeg::getBytesFromCache(char *buffer, quint64 offset,
 
         l_SObj = m_SCache[l_lPos];
 
-        l_lLeft = (size * 2);
+        l_lLeft = (size * SOUNDSOURCEFFMPEG_BYTESPERSAMPLE);
         memset(buffer, 0x00, l_lLeft);
         while (l_lLeft > 0) {
 
@@ -343,16 +348,16 @@ bool SoundSourceFFmpeg::getBytesFromCache(char *buffer, quint64 offset,
             }
 
             if (l_SObj->startByte <= offset) {
-                l_lOffset = (offset - l_SObj->startByte) * 2;
+                l_lOffset = (offset - l_SObj->startByte) * SOUNDSOURCEFFMPEG_BYTESPERSAMPLE;
             }
 
-            if (l_lOffset >= (l_SObj->length * 2)) {
+            if (l_lOffset >= (l_SObj->length * SOUNDSOURCEFFMPEG_BYTESPERSAMPLE)) {
                 l_SObj = m_SCache[++ l_lPos];
                 continue;
             }
 
-            if (l_lLeft > (l_SObj->length * 2)) {
-                l_lBytesToCopy = ((l_SObj->length * 2)  - l_lOffset);
+            if (l_lLeft > (l_SObj->length * SOUNDSOURCEFFMPEG_BYTESPERSAMPLE)) {
+                l_lBytesToCopy = ((l_SObj->length * SOUNDSOURCEFFMPEG_BYTESPERSAMPLE)  - l_lOffset);
                 memcpy(buffer, (l_SObj->bytes + l_lOffset), l_lBytesToCopy);
                 l_lOffset = 0;
                 buffer += l_lBytesToCopy;
@@ -438,7 +443,7 @@ Result SoundSourceFFmpeg::open() {
     }
 
     m_pResample = new EncoderFfmpegResample(m_pCodecCtx);
-    m_pResample->open(m_pCodecCtx->sample_fmt, AV_SAMPLE_FMT_S16);
+    m_pResample->open(m_pCodecCtx->sample_fmt, AV_SAMPLE_FMT_FLT);
 
     this->setChannels(m_pCodecCtx->channels);
     this->setSampleRate(m_pCodecCtx->sample_rate);
@@ -488,7 +493,7 @@ long SoundSourceFFmpeg::seek(long filepos) {
         if (filepos >= SOUNDSOURCEFFMPEG_POSDISTANCE) {
             for (i = 0; i < m_SJumpPoints.size(); i ++) {
                 if (m_SJumpPoints[i]->startByte >= (unsigned long) filepos && i > 2) {
-                    m_lCacheBytePos = m_SJumpPoints[i - 2]->startByte * 2;
+                    m_lCacheBytePos = m_SJumpPoints[i - 2]->startByte * SOUNDSOURCEFFMPEG_BYTESPERSAMPLE;
                     m_lStoredSeekPoint = m_SJumpPoints[i - 2]->pos;
                     break;
                 }
@@ -516,6 +521,23 @@ long SoundSourceFFmpeg::seek(long filepos) {
 
 unsigned int SoundSourceFFmpeg::read(unsigned long size,
                                      const SAMPLE * destination) {
+    if (m_readBuffer.size() < (int) size) {
+        m_readBuffer.resize(size);
+    }
+    unsigned int samplesRead = readFloat(size, m_readBuffer.data());
+
+    SAMPLE *l_pDest = const_cast<SAMPLE *>(destination);
+    const CSAMPLE *l_pSrc = m_readBuffer.constData();
+    for (unsigned int i = 0; i < samplesRead; ++i) {
+        l_pDest[i] = static_cast<SAMPLE>(math_clamp(
+                static_cast<int>(l_pSrc[i] * 0x8000),
+                static_cast<int>(SAMPLE_MIN), static_cast<int>(SAMPLE_MAX)));
+    }
+    return samplesRead;
+}
+
+unsigned int SoundSourceFFmpeg::readFloat(unsigned long size,
+                                          CSAMPLE * destination) {
 
     if (m_SCache.size() == 0) {
         // Make sure we allways start at begining and cache have some
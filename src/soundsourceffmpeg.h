@@ -70,6 +70,7 @@ public:
     Result open();
     long seek(long);
     unsigned int read(unsigned long size, const SAMPLE*);
+    unsigned int readFloat(unsigned long size, CSAMPLE*);
     Result parseHeader();
     QImage parseCoverArt();
     inline long unsigned length();
@@ -111,6 +112,9 @@ private:
     QVector<struct ffmpegLocationObject  *> m_SJumpPoints;
     quint64 m_lLastStoredPos;
     qint64 m_lStoredSeekPoint;
+
+    // Scratch buffer for converting the float cache to SAMPLEs in read().
+    QVector<CSAMPLE> m_readBuffer;
 };
 
 #endif
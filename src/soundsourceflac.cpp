@@ -35,7 +35,8 @@ SoundSourceFLAC::SoundSourceFLAC(QString filename)
     , m_flacBuffer(NULL)
     , m_flacBufferLength(0)
     , m_leftoverBuffer(NULL)
-    , m_leftoverBufferLength(0) {
+    , m_leftoverBufferLength(0)
+    , m_floatScale(CSAMPLE_ONE / 0x8000) {
     setType("flac");
 }
 
@@ -83,10 +84,10 @@ Result SoundSourceFLAC::open() {
     } // now number of samples etc. should be populated
     if (m_flacBuffer == NULL) {
         // we want 2 samples per frame, see ::flacWrite code -- bkgood
-        m_flacBuffer = new FLAC__int16[m_maxBlocksize * 2 /*m_iChannels*/];
+        m_flacBuffer = new FLAC__int32[m_maxBlocksize * 2 /*m_iChannels*/];
     }
     if (m_leftoverBuffer == NULL) {
-        m_leftoverBuffer = new FLAC__int16[m_maxBlocksize * 2 /*m_iChannels*/];
+        m_leftoverBuffer = new FLAC__int32[m_maxBlocksize * 2 /*m_iChannels*/];
     }
 //    qDebug() << "SSFLAC: Total samples: " << m_samples;
 //    qDebug() << "SSFLAC: Sampling rate: " << m_iSampleRate << " Hz";
@@ -116,8 +117,16 @@ long SoundSourceFLAC::seek(long filepos) {
 }
 
 unsigned int SoundSourceFLAC::read(unsigned long size, const SAMPLE *destination) {
+    return readSamples(size, const_cast<SAMPLE*>(destination));
+}
+
+unsigned int SoundSourceFLAC::readFloat(unsigned long size, CSAMPLE *destination) {
+    return readSamples(size, destination);
+}
+
+template<typename T>
+unsigned int SoundSourceFLAC::readSamples(unsigned long size, T *destBuffer) {
     if (!m_decoder) return 0;
-    SAMPLE *destBuffer(const_cast<SAMPLE*>(destination));
     unsigned int samplesWritten = 0;
     unsigned int i = 0;
     while (samplesWritten < size) {
@@ -133,7 +142,7 @@ unsigned int SoundSourceFLAC::read(unsigned long size, const SAMPLE *destination
                 break;
             }
         }
-        destBuffer[samplesWritten++] = m_flacBuffer[i++];
+        convertSample(m_flacBuffer[i++], &destBuffer[samplesWritten++]);
         --m_flacBufferLength;
     }
     if (m_flacBufferLength != 0) {
@@ -234,6 +243,19 @@ inline FLAC__int16 SoundSourceFLAC::shift(FLAC__int32 sample) const {
     }
 }
 
+inline void SoundSourceFLAC::convertSample(const FLAC__int32 sample,
+                                           SAMPLE* pDest) const {
+    *pDest = shift(sample);
+}
+
+/**
+ * Scale a sample from FLAC to the full precision CSAMPLE range.
+ */
+inline void SoundSourceFLAC::convertSample(const FLAC__int32 sample,
+                                           CSAMPLE* pDest) const {
+    *pDest = sample * m_floatScale;
+}
+
 // static
 QList<QString> SoundSourceFLAC::supportedFileExtensions() {
     QList<QString> list;
@@ -305,14 +327,14 @@ FLAC__StreamDecoderWriteStatus SoundSourceFLAC::flacWrite(
     if (frame->header.channels > 1) {
         // stereo (or greater)
         for (i = 0; i < frame->header.blocksize; ++i) {
-            m_flacBuffer[m_flacBufferLength++] = shift(buffer[0][i]); // left channel
-            m_flacBuffer[m_flacBufferLength++] = shift(buffer[1][i]); // right channel
+            m_flacBuffer[m_flacBufferLength++] = buffer[0][i]; // left channel
+            m_flacBuffer[m_flacBufferLength++] = buffer[1][i]; // right channel
         }
     } else {
         // mono
         for (i = 0; i < frame->header.blocksize; ++i) {
-            m_flacBuffer[m_flacBufferLength++] = shift(buffer[0][i]); // left channel
-            m_flacBuffer[m_flacBufferLength++] = shift(buffer[0][i]); // mono channel
+            m_flacBuffer[m_flacBufferLength++] = buffer[0][i]; // left channel
+            m_flacBuffer[m_flacBufferLength++] = buffer[0][i]; // mono channel
         }
     }
     return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE; // can't anticipate any errors here
@@ -329,6 +351,7 @@ void SoundSourceFLAC::flacMetadata(const FLAC__StreamMetadata *metadata) {
         m_maxBlocksize = metadata->data.stream_info.max_blocksize;
         m_minFramesize = metadata->data.stream_info.min_framesize;
         m_maxFramesize = metadata->data.stream_info.max_framesize;
+        m_floatScale = CSAMPLE_ONE / CSAMPLE(1LL << (m_bps - 1));
 //        qDebug() << "FLAC file " << getFilename();
 //        qDebug() << m_iChannels << " @ " << m_iSampleRate << " Hz, " << m_samples
 //            << " total, " << m_bps << " bps";
@@ -33,6 +33,7 @@ public:
     Result open();
     long seek(long filepos);
     unsigned read(unsigned long size, const SAMPLE *buffer);
+    unsigned readFloat(unsigned long size, CSAMPLE *buffer);
     inline long unsigned length();
     Result parseHeader();
     QImage parseCoverArt();
@@ -52,6 +53,11 @@ private:
     // they should only be used there -- bkgood
     inline int getShift() const;
     inline FLAC__int16 shift(const FLAC__int32 sample) const;
+    inline void convertSample(const FLAC__int32 sample, SAMPLE* pDest) const;
+    inline void convertSample(const FLAC__int32 sample, CSAMPLE* pDest) const;
+    // Shared implementation of read and readFloat.
+    template<typename T>
+    unsigned readSamples(unsigned long size, T* destBuffer);
     QFile m_file;
     FLAC__StreamDecoder *m_decoder;
     unsigned int m_samples; // total number of samples
@@ -65,11 +71,14 @@ private:
     unsigned int m_maxBlocksize;
     unsigned int m_minFramesize;
     unsigned int m_maxFramesize;
-    FLAC__int16 *m_flacBuffer; // buffer for the write callback to write a single frame's samples
+    // Samples are buffered as decoded by libFLAC (m_bps bits, not shifted)
+    // and only converted to the requested output format in read/readFloat.
+    FLAC__int32 *m_flacBuffer; // buffer for the write callback to write a single frame's samples
     unsigned int m_flacBufferLength;
-    FLAC__int16 *m_leftoverBuffer; // buffer to place any samples which haven't been used
+    FLAC__int32 *m_leftoverBuffer; // buffer to place any samples which haven't been used
                                    // at the end of a read call
     unsigned int m_leftoverBufferLength;
+    CSAMPLE m_floatScale; // 1 / 2^(m_bps - 1)
 };
 
 // callbacks for libFLAC
@@ -437,6 +437,22 @@ unsigned long SoundSourceMp3::discard(unsigned long samples_wanted) {
    samples actually read.
  */
 unsigned SoundSourceMp3::read(unsigned long samples_wanted, const SAMPLE * _destination)
+{
+    return readSamples(samples_wanted, const_cast<SAMPLE*>(_destination));
+}
+
+/*
+   read <size> samples into <destination> as float, and return the number of
+   samples actually read. mad's fixed point samples have 28 fractional bits
+   which are kept instead of being rounded to 16 bit.
+ */
+unsigned SoundSourceMp3::readFloat(unsigned long samples_wanted, CSAMPLE * destination)
+{
+    return readSamples(samples_wanted, destination);
+}
+
+template<typename T>
+unsigned SoundSourceMp3::readSamples(unsigned long samples_wanted, T * destination)
 {
     if (!isValid()) {
         qDebug() << "SSMP3: Error while reading " << getFilename();
@@ -451,7 +467,6 @@ unsigned SoundSourceMp3::read(unsigned long samples_wanted, const SAMPLE * _dest
     }
 //     qDebug() << "frame list " << m_qSeekList.count();
 
-    SAMPLE * destination = (SAMPLE *)_destination;
     unsigned Total_samples_decoded = 0;
     int i;
 
@@ -463,14 +478,14 @@ unsigned SoundSourceMp3::read(unsigned long samples_wanted, const SAMPLE * _dest
         for (i=rest; i<Synth->pcm.length && Total_samples_decoded < samples_wanted; i++)
         {
             // Left channel
-            *(destination++) = madScale(Synth->pcm.samples[0][i]);
+            madConvert(Synth->pcm.samples[0][i], destination++);
 
             /* Right channel. If the decoded stream is monophonic then
             * the right output channel is the same as the left one. */
             if (m_iChannels>1)
-                *(destination++) = madScale(Synth->pcm.samples[1][i]);
+                madConvert(Synth->pcm.samples[1][i], destination++);
             else
-                *(destination++) = madScale(Synth->pcm.samples[0][i]);
+                madConvert(Synth->pcm.samples[0][i], destination++);
 
             // This is safe because we have checked that samples_wanted is even.
             Total_samples_decoded += 2;
@@ -538,14 +553,14 @@ unsigned SoundSourceMp3::read(unsigned long samples_wanted, const SAMPLE * _dest
         for (i=0; i<no; i++)
         {
             // Left channel
-            *(destination++) = madScale(Synth->pcm.samples[0][i]);
+            madConvert(Synth->pcm.samples[0][i], destination++);
 
             /* Right channel. If the decoded stream is monophonic then
             * the right output channel is the same as the left one. */
             if (m_iChannels==2)
-                *(destination++) = madScale(Synth->pcm.samples[1][i]);
+                madConvert(Synth->pcm.samples[1][i], destination++);
             else
-                *(destination++) = madScale(Synth->pcm.samples[0][i]);
+                madConvert(Synth->pcm.samples[0][i], destination++);
         }
         Total_samples_decoded += 2*no;
 
@@ -672,3 +687,18 @@ inline signed int SoundSourceMp3::madScale(mad_fixed_t sample)
 
     return sample >> (MAD_F_FRACBITS + 1 - 16);
 }
+
+inline void SoundSourceMp3::madConvert(mad_fixed_t sample, SAMPLE* pDest)
+{
+    *pDest = madScale(sample);
+}
+
+inline void SoundSourceMp3::madConvert(mad_fixed_t sample, CSAMPLE* pDest)
+{
+    if (sample >= MAD_F_ONE)
+        sample = MAD_F_ONE - 1;
+    else if (sample < -MAD_F_ONE)
+        sample = -MAD_F_ONE;
+
+    *pDest = CSAMPLE(sample) / CSAMPLE(MAD_F_ONE);
+}
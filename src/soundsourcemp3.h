@@ -55,6 +55,7 @@ public:
     Result open();
     long seek(long);
     unsigned read(unsigned long size, const SAMPLE*);
+    unsigned readFloat(unsigned long size, CSAMPLE*);
     unsigned long discard(unsigned long size);
     /** Return the length of the file in samples. */
     inline long unsigned length();
@@ -69,6 +70,12 @@ private:
     int findFrame(int pos);
     /** Scale the mad sample to be in 16 bit range. */
     inline signed int madScale (mad_fixed_t sample);
+    /** Convert the mad sample to the output sample type. */
+    inline void madConvert(mad_fixed_t sample, SAMPLE* pDest);
+    inline void madConvert(mad_fixed_t sample, CSAMPLE* pDest);
+    /** Shared implementation of read and readFloat. */
+    template<typename T>
+    unsigned readSamples(unsigned long samples_wanted, T* destination);
     MadSeekFrameType* getSeekFrame(long frameIndex) const;
 
     // Returns true if the loaded file is valid and usable to read audio.
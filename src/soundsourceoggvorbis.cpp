@@ -265,6 +265,48 @@ inline long unsigned SoundSourceOggVorbis::length()
     return filelength;
 }
 
+/*
+   read <size> samples into <destination> as float, and return the number of
+   samples actually read. Uses ov_read_float so the decoder output is not
+   quantized to 16 bit.
+ */
+unsigned SoundSourceOggVorbis::readFloat(volatile unsigned long size, CSAMPLE * destination) {
+    if (size % 2 != 0) {
+        qDebug() << "SoundSourceOggVorbis got non-even size in readFloat.";
+        size--;
+    }
+
+    CSAMPLE *dest = destination;
+
+    // ov_read_float speaks frames and returns one non-interleaved buffer per
+    // channel. Mono streams are written to both output channels, streams with
+    // more than two channels only contribute their first two.
+    unsigned long framesNeeded = size / 2;
+    unsigned long framesRead = 0;
+
+    while (framesNeeded > 0) {
+        float** pcm = NULL;
+        long ret = ov_read_float(&vf, &pcm, framesNeeded, &current_section);
+
+        if (ret <= 0) {
+            // An error or EOF occured, break out and return what we have sofar.
+            break;
+        }
+
+        const float* left = pcm[0];
+        const float* right = channels > 1 ? pcm[1] : pcm[0];
+        for (long i = 0; i < ret; ++i) {
+            *dest++ = left[i];
+            *dest++ = right[i];
+        }
+
+        framesRead += ret;
+        framesNeeded -= ret;
+    }
+
+    return framesRead * 2;
+}
+
 QList<QString> SoundSourceOggVorbis::supportedFileExtensions()
 {
     QList<QString> list;
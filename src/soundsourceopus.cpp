@@ -171,6 +171,41 @@ unsigned SoundSourceOpus::read(volatile unsigned long size, const SAMPLE * desti
     return l_iReaded;
 }
 
+/*
+   read <size> samples into <destination> as float, and return the number of
+   samples actually read. libopusfile decodes to float internally so this
+   skips the int16 conversion.
+ */
+
+unsigned SoundSourceOpus::readFloat(unsigned long size, CSAMPLE * destination) {
+    if (size % 2 != 0) {
+        qDebug() << "SoundSourceOpus got non-even size in readFloat.";
+        size--;
+    }
+
+    float *l_fDest = destination;
+
+    unsigned int l_iNeeded = size;
+    unsigned int l_iReaded = 0;
+    int l_iRet = 0;
+
+    // loop until requested number of samples has been retrieved
+    while (l_iNeeded > 0) {
+        l_iRet = op_read_float_stereo(m_ptrOpusFile, l_fDest, l_iNeeded);
+
+        if (l_iRet <= 0) {
+            // An error or EOF occured, break out and return what we have sofar.
+            break;
+        }
+
+        l_iNeeded -= l_iRet * 2;
+        l_iReaded += l_iRet * 2;
+        l_fDest += l_iRet * 2;
+    }
+
+    return l_iReaded;
+}
+
 /*
    Parse the the file to get metadata
  */
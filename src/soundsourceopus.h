@@ -20,6 +20,7 @@ class SoundSourceOpus : public Mixxx::SoundSource {
     Result open();
     long seek(long);
     unsigned read(unsigned long size, const SAMPLE*);
+    unsigned readFloat(unsigned long size, CSAMPLE*);
     inline long unsigned length();
     Result parseHeader();
     QImage parseCoverArt();
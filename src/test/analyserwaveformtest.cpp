@@ -1,10 +1,13 @@
 #include <gtest/gtest.h>
 #include <QtDebug>
 #include <QDir>
+#include <vector>
 
 #include "trackinfoobject.h"
 #include "analyserwaveform.h"
+#include "analyserwaveformkernel.h"
 #include "test/mixxxtest.h"
+#include "util/timer.h"
 
 #define BIGBUF_SIZE (1024 * 1024)  //Megabyte
 #define CANARY_SIZE (1024*4)
@@ -95,4 +98,94 @@ TEST_F(AnalyserWaveformTest, wrongTotalSamples) {
         EXPECT_FLOAT_EQ(canaryBigBuf[i], CANARY_FLOAT);
     }
 }
+
+// Fills buffer with a few overlaid sines, so all three filter bands see some
+// signal, plus a bit of noise.
+void fillTestSignal(CSAMPLE* buffer, int size) {
+    for (int i = 0; i < size; i += 2) {
+        const double t = i / 2 / 44100.0;
+        const CSAMPLE noise = (rand() % 1000 - 500) / 10000.0f;
+        buffer[i] = 0.5 * sin(2 * M_PI * 80 * t) + 0.2 * sin(2 * M_PI * 1000 * t) +
+                0.1 * sin(2 * M_PI * 8000 * t) + noise;
+        buffer[i + 1] = -0.3 * sin(2 * M_PI * 120 * t) + 0.1 * sin(2 * M_PI * 6000 * t) -
+                noise;
+    }
+}
+
+// Every implementation of the kernel must give exactly the same peaks,
+// including for unaligned starts and odd frame counts.
+TEST_F(AnalyserWaveformTest, kernelMatchesScalar) {
+    const int size = 4096;
+    const CSAMPLE* pBuffers[AnalyserWaveformKernel::kStreamCount];
+    std::vector<CSAMPLE> streams[AnalyserWaveformKernel::kStreamCount];
+    for (int s = 0; s < AnalyserWaveformKernel::kStreamCount; ++s) {
+        streams[s].resize(size);
+        fillTestSignal(&streams[s][0], size);
+        pBuffers[s] = &streams[s][0];
+    }
+    // A NaN must never become a peak.
+    streams[AnalyserWaveformKernel::kMid][1001] =
+            std::numeric_limits<CSAMPLE>::quiet_NaN();
+
+    qDebug() << "Kernel:" << AnalyserWaveformKernel::implementationName();
+    const int starts[] = { 0, 2, 6, 1000 };
+    const int ends[] = { 2, 10, 14, 1002, 2050, size };
+    for (unsigned int s = 0; s < sizeof(starts) / sizeof(starts[0]); ++s) {
+        for (unsigned int e = 0; e < sizeof(ends) / sizeof(ends[0]); ++e) {
+            if (ends[e] <= starts[s]) {
+                continue;
+            }
+            CSAMPLE expected[AnalyserWaveformKernel::kStreamCount][2] = {
+                    { 0.0f, 0.0f }, { 0.0f, 0.0f }, { 0.0f, 0.0f }, { 0.0f, 0.0f } };
+            CSAMPLE actual[AnalyserWaveformKernel::kStreamCount][2] = {
+                    { 0.0f, 0.0f }, { 0.0f, 0.0f }, { 0.0f, 0.0f }, { 0.0f, 0.0f } };
+            AnalyserWaveformKernel::setForceScalar(true);
+            AnalyserWaveformKernel::accumulatePeaks(
+                    pBuffers, starts[s], ends[e], expected);
+            AnalyserWaveformKernel::setForceScalar(false);
+            AnalyserWaveformKernel::accumulatePeaks(
+                    pBuffers, starts[s], ends[e], actual);
+            EXPECT_EQ(0, memcmp(expected, actual, sizeof(expected)))
+                    << starts[s] << "-" << ends[e];
+        }
+    }
+}
+
+// Analyses the same signal with the scalar and the vectorised kernel. The
+// waveforms have to be bit-identical, the time taken by each is printed.
+TEST_F(AnalyserWaveformTest, kernelBenchmark) {
+    fillTestSignal(bigbuf, BIGBUF_SIZE);
+    const int blockSize = 4096;
+    std::vector<int> waveforms[2];
+    for (int pass = 0; pass < 2; ++pass) {
+        const bool forceScalar = pass == 0;
+        AnalyserWaveformKernel::setForceScalar(forceScalar);
+        TrackPointer pTrack(new TrackInfoObject("bar"));
+        pTrack->setSampleRate(44100);
+
+        Timer t("");
+        t.start();
+        aw->initialise(pTrack, pTrack->getSampleRate(), BIGBUF_SIZE);
+        for (int i = 0; i < BIGBUF_SIZE; i += blockSize) {
+            aw->process(&bigbuf[i], blockSize);
+        }
+        qint64 elapsed = t.elapsed(false);
+        qDebug() << AnalyserWaveformKernel::implementationName()
+                 << "waveform analysis" << elapsed << "ns" << BIGBUF_SIZE;
+
+        ConstWaveformPointer pWaveform = pTrack->getWaveform();
+        ConstWaveformPointer pSummary = pTrack->getWaveformSummary();
+        ASSERT_FALSE(pWaveform.isNull());
+        ASSERT_FALSE(pSummary.isNull());
+        for (int i = 0; i < pWaveform->getDataSize(); ++i) {
+            waveforms[pass].push_back(pWaveform->get(i).m_i);
+        }
+        for (int i = 0; i < pSummary->getDataSize(); ++i) {
+            waveforms[pass].push_back(pSummary->get(i).m_i);
+        }
+        aw->finalise(pTrack);
+    }
+    AnalyserWaveformKernel::setForceScalar(false);
+    EXPECT_TRUE(waveforms[0] == waveforms[1]);
+}
 }
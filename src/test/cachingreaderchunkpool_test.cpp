@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <QtDebug>
+
+#include "mixxxtest.h"
+#include "cachingreaderchunkpool.h"
+
+namespace {
+
+class CachingReaderChunkPoolTest : public MixxxTest {
+  protected:
+    virtual void SetUp() {
+        // 8 MiB of 64 KiB chunks.
+        config()->set(ConfigKey("[Master]", "CachingReaderMemoryMiB"),
+                      ConfigValue(8));
+        m_pPool = CachingReaderChunkPool::acquire(config());
+    }
+
+    virtual void TearDown() {
+        CachingReaderChunkPool::release(m_pPool);
+    }
+
+    CachingReaderChunkPool* m_pPool;
+};
+
+TEST_F(CachingReaderChunkPoolTest, SharedBetweenReaders) {
+    CachingReaderChunkPool* pOther = CachingReaderChunkPool::acquire(NULL);
+    EXPECT_EQ(m_pPool, pOther);
+    CachingReaderChunkPool::release(pOther);
+    EXPECT_EQ(128, m_pPool->chunkCount());
+}
+
+TEST_F(CachingReaderChunkPoolTest, TakeAndReturnAllChunks) {
+    QList<Chunk*> chunks;
+    for (int i = 0; i < m_pPool->chunkCount(); ++i) {
+        Chunk* pChunk = m_pPool->takeChunk();
+        ASSERT_TRUE(pChunk != NULL);
+        EXPECT_EQ(Chunk::FREE, pChunk->state);
+        EXPECT_FALSE(chunks.contains(pChunk));
+        chunks.append(pChunk);
+    }
+    EXPECT_TRUE(m_pPool->takeChunk() == NULL);
+
+    foreach (Chunk* pChunk, chunks) {
+        m_pPool->returnChunk(pChunk);
+    }
+    Chunk* pChunk = m_pPool->takeChunk();
+    EXPECT_TRUE(pChunk != NULL);
+    m_pPool->returnChunk(pChunk);
+}
+
+TEST_F(CachingReaderChunkPoolTest, PlayingReaderGetsBiggerQuota) {
+    // One playing deck and four idle decks.
+    m_pPool->adjustWeight(CachingReaderChunkPool::kPlayingWeight);
+    m_pPool->adjustWeight(4 * CachingReaderChunkPool::kIdleWeight);
+
+    const int playingQuota =
+            m_pPool->quotaForWeight(CachingReaderChunkPool::kPlayingWeight);
+    const int idleQuota =
+            m_pPool->quotaForWeight(CachingReaderChunkPool::kIdleWeight);
+    EXPECT_EQ(64, playingQuota);
+    EXPECT_EQ(16, idleQuota);
+    EXPECT_LE(playingQuota + 4 * idleQuota, m_pPool->chunkCount());
+
+    // A deck without a track still gets the minimum.
+    EXPECT_EQ(16, m_pPool->quotaForWeight(0));
+
+    m_pPool->adjustWeight(-CachingReaderChunkPool::kPlayingWeight);
+    m_pPool->adjustWeight(-4 * CachingReaderChunkPool::kIdleWeight);
+}
+
+}  // namespace
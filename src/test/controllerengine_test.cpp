@@ -10,6 +10,7 @@
 #include "configobject.h"
 #include "controllers/controllerengine.h"
 #include "test/mixxxtest.h"
+#include "util/timer.h"
 
 namespace {
 
@@ -257,4 +258,106 @@ TEST_F(ControllerEngineTest, automaticReaction) {
     co->set(2.5);
 }
 
+TEST_F(ControllerEngineTest, scriptControlHandle) {
+    ScopedTemporaryFile script(makeTemporaryFile(
+        "handleSetValue = function() {\n"
+        "    var co = engine.getControl('[Channel1]', 'co');\n"
+        "    co.setValue(co.getValue() + 1);\n"
+        "};\n"
+        "handleUnknown = function() {\n"
+        "    return engine.getControl('[Nothing]', 'nothing') === null;\n"
+        "};\n"));
+
+    cEngine->evaluate(script->fileName());
+    EXPECT_FALSE(cEngine->hasErrors(script->fileName()));
+
+    ScopedControl co(new ControlObject(ConfigKey("[Channel1]", "co")));
+    co->set(1.0);
+    EXPECT_TRUE(cEngine->execute("handleSetValue"));
+    EXPECT_DOUBLE_EQ(2.0, co->get());
+    EXPECT_TRUE(cEngine->execute("handleUnknown"));
+}
+
+// A handle from engine.getControl(), as a jog wheel script would use it,
+// reads and writes the same control as engine.getValue/setValue.
+TEST_F(ControllerEngineTest, controlHandleMatchesGetSetValue) {
+    ScopedTemporaryFile script(makeTemporaryFile(
+        "byName = function() {\n"
+        "    for (var i = 0; i < 1000; ++i) {\n"
+        "        engine.setValue('[Channel1]', 'co',\n"
+        "                        engine.getValue('[Channel1]', 'co') + 1);\n"
+        "    }\n"
+        "};\n"
+        "byHandle = function() {\n"
+        "    var co = engine.getControl('[Channel1]', 'co');\n"
+        "    for (var i = 0; i < 1000; ++i) {\n"
+        "        co.setValue(co.getValue() + 1);\n"
+        "    }\n"
+        "};\n"));
+
+    cEngine->evaluate(script->fileName());
+    EXPECT_FALSE(cEngine->hasErrors(script->fileName()));
+
+    ScopedControl co(new ControlObject(ConfigKey("[Channel1]", "co")));
+    co->set(0.0);
+
+    EXPECT_TRUE(cEngine->execute("byName"));
+    EXPECT_DOUBLE_EQ(1000.0, co->get());
+
+    // The handle continues where the lookups by name stopped.
+    EXPECT_TRUE(cEngine->execute("byHandle"));
+    EXPECT_DOUBLE_EQ(2000.0, co->get());
+
+    // And sees changes made from C++ in between.
+    co->set(-500.0);
+    EXPECT_TRUE(cEngine->execute("byHandle"));
+    EXPECT_DOUBLE_EQ(500.0, co->get());
+}
+
+// Compares looking up the control by name on every call with a handle from
+// engine.getControl(), as a jog wheel script would use them.
+TEST_F(ControllerEngineTest, controlHandleBenchmark) {
+    ScopedTemporaryFile script(makeTemporaryFile(
+        "byName = function() {\n"
+        "    for (var i = 0; i < 100000; ++i) {\n"
+        "        engine.setValue('[Channel1]', 'co',\n"
+        "                        engine.getValue('[Channel1]', 'co') + 1);\n"
+        "    }\n"
+        "};\n"
+        "byHandle = function() {\n"
+        "    var co = engine.getControl('[Channel1]', 'co');\n"
+        "    for (var i = 0; i < 100000; ++i) {\n"
+        "        co.setValue(co.getValue() + 1);\n"
+        "    }\n"
+        "};\n"));
+
+    cEngine->evaluate(script->fileName());
+    EXPECT_FALSE(cEngine->hasErrors(script->fileName()));
+
+    ScopedControl co(new ControlObject(ConfigKey("[Channel1]", "co")));
+    co->set(0.0);
+
+    qint64 elapsed;
+    Timer t("");
+    t.start();
+
+    EXPECT_TRUE(cEngine->execute("byName"));
+
+    elapsed = t.elapsed(false);
+    qDebug() << "engine.getValue/setValue" << elapsed / 100000
+             << "ns per call";
+    EXPECT_DOUBLE_EQ(100000.0, co->get());
+
+//#########
+
+    t.start();
+
+    EXPECT_TRUE(cEngine->execute("byHandle"));
+
+    elapsed = t.elapsed(false);
+    qDebug() << "control handle getValue/setValue" << elapsed / 100000
+             << "ns per call";
+    EXPECT_DOUBLE_EQ(200000.0, co->get());
+}
+
 }
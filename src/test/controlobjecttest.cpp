@@ -2,6 +2,8 @@
 #include <QtDebug>
 
 #include "controlobject.h"
+#include "controlobjectslave.h"
+#include "waveform/guitick.h"
 
 namespace {
 
@@ -68,4 +70,38 @@ TEST_F(ControlObjectTest, aliasRetrieval) {
     EXPECT_EQ(ControlObject::getControl(ckAlias), co);
 }
 
+TEST_F(ControlObjectTest, guiTickDeliversLatestValueOnce) {
+    // Every delivery sets the counter control, which counts all sets.
+    ControlObject counter(ConfigKey("[Test]", "deliveries"), false);
+    QSharedPointer<ControlDoublePrivate> pCounter =
+            ControlDoublePrivate::getControl(counter.getKey());
+    ControlObjectSlave target(counter.getKey());
+    ControlObjectSlave source(ck1);
+    ASSERT_TRUE(source.connectValueChangedOnGuiTick(
+            &target, SLOT(slotSet(double))));
+    const int deliveries = pCounter->changeCount();
+
+    GuiTick::deliverControlChanges();
+    EXPECT_EQ(deliveries, pCounter->changeCount());
+
+    for (int i = 1; i <= 100; ++i) {
+        co1->set(i);
+    }
+    EXPECT_EQ(deliveries, pCounter->changeCount());
+    GuiTick::deliverControlChanges();
+    EXPECT_EQ(deliveries + 1, pCounter->changeCount());
+    EXPECT_DOUBLE_EQ(100.0, counter.get());
+
+    // Sets that change nothing are not delivered.
+    co1->set(100.0);
+    GuiTick::deliverControlChanges();
+    EXPECT_EQ(deliveries + 1, pCounter->changeCount());
+
+    co1->set(1.0);
+    co2->set(2.0);
+    GuiTick::deliverControlChanges();
+    EXPECT_EQ(deliveries + 2, pCounter->changeCount());
+    EXPECT_DOUBLE_EQ(1.0, counter.get());
+}
+
 }
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include <QSet>
+#include <QThread>
+
+#include "effects/effectprocessor.h"
+#include "engine/channelhandle.h"
+#include "sampleutil.h"
+
+namespace {
+
+// Counts which thread created each state.
+struct CountingGroupState {
+    CountingGroupState()
+            : processed(0) {
+        ++s_iCreated;
+        if (QThread::currentThread() != s_pMainThread) {
+            ++s_iCreatedOutsideMainThread;
+        }
+    }
+
+    int processed;
+
+    static int s_iCreated;
+    static int s_iCreatedOutsideMainThread;
+    static QThread* s_pMainThread;
+};
+
+int CountingGroupState::s_iCreated = 0;
+int CountingGroupState::s_iCreatedOutsideMainThread = 0;
+QThread* CountingGroupState::s_pMainThread = NULL;
+
+class CountingEffect : public PerChannelEffectProcessor<CountingGroupState> {
+  public:
+    void processChannel(const ChannelHandle& handle,
+                        CountingGroupState* pState,
+                        const CSAMPLE* pInput, CSAMPLE* pOutput,
+                        const unsigned int numSamples,
+                        const unsigned int sampleRate,
+                        const EffectProcessor::EnableState enableState,
+                        const GroupFeatureState& groupFeatures) {
+        Q_UNUSED(handle);
+        Q_UNUSED(sampleRate);
+        Q_UNUSED(enableState);
+        Q_UNUSED(groupFeatures);
+        ++pState->processed;
+        SampleUtil::copyWithGain(pOutput, pInput, 0.5, numSamples);
+    }
+};
+
+// Processes on a thread of its own, like the engine does.
+class EngineThread : public QThread {
+  public:
+    EngineThread(EffectProcessor* pProcessor,
+                 const QList<ChannelHandle>& handles)
+            : m_pProcessor(pProcessor),
+              m_handles(handles) {
+    }
+
+  protected:
+    void run() {
+        CSAMPLE buffer[kSamples];
+        SampleUtil::fill(buffer, 1.0, kSamples);
+        GroupFeatureState features;
+        for (int i = 0; i < kCallbacks; ++i) {
+            foreach (const ChannelHandle& handle, m_handles) {
+                m_pProcessor->process(handle, buffer, buffer, kSamples, 44100,
+                                      EffectProcessor::ENABLED, features);
+            }
+        }
+    }
+
+  public:
+    static const int kSamples = 128;
+    static const int kCallbacks = 100;
+
+  private:
+    EffectProcessor* m_pProcessor;
+    QList<ChannelHandle> m_handles;
+};
+
+class EffectProcessorTest : public testing::Test {
+  protected:
+    EffectProcessorTest()
+            : m_master(m_factory.getOrCreateHandle("[Master]"), "[Master]"),
+              m_headphone(m_factory.getOrCreateHandle("[Headphone]"),
+                          "[Headphone]") {
+        CountingGroupState::s_iCreated = 0;
+        CountingGroupState::s_iCreatedOutsideMainThread = 0;
+        CountingGroupState::s_pMainThread = QThread::currentThread();
+        m_registeredChannels << m_master << m_headphone;
+    }
+
+    ChannelHandleFactory m_factory;
+    ChannelHandleAndGroup m_master;
+    ChannelHandleAndGroup m_headphone;
+    QSet<ChannelHandleAndGroup> m_registeredChannels;
+};
+
+TEST_F(EffectProcessorTest, EngineNeverCreatesState) {
+    CountingEffect effect;
+    effect.initialize(m_registeredChannels);
+    EXPECT_EQ(2, CountingGroupState::s_iCreated);
+
+    // A channel that was never registered is passed through untouched.
+    ChannelHandle sampler = m_factory.getOrCreateHandle("[Sampler1]");
+    EngineThread engine(&effect, QList<ChannelHandle>()
+                        << m_master.handle() << m_headphone.handle()
+                        << sampler);
+    engine.start();
+    engine.wait();
+
+    EXPECT_EQ(2, CountingGroupState::s_iCreated);
+    EXPECT_EQ(0, CountingGroupState::s_iCreatedOutsideMainThread);
+
+    CSAMPLE input[4] = { 1.0, 1.0, 1.0, 1.0 };
+    CSAMPLE output[4] = { 0.0, 0.0, 0.0, 0.0 };
+    GroupFeatureState features;
+    effect.process(sampler, input, output, 4, 44100,
+                   EffectProcessor::ENABLED, features);
+    EXPECT_FLOAT_EQ(1.0, output[0]);
+    EXPECT_EQ(2, CountingGroupState::s_iCreated);
+}
+
+TEST_F(EffectProcessorTest, LateChannelStateComesFromMainThread) {
+    CountingEffect effect;
+    effect.initialize(m_registeredChannels);
+
+    ChannelHandle sampler = m_factory.getOrCreateHandle("[Sampler1]");
+    EffectChannelState* pState = effect.createChannelState();
+    ASSERT_TRUE(pState != NULL);
+    EXPECT_EQ(3, CountingGroupState::s_iCreated);
+    EXPECT_TRUE(effect.addChannelState(sampler, pState));
+
+    // A second state for the same channel is refused and stays with the
+    // caller.
+    EffectChannelState* pDuplicate = effect.createChannelState();
+    EXPECT_FALSE(effect.addChannelState(sampler, pDuplicate));
+    EXPECT_FALSE(effect.addChannelState(m_master.handle(), pDuplicate));
+    delete pDuplicate;
+
+    EngineThread engine(&effect, QList<ChannelHandle>() << sampler);
+    engine.start();
+    engine.wait();
+
+    EXPECT_EQ(4, CountingGroupState::s_iCreated);
+    EXPECT_EQ(0, CountingGroupState::s_iCreatedOutsideMainThread);
+
+    CSAMPLE input[4] = { 1.0, 1.0, 1.0, 1.0 };
+    CSAMPLE output[4] = { 0.0, 0.0, 0.0, 0.0 };
+    GroupFeatureState features;
+    effect.process(sampler, input, output, 4, 44100,
+                   EffectProcessor::ENABLED, features);
+    EXPECT_FLOAT_EQ(0.5, output[0]);
+}
+
+}  // namespace
@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+
+#include <QByteArray>
+#include <QList>
+#include <QVector>
+#include <cmath>
+
+#include "encoder/encodercallback.h"
+#include "engine/sidechain/encoderbus.h"
+
+namespace {
+
+class ByteSink : public EncoderCallback {
+  public:
+    void write(unsigned char* header, unsigned char* body,
+               int headerLen, int bodyLen) {
+        data.append(reinterpret_cast<const char*>(header), headerLen);
+        data.append(reinterpret_cast<const char*>(body), bodyLen);
+    }
+    QByteArray data;
+};
+
+class EncoderBusTest : public testing::Test {
+  protected:
+    EncoderBusTest()
+            : m_buffer(2048),
+              m_iFrame(0) {
+        m_ogg.format = EncoderBus::Settings::OGG_VORBIS;
+        m_ogg.bitrate = 128;
+        m_ogg.samplerate = 44100;
+    }
+
+    // Feeds the bus a second of a stereo sine.
+    void processSecond(EncoderBus* pBus) {
+        for (int buffer = 0; buffer < 44100 / 1024; ++buffer) {
+            for (int i = 0; i < m_buffer.size(); i += 2, ++m_iFrame) {
+                m_buffer[i] = 0.5 * sin(m_iFrame * 0.05);
+                m_buffer[i + 1] = m_buffer[i];
+            }
+            pBus->process(m_buffer.constData(), m_buffer.size());
+        }
+    }
+
+    EncoderBus::Settings m_ogg;
+    QVector<CSAMPLE> m_buffer;
+    int m_iFrame;
+};
+
+TEST_F(EncoderBusTest, SinksShareOneEncoderPerSetting) {
+    EncoderBus bus;
+    EncoderBusSubscription* pFirst = bus.subscribe(m_ogg,
+                                                   SideChainWorker::DROP_NEWEST);
+    EncoderBusSubscription* pSecond = bus.subscribe(m_ogg,
+                                                    SideChainWorker::DROP_OLDEST);
+    ASSERT_TRUE(pFirst != NULL);
+    ASSERT_TRUE(pSecond != NULL);
+    EXPECT_EQ(1, bus.encoderCount());
+
+    EncoderBus::Settings lowBitrate = m_ogg;
+    lowBitrate.bitrate = 64;
+    EncoderBusSubscription* pThird = bus.subscribe(lowBitrate,
+                                                   SideChainWorker::DROP_NEWEST);
+    ASSERT_TRUE(pThird != NULL);
+    EXPECT_EQ(2, bus.encoderCount());
+
+    processSecond(&bus);
+    ByteSink first, second, third;
+    pFirst->drain(&first);
+    pSecond->drain(&second);
+    pThird->drain(&third);
+    EXPECT_TRUE(first.data.startsWith("OggS"));
+    EXPECT_EQ(first.data, second.data);
+    EXPECT_TRUE(third.data.startsWith("OggS"));
+    EXPECT_NE(first.data, third.data);
+
+    bus.unsubscribe(pThird);
+    delete pThird;
+    EXPECT_EQ(1, bus.encoderCount());
+
+    // Only the last subscriber gets the end of the stream.
+    bus.unsubscribe(pSecond);
+    pSecond->drain(&second);
+    delete pSecond;
+    EXPECT_EQ(first.data, second.data);
+    bus.unsubscribe(pFirst);
+    pFirst->drain(&first);
+    delete pFirst;
+    EXPECT_LT(second.data.size(), first.data.size());
+    EXPECT_EQ(0, bus.encoderCount());
+}
+
+TEST_F(EncoderBusTest, LateSinkGetsTheOggHeaders) {
+    EncoderBus bus;
+    EncoderBusSubscription* pFirst = bus.subscribe(m_ogg,
+                                                   SideChainWorker::DROP_NEWEST);
+    ASSERT_TRUE(pFirst != NULL);
+    processSecond(&bus);
+    ByteSink first;
+    pFirst->drain(&first);
+
+    EncoderBusSubscription* pLate = bus.subscribe(m_ogg,
+                                                  SideChainWorker::DROP_NEWEST);
+    ASSERT_TRUE(pLate != NULL);
+    processSecond(&bus);
+    ByteSink late;
+    pFirst->drain(&first);
+    pLate->drain(&late);
+
+    // The late stream starts with the header pages of the first one, the
+    // first page being the 58 bytes of the Vorbis identification header.
+    ASSERT_TRUE(late.data.startsWith("OggS"));
+    EXPECT_EQ(first.data.left(58), late.data.left(58));
+    EXPECT_LT(late.data.size(), first.data.size());
+    // It then continues with the data both got.
+    EXPECT_TRUE(first.data.endsWith(late.data.right(1024)));
+
+    bus.unsubscribe(pLate);
+    delete pLate;
+    bus.unsubscribe(pFirst);
+    delete pFirst;
+}
+
+// Returns the number of Ogg pages in data, or -1 if data is not a sequence of
+// whole pages of a single logical stream.
+int countOggPages(const QByteArray& data) {
+    int pages = 0;
+    int offset = 0;
+    while (offset < data.size()) {
+        if (data.size() - offset < 27 || data.mid(offset, 4) != "OggS" ||
+                data.mid(offset + 14, 4) != data.mid(14, 4)) {
+            return -1;
+        }
+        const int segments = static_cast<unsigned char>(data[offset + 26]);
+        int pageSize = 27 + segments;
+        for (int i = 0; i < segments && offset + 27 + i < data.size(); ++i) {
+            pageSize += static_cast<unsigned char>(data[offset + 27 + i]);
+        }
+        offset += pageSize;
+        ++pages;
+    }
+    return offset == data.size() ? pages : -1;
+}
+
+TEST_F(EncoderBusTest, OverflowingLateSinkKeepsTheOggHeaders) {
+    EncoderBus bus;
+    m_ogg.bitrate = 320;
+    EncoderBusSubscription* pFirst = bus.subscribe(m_ogg,
+                                                   SideChainWorker::DROP_NEWEST);
+    ASSERT_TRUE(pFirst != NULL);
+    processSecond(&bus);
+    ByteSink first;
+    pFirst->drain(&first);
+
+    // A stream that takes long to connect drains for the first time when its
+    // buffer has overflowed many times.
+    EncoderBusSubscription* pLate = bus.subscribe(m_ogg,
+                                                  SideChainWorker::DROP_OLDEST);
+    ASSERT_TRUE(pLate != NULL);
+    for (int i = 0; i < 10; ++i) {
+        processSecond(&bus);
+        pFirst->drain(&first);
+    }
+    ByteSink late;
+    pLate->drain(&late);
+    EXPECT_LT(0, pLate->droppedBytes());
+    processSecond(&bus);
+    pLate->drain(&late);
+
+    // The backlog is dropped, but not the header pages in front of it.
+    ASSERT_TRUE(late.data.startsWith("OggS"));
+    EXPECT_EQ(first.data.left(58), late.data.left(58));
+    EXPECT_LT(3, countOggPages(late.data));
+    EXPECT_LT(late.data.size(), first.data.size());
+
+    bus.unsubscribe(pLate);
+    delete pLate;
+    bus.unsubscribe(pFirst);
+    delete pFirst;
+}
+
+TEST_F(EncoderBusTest, DifferentSettingsEncodeInParallel) {
+    EncoderBus bus;
+    QList<EncoderBusSubscription*> subscriptions;
+    for (int bitrate = 64; bitrate <= 192; bitrate += 64) {
+        EncoderBus::Settings settings = m_ogg;
+        settings.bitrate = bitrate;
+        subscriptions.append(bus.subscribe(settings,
+                                           SideChainWorker::DROP_NEWEST));
+        ASSERT_TRUE(subscriptions.last() != NULL);
+    }
+    EXPECT_EQ(3, bus.encoderCount());
+
+    processSecond(&bus);
+    processSecond(&bus);
+
+    // Every sink gets the whole pages of its own stream only.
+    foreach (EncoderBusSubscription* pSubscription, subscriptions) {
+        bus.unsubscribe(pSubscription);
+        ByteSink sink;
+        pSubscription->drain(&sink);
+        EXPECT_EQ(0, pSubscription->droppedBytes());
+        EXPECT_LT(3, countOggPages(sink.data));
+        delete pSubscription;
+    }
+    EXPECT_EQ(0, bus.encoderCount());
+}
+
+}  // namespace
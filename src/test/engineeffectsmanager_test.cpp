@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+
+#include <QList>
+#include <QPair>
+#include <QScopedPointer>
+#include <QSharedPointer>
+#include <QVector>
+
+#include "effects/effectinstantiator.h"
+#include "effects/effectmanifest.h"
+#include "effects/effectprocessor.h"
+#include "engine/channelhandle.h"
+#include "engine/effects/engineeffect.h"
+#include "engine/effects/engineeffectchain.h"
+#include "engine/effects/engineeffectrack.h"
+#include "engine/effects/engineeffectsmanager.h"
+#include "engine/realtimeworkerpool.h"
+#include "sampleutil.h"
+#include "util/defs.h"
+
+namespace {
+
+struct CallCountGroupState {
+    CallCountGroupState() : calls(0) { }
+    int calls;
+};
+
+// Scales by a gain that depends on how often the channel was processed, so
+// the output shows if the state of two channels got mixed up.
+class CallCountEffect : public PerChannelEffectProcessor<CallCountGroupState> {
+  public:
+    CallCountEffect(EngineEffect* pEffect, const EffectManifest& manifest) {
+        Q_UNUSED(pEffect);
+        Q_UNUSED(manifest);
+    }
+
+    void processChannel(const ChannelHandle& handle,
+                        CallCountGroupState* pState,
+                        const CSAMPLE* pInput, CSAMPLE* pOutput,
+                        const unsigned int numSamples,
+                        const unsigned int sampleRate,
+                        const EffectProcessor::EnableState enableState,
+                        const GroupFeatureState& groupFeatures) {
+        Q_UNUSED(sampleRate);
+        Q_UNUSED(enableState);
+        Q_UNUSED(groupFeatures);
+        ++pState->calls;
+        SampleUtil::copyWithGain(pOutput, pInput,
+                                 1.0 / (pState->calls + handle.handle()),
+                                 numSamples);
+    }
+};
+
+// An EngineEffectsManager with one rack, one chain and one effect, enabled
+// for kChannels channels.
+class EffectsEngine {
+  public:
+    static const int kChannels = 6;
+
+    EffectsEngine()
+            : m_pRack(new EngineEffectRack(0)),
+              m_pChain(new EngineEffectChain("org.mixxx.test.chain")) {
+        QPair<EffectsRequestPipe*, EffectsResponsePipe*> pipes =
+                TwoWayMessagePipe<EffectsRequest*, EffectsResponse>::makeTwoWayMessagePipe(
+                    2048, 2048, false, false);
+        m_pRequestPipe.reset(pipes.first);
+        m_pManager.reset(new EngineEffectsManager(pipes.second));
+
+        for (int i = 0; i < kChannels; ++i) {
+            m_channels.append(ChannelHandleAndGroup(
+                    m_factory.getOrCreateHandle(QString("[Channel%1]").arg(i + 1)),
+                    QString("[Channel%1]").arg(i + 1)));
+        }
+
+        EffectManifest manifest;
+        manifest.setId("org.mixxx.test.callcount");
+        manifest.setName("Call count");
+        m_pEffect.reset(new EngineEffect(
+                manifest, QSet<ChannelHandleAndGroup>::fromList(m_channels),
+                EffectInstantiatorPointer(
+                        new EffectProcessorInstantiator<CallCountEffect>())));
+
+        foreach (const ChannelHandleAndGroup& channel, m_channels) {
+            EffectsRequest* pRequest = newRequest(EffectsRequest::REGISTER_CHANNEL);
+            pRequest->channel = channel.handle();
+            pRequest->RegisterChannel.pScratchBuffer =
+                    SampleUtil::alloc(MAX_BUFFER_LEN);
+        }
+
+        EffectsRequest* pRequest = newRequest(EffectsRequest::ADD_EFFECT_RACK);
+        pRequest->AddEffectRack.pRack = m_pRack.data();
+
+        pRequest = newRequest(EffectsRequest::ADD_CHAIN_TO_RACK);
+        pRequest->pTargetRack = m_pRack.data();
+        pRequest->AddChainToRack.pChain = m_pChain.data();
+        pRequest->AddChainToRack.iIndex = 0;
+
+        pRequest = newRequest(EffectsRequest::ADD_EFFECT_TO_CHAIN);
+        pRequest->pTargetChain = m_pChain.data();
+        pRequest->AddEffectToChain.pEffect = m_pEffect.data();
+        pRequest->AddEffectToChain.iIndex = 0;
+
+        // A mix below 1 makes the chain use the scratch buffer.
+        pRequest = newRequest(EffectsRequest::SET_EFFECT_CHAIN_PARAMETERS);
+        pRequest->pTargetChain = m_pChain.data();
+        pRequest->SetEffectChainParameters.enabled = true;
+        pRequest->SetEffectChainParameters.insertion_type = EffectChain::INSERT;
+        pRequest->SetEffectChainParameters.mix = 0.75;
+
+        foreach (const ChannelHandleAndGroup& channel, m_channels) {
+            pRequest = newRequest(EffectsRequest::ENABLE_EFFECT_CHAIN_FOR_CHANNEL);
+            pRequest->pTargetChain = m_pChain.data();
+            pRequest->channel = channel.handle();
+        }
+
+        foreach (EffectsRequest* pRequest, m_requests) {
+            m_pRequestPipe->writeMessages(&pRequest, 1);
+        }
+    }
+
+    ~EffectsEngine() {
+        // Deletes the scratch buffers.
+        m_pManager.reset();
+        qDeleteAll(m_requests);
+    }
+
+    // Runs one callback over all channels and returns the output of each.
+    QVector<QVector<CSAMPLE> > callback(RealtimeWorkerPool* pPool) {
+        m_pManager->onCallbackStart();
+        EffectsResponse response;
+        while (m_pRequestPipe->readMessages(&response, 1) == 1) {
+            EXPECT_TRUE(response.success);
+        }
+
+        QVector<QVector<CSAMPLE> > buffers(kChannels);
+        for (int i = 0; i < kChannels; ++i) {
+            buffers[i].resize(kSamples);
+            SampleUtil::fill(buffers[i].data(), i + 1, kSamples);
+        }
+        ProcessTask task(this, &buffers);
+        if (pPool) {
+            pPool->parallelFor(&task, kChannels);
+        } else {
+            for (int i = 0; i < kChannels; ++i) {
+                task.runItem(i);
+            }
+        }
+        return buffers;
+    }
+
+  private:
+    static const int kSamples = 512;
+
+    class ProcessTask : public RealtimeTask {
+      public:
+        ProcessTask(EffectsEngine* pEngine,
+                    QVector<QVector<CSAMPLE> >* pBuffers)
+                : m_pEngine(pEngine),
+                  m_pBuffers(pBuffers) {
+        }
+        void runItem(int index) {
+            GroupFeatureState features;
+            m_pEngine->m_pManager->process(
+                    m_pEngine->m_channels[index].handle(),
+                    (*m_pBuffers)[index].data(), kSamples, 44100, features);
+        }
+      private:
+        EffectsEngine* m_pEngine;
+        QVector<QVector<CSAMPLE> >* m_pBuffers;
+    };
+
+    EffectsRequest* newRequest(EffectsRequest::MessageType type) {
+        EffectsRequest* pRequest = new EffectsRequest();
+        pRequest->type = type;
+        pRequest->request_id = m_requests.size();
+        m_requests.append(pRequest);
+        return pRequest;
+    }
+
+    ChannelHandleFactory m_factory;
+    QList<ChannelHandleAndGroup> m_channels;
+    QScopedPointer<EffectsRequestPipe> m_pRequestPipe;
+    QScopedPointer<EngineEffectsManager> m_pManager;
+    QScopedPointer<EngineEffectRack> m_pRack;
+    QScopedPointer<EngineEffectChain> m_pChain;
+    QScopedPointer<EngineEffect> m_pEffect;
+    QList<EffectsRequest*> m_requests;
+};
+
+TEST(EngineEffectsManagerTest, ParallelMatchesSerial) {
+    EffectsEngine serial;
+    EffectsEngine parallel;
+    RealtimeWorkerPool pool(3);
+
+    // The first callbacks ramp the chain and the channels in.
+    for (int callback = 0; callback < 4; ++callback) {
+        QVector<QVector<CSAMPLE> > expected = serial.callback(NULL);
+        QVector<QVector<CSAMPLE> > actual = parallel.callback(&pool);
+        for (int i = 0; i < EffectsEngine::kChannels; ++i) {
+            ASSERT_EQ(expected[i], actual[i])
+                    << "callback " << callback << " channel " << i;
+        }
+    }
+}
+
+}  // namespace
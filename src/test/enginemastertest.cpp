@@ -415,4 +415,49 @@ TEST_F(EngineMasterTest, SingleChannelPFLOutputWorks) {
     AssertWholeBufferEquals(pHeadphoneBuffer, 0.1f, MAX_BUFFER_LEN);
 }
 
+TEST_F(EngineMasterTest, ParallelProcessingProcessesEveryChannelOnce) {
+    ControlObjectSlave parallelProcessing(
+            ConfigKey("[Master]", "parallel_processing"));
+    parallelProcessing.set(1.0);
+
+    const int kNumChannels = 8;
+    EngineChannelMock* channels[kNumChannels];
+    for (int i = 0; i < kNumChannels; ++i) {
+        QString group = QString("[Test%1]").arg(i + 1);
+        channels[i] = new EngineChannelMock(
+                group, EngineChannel::CENTER, m_pMaster);
+        m_pMaster->addChannel(channels[i]);
+
+        CSAMPLE* pChannelBuffer = const_cast<CSAMPLE*>(
+                m_pMaster->getChannelBuffer(group));
+        FillBuffer(pChannelBuffer, 0.125f, MAX_BUFFER_LEN);
+
+        // Instruct each channel to claim it is active, master and not PFL.
+        EXPECT_CALL(*channels[i], isActive())
+                .Times(1)
+                .WillOnce(Return(true));
+        EXPECT_CALL(*channels[i], isMasterEnabled())
+                .Times(1)
+                .WillOnce(Return(true));
+        EXPECT_CALL(*channels[i], isPflEnabled())
+                .Times(1)
+                .WillOnce(Return(false));
+
+        // Every channel must be processed exactly once no matter which
+        // thread picks it up, followed by exactly one postProcess.
+        EXPECT_CALL(*channels[i], process(_, MAX_BUFFER_LEN))
+                .Times(1)
+                .WillOnce(Return());
+        EXPECT_CALL(*channels[i], postProcess(MAX_BUFFER_LEN))
+                .Times(1)
+                .WillOnce(Return());
+    }
+
+    m_pMaster->process(MAX_BUFFER_LEN);
+
+    // Check that the master output contains the sum of the channel data.
+    const CSAMPLE* pMasterBuffer = m_pMaster->getMasterBuffer();
+    AssertWholeBufferEquals(pMasterBuffer, 1.0f, MAX_BUFFER_LEN);
+}
+
 }  // namespace
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include <QList>
+#include <QThread>
+#include <QTime>
+
+#include "engine/engineworker.h"
+#include "engine/engineworkerscheduler.h"
+
+namespace {
+
+// Never started, it only counts how often the scheduler woke it.
+class CountingWorker : public EngineWorker {
+  public:
+    int wakeups() const {
+        return m_semaRun.available();
+    }
+};
+
+// Signals a set of workers as ready, like the channels EngineMaster processes
+// in parallel do.
+class ProducerThread : public QThread {
+  public:
+    explicit ProducerThread(const QList<CountingWorker*>& workers)
+            : m_workers(workers) {
+    }
+
+  protected:
+    void run() {
+        foreach (CountingWorker* pWorker, m_workers) {
+            pWorker->workReady();
+        }
+    }
+
+  private:
+    QList<CountingWorker*> m_workers;
+};
+
+TEST(EngineWorkerSchedulerTest, ConcurrentWorkerReadyLosesNothing) {
+    const int kProducers = 4;
+    const int kWorkersPerProducer = MAX_ENGINE_WORKERS / kProducers - 1;
+    const int kRounds = 100;
+
+    EngineWorkerScheduler scheduler;
+    scheduler.start();
+    QList<CountingWorker*> workers;
+    QList<ProducerThread*> producers;
+    for (int i = 0; i < kProducers; ++i) {
+        QList<CountingWorker*> producerWorkers;
+        for (int j = 0; j < kWorkersPerProducer; ++j) {
+            CountingWorker* pWorker = new CountingWorker();
+            pWorker->setScheduler(&scheduler);
+            producerWorkers.append(pWorker);
+        }
+        workers.append(producerWorkers);
+        producers.append(new ProducerThread(producerWorkers));
+    }
+    // Wakes the scheduler again if it was not waiting yet when woken. Only
+    // one of its entries is in the FIFO at a time, so the FIFO never
+    // overflows.
+    CountingWorker spare;
+    spare.setScheduler(&scheduler);
+    int spareWrites = 0;
+
+    for (int round = 1; round <= kRounds; ++round) {
+        foreach (ProducerThread* pProducer, producers) {
+            pProducer->start();
+        }
+        foreach (ProducerThread* pProducer, producers) {
+            pProducer->wait();
+        }
+        scheduler.runWorkers();
+
+        QTime timeout;
+        timeout.start();
+        bool done = false;
+        while (!done && timeout.elapsed() < 5000) {
+            done = true;
+            foreach (CountingWorker* pWorker, workers) {
+                if (pWorker->wakeups() < round) {
+                    done = false;
+                    break;
+                }
+            }
+            if (!done) {
+                if (spare.wakeups() == spareWrites) {
+                    spare.workReady();
+                    ++spareWrites;
+                }
+                scheduler.runWorkers();
+                QThread::yieldCurrentThread();
+            }
+        }
+        foreach (CountingWorker* pWorker, workers) {
+            ASSERT_EQ(round, pWorker->wakeups());
+        }
+    }
+
+    qDeleteAll(producers);
+    qDeleteAll(workers);
+}
+
+}  // namespace
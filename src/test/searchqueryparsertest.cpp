@@ -668,3 +668,21 @@ TEST_F(SearchQueryParserTest, HumanReadableDurationSearchwithRangeFilter) {
         qPrintable(QString("(duration >= 150 AND duration <= 200)")),
         qPrintable(pQuery->toSql()));
 }
+
+TEST_F(SearchQueryParserTest, QueryRefines) {
+    // Extending the last term or adding a term only removes matches.
+    EXPECT_TRUE(SearchQueryParser::queryRefines("", "daft"));
+    EXPECT_TRUE(SearchQueryParser::queryRefines("daft", "daft"));
+    EXPECT_TRUE(SearchQueryParser::queryRefines("daft", "daft pu"));
+    EXPECT_TRUE(SearchQueryParser::queryRefines("daft p", "daft pu"));
+
+    // Removing text or changing a term does not.
+    EXPECT_FALSE(SearchQueryParser::queryRefines("daft pu", "daft p"));
+    EXPECT_FALSE(SearchQueryParser::queryRefines("daft", "deft"));
+
+    // Extending a filter or a negated term can match more tracks.
+    EXPECT_FALSE(SearchQueryParser::queryRefines("bpm:>1", "bpm:>12"));
+    EXPECT_FALSE(SearchQueryParser::queryRefines("-d", "-da"));
+    EXPECT_FALSE(SearchQueryParser::queryRefines("daft", "daft -p"));
+    EXPECT_FALSE(SearchQueryParser::queryRefines("daft", "daft key:"));
+}
@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+
+#include <QSemaphore>
+#include <QVector>
+
+#include "engine/sidechain/enginesidechain.h"
+#include "engine/sidechain/sidechainworker.h"
+#include "engine/sidechain/sidechainworkerthread.h"
+#include "sampleutil.h"
+
+namespace {
+
+const int kSamplesPerBuffer = 512;
+
+// Keeps every sample it gets. Blocks in its first process call until it is
+// shut down, like EngineShoutcast on a stalled connection.
+class StallingWorker : public SideChainWorker {
+  public:
+    StallingWorker(OverflowPolicy policy, QVector<CSAMPLE>* pReceived,
+                   QSemaphore* pStalled)
+            : m_policy(policy),
+              m_pReceived(pReceived),
+              m_pStalled(pStalled),
+              m_bStalled(false) {
+    }
+
+    void process(const CSAMPLE* pBuffer, const int iBufferSize) {
+        for (int i = 0; i < iBufferSize; ++i) {
+            m_pReceived->append(pBuffer[i]);
+        }
+        if (!m_bStalled) {
+            m_bStalled = true;
+            m_pStalled->release();
+            m_shutdown.acquire();
+        }
+    }
+    void shutdown() {
+        m_shutdown.release();
+    }
+    OverflowPolicy overflowPolicy() const {
+        return m_policy;
+    }
+
+  private:
+    const OverflowPolicy m_policy;
+    QVector<CSAMPLE>* m_pReceived;
+    QSemaphore* m_pStalled;
+    QSemaphore m_shutdown;
+    bool m_bStalled;
+};
+
+class CountingWorker : public SideChainWorker {
+  public:
+    explicit CountingWorker(int* pReceived)
+            : m_pReceived(pReceived) {
+    }
+    void process(const CSAMPLE* pBuffer, const int iBufferSize) {
+        Q_UNUSED(pBuffer);
+        *m_pReceived += iBufferSize;
+    }
+    void shutdown() {
+    }
+
+  private:
+    int* m_pReceived;
+};
+
+class SideChainWorkerThreadTest : public testing::Test {
+  protected:
+    SideChainWorkerThreadTest()
+            : m_iBuffersWritten(0) {
+        m_pBuffer = SampleUtil::alloc(kSamplesPerBuffer);
+    }
+    virtual ~SideChainWorkerThreadTest() {
+        SampleUtil::free(m_pBuffer);
+    }
+
+    // Writes a buffer filled with the number of buffers written before it.
+    void writeBuffer(SideChainWorkerThread* pThread) {
+        SampleUtil::fill(m_pBuffer, m_iBuffersWritten++, kSamplesPerBuffer);
+        pThread->writeSamples(m_pBuffer, kSamplesPerBuffer);
+    }
+
+    // Writes until the worker stalls, then fills its buffer a few times over.
+    // Returns the number of buffers written before the worker stalled.
+    int stallWorker(SideChainWorkerThread* pThread, QSemaphore* pStalled,
+                    int bufferSize) {
+        while (!pStalled->tryAcquire(1, 10)) {
+            writeBuffer(pThread);
+        }
+        int buffersBeforeStall = m_iBuffersWritten;
+        for (int i = 0; i < 4 * bufferSize / kSamplesPerBuffer; ++i) {
+            writeBuffer(pThread);
+        }
+        return buffersBeforeStall;
+    }
+
+    int samplesWritten() const {
+        return m_iBuffersWritten * kSamplesPerBuffer;
+    }
+
+    CSAMPLE* m_pBuffer;
+    int m_iBuffersWritten;
+};
+
+TEST_F(SideChainWorkerThreadTest, DropNewestKeepsTheBacklog) {
+    const int kBufferSize = 4096;
+    QVector<CSAMPLE> received;
+    QSemaphore stalled;
+    SideChainWorkerThread thread(
+            new StallingWorker(SideChainWorker::DROP_NEWEST, &received,
+                               &stalled),
+            kBufferSize);
+    stallWorker(&thread, &stalled, kBufferSize);
+    thread.stop();
+
+    EXPECT_LT(0, thread.overflows());
+    EXPECT_EQ(samplesWritten(), received.size() + thread.droppedSamples());
+    // Everything up to the gap arrives in order, including a full buffer of
+    // samples that were written while the worker stalled.
+    ASSERT_LE(kBufferSize, received.size());
+    for (int i = 0; i < received.size(); ++i) {
+        ASSERT_EQ(static_cast<CSAMPLE>(i / kSamplesPerBuffer), received[i])
+                << i;
+    }
+}
+
+TEST_F(SideChainWorkerThreadTest, DropOldestSkipsTheBacklog) {
+    const int kBufferSize = 4096;
+    QVector<CSAMPLE> received;
+    QSemaphore stalled;
+    SideChainWorkerThread thread(
+            new StallingWorker(SideChainWorker::DROP_OLDEST, &received,
+                               &stalled),
+            kBufferSize);
+    int buffersBeforeStall = stallWorker(&thread, &stalled, kBufferSize);
+    thread.stop();
+
+    EXPECT_LT(0, thread.overflows());
+    EXPECT_EQ(samplesWritten(), received.size() + thread.droppedSamples());
+    // Nothing written while the worker stalled arrives afterwards.
+    ASSERT_LT(0, received.size());
+    for (int i = 0; i < received.size(); ++i) {
+        ASSERT_GT(static_cast<CSAMPLE>(buffersBeforeStall), received[i]) << i;
+    }
+}
+
+TEST_F(SideChainWorkerThreadTest, StalledWorkerDoesNotDelayOthers) {
+    int counted = 0;
+    QVector<CSAMPLE> received;
+    QSemaphore stalled;
+    {
+        EngineSideChain sideChain(NULL);
+        sideChain.addSideChainWorker(new StallingWorker(
+                SideChainWorker::DROP_OLDEST, &received, &stalled));
+        sideChain.addSideChainWorker(new CountingWorker(&counted));
+
+        SampleUtil::fill(m_pBuffer, 0, kSamplesPerBuffer);
+        while (!stalled.tryAcquire(1, 10)) {
+            sideChain.writeSamples(m_pBuffer, kSamplesPerBuffer);
+            ++m_iBuffersWritten;
+        }
+        // Less than the sidechain buffers, so the counting worker can not
+        // overflow however late it runs.
+        for (int i = 0; i < 32; ++i) {
+            sideChain.writeSamples(m_pBuffer, kSamplesPerBuffer);
+            ++m_iBuffersWritten;
+        }
+        // Stops the workers after they processed their buffers.
+    }
+    EXPECT_EQ(samplesWritten(), counted);
+}
+
+}  // namespace
@@ -56,3 +56,43 @@ TEST_F(SoundSourceProxyTest, TOAL_TPE2) {
     EXPECT_EQ("ARTIST", p->getAlbum());
     EXPECT_EQ("TITLE", p->getAlbumArtist());
 }
+
+TEST_F(SoundSourceProxyTest, readFloatMatchesRead) {
+    const QString kCoverFilePath(
+            QDir::currentPath() + "/src/test/id3-test-data/cover-test.");
+
+    QStringList extensions;
+    extensions << "aiff" << "flac" << "mp3" << "ogg" << "wav";
+
+    const unsigned long kReadSize = 4096;
+    // Precision of the 16 bit path plus rounding differences between the
+    // decoders' own float and int16 output.
+    const CSAMPLE kTolerance = 2.0f / 0x8000;
+
+    foreach (const QString& extension, extensions) {
+        QString filePath = kCoverFilePath + extension;
+
+        Mixxx::SoundSourcePointer pReadSource(loadProxy(filePath));
+        ASSERT_TRUE(!pReadSource.isNull());
+        ASSERT_EQ(OK, pReadSource->open());
+        QScopedPointer<SoundSourceProxy> pReadProxy(m_pProxy.take());
+
+        Mixxx::SoundSourcePointer pReadFloatSource(loadProxy(filePath));
+        ASSERT_TRUE(!pReadFloatSource.isNull());
+        ASSERT_EQ(OK, pReadFloatSource->open());
+
+        SAMPLE samples[kReadSize];
+        CSAMPLE floatSamples[kReadSize];
+        unsigned samplesRead = pReadSource->read(kReadSize, samples);
+        unsigned floatSamplesRead = pReadFloatSource->readFloat(
+                kReadSize, floatSamples);
+        EXPECT_EQ(samplesRead, floatSamplesRead) << filePath;
+
+        unsigned differences = 0;
+        for (unsigned i = 0; i < math_min(samplesRead, floatSamplesRead); ++i) {
+            const CSAMPLE expected = CSAMPLE(samples[i]) / 0x8000;
+            differences += fabs(expected - floatSamples[i]) > kTolerance;
+        }
+        EXPECT_EQ(0U, differences) << filePath;
+    }
+}
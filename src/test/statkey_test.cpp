@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+
+#include "util/stat.h"
+#include "util/trace.h"
+
+namespace {
+
+TEST(StatKeyTest, SameTagSameKey) {
+    StatKey key1("StatKeyTest::key1");
+    StatKey key2("StatKeyTest::key2");
+    StatKey key1Again(QString("StatKeyTest::%1").arg("key1"));
+
+    EXPECT_TRUE(key1.isValid());
+    EXPECT_TRUE(key2.isValid());
+    EXPECT_NE(key1.id(), key2.id());
+    EXPECT_EQ(key1.id(), key1Again.id());
+
+    EXPECT_EQ(QString("StatKeyTest::key1"), key1.tag());
+    EXPECT_EQ(QString("StatKeyTest::key2"), StatKey::tagForId(key2.id()));
+}
+
+TEST(StatKeyTest, InvalidKey) {
+    StatKey key;
+    EXPECT_FALSE(key.isValid());
+    EXPECT_TRUE(key.tag().isNull());
+    // Reports under an invalid key are dropped.
+    EXPECT_FALSE(Stat::track(key, Stat::COUNTER, Stat::COUNT, 1.0));
+}
+
+TEST(StatKeyTest, TraceKey) {
+    TraceKey key("StatKeyTest::trace");
+    EXPECT_EQ(QString("StatKeyTest::trace"), key.key().tag());
+    EXPECT_EQ(QString("StatKeyTest::trace_duration"), key.durationKey().tag());
+}
+
+}  // namespace
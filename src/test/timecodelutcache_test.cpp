@@ -0,0 +1,139 @@
+#ifdef __VINYLCONTROL__
+
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QScopedPointer>
+#include <QTemporaryFile>
+#include <string.h>
+
+#include "vinylcontrol/timecodelutcache.h"
+
+namespace {
+
+class TimecodeLutCacheTest : public testing::Test {
+  protected:
+    virtual void TearDown() {
+        TimecodeLutCache::freeLookupTables();
+    }
+
+    static bool saveToTemporaryFile(const timecode_def& def,
+                                    QTemporaryFile* pFile) {
+        if (!pFile->open()) {
+            return false;
+        }
+        pFile->close();
+        return TimecodeLutCache::saveLookupTable(def, pFile->fileName());
+    }
+};
+
+// Checks that the table of loaded is a copy of the one of built, and that it
+// finds every timecode in the same slot.
+void expectTablesMatch(const timecode_def& built, timecode_def* pLoaded) {
+    ASSERT_TRUE(pLoaded->lookup);
+    EXPECT_NE(built.lut.table, pLoaded->lut.table);
+    ASSERT_EQ(built.lut.avail, pLoaded->lut.avail);
+    EXPECT_EQ(0, memcmp(built.lut.table, pLoaded->lut.table,
+                        LUT_HASHES * sizeof(slot_no_t)));
+    EXPECT_EQ(0, memcmp(built.lut.slot, pLoaded->lut.slot,
+                        built.lut.avail * sizeof(struct slot)));
+    for (slot_no_t i = 0; i < built.lut.avail; ++i) {
+        ASSERT_EQ(i, lut_lookup(&pLoaded->lut, built.lut.slot[i].timecode))
+                << built.name << " " << i;
+    }
+}
+
+TEST_F(TimecodeLutCacheTest, LoadedTablesMatchBuiltTables) {
+    const char* names[] = { "serato_2a", "traktor_a", "mixvibes_v2" };
+    for (unsigned int i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        timecode_def* pBuilt = timecoder_find_definition(names[i]);
+        ASSERT_TRUE(pBuilt != NULL);
+        QTemporaryFile file;
+        ASSERT_TRUE(saveToTemporaryFile(*pBuilt, &file));
+
+        timecode_def loaded = *pBuilt;
+        loaded.lookup = false;
+        QScopedPointer<QFile> pMapped(TimecodeLutCache::loadLookupTable(
+                &loaded, file.fileName()));
+        ASSERT_FALSE(pMapped.isNull());
+        expectTablesMatch(*pBuilt, &loaded);
+        lut_clear(&loaded.lut);
+    }
+}
+
+TEST_F(TimecodeLutCacheTest, RejectsOtherTables) {
+    timecode_def* pBuilt = timecoder_find_definition("serato_2b");
+    ASSERT_TRUE(pBuilt != NULL);
+    QTemporaryFile file;
+    ASSERT_TRUE(saveToTemporaryFile(*pBuilt, &file));
+
+    EXPECT_TRUE(TimecodeLutCache::loadLookupTable(
+            pBuilt, "/does/not/exist") == NULL);
+
+    // A changed definition needs a new table.
+    timecode_def changed = *pBuilt;
+    changed.lookup = false;
+    changed.seed ^= 1;
+    EXPECT_TRUE(TimecodeLutCache::loadLookupTable(
+            &changed, file.fileName()) == NULL);
+    EXPECT_FALSE(changed.lookup);
+    EXPECT_NE(TimecodeLutCache::lookupTableFilePath(*pBuilt, "dir"),
+              TimecodeLutCache::lookupTableFilePath(changed, "dir"));
+
+    timecode_def other = *timecoder_match_definition("serato_2a");
+    other.lookup = false;
+    EXPECT_TRUE(TimecodeLutCache::loadLookupTable(
+            &other, file.fileName()) == NULL);
+
+    QFile savedFile(file.fileName());
+    ASSERT_TRUE(savedFile.resize(savedFile.size() - 1));
+    timecode_def truncated = *pBuilt;
+    truncated.lookup = false;
+    EXPECT_TRUE(TimecodeLutCache::loadLookupTable(
+            &truncated, file.fileName()) == NULL);
+    EXPECT_FALSE(truncated.lookup);
+}
+
+TEST_F(TimecodeLutCacheTest, FindDefinitionBuildsOnce) {
+    QDir directory(QDir::temp().filePath(
+            QString("mixxx-timecodelutcache-test-%1").arg(
+                    QCoreApplication::applicationPid())));
+    TimecodeLutCache::freeLookupTables();
+    const QString fileName = TimecodeLutCache::lookupTableFilePath(
+            *timecoder_match_definition("traktor_b"), directory.path());
+    QFile::remove(fileName);
+
+    // The first use builds the table and saves it.
+    timecode_def* pDef = TimecodeLutCache::findDefinition(
+            "traktor_b", directory.path());
+    ASSERT_TRUE(pDef != NULL);
+    ASSERT_TRUE(pDef->lookup);
+    EXPECT_EQ(0, pDef->lut.external);
+    EXPECT_TRUE(QFile::exists(fileName));
+    timecode_def built = *pDef;
+    built.lut.table = new slot_no_t[LUT_HASHES];
+    built.lut.slot = new struct slot[pDef->lut.avail];
+    memcpy(built.lut.table, pDef->lut.table, LUT_HASHES * sizeof(slot_no_t));
+    memcpy(built.lut.slot, pDef->lut.slot,
+           pDef->lut.avail * sizeof(struct slot));
+
+    // Later uses map it.
+    TimecodeLutCache::freeLookupTables();
+    EXPECT_FALSE(pDef->lookup);
+    EXPECT_EQ(pDef, TimecodeLutCache::findDefinition(
+            "traktor_b", directory.path()));
+    EXPECT_EQ(1, pDef->lut.external);
+    expectTablesMatch(built, pDef);
+
+    delete [] built.lut.table;
+    delete [] built.lut.slot;
+    TimecodeLutCache::freeLookupTables();
+    EXPECT_TRUE(QFile::remove(fileName));
+    EXPECT_TRUE(QDir::temp().rmdir(directory.dirName()));
+}
+
+}  // namespace
+
+#endif  // __VINYLCONTROL__
@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+
+#include <QtDebug>
+#include <QHash>
+#include <QScopedPointer>
+#include <QSqlDatabase>
+#include <QVector>
+
+#include "library/columncache.h"
+#include "library/searchqueryparser.h"
+#include "library/trackindex.h"
+#include "util/timer.h"
+
+namespace {
+
+class TrackIndexTest : public testing::Test {
+  protected:
+    TrackIndexTest()
+            : m_columns(QStringList() << "id" << "artist" << "title"
+                        << "bpm" << "duration" << "rating" << "tracknumber"
+                        << "key_id"),
+              m_columnCache(m_columns),
+              m_index(m_columnCache, m_columns.size()),
+              m_parser(m_database) {
+        m_searchColumns << "artist" << "title";
+    }
+
+    int column(const QString& name) const {
+        return m_columnCache.fieldIndex(name);
+    }
+
+    void addTrack(int id, const QString& artist, const QString& title,
+                  double bpm, int rating, const QString& trackNumber) {
+        const int row = m_index.insertTrack(id);
+        m_index.setValue(row, column("id"), QVariant(static_cast<qlonglong>(id)));
+        m_index.setValue(row, column("artist"), artist);
+        m_index.setValue(row, column("title"), title);
+        m_index.setValue(row, column("bpm"), bpm);
+        m_index.setValue(row, column("duration"), QVariant(static_cast<qlonglong>(180 + id)));
+        m_index.setValue(row, column("rating"), QVariant(static_cast<qlonglong>(rating)));
+        m_index.setValue(row, column("tracknumber"), trackNumber);
+        m_index.setValue(row, column("key_id"), QVariant(static_cast<qlonglong>(id % 24 + 1)));
+    }
+
+    // Returns the track IDs matching query, sorted like BaseTrackCache does.
+    QList<int> search(const QString& query, const QString& sortColumn,
+                      Qt::SortOrder sortOrder = Qt::AscendingOrder) {
+        QScopedPointer<QueryNode> pQuery(
+                m_parser.parseQuery(query, m_searchColumns, ""));
+        EXPECT_TRUE(pQuery->canMatchIndex(m_index));
+        m_index.clearSearchCache();
+        const QVector<int>& rows = m_index.sortedRows(column(sortColumn));
+        QList<int> result;
+        for (int i = 0; i < rows.size(); ++i) {
+            const int row = sortOrder == Qt::AscendingOrder ?
+                    rows[i] : rows[rows.size() - 1 - i];
+            if (m_index.trackForRow(row) >= 0 &&
+                    pQuery->matchIndex(m_index, row)) {
+                result.append(m_index.trackForRow(row));
+            }
+        }
+        return result;
+    }
+
+    QStringList m_columns;
+    ColumnCache m_columnCache;
+    TrackIndex m_index;
+    QSqlDatabase m_database;
+    SearchQueryParser m_parser;
+    QStringList m_searchColumns;
+};
+
+TEST_F(TrackIndexTest, ValuesAreUnchanged) {
+    addTrack(1, "Artist", "Title", 128.5, 3, "01");
+    const int row = m_index.rowForTrack(1);
+    ASSERT_LE(0, row);
+
+    EXPECT_EQ(TrackIndex::COLUMN_INTEGER, m_index.columnType(column("rating")));
+    EXPECT_EQ(TrackIndex::COLUMN_DOUBLE, m_index.columnType(column("bpm")));
+    EXPECT_EQ(TrackIndex::COLUMN_STRING, m_index.columnType(column("artist")));
+
+    EXPECT_EQ(QVariant(static_cast<qlonglong>(3)),
+              m_index.value(row, column("rating")));
+    EXPECT_EQ(QVariant(128.5), m_index.value(row, column("bpm")));
+    EXPECT_EQ(QVariant(QString("Artist")), m_index.value(row, column("artist")));
+
+    // NULL stays NULL.
+    m_index.setValue(row, column("title"), QVariant(QVariant::String));
+    EXPECT_TRUE(m_index.value(row, column("title")).isNull());
+
+    // A value of another type turns the column into a QVariant column
+    // without changing any value.
+    m_index.setValue(row, column("bpm"), QString("fast"));
+    EXPECT_EQ(TrackIndex::COLUMN_VARIANT, m_index.columnType(column("bpm")));
+    EXPECT_EQ(QVariant(QString("fast")), m_index.value(row, column("bpm")));
+    EXPECT_EQ(QVariant(static_cast<qlonglong>(3)),
+              m_index.value(row, column("rating")));
+}
+
+TEST_F(TrackIndexTest, RemovedRowsAreReused) {
+    addTrack(1, "A", "A", 120, 1, "1");
+    addTrack(2, "B", "B", 120, 1, "2");
+    const int row = m_index.rowForTrack(1);
+    m_index.removeTrack(1);
+    EXPECT_EQ(-1, m_index.rowForTrack(1));
+    EXPECT_EQ(1, m_index.trackCount());
+
+    EXPECT_EQ(row, m_index.insertTrack(3));
+    // The new track starts without the values of the removed one.
+    EXPECT_TRUE(m_index.isNull(row, column("artist")));
+    EXPECT_EQ(2, m_index.rowCount());
+}
+
+TEST_F(TrackIndexTest, UnusedStringsAreDropped) {
+    addTrack(1, "Artist", "One", 120, 1, "1");
+    addTrack(2, "Artist", "Two", 120, 1, "1");
+    // "Artist", "One", "Two" and "1".
+    EXPECT_EQ(4, m_index.stringCount());
+
+    m_index.removeTrack(1);
+    EXPECT_EQ(3, m_index.stringCount());
+    const int row = m_index.rowForTrack(2);
+    m_index.setValue(row, column("title"), QString("Three"));
+    EXPECT_EQ(3, m_index.stringCount());
+    m_index.setValue(row, column("title"), QString("Three"));
+    EXPECT_EQ(3, m_index.stringCount());
+    m_index.setValue(row, column("artist"), QVariant(QVariant::String));
+    EXPECT_EQ(2, m_index.stringCount());
+
+    // A reused string ID is not mistaken for the dropped string.
+    EXPECT_EQ(QList<int>(), search("one", "id"));
+    addTrack(3, "Other", "Four", 120, 1, "1");
+    EXPECT_EQ(QList<int>() << 3, search("four", "id"));
+    EXPECT_EQ(QList<int>(), search("artist", "id"));
+    EXPECT_EQ(QVariant(QString("Three")), m_index.value(row, column("title")));
+}
+
+TEST_F(TrackIndexTest, TiesAreSortedByTrackId) {
+    addTrack(5, "Same", "x", 120, 1, "1");
+    addTrack(2, "Same", "x", 120, 1, "1");
+    addTrack(7, "Same", "x", 120, 1, "1");
+    // Track 9 reuses the row of track 5.
+    m_index.removeTrack(5);
+    addTrack(9, "Same", "x", 120, 1, "1");
+
+    EXPECT_EQ(QList<int>() << 2 << 7 << 9, search("", "artist"));
+    EXPECT_EQ(QList<int>() << 2 << 7 << 9, search("", "bpm"));
+}
+
+TEST_F(TrackIndexTest, Sort) {
+    addTrack(1, "beta", "x", 125.0, 2, "10");
+    addTrack(2, "Alpha", "x", 90.0, 5, "9");
+    addTrack(3, "gamma", "x", 174.0, 0, "1");
+    const int row = m_index.insertTrack(4);
+    m_index.setValue(row, column("title"), QString("x"));
+
+    // Strings are sorted case-insensitively with NULL first.
+    EXPECT_EQ(QList<int>() << 4 << 2 << 1 << 3, search("", "artist"));
+    EXPECT_EQ(QList<int>() << 3 << 1 << 2 << 4,
+              search("", "artist", Qt::DescendingOrder));
+    EXPECT_EQ(QList<int>() << 4 << 2 << 1 << 3, search("", "bpm"));
+    // Track numbers are sorted as numbers.
+    EXPECT_EQ(QList<int>() << 4 << 3 << 2 << 1, search("", "tracknumber"));
+
+    // Changing a value drops the cached order.
+    m_index.setValue(m_index.rowForTrack(3), column("artist"), QString("Aardvark"));
+    EXPECT_EQ(QList<int>() << 4 << 3 << 2 << 1, search("", "artist"));
+}
+
+TEST_F(TrackIndexTest, Search) {
+    addTrack(1, "Daft Punk", "Around the World", 121.0, 5, "1");
+    addTrack(2, "Deadmau5", "Strobe", 128.0, 4, "2");
+    addTrack(3, "DAFT punk", "One More Time", 123.0, 3, "3");
+
+    EXPECT_EQ(QList<int>() << 1 << 3, search("daft", "id"));
+    EXPECT_EQ(QList<int>() << 3, search("daft time", "id"));
+    EXPECT_EQ(QList<int>() << 2, search("-punk", "id"));
+    EXPECT_EQ(QList<int>() << 2 << 3, search("bpm:>122", "id"));
+    EXPECT_EQ(QList<int>() << 1 << 3, search("bpm:120-125", "id"));
+    EXPECT_EQ(QList<int>() << 1 << 2, search("rating:>3", "id"));
+    EXPECT_EQ(QList<int>() << 2, search("title:strobe", "id"));
+}
+
+// Compares the old per-track QVariant cache with TrackIndex on a library of
+// 120000 tracks: filtering by a search term and sorting by artist.
+TEST_F(TrackIndexTest, Benchmark) {
+    const int kTracks = 120000;
+    QHash<int, QVector<QVariant> > trackInfo;
+    for (int i = 1; i <= kTracks; ++i) {
+        const QString artist = QString("Artist %1").arg(i % 5000);
+        const QString title = QString("Title %1").arg(i);
+        addTrack(i, artist, title, 80.0 + i % 100, i % 6,
+                 QString::number(i % 20));
+        QVector<QVariant>& record = trackInfo[i];
+        record.resize(m_columns.size());
+        for (int c = 0; c < m_columns.size(); ++c) {
+            record[c] = m_index.value(m_index.rowForTrack(i), c);
+        }
+    }
+
+    const QString term = "12";
+    const int artistColumn = column("artist");
+    const int titleColumn = column("title");
+
+    Timer t("");
+    t.start();
+    QList<QPair<QString, int> > variantResult;
+    for (QHash<int, QVector<QVariant> >::const_iterator it = trackInfo.begin();
+         it != trackInfo.end(); ++it) {
+        const QVector<QVariant>& record = it.value();
+        if (record[artistColumn].toString().contains(term, Qt::CaseInsensitive) ||
+                record[titleColumn].toString().contains(term, Qt::CaseInsensitive)) {
+            variantResult.append(qMakePair(record[artistColumn].toString().toLower(),
+                                           it.key()));
+        }
+    }
+    qSort(variantResult);
+    qint64 elapsed = t.elapsed(false);
+    qDebug() << "QVariant cache search and sort" << elapsed << "ns"
+             << variantResult.size();
+
+    // The first search also sorts the column and interns the search term.
+    t.start();
+    QList<int> indexResult = search(term, "artist");
+    elapsed = t.elapsed(false);
+    qDebug() << "TrackIndex first search and sort" << elapsed << "ns"
+             << indexResult.size();
+
+    t.start();
+    indexResult = search(term, "artist");
+    elapsed = t.elapsed(false);
+    qDebug() << "TrackIndex search and sort" << elapsed << "ns"
+             << indexResult.size();
+
+    EXPECT_EQ(variantResult.size(), indexResult.size());
+}
+
+}  // namespace
@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <QtDebug>
+#include <QFile>
+#include <QScopedPointer>
+#include <QTemporaryFile>
+
+#include "waveform/waveform.h"
+#include "util/math.h"
+#include "util/timer.h"
+
+namespace {
+
+class WaveformTest : public testing::Test {
+  protected:
+    // Returns a waveform of a track of the given length in seconds, like
+    // AnalyserWaveform creates it.
+    static Waveform* createWaveform(int seconds) {
+        Waveform* pWaveform = new Waveform(44100, 44100 * 2 * seconds, 441, -1);
+        WaveformData* pData = pWaveform->data();
+        for (int i = 0; i < pWaveform->getDataSize(); ++i) {
+            pData[i].filtered.all = static_cast<unsigned char>(i);
+            pData[i].filtered.low = static_cast<unsigned char>(i * 3);
+            pData[i].filtered.mid = static_cast<unsigned char>(i * 5);
+            pData[i].filtered.high = static_cast<unsigned char>(i * 7);
+        }
+        pWaveform->setCompletion(pWaveform->getDataSize());
+        return pWaveform;
+    }
+
+    static bool writeFile(const Waveform& waveform, QTemporaryFile* pFile) {
+        if (!pFile->open()) {
+            return false;
+        }
+        bool success = waveform.writeFile(pFile);
+        pFile->close();
+        return success;
+    }
+};
+
+TEST_F(WaveformTest, MapFileRoundTrip) {
+    QScopedPointer<Waveform> pWaveform(createWaveform(60));
+    QTemporaryFile file;
+    ASSERT_TRUE(writeFile(*pWaveform, &file));
+
+    QScopedPointer<Waveform> pMapped(Waveform::mapFile(file.fileName()));
+    ASSERT_FALSE(pMapped.isNull());
+    EXPECT_TRUE(pMapped->isMapped());
+    EXPECT_FALSE(pWaveform->isMapped());
+    EXPECT_EQ(pWaveform->getDataSize(), pMapped->getDataSize());
+    EXPECT_EQ(pWaveform->getTextureStride(), pMapped->getTextureStride());
+    EXPECT_EQ(pWaveform->getTextureSize(), pMapped->getTextureSize());
+    EXPECT_DOUBLE_EQ(pWaveform->getVisualSampleRate(),
+                     pMapped->getVisualSampleRate());
+    EXPECT_DOUBLE_EQ(pWaveform->getAudioVisualRatio(),
+                     pMapped->getAudioVisualRatio());
+    EXPECT_EQ(pWaveform->getDataSize(), pMapped->getCompletion());
+    for (int i = 0; i < pWaveform->getTextureSize(); ++i) {
+        ASSERT_EQ(pWaveform->get(i).m_i, pMapped->get(i).m_i) << i;
+    }
+}
+
+TEST_F(WaveformTest, MapFileRejectsBadFiles) {
+    EXPECT_TRUE(Waveform::mapFile("/does/not/exist") == NULL);
+
+    QTemporaryFile garbage;
+    ASSERT_TRUE(garbage.open());
+    garbage.write(QByteArray(4096, 'x'));
+    garbage.close();
+    EXPECT_TRUE(Waveform::mapFile(garbage.fileName()) == NULL);
+
+    QScopedPointer<Waveform> pWaveform(createWaveform(10));
+    QTemporaryFile truncated;
+    ASSERT_TRUE(writeFile(*pWaveform, &truncated));
+    ASSERT_TRUE(truncated.resize(truncated.size() / 2));
+    EXPECT_TRUE(Waveform::mapFile(truncated.fileName()) == NULL);
+}
+
+// Checks every entry of every level against the data it covers.
+void expectLevelsMatchData(const Waveform& waveform) {
+    const int frames = waveform.getDataSize() / 2;
+    ASSERT_LT(1, waveform.getLevelCount());
+    EXPECT_EQ(2, waveform.getLevelDataSize(waveform.getLevelCount() - 1));
+    for (int level = 1; level < waveform.getLevelCount(); ++level) {
+        const WaveformData* pLevel = waveform.levelData(level);
+        const int framesPerEntry = 1 << level;
+        ASSERT_EQ((frames + framesPerEntry - 1) / framesPerEntry * 2,
+                  waveform.getLevelDataSize(level));
+        for (int i = 0; i < waveform.getLevelDataSize(level); ++i) {
+            const int channel = i % 2;
+            unsigned char maxLow = 0;
+            unsigned char maxAll = 0;
+            for (int frame = (i / 2) * framesPerEntry;
+                 frame < frames && frame < (i / 2 + 1) * framesPerEntry;
+                 ++frame) {
+                maxLow = math_max(maxLow, waveform.getLow(frame * 2 + channel));
+                maxAll = math_max(maxAll, waveform.getAll(frame * 2 + channel));
+            }
+            ASSERT_EQ(maxLow, pLevel[i].filtered.low) << level << " " << i;
+            ASSERT_EQ(maxAll, pLevel[i].filtered.all) << level << " " << i;
+        }
+    }
+}
+
+TEST_F(WaveformTest, LevelsAreBuiltIncrementally) {
+    // An odd number of frames leaves a partial entry in every level.
+    QScopedPointer<Waveform> pWaveform(new Waveform(44100, 617300, 441, -1));
+    ASSERT_EQ(1, (pWaveform->getDataSize() / 2) % 2);
+    WaveformData* pData = pWaveform->data();
+    // Fill and complete the waveform a few frames at a time, like
+    // AnalyserWaveform does.
+    for (int i = 0; i < pWaveform->getDataSize(); i += 2) {
+        pData[i].filtered.low = static_cast<unsigned char>((i * 37) % 251);
+        pData[i].filtered.all = static_cast<unsigned char>((i * 11) % 241);
+        pData[i + 1].filtered.low = static_cast<unsigned char>((i * 13) % 239);
+        pData[i + 1].filtered.all = static_cast<unsigned char>((i * 7) % 233);
+        if (i % 10 == 0) {
+            pWaveform->setCompletion(i + 2);
+        }
+    }
+    pWaveform->setCompletion(pWaveform->getDataSize());
+    expectLevelsMatchData(*pWaveform);
+
+    EXPECT_EQ(0, pWaveform->levelForFramesPerPixel(0.5));
+    EXPECT_EQ(0, pWaveform->levelForFramesPerPixel(1.9));
+    EXPECT_EQ(1, pWaveform->levelForFramesPerPixel(2.0));
+    EXPECT_EQ(3, pWaveform->levelForFramesPerPixel(15.0));
+    EXPECT_EQ(pWaveform->getLevelCount() - 1,
+              pWaveform->levelForFramesPerPixel(1e9));
+
+    // Loading the waveform again computes the same levels.
+    QScopedPointer<Waveform> pDecoded(new Waveform(pWaveform->toByteArray()));
+    expectLevelsMatchData(*pDecoded);
+
+    QTemporaryFile file;
+    ASSERT_TRUE(writeFile(*pWaveform, &file));
+    QScopedPointer<Waveform> pMapped(Waveform::mapFile(file.fileName()));
+    ASSERT_FALSE(pMapped.isNull());
+    ASSERT_EQ(pWaveform->getLevelCount(), pMapped->getLevelCount());
+    expectLevelsMatchData(*pMapped);
+}
+
+// Compares loading the waveform of a 10 minute track from the compressed
+// protobuf blob of the old format with mapping it from a file.
+TEST_F(WaveformTest, LoadBenchmark) {
+    QScopedPointer<Waveform> pWaveform(createWaveform(600));
+    const QByteArray compressed = qCompress(pWaveform->toByteArray());
+    QTemporaryFile file;
+    ASSERT_TRUE(writeFile(*pWaveform, &file));
+
+    // Both loads touch every entry, since the renderers upload all of them
+    // to the texture.
+    Timer t("");
+    t.start();
+    QScopedPointer<Waveform> pDecoded(new Waveform(qUncompress(compressed)));
+    int decodedSum = 0;
+    for (int i = 0; i < pDecoded->getDataSize(); ++i) {
+        decodedSum += pDecoded->getAll(i);
+    }
+    qint64 elapsed = t.elapsed(false);
+    qDebug() << "Protobuf and qUncompress load" << elapsed << "ns";
+
+    t.start();
+    QScopedPointer<Waveform> pMapped(Waveform::mapFile(file.fileName()));
+    ASSERT_FALSE(pMapped.isNull());
+    int mappedSum = 0;
+    for (int i = 0; i < pMapped->getDataSize(); ++i) {
+        mappedSum += pMapped->getAll(i);
+    }
+    elapsed = t.elapsed(false);
+    qDebug() << "Memory-mapped load" << elapsed << "ns";
+
+    EXPECT_EQ(decodedSum, mappedSum);
+}
+
+}  // namespace
@@ -39,6 +39,9 @@ class CmdlineArgs {
             } else if (argv[i] == QString("--timelinePath") && i+1 < argc) {
                 m_timelinePath = QString::fromLocal8Bit(argv[i+1]);
                 i++;
+            } else if (argv[i] == QString("--tracePath") && i+1 < argc) {
+                m_tracePath = QString::fromLocal8Bit(argv[i+1]);
+                i++;
             } else if (QString::fromLocal8Bit(argv[i]).contains("--midiDebug", Qt::CaseInsensitive) ||
                        QString::fromLocal8Bit(argv[i]).contains("--controllerDebug", Qt::CaseInsensitive)) {
                 m_midiDebug = true;
@@ -59,11 +62,13 @@ class CmdlineArgs {
     bool getDeveloper() const { return m_developer; }
     bool getSafeMode() const { return m_safeMode; }
     bool getTimelineEnabled() const { return !m_timelinePath.isEmpty(); }
+    bool getTraceEnabled() const { return !m_tracePath.isEmpty(); }
     const QString& getLocale() const { return m_locale; }
     const QString& getSettingsPath() const { return m_settingsPath; }
     const QString& getResourcePath() const { return m_resourcePath; }
     const QString& getPluginPath() const { return m_pluginPath; }
     const QString& getTimelinePath() const { return m_timelinePath; }
+    const QString& getTracePath() const { return m_tracePath; }
 
   private:
     CmdlineArgs() :
@@ -85,6 +90,7 @@ class CmdlineArgs {
     QString m_resourcePath;
     QString m_pluginPath;
     QString m_timelinePath;
+    QString m_tracePath;
 };
 
 #endif /* CMDLINEARGS_H */
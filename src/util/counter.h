@@ -6,13 +6,23 @@
 class Counter {
   public:
     Counter(const QString& tag)
-    : m_tag(tag) {
+    : m_tag(tag),
+      m_pKey(NULL) {
+    }
+    // Counts under a pre-registered key, which never allocates. key must
+    // outlive the Counter.
+    explicit Counter(const StatKey& key)
+    : m_pKey(&key) {
     }
     void increment(int by=1) {
         Stat::ComputeFlags flags = Stat::experimentFlags(
             Stat::COUNT | Stat::SUM | Stat::AVERAGE |
             Stat::SAMPLE_VARIANCE | Stat::MIN | Stat::MAX);
-        Stat::track(m_tag, Stat::COUNTER, flags, by);
+        if (m_pKey != NULL) {
+            Stat::track(*m_pKey, Stat::COUNTER, flags, by);
+        } else {
+            Stat::track(m_tag, Stat::COUNTER, flags, by);
+        }
     }
     Counter& operator+=(int by) {
         this->increment(by);
@@ -25,6 +35,7 @@ class Counter {
     }
   private:
     QString m_tag;
+    const StatKey* m_pKey;
 };
 
 #endif /* COUNTER_H */
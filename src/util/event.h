@@ -10,7 +10,9 @@ class Event {
   public:
     Event()
             : m_type(Stat::UNSPECIFIED),
-              m_time(-1) {
+              m_time(-1),
+              m_duration(0),
+              m_threadId(-1) {
     }
 
     typedef Stat::StatType EventType;
@@ -18,17 +20,30 @@ class Event {
     QString m_tag;
     EventType m_type;
     qint64 m_time;
+    // For DURATION_NANOSEC events the duration that ended at m_time.
+    qint64 m_duration;
+    // Identifies the thread that reported the event, see StatsManager.
+    int m_threadId;
 
     static bool event(const QString& tag, Event::EventType type = Stat::EVENT) {
         return Stat::track(tag, type, Stat::experimentFlags(Stat::COUNT), 0.0);
     }
+    static bool event(const StatKey& key, Event::EventType type = Stat::EVENT) {
+        return Stat::track(key, type, Stat::experimentFlags(Stat::COUNT), 0.0);
+    }
 
     static bool start(const QString& tag) {
         return event(tag, Stat::EVENT_START);
     }
+    static bool start(const StatKey& key) {
+        return event(key, Stat::EVENT_START);
+    }
     static bool end(const QString& tag) {
         return event(tag, Stat::EVENT_END);
     }
+    static bool end(const StatKey& key) {
+        return event(key, Stat::EVENT_END);
+    }
 };
 
 #endif /* EVENT_H */
@@ -1,5 +1,8 @@
 #include <limits>
 
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QStringList>
 #include <QtDebug>
 
@@ -8,6 +11,51 @@
 #include "util/math.h"
 #include "util/statsmanager.h"
 
+namespace {
+
+// All tags registered as a StatKey. Keys are never unregistered.
+class StatKeyRegistry {
+  public:
+    int registerTag(const QString& tag) {
+        QMutexLocker locker(&m_mutex);
+        QHash<QString, int>::const_iterator it = m_ids.find(tag);
+        if (it != m_ids.end()) {
+            return it.value();
+        }
+        const int id = m_tags.size();
+        m_tags.append(tag);
+        m_ids.insert(tag, id);
+        return id;
+    }
+
+    QString tagForId(int id) {
+        QMutexLocker locker(&m_mutex);
+        return m_tags.value(id);
+    }
+
+  private:
+    QMutex m_mutex;
+    QVector<QString> m_tags;
+    QHash<QString, int> m_ids;
+};
+
+// Constructed on first use since StatKeys are often statics themselves.
+StatKeyRegistry& statKeyRegistry() {
+    static StatKeyRegistry registry;
+    return registry;
+}
+
+}  // namespace
+
+StatKey::StatKey(const QString& tag)
+        : m_id(statKeyRegistry().registerTag(tag)) {
+}
+
+// static
+QString StatKey::tagForId(int id) {
+    return statKeyRegistry().tagForId(id);
+}
+
 Stat::Stat()
         : m_type(UNSPECIFIED),
           m_compute(NONE),
@@ -146,6 +194,26 @@ bool Stat::track(const QString& tag,
     }
     StatReport report;
     report.tag = strdup(tag.toAscii().constData());
+    report.keyId = -1;
+    report.type = type;
+    report.compute = compute;
+    report.time = Time::elapsed();
+    report.value = value;
+    StatsManager* pManager = StatsManager::instance();
+    return pManager && pManager->maybeWriteReport(report);
+}
+
+// static
+bool Stat::track(const StatKey& key,
+                 Stat::StatType type,
+                 Stat::ComputeFlags compute,
+                 double value) {
+    if (!StatsManager::s_bStatsManagerEnabled || !key.isValid()) {
+        return false;
+    }
+    StatReport report;
+    report.tag = NULL;
+    report.keyId = key.id();
     report.type = type;
     report.compute = compute;
     report.time = Time::elapsed();
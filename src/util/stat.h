@@ -9,6 +9,35 @@
 
 struct StatReport;
 
+// A stat tag registered once, e.g. as a static or a member of the class that
+// reports it. Reporting a StatKey neither builds nor copies a string, so
+// timers and traces on the audio callback thread should use one instead of a
+// QString tag. Registering the same tag twice returns the same key.
+class StatKey {
+  public:
+    // An invalid key. Reports under it are dropped.
+    StatKey()
+            : m_id(-1) {
+    }
+    explicit StatKey(const QString& tag);
+
+    bool isValid() const {
+        return m_id >= 0;
+    }
+    int id() const {
+        return m_id;
+    }
+    QString tag() const {
+        return tagForId(m_id);
+    }
+
+    // Returns the tag registered as id or a null string if there is none.
+    static QString tagForId(int id);
+
+  private:
+    int m_id;
+};
+
 class Stat {
   public:
     enum StatType {
@@ -122,12 +151,20 @@ class Stat {
                       Stat::StatType type,
                       Stat::ComputeFlags compute,
                       double value);
+    // Same as above, but does not allocate.
+    static bool track(const StatKey& key,
+                      Stat::StatType type,
+                      Stat::ComputeFlags compute,
+                      double value);
 };
 
 QDebug operator<<(QDebug dbg, const Stat &stat);
 
 struct StatReport {
+    // Either tag is a string owned by the report or it is NULL and keyId is
+    // the id of a StatKey.
     char* tag;
+    int keyId;
     qint64 time;
     Stat::StatType type;
     Stat::ComputeFlags compute;
@@ -12,12 +12,18 @@
 const int kStatsPipeSize = 1 << 20;
 const int kProcessLength = kStatsPipeSize * 4 / 5;
 
+// The number of events kept for the timeline and the trace, about 64 MB. When
+// there are more, the oldest quarter is dropped, so a long session keeps its
+// most recent events.
+const int kMaxEvents = 1 << 20;
+
 // static
 bool StatsManager::s_bStatsManagerEnabled = false;
 
-StatsPipe::StatsPipe(StatsManager* pManager)
+StatsPipe::StatsPipe(StatsManager* pManager, int threadId)
         : FIFO<StatReport>(kStatsPipeSize),
-          m_pManager(pManager) {
+          m_pManager(pManager),
+          m_threadId(threadId) {
     qRegisterMetaType<Stat>("Stat");
 }
 
@@ -29,7 +35,8 @@ StatsPipe::~StatsPipe() {
 
 StatsManager::StatsManager()
         : QThread(),
-          m_quit(0) {
+          m_quit(0),
+          m_iDroppedEvents(0) {
     s_bStatsManagerEnabled = true;
     setObjectName("StatsManager");
     moveToThread(this);
@@ -71,9 +78,16 @@ StatsManager::~StatsManager() {
     }
     qDebug() << "=====================================";
 
+    if (m_iDroppedEvents > 0) {
+        qDebug() << "The timeline and trace miss the oldest"
+                 << m_iDroppedEvents << "events";
+    }
     if (CmdlineArgs::Instance().getTimelineEnabled()) {
         writeTimeline(CmdlineArgs::Instance().getTimelinePath());
     }
+    if (CmdlineArgs::Instance().getTraceEnabled()) {
+        writeTrace(CmdlineArgs::Instance().getTracePath());
+    }
 }
 
 class OrderByTime {
@@ -126,6 +140,11 @@ void StatsManager::writeTimeline(const QString& filename) {
 
     QTextStream out(&timeline);
     foreach (const Event& event, m_events) {
+        // Durations are only kept for writeTrace.
+        if (event.m_type == Stat::DURATION_NANOSEC) {
+            continue;
+        }
+
         qint64 last_start = startTimes.value(event.m_tag, -1);
         qint64 last_end = endTimes.value(event.m_tag, -1);
 
@@ -160,6 +179,97 @@ void StatsManager::writeTimeline(const QString& filename) {
     timeline.close();
 }
 
+namespace {
+
+QString jsonString(const QString& string) {
+    QString escaped;
+    escaped.reserve(string.size() + 2);
+    escaped.append('"');
+    for (int i = 0; i < string.size(); ++i) {
+        const QChar c = string[i];
+        if (c == '\\' || c == '"') {
+            escaped.append('\\');
+            escaped.append(c);
+        } else if (c.unicode() < 0x20) {
+            // JSON does not allow control characters in strings.
+            escaped.append(QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0')));
+        } else {
+            escaped.append(c);
+        }
+    }
+    escaped.append('"');
+    return escaped;
+}
+
+// Chrome trace timestamps are in microseconds.
+QString traceTimestamp(qint64 nanos) {
+    return QString::number(static_cast<double>(nanos) / 1e3, 'f', 3);
+}
+
+}  // namespace
+
+void StatsManager::writeTrace(const QString& filename) {
+    QFile trace(filename);
+    if (!trace.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qDebug() << "Could not open trace file for writing:"
+                 << trace.fileName();
+        return;
+    }
+
+    // Sort by time. Durations are reported when they end, so their start is
+    // written out instead.
+    qSort(m_events.begin(), m_events.end(), OrderByTime());
+
+    QTextStream out(&trace);
+    out << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (int i = 0; i < m_threadNames.size(); ++i) {
+        const QString name = m_threadNames[i].isEmpty() ?
+                QString("Thread %1").arg(i) : m_threadNames[i];
+        out << (first ? "" : ",\n")
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,"
+            << "\"tid\":" << i << ",\"args\":{\"name\":"
+            << jsonString(name) << "}}";
+        first = false;
+    }
+
+    foreach (const Event& event, m_events) {
+        QString phase;
+        QString extra;
+        qint64 time = event.m_time;
+        switch (event.m_type) {
+            case Stat::EVENT_START:
+                phase = "B";
+                break;
+            case Stat::EVENT_END:
+                phase = "E";
+                break;
+            case Stat::EVENT:
+                phase = "i";
+                extra = ",\"s\":\"t\"";
+                break;
+            case Stat::DURATION_NANOSEC:
+                phase = "X";
+                time -= event.m_duration;
+                extra = QString(",\"dur\":%1").arg(
+                        traceTimestamp(event.m_duration));
+                break;
+            default:
+                continue;
+        }
+        out << (first ? "" : ",\n")
+            << "{\"name\":" << jsonString(event.m_tag)
+            << ",\"ph\":\"" << phase << "\""
+            << ",\"ts\":" << traceTimestamp(time)
+            << ",\"pid\":0,\"tid\":" << event.m_threadId
+            << extra << "}";
+        first = false;
+    }
+    out << "\n]}\n";
+
+    trace.close();
+}
+
 void StatsManager::onStatsPipeDestroyed(StatsPipe* pPipe) {
     QMutexLocker locker(&m_statsPipeLock);
     processIncomingStatReports();
@@ -170,9 +280,10 @@ StatsPipe* StatsManager::getStatsPipeForThread() {
     if (m_threadStatsPipes.hasLocalData()) {
         return m_threadStatsPipes.localData();
     }
-    StatsPipe* pResult = new StatsPipe(this);
-    m_threadStatsPipes.setLocalData(pResult);
     QMutexLocker locker(&m_statsPipeLock);
+    StatsPipe* pResult = new StatsPipe(this, m_threadNames.size());
+    m_threadNames.append(QThread::currentThread()->objectName());
+    m_threadStatsPipes.setLocalData(pResult);
     m_statsPipes.push_back(pResult);
     return pResult;
 }
@@ -190,11 +301,27 @@ bool StatsManager::maybeWriteReport(const StatReport& report) {
     return success;
 }
 
+QString StatsManager::tagForReport(const StatReport& report) {
+    if (report.tag != NULL) {
+        return QString::fromUtf8(report.tag);
+    }
+    if (report.keyId >= m_statKeyTags.size()) {
+        m_statKeyTags.resize(report.keyId + 1);
+    }
+    QString& tag = m_statKeyTags[report.keyId];
+    if (tag.isNull()) {
+        tag = StatKey::tagForId(report.keyId);
+    }
+    return tag;
+}
+
 void StatsManager::processIncomingStatReports() {
+    const bool timelineEnabled = CmdlineArgs::Instance().getTimelineEnabled();
+    const bool traceEnabled = CmdlineArgs::Instance().getTraceEnabled();
     StatReport report;
     foreach (StatsPipe* pStatsPipe, m_statsPipes) {
         while (pStatsPipe->read(&report, 1) == 1) {
-            QString tag = QString::fromUtf8(report.tag);
+            QString tag = tagForReport(report);
             Stat& info = m_stats[tag];
             info.m_tag = tag;
             info.m_type = report.type;
@@ -216,21 +343,40 @@ void StatsManager::processIncomingStatReports() {
                 base.processReport(report);
             }
 
-            if (CmdlineArgs::Instance().getTimelineEnabled() &&
-                    (report.type == Stat::EVENT ||
-                     report.type == Stat::EVENT_START ||
-                     report.type == Stat::EVENT_END)) {
+            const bool isEvent = report.type == Stat::EVENT ||
+                    report.type == Stat::EVENT_START ||
+                    report.type == Stat::EVENT_END;
+            const bool isDuration = report.type == Stat::DURATION_NANOSEC;
+            if ((isEvent && (timelineEnabled || traceEnabled)) ||
+                    (isDuration && traceEnabled)) {
                 Event event;
                 event.m_tag = tag;
                 event.m_type = report.type;
                 event.m_time = report.time;
+                event.m_threadId = pStatsPipe->threadId();
+                if (isDuration) {
+                    event.m_duration = static_cast<qint64>(report.value);
+                }
                 m_events.append(event);
+                if (m_events.size() > kMaxEvents) {
+                    dropOldestEvents();
+                }
             }
             free(report.tag);
         }
     }
 }
 
+void StatsManager::dropOldestEvents() {
+    const int dropped = kMaxEvents / 4;
+    if (m_iDroppedEvents == 0) {
+        qWarning() << "StatsManager: more than" << kMaxEvents
+                   << "events, dropping the oldest ones";
+    }
+    m_events.erase(m_events.begin(), m_events.begin() + dropped);
+    m_iDroppedEvents += dropped;
+}
+
 void StatsManager::run() {
     qDebug() << "StatsManager thread starting up.";
     while (true) {
@@ -11,6 +11,7 @@
 #include <QWaitCondition>
 #include <QThreadStorage>
 #include <QList>
+#include <QVector>
 
 #include "util/fifo.h"
 #include "util/singleton.h"
@@ -21,10 +22,17 @@ class StatsManager;
 
 class StatsPipe : public FIFO<StatReport> {
   public:
-    StatsPipe(StatsManager* pManager);
+    StatsPipe(StatsManager* pManager, int threadId);
     virtual ~StatsPipe();
+
+    // Numbers the threads that reported stats in the order they started to.
+    int threadId() const {
+        return m_threadId;
+    }
+
   private:
     StatsManager* m_pManager;
+    const int m_threadId;
 };
 
 class StatsManager : public QThread, public Singleton<StatsManager> {
@@ -55,9 +63,14 @@ class StatsManager : public QThread, public Singleton<StatsManager> {
 
   private:
     void processIncomingStatReports();
+    QString tagForReport(const StatReport& report);
     StatsPipe* getStatsPipeForThread();
     void onStatsPipeDestroyed(StatsPipe* pPipe);
+    // Keeps m_events from growing without bounds in long sessions.
+    void dropOldestEvents();
     void writeTimeline(const QString& filename);
+    // Writes m_events in the Chrome trace event format.
+    void writeTrace(const QString& filename);
 
     QAtomicInt m_emitAllStats;
     QAtomicInt m_quit;
@@ -65,6 +78,12 @@ class StatsManager : public QThread, public Singleton<StatsManager> {
     QMap<QString, Stat> m_baseStats;
     QMap<QString, Stat> m_experimentStats;
     QList<Event> m_events;
+    // The number of events dropped from m_events so far.
+    qint64 m_iDroppedEvents;
+    // The tags of StatKeys seen so far, indexed by their id.
+    QVector<QString> m_statKeyTags;
+    // The names of the threads that reported stats, indexed by thread ID.
+    QVector<QString> m_threadNames;
 
     QWaitCondition m_statsPipeCondition;
     QMutex m_statsPipeLock;
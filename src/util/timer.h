@@ -48,9 +48,29 @@ class SuspendableTimer : public Timer {
 
 class ScopedTimer {
   public:
+    // Reports under a pre-registered key. Unlike the other constructors this
+    // never allocates, so it is the one to use on the audio callback thread.
+    // Constructing the StatKey does allocate, so create it at startup, not as
+    // a function-local static on the callback thread. key must outlive the
+    // ScopedTimer.
+    explicit ScopedTimer(const StatKey& key,
+                         Stat::ComputeFlags compute = kDefaultComputeFlags)
+            : m_pTimer(NULL),
+              m_pKey(NULL),
+              m_compute(compute),
+              m_cancel(false) {
+        if (CmdlineArgs::Instance().getDeveloper()) {
+            m_pKey = &key;
+            m_compute = Stat::experimentFlags(compute);
+            m_time.start();
+        }
+    }
+
     ScopedTimer(const char* key, int i,
                 Stat::ComputeFlags compute = kDefaultComputeFlags)
             : m_pTimer(NULL),
+              m_pKey(NULL),
+              m_compute(compute),
               m_cancel(false) {
         if (CmdlineArgs::Instance().getDeveloper()) {
             initialize(QString(key), QString::number(i), compute);
@@ -60,6 +80,8 @@ class ScopedTimer {
     ScopedTimer(const char* key, const char *arg = NULL,
                 Stat::ComputeFlags compute = kDefaultComputeFlags)
             : m_pTimer(NULL),
+              m_pKey(NULL),
+              m_compute(compute),
               m_cancel(false) {
         if (CmdlineArgs::Instance().getDeveloper()) {
             initialize(QString(key), arg ? QString(arg) : QString(), compute);
@@ -69,6 +91,8 @@ class ScopedTimer {
     ScopedTimer(const char* key, const QString& arg,
                 Stat::ComputeFlags compute = kDefaultComputeFlags)
             : m_pTimer(NULL),
+              m_pKey(NULL),
+              m_compute(compute),
               m_cancel(false) {
         if (CmdlineArgs::Instance().getDeveloper()) {
             initialize(QString(key), arg, compute);
@@ -81,6 +105,12 @@ class ScopedTimer {
                 m_pTimer->elapsed(true);
             }
             m_pTimer->~Timer();
+        } else if (m_pKey && !m_cancel) {
+            const qint64 nsec = m_time.elapsed();
+            // Ignore the report if it crosses the experiment boundary.
+            if (Stat::modeFromFlags(m_compute) == Experiment::mode()) {
+                Stat::track(*m_pKey, Stat::DURATION_NANOSEC, m_compute, nsec);
+            }
         }
     }
 
@@ -102,6 +132,9 @@ class ScopedTimer {
   private:
     Timer* m_pTimer;
     char m_timerMem[sizeof(Timer)];
+    const StatKey* m_pKey;
+    Stat::ComputeFlags m_compute;
+    PerformanceTimer m_time;
     bool m_cancel;
 };
 
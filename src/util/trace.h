@@ -9,12 +9,50 @@
 #include "util/event.h"
 #include "util/performancetimer.h"
 
+// The keys a Trace reports under, registered once so tracing does not
+// allocate. See StatKey.
+class TraceKey {
+  public:
+    TraceKey() {
+    }
+    explicit TraceKey(const QString& tag)
+            : m_key(tag),
+              m_durationKey(tag + "_duration") {
+    }
+
+    const StatKey& key() const {
+        return m_key;
+    }
+    const StatKey& durationKey() const {
+        return m_durationKey;
+    }
+
+  private:
+    StatKey m_key;
+    StatKey m_durationKey;
+};
+
 class Trace {
   public:
+    // Traces under a pre-registered key. key must outlive the Trace.
+    explicit Trace(const TraceKey& key, bool time=true)
+            : m_writeToStdout(false),
+              m_time(time),
+              m_pKey(NULL) {
+        if (CmdlineArgs::Instance().getDeveloper() && key.key().isValid()) {
+            m_pKey = &key;
+            Event::start(key.key());
+            if (m_time) {
+                m_timer.start();
+            }
+        }
+    }
+
     Trace(const char* tag, const char* arg=NULL,
           bool writeToStdout=false, bool time=true)
             : m_writeToStdout(writeToStdout),
-              m_time(time) {
+              m_time(time),
+              m_pKey(NULL) {
         if (writeToStdout || CmdlineArgs::Instance().getDeveloper()) {
             initialize(tag, arg);
         }
@@ -23,7 +61,8 @@ class Trace {
     Trace(const char* tag, int arg,
           bool writeToStdout=false, bool time=true)
             : m_writeToStdout(writeToStdout),
-              m_time(time) {
+              m_time(time),
+              m_pKey(NULL) {
         if (writeToStdout || CmdlineArgs::Instance().getDeveloper()) {
             initialize(tag, QString::number(arg));
         }
@@ -32,15 +71,26 @@ class Trace {
     Trace(const char* tag, const QString& arg,
           bool writeToStdout=false, bool time=true)
             : m_writeToStdout(writeToStdout),
-              m_time(time) {
+              m_time(time),
+              m_pKey(NULL) {
         if (writeToStdout || CmdlineArgs::Instance().getDeveloper()) {
             initialize(tag, arg);
         }
     }
 
     virtual ~Trace() {
+        if (m_pKey) {
+            Event::end(m_pKey->key());
+            if (m_time) {
+                Stat::track(
+                        m_pKey->durationKey(),
+                        Stat::DURATION_NANOSEC,
+                        Stat::COUNT | Stat::AVERAGE | Stat::SAMPLE_VARIANCE |
+                        Stat::MAX | Stat::MIN,
+                        m_timer.elapsed());
+            }
         // Proxy for whether initialize was called.
-        if (!m_tag.isEmpty()) {
+        } else if (!m_tag.isEmpty()) {
             Event::end(m_tag);
 
             qint64 elapsed = m_time ? m_timer.elapsed() : 0;
@@ -86,6 +136,7 @@ class Trace {
 
     QString m_tag;
     const bool m_writeToStdout, m_time;
+    const TraceKey* m_pKey;
     PerformanceTimer m_timer;
 
 };
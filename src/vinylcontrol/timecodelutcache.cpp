@@ -0,0 +1,196 @@
+#include <QDir>
+#include <QtDebug>
+#include <string.h>
+
+#include "vinylcontrol/timecodelutcache.h"
+
+#include "util/timer.h"
+
+namespace {
+
+// The header of a lookup table file. All fields are in the byte order of the
+// machine that wrote the file. The LUT_HASHES entries of the hash table follow
+// the header, then the used slots.
+struct TimecodeLutFileHeader {
+    char magic[8];
+    // kByteOrderMark as written by the machine that wrote the file.
+    quint32 byteOrderMark;
+    quint32 formatVersion;
+    quint32 headerSize;
+    quint32 slotSize;
+    quint32 hashes;
+    quint32 slots;
+    // The timecode definition the table was built for.
+    char name[32];
+    qint32 bits;
+    quint32 seed;
+    quint32 taps;
+    quint32 length;
+};
+
+const char kFileMagic[8] = { 'M', 'X', 'X', 'X', 'V', 'L', 'U', 'T' };
+const quint32 kByteOrderMark = 0x01020304;
+const quint32 kFileFormatVersion = 1;
+
+void fillHeader(TimecodeLutFileHeader* pHeader, const timecode_def& def) {
+    memset(pHeader, 0, sizeof(*pHeader));
+    memcpy(pHeader->magic, kFileMagic, sizeof(kFileMagic));
+    pHeader->byteOrderMark = kByteOrderMark;
+    pHeader->formatVersion = kFileFormatVersion;
+    pHeader->headerSize = sizeof(*pHeader);
+    pHeader->slotSize = sizeof(struct slot);
+    pHeader->hashes = LUT_HASHES;
+    pHeader->slots = def.length;
+    strncpy(pHeader->name, def.name, sizeof(pHeader->name) - 1);
+    pHeader->bits = def.bits;
+    pHeader->seed = def.seed;
+    pHeader->taps = def.taps;
+    pHeader->length = def.length;
+}
+
+}  // namespace
+
+QList<QFile*> TimecodeLutCache::s_mappedFiles;
+
+// static
+timecode_def* TimecodeLutCache::findDefinition(const char* name,
+                                               const QString& directory) {
+    timecode_def* pDef = timecoder_match_definition(name);
+    if (pDef == NULL || pDef->lookup || directory.isEmpty()) {
+        return timecoder_find_definition(name);
+    }
+
+    const QString fileName = lookupTableFilePath(*pDef, directory);
+    Timer t("TimecodeLutCache::findDefinition");
+    t.start();
+    QFile* pFile = loadLookupTable(pDef, fileName);
+    if (pFile != NULL) {
+        s_mappedFiles.append(pFile);
+        qDebug() << "Loaded timecode lookup table for" << name << "from"
+                 << fileName << "in" << t.elapsed(false) / 1000 << "us";
+        return pDef;
+    }
+
+    if (timecoder_build_lookup(pDef) == -1) {
+        return NULL;
+    }
+    qDebug() << "Built timecode lookup table for" << name << "in"
+             << t.elapsed(false) / 1000000 << "ms";
+
+    if (QDir().mkpath(directory) && saveLookupTable(*pDef, fileName)) {
+        qDebug() << "Saved timecode lookup table to" << fileName;
+    } else {
+        qWarning() << "Could not save timecode lookup table to" << fileName;
+    }
+    return pDef;
+}
+
+// static
+void TimecodeLutCache::freeLookupTables() {
+    // The mapped tables are only marked as unused here.
+    timecoder_free_lookup();
+    qDeleteAll(s_mappedFiles);
+    s_mappedFiles.clear();
+}
+
+// static
+QString TimecodeLutCache::lookupTableFilePath(const timecode_def& def,
+                                              const QString& directory) {
+    // Tables of a changed definition get a file of their own.
+    return QDir(directory).filePath(QString("%1_%2_%3_%4.lut")
+            .arg(def.name)
+            .arg(def.seed, 0, 16)
+            .arg(def.taps, 0, 16)
+            .arg(def.length));
+}
+
+// static
+QFile* TimecodeLutCache::loadLookupTable(timecode_def* pDef,
+                                         const QString& fileName) {
+    QFile* pFile = new QFile(fileName);
+    if (!pFile->open(QIODevice::ReadOnly)) {
+        delete pFile;
+        return NULL;
+    }
+
+    TimecodeLutFileHeader expected;
+    fillHeader(&expected, *pDef);
+    TimecodeLutFileHeader header;
+    if (pFile->read(reinterpret_cast<char*>(&header), sizeof(header)) !=
+            static_cast<qint64>(sizeof(header)) ||
+            memcmp(&header, &expected, sizeof(header)) != 0) {
+        qDebug() << "Not a timecode lookup table for" << pDef->name << ":"
+                 << fileName;
+        delete pFile;
+        return NULL;
+    }
+
+    const qint64 tableBytes =
+            static_cast<qint64>(header.hashes) * sizeof(slot_no_t);
+    const qint64 slotBytes =
+            static_cast<qint64>(header.slots) * sizeof(struct slot);
+    const qint64 mappedSize = header.headerSize + tableBytes + slotBytes;
+    if (pFile->size() != mappedSize) {
+        qDebug() << "Timecode lookup table has the wrong size:" << fileName
+                 << pFile->size() << "!=" << mappedSize;
+        delete pFile;
+        return NULL;
+    }
+
+    uchar* pMapped = pFile->map(0, mappedSize);
+    if (pMapped == NULL) {
+        qDebug() << "Could not map timecode lookup table:" << fileName
+                 << pFile->errorString();
+        delete pFile;
+        return NULL;
+    }
+
+    // xwax only reads the table, but takes non-const pointers. The mapping is
+    // read only, so a stray write crashes instead of corrupting the file.
+    lut_init_external(&pDef->lut,
+            reinterpret_cast<struct slot*>(
+                    pMapped + header.headerSize + tableBytes),
+            reinterpret_cast<slot_no_t*>(pMapped + header.headerSize),
+            header.slots);
+    pDef->lookup = true;
+    return pFile;
+}
+
+// static
+bool TimecodeLutCache::saveLookupTable(const timecode_def& def,
+                                       const QString& fileName) {
+    if (!def.lookup || def.lut.avail != def.length) {
+        return false;
+    }
+
+    TimecodeLutFileHeader header;
+    fillHeader(&header, def);
+    const qint64 tableBytes =
+            static_cast<qint64>(header.hashes) * sizeof(slot_no_t);
+    const qint64 slotBytes =
+            static_cast<qint64>(header.slots) * sizeof(struct slot);
+
+    // Always write to a temp file first. Another Mixxx may have the old file
+    // mapped.
+    QString tempFileName = fileName + ".tmp";
+    QFile tempFile(tempFileName);
+    if (!tempFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    if (tempFile.write(reinterpret_cast<const char*>(&header),
+                       sizeof(header)) != static_cast<qint64>(sizeof(header)) ||
+            tempFile.write(reinterpret_cast<const char*>(def.lut.table),
+                           tableBytes) != tableBytes ||
+            tempFile.write(reinterpret_cast<const char*>(def.lut.slot),
+                           slotBytes) != slotBytes) {
+        tempFile.remove();
+        return false;
+    }
+    tempFile.close();
+    QFile file(fileName);
+    if (file.exists() && !file.remove()) {
+        tempFile.remove();
+        return false;
+    }
+    return tempFile.rename(fileName);
+}
@@ -0,0 +1,56 @@
+#ifndef TIMECODELUTCACHE_H
+#define TIMECODELUTCACHE_H
+
+#include <QFile>
+#include <QList>
+#include <QString>
+
+#ifdef _MSC_VER
+#include "timecoder.h"
+#else
+extern "C" {
+#include "timecoder.h"
+}
+#endif
+
+// Keeps the xwax timecode lookup tables in files, so a table is built only the
+// first time a timecode is ever used. Building the table of a long timecode
+// such as serato_cd takes seconds, mapping its file takes no time at all.
+//
+// A file holds the table exactly as lut_init() and lut_push() leave it in
+// memory, after a header with the timecode definition it was built for. The
+// file is mapped and used in place. Files of another format version, another
+// machine or another definition are ignored and replaced.
+//
+// The lookup tables are global in xwax, so none of these methods are thread
+// safe. VinylControlXwax calls them with its LUT mutex held.
+class TimecodeLutCache {
+  public:
+    // Returns the definition of the timecode called name with its lookup
+    // table. The table is loaded from directory if it was saved there before,
+    // else it is built and saved there. An empty directory only builds it.
+    // Returns NULL if there is no such timecode or no memory for the table.
+    static timecode_def* findDefinition(const char* name,
+                                        const QString& directory);
+
+    // Frees the lookup tables of all timecodes, including the mapped ones.
+    static void freeLookupTables();
+
+    // The file the lookup table of def is kept in.
+    static QString lookupTableFilePath(const timecode_def& def,
+                                       const QString& directory);
+
+    // Maps fileName and points the lookup table of pDef to it if it is a table
+    // for pDef. Returns the mapped file, which must stay open as long as the
+    // table is used, or NULL if the file was missing or did not match.
+    static QFile* loadLookupTable(timecode_def* pDef, const QString& fileName);
+
+    // Writes the built lookup table of def to fileName.
+    static bool saveLookupTable(const timecode_def& def,
+                                const QString& fileName);
+
+  private:
+    static QList<QFile*> s_mappedFiles;
+};
+
+#endif /* TIMECODELUTCACHE_H */
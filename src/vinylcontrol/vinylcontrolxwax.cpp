@@ -19,10 +19,12 @@
 *                                                                         *
 ***************************************************************************/
 
+#include <QDir>
 #include <QtDebug>
 #include <limits.h>
 
 #include "vinylcontrol/vinylcontrolxwax.h"
+#include "vinylcontrol/timecodelutcache.h"
 #include "util/timer.h"
 #include "controlobjectthread.h"
 #include "controlobjectslave.h"
@@ -124,13 +126,6 @@ VinylControlXwax::VinylControlXwax(ConfigObject<ConfigValue>* pConfig, QString g
     }
 
 
-    timecode_def* tc_def = timecoder_find_definition(timecode);
-    if (tc_def == NULL) {
-        qDebug() << "Error finding timecode definition for " << timecode << ", defaulting to serato_2a";
-        timecode = (char*)"serato_2a";
-        tc_def = timecoder_find_definition(timecode);
-    }
-
     double speed = 1.0;
     double rpm = 100.0 / 3.0;
     if (strVinylSpeed == MIXXX_VINYL_SPEED_45) {
@@ -154,12 +149,24 @@ VinylControlXwax::VinylControlXwax(ConfigObject<ConfigValue>* pConfig, QString g
     m_pPitchRing = new double[m_iPitchRingSize];
 
     qDebug() << "Xwax Vinyl control starting with a sample rate of:" << iSampleRate;
-    qDebug() << "Building timecode lookup tables for" << strVinylType << "with speed" << strVinylSpeed;
+    qDebug() << "Loading timecode lookup tables for" << strVinylType << "with speed" << strVinylSpeed;
 
     // Initialize the timecoder structure. Use the static mutex so that we only
     // do this once across the VinylControlXwax instances.
     s_xwaxLUTMutex.lock();
 
+    // The lookup tables are built once and then loaded from the settings
+    // directory.
+    const QString lutDirectory =
+            QDir(m_pConfig->getSettingsPath()).filePath("timecodes");
+    timecode_def* tc_def = TimecodeLutCache::findDefinition(
+            timecode, lutDirectory);
+    if (tc_def == NULL) {
+        qDebug() << "Error finding timecode definition for " << timecode << ", defaulting to serato_2a";
+        timecode = (char*)"serato_2a";
+        tc_def = TimecodeLutCache::findDefinition(timecode, lutDirectory);
+    }
+
     timecoder_init(&timecoder, tc_def, speed, iSampleRate, /* phono */ false);
     timecoder_monitor_init(&timecoder, MIXXX_VINYL_SCOPE_SIZE);
     //Note that timecoder_init will not double-malloc the LUTs, and after this we are guaranteed
@@ -182,10 +189,6 @@ VinylControlXwax::~VinylControlXwax() {
     timecoder_monitor_clear(&timecoder);
     timecoder_clear(&timecoder);
 
-    // TODO(rryan): This looks wrong. freeLUTs is called later by
-    // VinylControlProcessor so we are probably leaking the LUTs.
-    s_bLUTInitialized = false;
-
     m_pVCRate->set(0.0);
 }
 
@@ -193,7 +196,8 @@ VinylControlXwax::~VinylControlXwax() {
 void VinylControlXwax::freeLUTs() {
     s_xwaxLUTMutex.lock(); //Static mutex! We don't want two threads doing this!
     if (s_bLUTInitialized) {
-        timecoder_free_lookup(); //Frees all the LUTs in xwax.
+        // Frees all the LUTs in xwax and unmaps the loaded ones.
+        TimecodeLutCache::freeLookupTables();
         s_bLUTInitialized = false;
     }
     s_xwaxLUTMutex.unlock();
@@ -2,10 +2,13 @@
 
 #include "guitick.h"
 #include "controlobject.h"
+#include "controlobjectslave.h"
 
 
 // static
 double GuiTick::m_cpuTimeLastTick = 0.0;
+// static
+QList<ControlObjectSlave*> GuiTick::s_tickSubscribers;
 
 GuiTick::GuiTick(QObject* pParent)
         : QObject(pParent),
@@ -32,6 +35,38 @@ void GuiTick::process() {
         m_lastUpdateTime = m_cpuTimeLastTick;
         m_pCOGuiTick50ms->set(m_cpuTimeLastTick);
     }
+
+    // One queued call per tick, no matter how many controls changed. If the
+    // GUI thread did not get to the previous one yet, that one delivers the
+    // changes of this tick as well.
+    if (m_deliveryPending.testAndSetOrdered(0, 1)) {
+        QMetaObject::invokeMethod(this, "slotDeliverControlChanges",
+                                  Qt::QueuedConnection);
+    }
+}
+
+void GuiTick::slotDeliverControlChanges() {
+    m_deliveryPending.fetchAndStoreOrdered(0);
+    deliverControlChanges();
+}
+
+// static
+void GuiTick::deliverControlChanges() {
+    // A receiver may delete subscribers. A control skipped because of that
+    // is delivered on the next tick.
+    for (int i = 0; i < s_tickSubscribers.size(); ++i) {
+        s_tickSubscribers[i]->deliverGuiTickChange();
+    }
+}
+
+// static
+void GuiTick::addTickSubscriber(ControlObjectSlave* pSlave) {
+    s_tickSubscribers.append(pSlave);
+}
+
+// static
+void GuiTick::removeTickSubscriber(ControlObjectSlave* pSlave) {
+    s_tickSubscribers.removeOne(pSlave);
 }
 
 // static
@@ -1,11 +1,14 @@
 #ifndef GUITICK_H
 #define GUITICK_H
 
+#include <QAtomicInt>
+#include <QList>
 #include <QObject>
 
 #include "util/performancetimer.h"
 
 class ControlObject;
+class ControlObjectSlave;
 class QTimer;
 
 class GuiTick : public QObject {
@@ -16,6 +19,17 @@ class GuiTick : public QObject {
     void process();
     static double cpuTimeLastTick();
 
+    // Emits the latest value of every control that changed since the last
+    // call to the receivers connected with
+    // ControlObjectSlave::connectValueChangedOnGuiTick(). Called once per
+    // tick on the GUI thread. These three are GUI thread only.
+    static void deliverControlChanges();
+    static void addTickSubscriber(ControlObjectSlave* pSlave);
+    static void removeTickSubscriber(ControlObjectSlave* pSlave);
+
+  private slots:
+    void slotDeliverControlChanges();
+
   private:
     ControlObject* m_pCOGuiTickTime;
     ControlObject* m_pCOGuiTick50ms;
@@ -24,6 +38,10 @@ class GuiTick : public QObject {
 
     double m_lastUpdateTime;
     static double m_cpuTimeLastTick; // Stream Time in seconds
+
+    // 1 while a call of slotDeliverControlChanges() is queued.
+    QAtomicInt m_deliveryPending;
+    static QList<ControlObjectSlave*> s_tickSubscribers;
 };
 
 #endif // GUITICK_H
@@ -10,18 +10,87 @@
 
 #include <qgl.h>
 
+namespace {
+
+// Each frame is drawn as one line per band.
+const int kVerticesPerFrame = 6;
+
+inline void setVertex(GLWaveformVertexCache::Vertex* pVertex,
+                      GLfloat x, GLfloat y,
+                      qreal r, qreal g, qreal b, GLubyte alpha) {
+    pVertex->x = x;
+    pVertex->y = y;
+    pVertex->color[0] = static_cast<GLubyte>(255.0 * r);
+    pVertex->color[1] = static_cast<GLubyte>(255.0 * g);
+    pVertex->color[2] = static_cast<GLubyte>(255.0 * b);
+    pVertex->color[3] = alpha;
+}
+
+}  // namespace
+
 GLWaveformRendererFilteredSignal::GLWaveformRendererFilteredSignal(
         WaveformWidgetRenderer* waveformWidgetRenderer)
-    : WaveformRendererSignalBase(waveformWidgetRenderer) {
-
+    : WaveformRendererSignalBase(waveformWidgetRenderer),
+      m_pVertexCache(NULL),
+      m_bVertexCacheValid(false),
+      m_vertexCacheAlignment(Qt::AlignCenter) {
+    for (int i = 0; i < 3; ++i) {
+        m_vertexCacheGains[i] = 1.0;
+    }
 }
 
 GLWaveformRendererFilteredSignal::~GLWaveformRendererFilteredSignal() {
-
+    delete m_pVertexCache;
 }
 
 void GLWaveformRendererFilteredSignal::onSetup(const QDomNode& /*node*/) {
+    // The colors or the alignment may have changed.
+    m_bVertexCacheValid = false;
+}
 
+void GLWaveformRendererFilteredSignal::buildVertices(
+        const WaveformData* pLevelData, int level, int firstFrame, int lastFrame,
+        GLWaveformVertexCache::Vertex* pVertices) {
+    const float lowGain = m_vertexCacheGains[0];
+    const float midGain = m_vertexCacheGains[1];
+    const float highGain = m_vertexCacheGains[2];
+
+    for (int frame = firstFrame; frame < lastFrame; ++frame) {
+        const WaveformData& left = pLevelData[frame * 2];
+        const WaveformData& right = pLevelData[frame * 2 + 1];
+        const GLfloat x = GLWaveformVertexCache::visualIndex(level, frame);
+
+        GLfloat lowStart, lowEnd, midStart, midEnd, highStart, highEnd;
+        if (m_vertexCacheAlignment == Qt::AlignCenter) {
+            lowStart = lowGain * left.filtered.low;
+            lowEnd = -1.f * lowGain * right.filtered.low;
+            midStart = midGain * left.filtered.mid;
+            midEnd = -1.f * midGain * right.filtered.mid;
+            highStart = highGain * left.filtered.high;
+            highEnd = -1.f * highGain * right.filtered.high;
+        } else {  // top || bottom
+            lowStart = 0.f;
+            lowEnd = lowGain * math_max(left.filtered.low, right.filtered.low);
+            midStart = 0.f;
+            midEnd = midGain * math_max(left.filtered.mid, right.filtered.mid);
+            highStart = 0.f;
+            highEnd = highGain * math_max(left.filtered.high, right.filtered.high);
+        }
+
+        setVertex(pVertices, x, lowStart,
+                  m_lowColor_r, m_lowColor_g, m_lowColor_b, 204);
+        setVertex(pVertices + 1, x, lowEnd,
+                  m_lowColor_r, m_lowColor_g, m_lowColor_b, 204);
+        setVertex(pVertices + 2, x, midStart,
+                  m_midColor_r, m_midColor_g, m_midColor_b, 217);
+        setVertex(pVertices + 3, x, midEnd,
+                  m_midColor_r, m_midColor_g, m_midColor_b, 217);
+        setVertex(pVertices + 4, x, highStart,
+                  m_highColor_r, m_highColor_g, m_highColor_b, 230);
+        setVertex(pVertices + 5, x, highEnd,
+                  m_highColor_r, m_highColor_g, m_highColor_b, 230);
+        pVertices += kVerticesPerFrame;
+    }
 }
 
 void GLWaveformRendererFilteredSignal::draw(QPainter* painter, QPaintEvent* /*event*/) {
@@ -55,6 +124,13 @@ void GLWaveformRendererFilteredSignal::draw(QPainter* painter, QPaintEvent* /*ev
     const int lastIndex = int(lastVisualIndex+0.5);
     lastVisualIndex = lastIndex + lastIndex%2;
 
+    // Zoomed out, draw from the level that has about one entry per pixel.
+    const double framesPerPixel = (lastVisualIndex - firstVisualIndex) / 2.0 /
+            m_waveformRenderer->getWidth();
+    const int level = waveform->levelForFramesPerPixel(framesPerPixel);
+    const int firstFrame = math_max(firstIndex, 0) / 2 >> level;
+    const int lastFrame = (math_max(lastIndex, 0) / 2 >> level) + 1;
+
     // Reset device for native painting
     painter->beginNativePainting();
 
@@ -65,23 +141,42 @@ void GLWaveformRendererFilteredSignal::draw(QPainter* painter, QPaintEvent* /*ev
     float allGain(1.0), lowGain(1.0), midGain(1.0), highGain(1.0);
     getGains(&allGain, &lowGain, &midGain, &highGain);
 
-    float maxLow[2];
-    float maxMid[2];
-    float maxHigh[2];
-    float meanIndex;
+    // The vertices depend on the band gains and the alignment. The overall
+    // gain is applied by scaling them.
+    if (m_pVertexCache == NULL) {
+        m_pVertexCache = new GLWaveformVertexCache(this, kVerticesPerFrame);
+    }
+    if (!m_bVertexCacheValid ||
+            m_vertexCacheAlignment != m_alignment ||
+            m_vertexCacheGains[0] != lowGain ||
+            m_vertexCacheGains[1] != midGain ||
+            m_vertexCacheGains[2] != highGain) {
+        m_vertexCacheAlignment = m_alignment;
+        m_vertexCacheGains[0] = lowGain;
+        m_vertexCacheGains[1] = midGain;
+        m_vertexCacheGains[2] = highGain;
+        m_pVertexCache->invalidate();
+        m_bVertexCacheValid = true;
+    }
 
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
     if (m_alignment == Qt::AlignCenter) {
-        glMatrixMode(GL_PROJECTION);
-        glPushMatrix();
-        glLoadIdentity();
         glOrtho(firstVisualIndex, lastVisualIndex, -255.0, 255.0, -10.0, 10.0);
+    } else if (m_alignment == Qt::AlignBottom) {
+        glOrtho(firstVisualIndex, lastVisualIndex, 0.0, 255.0, -10.0, 10.0);
+    } else {
+        glOrtho(firstVisualIndex, lastVisualIndex, 255.0, 0.0, -10.0, 10.0);
+    }
 
-        glMatrixMode(GL_MODELVIEW);
-        glPushMatrix();
-        glLoadIdentity();
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
 
-        glScalef(1.f,allGain,1.f);
+    glScalef(1.f,allGain,1.f);
 
+    if (m_alignment == Qt::AlignCenter) {
         glLineWidth(1.0);
         glDisable(GL_LINE_SMOOTH);
 
@@ -93,107 +188,12 @@ void GLWaveformRendererFilteredSignal::draw(QPainter* painter, QPaintEvent* /*ev
             glVertex2f(lastVisualIndex,0);
         }
         glEnd();
-
-        glLineWidth(1.1);
-        glEnable(GL_LINE_SMOOTH);
-
-        glBegin(GL_LINES); {
-            for (int visualIndex = firstVisualIndex;
-                 visualIndex < lastVisualIndex;
-                 visualIndex += 2) {
-
-                if (visualIndex < 0)
-                    continue;
-
-                if (visualIndex > dataSize - 1)
-                    break;
-
-                maxLow[0] = (float)data[visualIndex].filtered.low;
-                maxMid[0] = (float)data[visualIndex].filtered.mid;
-                maxHigh[0] = (float)data[visualIndex].filtered.high;
-                maxLow[1] = (float)data[visualIndex+1].filtered.low;
-                maxMid[1] = (float)data[visualIndex+1].filtered.mid;
-                maxHigh[1] = (float)data[visualIndex+1].filtered.high;
-
-                meanIndex = visualIndex;
-
-                glColor4f(m_lowColor_r, m_lowColor_g, m_lowColor_b, 0.8);
-                glVertex2f(meanIndex,lowGain*maxLow[0]);
-                glVertex2f(meanIndex,-1.f*lowGain*maxLow[1]);
-
-                glColor4f(m_midColor_r, m_midColor_g, m_midColor_b, 0.85);
-                glVertex2f(meanIndex,midGain*maxMid[0]);
-                glVertex2f(meanIndex,-1.f*midGain*maxMid[1]);
-
-                glColor4f(m_highColor_r, m_highColor_g, m_highColor_b, 0.9);
-                glVertex2f(meanIndex,highGain*maxHigh[0]);
-                glVertex2f(meanIndex,-1.f*highGain*maxHigh[1]);
-            }
-        }
-        glEnd();
-    } else { //top || bottom
-        glMatrixMode(GL_PROJECTION);
-        glPushMatrix();
-        glLoadIdentity();
-        if (m_alignment == Qt::AlignBottom)
-            glOrtho(firstVisualIndex, lastVisualIndex, 0.0, 255.0, -10.0, 10.0);
-        else
-            glOrtho(firstVisualIndex, lastVisualIndex, 255.0, 0.0, -10.0, 10.0);
-
-        glMatrixMode(GL_MODELVIEW);
-        glPushMatrix();
-        glLoadIdentity();
-
-        glScalef(1.f,allGain,1.f);
-
-        glLineWidth(1.1);
-        glEnable(GL_LINE_SMOOTH);
-
-        glBegin(GL_LINES); {
-            for (int visualIndex = firstVisualIndex;
-                 visualIndex < lastVisualIndex;
-                 visualIndex += 2) {
-
-                if (visualIndex < 0)
-                    continue;
-
-                if (visualIndex > dataSize - 1)
-                    break;
-
-                maxLow[0] = (float)data[visualIndex].filtered.low;
-                maxLow[1] = (float)data[visualIndex+1].filtered.low;
-                maxMid[0] = (float)data[visualIndex].filtered.mid;
-                maxMid[1] = (float)data[visualIndex+1].filtered.mid;
-                maxHigh[0] = (float)data[visualIndex].filtered.high;
-                maxHigh[1] = (float)data[visualIndex+1].filtered.high;
-
-                glColor4f(m_lowColor_r, m_lowColor_g, m_lowColor_b, 0.8);
-                glVertex2f(float(visualIndex),0.f);
-                glVertex2f(float(visualIndex),lowGain*math_max(maxLow[0],maxLow[1]));
-
-                glColor4f(m_midColor_r, m_midColor_g, m_midColor_b, 0.85);
-                glVertex2f(float(visualIndex),0.f);
-                glVertex2f(float(visualIndex),midGain*math_max(maxMid[0],maxMid[1]));
-
-                glColor4f(m_highColor_r, m_highColor_g, m_highColor_b, 0.9);
-                glVertex2f(float(visualIndex),0.f);
-                glVertex2f(float(visualIndex),highGain*math_max(maxHigh[0],maxHigh[1]));
-            }
-        }
-        glEnd();
     }
 
-    //DEBUG
-    /*glDisable(GL_ALPHA_TEST);
-    glBegin(GL_LINE_LOOP);
-    {
-        glColor4f(0.5,1.0,0.5,0.25);
-        glVertex3f(firstVisualIndex,-1.0f, 0.0f);
-        glVertex3f(lastVisualIndex, 1.0f, 0.0f);
-        glVertex3f(lastVisualIndex,-1.0f, 0.0f);
-        glVertex3f(firstVisualIndex, 1.0f, 0.0f);
-    }
-    glEnd();*/
+    glLineWidth(1.1);
+    glEnable(GL_LINE_SMOOTH);
+
+    m_pVertexCache->draw(waveform, level, firstFrame, lastFrame, true);
 
     glPopMatrix();
     glMatrixMode(GL_PROJECTION);
@@ -2,16 +2,30 @@
 #define GLWAVEFROMRENDERERFILTEREDSIGNAL_H
 
 #include "waveformrenderersignalbase.h"
+#include "waveform/renderers/glwaveformvertexcache.h"
 
 class ControlObject;
 
-class GLWaveformRendererFilteredSignal : public WaveformRendererSignalBase {
+class GLWaveformRendererFilteredSignal : public WaveformRendererSignalBase,
+                                         private GLWaveformVertexCache::VertexBuilder {
   public:
     explicit GLWaveformRendererFilteredSignal(WaveformWidgetRenderer* waveformWidgetRenderer);
     virtual ~GLWaveformRendererFilteredSignal();
 
     virtual void onSetup(const QDomNode &node);
     virtual void draw(QPainter* painter, QPaintEvent* event);
+
+  private:
+    virtual void buildVertices(const WaveformData* pLevelData, int level,
+                               int firstFrame, int lastFrame,
+                               GLWaveformVertexCache::Vertex* pVertices);
+
+    // Created on the first draw, when the GL context is current.
+    GLWaveformVertexCache* m_pVertexCache;
+    // What the cached vertices were built with.
+    bool m_bVertexCacheValid;
+    Qt::Alignment m_vertexCacheAlignment;
+    float m_vertexCacheGains[3];
 };
 
 #endif // GLWAVEFROMRENDERERFILTEREDSIGNAL_H
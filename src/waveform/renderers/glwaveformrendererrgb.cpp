@@ -9,16 +9,111 @@
 #include "controlobjectthread.h"
 #include "util/math.h"
 
+namespace {
+
+const float kHeightScaleFactor = 255.0 / sqrtf(255 * 255 * 3);
+
+// Sets pVertices[0] and pVertices[1] to a line from the axis to the height of
+// the bands, colored by the mix of their colors.
+inline void setLine(GLWaveformVertexCache::Vertex* pVertices, GLfloat x,
+                    float low, float mid, float high, float direction,
+                    GLubyte alpha,
+                    qreal lowR, qreal lowG, qreal lowB,
+                    qreal midR, qreal midG, qreal midB,
+                    qreal highR, qreal highG, qreal highB) {
+    const float all = sqrtf(low * low + mid * mid + high * high) * kHeightScaleFactor;
+    const float red   = low * lowR + mid * midR + high * highR;
+    const float green = low * lowG + mid * midG + high * highG;
+    const float blue  = low * lowB + mid * midB + high * highB;
+    const float max = math_max3(red, green, blue);
+
+    pVertices[0].x = x;
+    pVertices[0].y = 0.0f;
+    pVertices[1].x = x;
+    if (max > 0.0f) {  // Prevent division by zero
+        pVertices[1].y = direction * all;
+        pVertices[0].color[0] = static_cast<GLubyte>(255.0f * red / max);
+        pVertices[0].color[1] = static_cast<GLubyte>(255.0f * green / max);
+        pVertices[0].color[2] = static_cast<GLubyte>(255.0f * blue / max);
+        pVertices[0].color[3] = alpha;
+    } else {
+        // A transparent line of length 0, since the vertex count per frame
+        // is fixed.
+        pVertices[1].y = 0.0f;
+        pVertices[0].color[0] = 0;
+        pVertices[0].color[1] = 0;
+        pVertices[0].color[2] = 0;
+        pVertices[0].color[3] = 0;
+    }
+    for (int i = 0; i < 4; ++i) {
+        pVertices[1].color[i] = pVertices[0].color[i];
+    }
+}
+
+}  // namespace
+
 GLWaveformRendererRGB::GLWaveformRendererRGB(
         WaveformWidgetRenderer* waveformWidgetRenderer)
-    : WaveformRendererSignalBase(waveformWidgetRenderer) {
-
+    : WaveformRendererSignalBase(waveformWidgetRenderer),
+      m_pVertexCache(NULL),
+      m_bVertexCacheValid(false),
+      m_vertexCacheAlignment(Qt::AlignCenter) {
+    for (int i = 0; i < 3; ++i) {
+        m_vertexCacheGains[i] = 1.0;
+    }
 }
 
 GLWaveformRendererRGB::~GLWaveformRendererRGB() {
+    delete m_pVertexCache;
 }
 
 void GLWaveformRendererRGB::onSetup(const QDomNode& /* node */) {
+    // The colors or the alignment may have changed.
+    m_bVertexCacheValid = false;
+}
+
+void GLWaveformRendererRGB::buildVertices(
+        const WaveformData* pLevelData, int level, int firstFrame, int lastFrame,
+        GLWaveformVertexCache::Vertex* pVertices) {
+    const float lowGain = m_vertexCacheGains[0];
+    const float midGain = m_vertexCacheGains[1];
+    const float highGain = m_vertexCacheGains[2];
+
+    for (int frame = firstFrame; frame < lastFrame; ++frame) {
+        const WaveformData& left = pLevelData[frame * 2];
+        const WaveformData& right = pLevelData[frame * 2 + 1];
+        const GLfloat x = GLWaveformVertexCache::visualIndex(level, frame);
+
+        if (m_vertexCacheAlignment == Qt::AlignCenter) {
+            setLine(pVertices, x,
+                    lowGain * left.filtered.low,
+                    midGain * left.filtered.mid,
+                    highGain * left.filtered.high,
+                    1.0f, 204,
+                    m_rgbLowColor_r, m_rgbLowColor_g, m_rgbLowColor_b,
+                    m_rgbMidColor_r, m_rgbMidColor_g, m_rgbMidColor_b,
+                    m_rgbHighColor_r, m_rgbHighColor_g, m_rgbHighColor_b);
+            setLine(pVertices + 2, x,
+                    lowGain * right.filtered.low,
+                    midGain * right.filtered.mid,
+                    highGain * right.filtered.high,
+                    -1.0f, 204,
+                    m_rgbLowColor_r, m_rgbLowColor_g, m_rgbLowColor_b,
+                    m_rgbMidColor_r, m_rgbMidColor_g, m_rgbMidColor_b,
+                    m_rgbHighColor_r, m_rgbHighColor_g, m_rgbHighColor_b);
+            pVertices += 4;
+        } else {  // top || bottom
+            setLine(pVertices, x,
+                    lowGain * math_max(left.filtered.low, right.filtered.low),
+                    midGain * math_max(left.filtered.mid, right.filtered.mid),
+                    highGain * math_max(left.filtered.high, right.filtered.high),
+                    1.0f, 230,
+                    m_rgbLowColor_r, m_rgbLowColor_g, m_rgbLowColor_b,
+                    m_rgbMidColor_r, m_rgbMidColor_g, m_rgbMidColor_b,
+                    m_rgbHighColor_r, m_rgbHighColor_g, m_rgbHighColor_b);
+            pVertices += 2;
+        }
+    }
 }
 
 void GLWaveformRendererRGB::draw(QPainter* painter, QPaintEvent* /*event*/) {
@@ -51,6 +146,14 @@ void GLWaveformRendererRGB::draw(QPainter* painter, QPaintEvent* /*event*/) {
     const int lastIndex = int(lastVisualIndex + 0.5);
     lastVisualIndex = lastIndex + lastIndex % 2;
 
+    // Zoomed out, draw one line per entry of the level that has about one
+    // entry per pixel instead of one per visual frame.
+    const double framesPerPixel = (lastVisualIndex - firstVisualIndex) / 2.0 /
+            m_waveformRenderer->getWidth();
+    const int level = waveform->levelForFramesPerPixel(framesPerPixel);
+    const int firstFrame = math_max(firstIndex, 0) / 2 >> level;
+    const int lastFrame = (math_max(lastIndex, 0) / 2 >> level) + 1;
+
     // Reset device for native painting
     painter->beginNativePainting();
 
@@ -61,20 +164,47 @@ void GLWaveformRendererRGB::draw(QPainter* painter, QPaintEvent* /*event*/) {
     float allGain(1.0), lowGain(1.0), midGain(1.0), highGain(1.0);
     getGains(&allGain, &lowGain, &midGain, &highGain);
 
-    const float kHeightScaleFactor = 255.0 / sqrtf(255 * 255 * 3);
+    // The vertices depend on the band gains and the alignment. The overall
+    // gain is applied by scaling them.
+    if (m_pVertexCache != NULL && m_vertexCacheAlignment != m_alignment) {
+        delete m_pVertexCache;
+        m_pVertexCache = NULL;
+    }
+    if (m_pVertexCache == NULL) {
+        m_vertexCacheAlignment = m_alignment;
+        m_pVertexCache = new GLWaveformVertexCache(
+                this, m_alignment == Qt::AlignCenter ? 4 : 2);
+        m_bVertexCacheValid = true;
+    }
+    if (!m_bVertexCacheValid ||
+            m_vertexCacheGains[0] != lowGain ||
+            m_vertexCacheGains[1] != midGain ||
+            m_vertexCacheGains[2] != highGain) {
+        m_vertexCacheGains[0] = lowGain;
+        m_vertexCacheGains[1] = midGain;
+        m_vertexCacheGains[2] = highGain;
+        m_pVertexCache->invalidate();
+        m_bVertexCacheValid = true;
+    }
 
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
     if (m_alignment == Qt::AlignCenter) {
-        glMatrixMode(GL_PROJECTION);
-        glPushMatrix();
-        glLoadIdentity();
         glOrtho(firstVisualIndex, lastVisualIndex, -255.0, 255.0, -10.0, 10.0);
+    } else if (m_alignment == Qt::AlignBottom) {
+        glOrtho(firstVisualIndex, lastVisualIndex, 0.0, 255.0, -10.0, 10.0);
+    } else {
+        glOrtho(firstVisualIndex, lastVisualIndex, 255.0, 0.0, -10.0, 10.0);
+    }
 
-        glMatrixMode(GL_MODELVIEW);
-        glPushMatrix();
-        glLoadIdentity();
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
 
-        glScalef(1.0f, allGain, 1.0f);
+    glScalef(1.0f, allGain, 1.0f);
 
+    if (m_alignment == Qt::AlignCenter) {
         glLineWidth(1.2);
         glDisable(GL_LINE_SMOOTH);
 
@@ -85,108 +215,12 @@ void GLWaveformRendererRGB::draw(QPainter* painter, QPaintEvent* /*event*/) {
             glVertex2f(lastVisualIndex,  0);
         }
         glEnd();
+    }
 
-        glLineWidth(2.0);
-        glEnable(GL_LINE_SMOOTH);
-
-        glBegin(GL_LINES); {
-            for (int visualIndex = firstVisualIndex;
-                 visualIndex < lastVisualIndex;
-                 visualIndex += 2) {
-
-                if (visualIndex < 0) {
-                    continue;
-                }
-
-                if (visualIndex > dataSize - 1) {
-                    break;
-                }
-
-                float left_low    = lowGain  * (float) data[visualIndex].filtered.low;
-                float left_mid    = midGain  * (float) data[visualIndex].filtered.mid;
-                float left_high   = highGain * (float) data[visualIndex].filtered.high;
-                float left_all    = sqrtf(left_low * left_low + left_mid * left_mid + left_high * left_high) * kHeightScaleFactor;
-                float left_red    = left_low  * m_rgbLowColor_r + left_mid  * m_rgbMidColor_r + left_high  * m_rgbHighColor_r;
-                float left_green  = left_low  * m_rgbLowColor_g + left_mid  * m_rgbMidColor_g + left_high  * m_rgbHighColor_g;
-                float left_blue   = left_low  * m_rgbLowColor_b + left_mid  * m_rgbMidColor_b + left_high  * m_rgbHighColor_b;
-                float left_max    = math_max3(left_red, left_green, left_blue);
-                if (left_max > 0.0f) {  // Prevent division by zero
-                    glColor4f(left_red / left_max, left_green / left_max, left_blue / left_max, 0.8f);
-                    glVertex2f(visualIndex, 0.0f);
-                    glVertex2f(visualIndex, left_all);
-                }
-
-                float right_low   = lowGain  * (float) data[visualIndex+1].filtered.low;
-                float right_mid   = midGain  * (float) data[visualIndex+1].filtered.mid;
-                float right_high  = highGain * (float) data[visualIndex+1].filtered.high;
-                float right_all   = sqrtf(right_low * right_low + right_mid * right_mid + right_high * right_high) * kHeightScaleFactor;
-                float right_red   = right_low * m_rgbLowColor_r + right_mid * m_rgbMidColor_r + right_high * m_rgbHighColor_r;
-                float right_green = right_low * m_rgbLowColor_g + right_mid * m_rgbMidColor_g + right_high * m_rgbHighColor_g;
-                float right_blue  = right_low * m_rgbLowColor_b + right_mid * m_rgbMidColor_b + right_high * m_rgbHighColor_b;
-                float right_max   = math_max3(right_red, right_green, right_blue);
-                if (right_max > 0.0f) {  // Prevent division by zero
-                    glColor4f(right_red / right_max, right_green / right_max, right_blue / right_max, 0.8f);
-                    glVertex2f(visualIndex, 0.0f);
-                    glVertex2f(visualIndex, -1.0f * right_all);
-                }
-            }
-        }
-
-        glEnd();
-
-    } else {  // top || bottom
-        glMatrixMode(GL_PROJECTION);
-        glPushMatrix();
-        glLoadIdentity();
-        if (m_alignment == Qt::AlignBottom) {
-            glOrtho(firstVisualIndex, lastVisualIndex, 0.0, 255.0, -10.0, 10.0);
-        } else {
-            glOrtho(firstVisualIndex, lastVisualIndex, 255.0, 0.0, -10.0, 10.0);
-        }
-
-        glMatrixMode(GL_MODELVIEW);
-        glPushMatrix();
-        glLoadIdentity();
-
-        glScalef(1.0f, allGain, 1.0f);
-
-        glLineWidth(2.0);
-        glEnable(GL_LINE_SMOOTH);
-
-        glBegin(GL_LINES); {
-            for (int visualIndex = firstVisualIndex;
-                 visualIndex < lastVisualIndex;
-                 visualIndex += 2) {
-
-                if (visualIndex < 0) {
-                    continue;
-                }
-
-                if (visualIndex > dataSize - 1) {
-                    break;
-                }
-
-                float low  = lowGain  * (float) math_max(data[visualIndex].filtered.low,  data[visualIndex+1].filtered.low);
-                float mid  = midGain  * (float) math_max(data[visualIndex].filtered.mid,  data[visualIndex+1].filtered.mid);
-                float high = highGain * (float) math_max(data[visualIndex].filtered.high, data[visualIndex+1].filtered.high);
-
-                float all = sqrtf(low * low + mid * mid + high * high) * kHeightScaleFactor;
-
-                float red   = low * m_rgbLowColor_r + mid * m_rgbMidColor_r + high * m_rgbHighColor_r;
-                float green = low * m_rgbLowColor_g + mid * m_rgbMidColor_g + high * m_rgbHighColor_g;
-                float blue  = low * m_rgbLowColor_b + mid * m_rgbMidColor_b + high * m_rgbHighColor_b;
-
-                float max = math_max3(red, green, blue);
-                if (max > 0.0f) {  // Prevent division by zero
-                    glColor4f(red / max, green / max, blue / max, 0.9f);
-                    glVertex2f(float(visualIndex), 0.0f);
-                    glVertex2f(float(visualIndex), all);
-                }
-            }
-        }
+    glLineWidth(2.0);
+    glEnable(GL_LINE_SMOOTH);
 
-        glEnd();
-    }
+    m_pVertexCache->draw(waveform, level, firstFrame, lastFrame, true);
 
     glPopMatrix();
     glMatrixMode(GL_PROJECTION);
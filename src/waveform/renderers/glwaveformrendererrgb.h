@@ -2,10 +2,12 @@
 #define GLWAVEFORMRENDERERRGB_H
 
 #include "waveformrenderersignalbase.h"
+#include "waveform/renderers/glwaveformvertexcache.h"
 
 class ControlObject;
 
-class GLWaveformRendererRGB : public WaveformRendererSignalBase {
+class GLWaveformRendererRGB : public WaveformRendererSignalBase,
+                              private GLWaveformVertexCache::VertexBuilder {
   public:
     explicit GLWaveformRendererRGB(WaveformWidgetRenderer* waveformWidgetRenderer);
     virtual ~GLWaveformRendererRGB();
@@ -14,6 +16,17 @@ class GLWaveformRendererRGB : public WaveformRendererSignalBase {
     virtual void draw(QPainter* painter, QPaintEvent* event);
 
   private:
+    virtual void buildVertices(const WaveformData* pLevelData, int level,
+                               int firstFrame, int lastFrame,
+                               GLWaveformVertexCache::Vertex* pVertices);
+
+    // Created on the first draw, when the GL context is current.
+    GLWaveformVertexCache* m_pVertexCache;
+    // What the cached vertices were built with.
+    bool m_bVertexCacheValid;
+    Qt::Alignment m_vertexCacheAlignment;
+    float m_vertexCacheGains[3];
+
     DISALLOW_COPY_AND_ASSIGN(GLWaveformRendererRGB);
 };
 
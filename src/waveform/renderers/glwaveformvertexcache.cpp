@@ -0,0 +1,168 @@
+#include <cstddef>
+
+#include <QtDebug>
+
+#include "waveform/renderers/glwaveformvertexcache.h"
+
+#include "util/math.h"
+
+namespace {
+
+// The number of frames built at a time. Zoomed in, one or two chunks cover
+// the widget. Zoomed out, the drawn level has about one frame per pixel.
+const int kChunkFrames = 4096;
+
+}  // namespace
+
+GLWaveformVertexCache::GLWaveformVertexCache(VertexBuilder* pBuilder,
+                                             int verticesPerFrame)
+        : m_pBuilder(pBuilder),
+          m_iVerticesPerFrame(verticesPerFrame),
+          m_bUseVertexBuffers(true) {
+}
+
+GLWaveformVertexCache::~GLWaveformVertexCache() {
+    clear();
+}
+
+void GLWaveformVertexCache::invalidate() {
+    for (int i = 0; i < m_levels.size(); ++i) {
+        m_levels[i].chunkCompletion.fill(-1);
+    }
+}
+
+void GLWaveformVertexCache::clear() {
+    for (int i = 0; i < m_levels.size(); ++i) {
+        delete m_levels[i].pBuffer;
+    }
+    m_levels.clear();
+    m_pWaveform.clear();
+}
+
+bool GLWaveformVertexCache::prepareLevel(Level* pLevel, int level) {
+    if (!pLevel->chunkCompletion.isEmpty()) {
+        return true;
+    }
+
+    const int frames = m_pWaveform->getLevelDataSize(level) / 2;
+    if (frames <= 0) {
+        return false;
+    }
+    const int vertexCount = frames * m_iVerticesPerFrame;
+
+    if (m_bUseVertexBuffers) {
+        QGLBuffer* pBuffer = new QGLBuffer(QGLBuffer::VertexBuffer);
+        pBuffer->setUsagePattern(QGLBuffer::DynamicDraw);
+        if (pBuffer->create() && pBuffer->bind()) {
+            pBuffer->allocate(vertexCount * sizeof(Vertex));
+            pBuffer->release();
+            pLevel->pBuffer = pBuffer;
+        } else {
+            qDebug() << "GLWaveformVertexCache: vertex buffer objects are not"
+                     << "supported, falling back to vertex arrays";
+            delete pBuffer;
+            m_bUseVertexBuffers = false;
+        }
+    }
+    if (pLevel->pBuffer == NULL) {
+        pLevel->vertices.resize(vertexCount);
+    }
+    pLevel->chunkCompletion.fill(-1, (frames + kChunkFrames - 1) / kChunkFrames);
+    return true;
+}
+
+void GLWaveformVertexCache::buildChunk(Level* pLevel, int level, int chunk,
+                                       int completion) {
+    const int frames = m_pWaveform->getLevelDataSize(level) / 2;
+    const int firstFrame = chunk * kChunkFrames;
+    const int lastFrame = math_min(firstFrame + kChunkFrames, frames);
+    const int vertexOffset = firstFrame * m_iVerticesPerFrame;
+    const int vertexCount = (lastFrame - firstFrame) * m_iVerticesPerFrame;
+
+    Vertex* pVertices;
+    if (pLevel->pBuffer != NULL) {
+        m_chunkVertices.resize(vertexCount);
+        pVertices = m_chunkVertices.data();
+    } else {
+        pVertices = pLevel->vertices.data() + vertexOffset;
+    }
+
+    m_pBuilder->buildVertices(m_pWaveform->levelData(level), level,
+                              firstFrame, lastFrame, pVertices);
+
+    if (pLevel->pBuffer != NULL) {
+        pLevel->pBuffer->bind();
+        pLevel->pBuffer->write(vertexOffset * sizeof(Vertex), pVertices,
+                               vertexCount * sizeof(Vertex));
+        pLevel->pBuffer->release();
+    }
+    pLevel->chunkCompletion[chunk] = completion;
+}
+
+void GLWaveformVertexCache::draw(const ConstWaveformPointer& pWaveform,
+                                 int level, int firstFrame, int lastFrame,
+                                 bool useColors) {
+    if (pWaveform.data() != m_pWaveform.data()) {
+        clear();
+        m_pWaveform = pWaveform;
+        if (m_pWaveform) {
+            m_levels.resize(m_pWaveform->getLevelCount());
+        }
+    }
+    if (!m_pWaveform || level < 0 || level >= m_levels.size()) {
+        return;
+    }
+
+    Level* pLevel = &m_levels[level];
+    if (!prepareLevel(pLevel, level)) {
+        return;
+    }
+
+    const int frames = m_pWaveform->getLevelDataSize(level) / 2;
+    firstFrame = math_max(firstFrame, 0);
+    lastFrame = math_min(lastFrame, frames);
+    if (firstFrame >= lastFrame) {
+        return;
+    }
+
+    // Build the visible chunks that were never built, or that were built
+    // before the part of the waveform they cover was analysed.
+    const int completion = m_pWaveform->getCompletion();
+    for (int chunk = firstFrame / kChunkFrames;
+         chunk <= (lastFrame - 1) / kChunkFrames; ++chunk) {
+        const int builtCompletion = pLevel->chunkCompletion[chunk];
+        const int chunkEnd = static_cast<int>(
+                visualIndex(level, (chunk + 1) * kChunkFrames));
+        if (builtCompletion < 0 ||
+                (builtCompletion < completion && builtCompletion < chunkEnd)) {
+            buildChunk(pLevel, level, chunk, completion);
+        }
+    }
+
+    const char* pBase = NULL;
+    if (pLevel->pBuffer != NULL) {
+        pLevel->pBuffer->bind();
+    } else {
+        pBase = reinterpret_cast<const char*>(pLevel->vertices.constData());
+    }
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(Vertex), pBase + offsetof(Vertex, x));
+    if (useColors) {
+        glEnableClientState(GL_COLOR_ARRAY);
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex),
+                       pBase + offsetof(Vertex, color));
+    }
+
+    glDrawArrays(GL_LINES, firstFrame * m_iVerticesPerFrame,
+                 (lastFrame - firstFrame) * m_iVerticesPerFrame);
+
+    if (useColors) {
+        glDisableClientState(GL_COLOR_ARRAY);
+    }
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    if (pLevel->pBuffer != NULL) {
+        pLevel->pBuffer->release();
+    }
+}
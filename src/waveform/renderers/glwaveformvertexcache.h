@@ -0,0 +1,98 @@
+#ifndef GLWAVEFORMVERTEXCACHE_H
+#define GLWAVEFORMVERTEXCACHE_H
+
+#include <QGLBuffer>
+#include <QVector>
+#include <qgl.h>
+
+#include "waveform/waveform.h"
+#include "util.h"
+
+// Keeps the GL_LINES vertices of a waveform on the GPU, so a renderer draws
+// the visible part of it with one glDrawArrays call instead of sending every
+// vertex again in immediate mode on each frame.
+//
+// There is one vertex buffer per level of the waveform (see
+// Waveform::levelData), created when the level is first drawn. Vertices are
+// built in chunks of frames when a chunk first becomes visible, and built
+// again when more of the waveform was analysed since. The x coordinate of
+// every vertex is the visual index of its frame in level 0, so all levels
+// share one projection.
+//
+// If the driver has no vertex buffer objects, the vertices are kept in client
+// memory and drawn from there as a vertex array. This still takes a single
+// draw call, which matters most on software GL implementations.
+//
+// All methods, including the destructor, must be called with the GL context
+// the vertices are drawn with current.
+class GLWaveformVertexCache {
+  public:
+    struct Vertex {
+        GLfloat x;
+        GLfloat y;
+        GLubyte color[4];
+    };
+
+    class VertexBuilder {
+      public:
+        virtual ~VertexBuilder() {}
+        // Fills verticesPerFrame() vertices for each of the frames
+        // [firstFrame, lastFrame) of pLevelData into pVertices.
+        virtual void buildVertices(const WaveformData* pLevelData, int level,
+                                   int firstFrame, int lastFrame,
+                                   Vertex* pVertices) = 0;
+    };
+
+    GLWaveformVertexCache(VertexBuilder* pBuilder, int verticesPerFrame);
+    virtual ~GLWaveformVertexCache();
+
+    // Drops all vertices, e.g. after the gains or colors they were built with
+    // changed.
+    void invalidate();
+
+    // Draws the frames [firstFrame, lastFrame) of level of pWaveform as
+    // GL_LINES. Vertices are drawn with their own color if useColors is true,
+    // else with the current GL color.
+    void draw(const ConstWaveformPointer& pWaveform, int level,
+              int firstFrame, int lastFrame, bool useColors);
+
+    bool usesVertexBuffers() const {
+        return m_bUseVertexBuffers;
+    }
+
+    // The visual index in level 0 of frame in level.
+    static GLfloat visualIndex(int level, int frame) {
+        return static_cast<GLfloat>(frame << (level + 1));
+    }
+
+  private:
+    struct Level {
+        Level()
+                : pBuffer(NULL) {
+        }
+        QGLBuffer* pBuffer;
+        // The vertices if there are no vertex buffers.
+        QVector<Vertex> vertices;
+        // Per chunk the completion of the waveform when it was built, or -1
+        // if it was not built yet.
+        QVector<int> chunkCompletion;
+    };
+
+    void clear();
+    bool prepareLevel(Level* pLevel, int level);
+    void buildChunk(Level* pLevel, int level, int chunk, int completion);
+
+    VertexBuilder* m_pBuilder;
+    const int m_iVerticesPerFrame;
+    bool m_bUseVertexBuffers;
+    // The waveform the vertices were built for. Kept alive so it is never
+    // mistaken for a new waveform at the same address.
+    ConstWaveformPointer m_pWaveform;
+    QVector<Level> m_levels;
+    // Scratch space for building a chunk before it is uploaded.
+    QVector<Vertex> m_chunkVertices;
+
+    DISALLOW_COPY_AND_ASSIGN(GLWaveformVertexCache);
+};
+
+#endif // GLWAVEFORMVERTEXCACHE_H
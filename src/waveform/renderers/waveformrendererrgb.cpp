@@ -58,6 +58,12 @@ void WaveformRendererRGB::draw(QPainter* painter,
     const double gain = (lastVisualIndex - firstVisualIndex) /
             (double)m_waveformRenderer->getWidth();
 
+    // Zoomed out, read from the level that has about one entry per pixel,
+    // so the cost of a frame does not depend on the zoom.
+    const int level = waveform->levelForFramesPerPixel(gain / 2.0);
+    const WaveformData* levelData = waveform->levelData(level);
+    const int levelDataSize = waveform->getLevelDataSize(level);
+
     // Per-band gain from the EQ knobs.
     float allGain(1.0), lowGain(1.0), midGain(1.0), highGain(1.0);
     getGains(&allGain, &lowGain, &midGain, &highGain);
@@ -100,8 +106,9 @@ void WaveformRendererRGB::draw(QPainter* painter,
         visualFrameStart = math_clamp(visualFrameStart, 0, lastVisualFrame);
         visualFrameStop = math_clamp(visualFrameStop, 0, lastVisualFrame);
 
-        int visualIndexStart = visualFrameStart * 2;
-        int visualIndexStop  = visualFrameStop * 2;
+        // The entries of the level covering the visual frames.
+        int visualIndexStart = (visualFrameStart >> level) * 2;
+        int visualIndexStop  = (visualFrameStop >> level) * 2;
 
         unsigned char maxLow  = 0;
         unsigned char maxMid  = 0;
@@ -110,9 +117,9 @@ void WaveformRendererRGB::draw(QPainter* painter,
         unsigned char maxAllB = 0;
 
         for (int i = visualIndexStart;
-             i >= 0 && i + 1 < dataSize && i + 1 <= visualIndexStop; i += 2) {
-            const WaveformData& waveformData = *(data + i);
-            const WaveformData& waveformDataNext = *(data + i + 1);
+             i >= 0 && i + 1 < levelDataSize && i + 1 <= visualIndexStop; i += 2) {
+            const WaveformData& waveformData = *(levelData + i);
+            const WaveformData& waveformDataNext = *(levelData + i + 1);
 
             maxLow  = math_max3(maxLow,  waveformData.filtered.low,  waveformDataNext.filtered.low);
             maxMid  = math_max3(maxMid,  waveformData.filtered.mid,  waveformDataNext.filtered.mid);
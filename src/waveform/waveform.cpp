@@ -1,12 +1,46 @@
+#include <cstring>
+
+#include <QFile>
 #include <QtDebug>
 
 #include "waveform/waveform.h"
 #include "proto/waveform.pb.h"
+#include "util/assert.h"
+#include "util/math.h"
 
 using namespace mixxx::track;
 
 const int kNumChannels = 2;
 
+namespace {
+
+// The header of a file written by Waveform::writeFile. All fields are in the
+// byte order of the machine that wrote the file. The WaveformData of the
+// whole texture (textureStride * textureStride entries) follows the header.
+struct WaveformFileHeader {
+    char magic[8];
+    // kByteOrderMark as written by the machine that wrote the file.
+    quint32 byteOrderMark;
+    quint32 formatVersion;
+    quint32 headerSize;
+    qint32 dataSize;
+    qint32 textureStride;
+    // Offset and number of the levels above level 0 (see
+    // Waveform::levelData), stored after the texture. Both are 0 if the file
+    // has none.
+    qint32 summaryOffset;
+    qint32 summaryLevels;
+    qint32 reserved;
+    double visualSampleRate;
+    double audioVisualRatio;
+};
+
+const char kFileMagic[8] = { 'M', 'X', 'X', 'X', 'W', 'A', 'V', 'E' };
+const quint32 kByteOrderMark = 0x01020304;
+const quint32 kFileFormatVersion = 1;
+
+}  // namespace
+
 // Return the smallest power of 2 which is greater than the desired size when
 // squared.
 int computeTextureStride(int size) {
@@ -17,10 +51,29 @@ int computeTextureStride(int size) {
     return stride;
 }
 
+// Returns the offsets of the levels above level 0 for a waveform of size
+// entries, followed by their total size.
+QVector<int> computeLevelOffsets(int size) {
+    QVector<int> offsets;
+    offsets.append(0);
+    int frames = size / kNumChannels;
+    while (frames > 1) {
+        frames = (frames + 1) / 2;
+        offsets.append(offsets.last() + frames * kNumChannels);
+    }
+    return offsets;
+}
+
 Waveform::Waveform(const QByteArray data)
         : m_id(-1),
           m_bDirty(true),
           m_dataSize(0),
+          m_pData(NULL),
+          m_textureSize(0),
+          m_pMappedFile(NULL),
+          m_pLevels(NULL),
+          m_levelOffsets(1, 0),
+          m_levelCompletion(0),
           m_visualSampleRate(0),
           m_audioVisualRatio(0),
           m_textureStride(computeTextureStride(0)),
@@ -33,6 +86,12 @@ Waveform::Waveform(int audioSampleRate, int audioSamples,
         : m_id(-1),
           m_bDirty(true),
           m_dataSize(0),
+          m_pData(NULL),
+          m_textureSize(0),
+          m_pMappedFile(NULL),
+          m_pLevels(NULL),
+          m_levelOffsets(1, 0),
+          m_levelCompletion(0),
           m_visualSampleRate(0),
           m_audioVisualRatio(0),
           m_textureStride(1024),
@@ -64,7 +123,150 @@ Waveform::Waveform(int audioSampleRate, int audioSamples,
     setCompletion(0);
 }
 
+Waveform::Waveform(QFile* pMappedFile, const WaveformData* pMappedData)
+        : m_id(-1),
+          m_bDirty(false),
+          m_dataSize(0),
+          m_pData(pMappedData),
+          m_textureSize(0),
+          m_pMappedFile(pMappedFile),
+          m_pLevels(NULL),
+          m_levelOffsets(1, 0),
+          m_levelCompletion(0),
+          m_visualSampleRate(0),
+          m_audioVisualRatio(0),
+          m_textureStride(computeTextureStride(0)),
+          m_completion(-1) {
+}
+
 Waveform::~Waveform() {
+    if (m_pMappedFile) {
+        // Closing the file unmaps it.
+        delete m_pMappedFile;
+    }
+}
+
+// static
+Waveform* Waveform::mapFile(const QString& fileName) {
+    QFile* pFile = new QFile(fileName);
+    if (!pFile->open(QIODevice::ReadOnly)) {
+        delete pFile;
+        return NULL;
+    }
+
+    WaveformFileHeader header;
+    const qint64 fileSize = pFile->size();
+    if (pFile->read(reinterpret_cast<char*>(&header), sizeof(header)) !=
+            static_cast<qint64>(sizeof(header)) ||
+            memcmp(header.magic, kFileMagic, sizeof(kFileMagic)) != 0 ||
+            header.byteOrderMark != kByteOrderMark ||
+            header.formatVersion != kFileFormatVersion ||
+            header.headerSize < sizeof(header) ||
+            header.headerSize % sizeof(WaveformData) != 0 ||
+            header.dataSize <= 0 ||
+            header.textureStride != computeTextureStride(header.dataSize) ||
+            header.visualSampleRate <= 0) {
+        qDebug() << "ERROR: Not a compatible waveform file:" << fileName;
+        delete pFile;
+        return NULL;
+    }
+
+    const qint64 textureSize =
+            static_cast<qint64>(header.textureStride) * header.textureStride;
+    qint64 mappedSize =
+            header.headerSize + textureSize * sizeof(WaveformData);
+    // Files without levels, or with levels that do not match, still work.
+    // The levels are then computed while loading.
+    const QVector<int> levelOffsets = computeLevelOffsets(header.dataSize);
+    const bool hasLevels = header.summaryLevels == levelOffsets.size() - 1 &&
+            header.summaryLevels > 0 &&
+            header.summaryOffset >= mappedSize &&
+            header.summaryOffset % sizeof(WaveformData) == 0;
+    if (hasLevels) {
+        mappedSize = header.summaryOffset +
+                static_cast<qint64>(levelOffsets.last()) * sizeof(WaveformData);
+    }
+    if (fileSize < mappedSize) {
+        qDebug() << "ERROR: Waveform file is truncated:" << fileName
+                 << fileSize << "<" << mappedSize;
+        delete pFile;
+        return NULL;
+    }
+
+    uchar* pMapped = pFile->map(0, mappedSize);
+    if (pMapped == NULL) {
+        qDebug() << "ERROR: Could not map waveform file:" << fileName
+                 << pFile->errorString();
+        delete pFile;
+        return NULL;
+    }
+
+    Waveform* pWaveform = new Waveform(pFile,
+            reinterpret_cast<const WaveformData*>(pMapped + header.headerSize));
+    pWaveform->m_dataSize = header.dataSize;
+    pWaveform->m_textureStride = header.textureStride;
+    pWaveform->m_textureSize = static_cast<int>(textureSize);
+    pWaveform->m_visualSampleRate = header.visualSampleRate;
+    pWaveform->m_audioVisualRatio = header.audioVisualRatio;
+    if (hasLevels) {
+        pWaveform->m_levelOffsets = levelOffsets;
+        pWaveform->m_pLevels = reinterpret_cast<const WaveformData*>(
+                pMapped + header.summaryOffset);
+        pWaveform->m_levelCompletion = header.dataSize;
+    } else {
+        pWaveform->allocateLevels();
+        pWaveform->updateLevels(header.dataSize);
+    }
+    pWaveform->m_completion = header.dataSize;
+    return pWaveform;
+}
+
+bool Waveform::writeFile(QFile* pFile) const {
+    const int dataSize = getDataSize();
+    if (dataSize <= 0) {
+        return false;
+    }
+
+    WaveformFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kFileMagic, sizeof(kFileMagic));
+    header.byteOrderMark = kByteOrderMark;
+    header.formatVersion = kFileFormatVersion;
+    header.headerSize = sizeof(header);
+    header.dataSize = dataSize;
+    header.textureStride = m_textureStride;
+    header.visualSampleRate = m_visualSampleRate;
+    header.audioVisualRatio = m_audioVisualRatio;
+
+    const qint64 textureEnd = sizeof(header) +
+            static_cast<qint64>(m_textureSize) * sizeof(WaveformData);
+    const qint64 levelBytes =
+            static_cast<qint64>(m_levelOffsets.last()) * sizeof(WaveformData);
+    if (levelBytes > 0) {
+        header.summaryOffset = textureEnd;
+        header.summaryLevels = getLevelCount() - 1;
+    }
+
+    const qint64 dataBytes = static_cast<qint64>(dataSize) * sizeof(WaveformData);
+    if (pFile->write(reinterpret_cast<const char*>(&header), sizeof(header)) !=
+            static_cast<qint64>(sizeof(header)) ||
+            pFile->write(reinterpret_cast<const char*>(m_pData), dataBytes) !=
+            dataBytes) {
+        return false;
+    }
+    // The padding of the texture is all zero. Growing the file leaves a hole
+    // instead of writing it.
+    if (!pFile->resize(textureEnd)) {
+        return false;
+    }
+    if (levelBytes > 0) {
+        if (!pFile->seek(textureEnd) ||
+                pFile->write(reinterpret_cast<const char*>(m_pLevels),
+                             levelBytes) != levelBytes) {
+            return false;
+        }
+    }
+    return true;
 }
 
 QByteArray Waveform::toByteArray() const {
@@ -108,7 +310,7 @@ QByteArray Waveform::toByteArray() const {
 
     int dataSize = getDataSize();
     for (int i = 0; i < dataSize; ++i) {
-        const WaveformData& datum = m_data.at(i);
+        const WaveformData& datum = m_pData[i];
         all->add_value(datum.filtered.all);
         low->add_value(datum.filtered.low);
         mid->add_value(datum.filtered.mid);
@@ -192,28 +394,108 @@ void Waveform::readByteArray(const QByteArray& data) {
         m_data[i].filtered.mid = use_mid ? static_cast<unsigned char>(mid.value(i)) : 0;
         m_data[i].filtered.high = use_high ? static_cast<unsigned char>(high.value(i)) : 0;
     }
+    updateLevels(dataSize);
     m_completion = dataSize;
     m_bDirty = false;
 }
 
 void Waveform::resize(int size) {
+    DEBUG_ASSERT(!isMapped());
     m_dataSize = size;
     m_textureStride = computeTextureStride(size);
     m_data.resize(m_textureStride * m_textureStride);
+    m_pData = &m_data[0];
+    m_textureSize = m_data.size();
+    allocateLevels();
     m_bDirty = true;
 }
 
 void Waveform::assign(int size, int value) {
+    DEBUG_ASSERT(!isMapped());
     m_dataSize = size;
     m_textureStride = computeTextureStride(size);
     m_data.assign(m_textureStride * m_textureStride, value);
+    m_pData = &m_data[0];
+    m_textureSize = m_data.size();
+    allocateLevels();
     m_bDirty = true;
 }
 
+void Waveform::allocateLevels() {
+    m_levelOffsets = computeLevelOffsets(m_dataSize);
+    m_levels.assign(m_levelOffsets.last(), 0);
+    m_pLevels = m_levels.empty() ? NULL : &m_levels[0];
+    m_levelCompletion = 0;
+}
+
+void Waveform::updateLevels(int completion) {
+    if (completion <= m_levelCompletion || m_levels.empty()) {
+        m_levelCompletion = completion;
+        return;
+    }
+
+    // The frames of the level below that changed, [firstFrame, lastFrame).
+    int firstFrame = m_levelCompletion / kNumChannels;
+    int lastFrame = math_min(completion, m_dataSize) / kNumChannels;
+    const WaveformData* pSource = m_pData;
+    int sourceFrames = m_dataSize / kNumChannels;
+    for (int level = 1; level < getLevelCount(); ++level) {
+        WaveformData* pTarget = &m_levels[m_levelOffsets[level - 1]];
+        firstFrame /= 2;
+        lastFrame = (lastFrame + 1) / 2;
+        for (int frame = firstFrame; frame < lastFrame; ++frame) {
+            const bool hasSecond = frame * 2 + 1 < sourceFrames;
+            for (int ch = 0; ch < kNumChannels; ++ch) {
+                const WaveformData& first = pSource[frame * 4 + ch];
+                WaveformData& target = pTarget[frame * 2 + ch];
+                target = first;
+                if (hasSecond) {
+                    const WaveformData& second = pSource[frame * 4 + 2 + ch];
+                    target.filtered.low = math_max(first.filtered.low,
+                                                   second.filtered.low);
+                    target.filtered.mid = math_max(first.filtered.mid,
+                                                   second.filtered.mid);
+                    target.filtered.high = math_max(first.filtered.high,
+                                                    second.filtered.high);
+                    target.filtered.all = math_max(first.filtered.all,
+                                                   second.filtered.all);
+                }
+            }
+        }
+        pSource = pTarget;
+        sourceFrames = (sourceFrames + 1) / 2;
+    }
+    m_levelCompletion = completion;
+}
+
+int Waveform::getLevelDataSize(int level) const {
+    if (level == 0) {
+        return m_dataSize;
+    }
+    return m_levelOffsets[level] - m_levelOffsets[level - 1];
+}
+
+const WaveformData* Waveform::levelData(int level) const {
+    if (level == 0) {
+        return m_pData;
+    }
+    return m_pLevels + m_levelOffsets[level - 1];
+}
+
+int Waveform::levelForFramesPerPixel(double framesPerPixel) const {
+    int level = 0;
+    while (level + 1 < getLevelCount() && (1 << (level + 1)) <= framesPerPixel) {
+        ++level;
+    }
+    return level;
+}
+
 void Waveform::dump() const {
     qDebug() << "Waveform" << this
+             << (isMapped() ? "mapped" : "")
              << "size("+QString::number(getDataSize())+")"
              << "textureStride("+QString::number(m_textureStride)+")"
+             << "levels("+QString::number(getLevelCount())+")"
              << "completion("+QString::number(getCompletion())+")"
              << "visualSampleRate("+QString::number(m_visualSampleRate)+")"
              << "audioVisualRatio("+QString::number(m_audioVisualRatio)+")";
@@ -7,11 +7,14 @@
 #include <QAtomicInt>
 #include <QSharedPointer>
 #include <QMutexLocker>
+#include <QVector>
 #include <vector>
 
 #include "util.h"
 #include "util/compatibility.h"
 
+class QFile;
+
 enum FilterIndex { Low = 0, Mid = 1, High = 2, FilterCount = 3};
 enum ChannelIndex { Left = 0, Right = 1, ChannelCount = 2};
 
@@ -36,6 +39,12 @@ class Waveform {
 
     virtual ~Waveform();
 
+    // Memory-maps a file written by writeFile(). The data is used straight
+    // from the file without copying or decoding, so a mapped Waveform must
+    // never be written to. Returns NULL if the file can not be mapped or is
+    // not a waveform file of a compatible format.
+    static Waveform* mapFile(const QString& fileName);
+
     int getId() const {
         QMutexLocker locker(&m_mutex);
         return m_id;
@@ -66,8 +75,20 @@ class Waveform {
         m_description = description;
     }
 
+    // Serialises the waveform with the waveform.proto message. Only used for
+    // the formats before the mapped file format.
     QByteArray toByteArray() const;
 
+    // Writes the waveform in the fixed layout that mapFile() reads: a small
+    // header followed by the WaveformData of the whole texture. The texture
+    // padding is not written, so it takes no disk space on file systems
+    // that support sparse files.
+    bool writeFile(QFile* pFile) const;
+
+    bool isMapped() const {
+        return m_pMappedFile != NULL;
+    }
+
     // We do not lock the mutex since m_dataSize and m_visualSampleRate are not
     // changed after the constructor runs.
     bool isValid() const {
@@ -95,7 +116,10 @@ class Waveform {
     int getCompletion() const {
         return load_atomic(m_completion);
     }
+    // Also brings the levels up to date with the data before completion, so
+    // it must only be called by the thread that writes the data.
     void setCompletion(int completion) {
+        updateLevels(completion);
         m_completion = completion;
     }
 
@@ -105,33 +129,54 @@ class Waveform {
 
     // We do not lock the mutex since m_data is not resized after the
     // constructor runs.
-    inline int getTextureSize() const { return m_data.size(); }
+    inline int getTextureSize() const { return m_textureSize; }
 
     // Atomically get the number of data elements in this Waveform. We do not
     // lock the mutex since m_dataSize is not changed after the constructor
     // runs.
     inline int getDataSize() const { return m_dataSize; }
 
-    inline const WaveformData& get(int i) const { return m_data[i];}
-    inline unsigned char getLow(int i) const { return m_data[i].filtered.low;}
-    inline unsigned char getMid(int i) const { return m_data[i].filtered.mid;}
-    inline unsigned char getHigh(int i) const { return m_data[i].filtered.high;}
-    inline unsigned char getAll(int i) const { return m_data[i].filtered.all;}
+    inline const WaveformData& get(int i) const { return m_pData[i];}
+    inline unsigned char getLow(int i) const { return m_pData[i].filtered.low;}
+    inline unsigned char getMid(int i) const { return m_pData[i].filtered.mid;}
+    inline unsigned char getHigh(int i) const { return m_pData[i].filtered.high;}
+    inline unsigned char getAll(int i) const { return m_pData[i].filtered.all;}
 
     // We do not lock the mutex since m_data is not resized after the
-    // constructor runs.
+    // constructor runs. Must not be used on a mapped Waveform.
     WaveformData* data() { return &m_data[0];}
 
-    // We do not lock the mutex since m_data is not resized after the
+    // We do not lock the mutex since the data is not moved after the
+    // constructor runs.
+    const WaveformData* data() const { return m_pData;}
+
+    // The waveform keeps a pyramid of levels for drawing it zoomed out. Level
+    // 0 is data(). Entry j of level k holds the maximum of every band over the
+    // visual frames [j * 2^k, (j + 1) * 2^k), with left and right interleaved
+    // like in data(), so a renderer can use any level in place of data().
+    //
+    // We do not lock the mutex since the levels are not moved after the
     // constructor runs.
-    const WaveformData* data() const { return &m_data[0];}
+    int getLevelCount() const {
+        return m_levelOffsets.size();
+    }
+    int getLevelDataSize(int level) const;
+    const WaveformData* levelData(int level) const;
+    // Returns the coarsest level in which one entry covers no more than
+    // framesPerPixel visual frames, so drawing from it takes at least one
+    // entry per pixel.
+    int levelForFramesPerPixel(double framesPerPixel) const;
 
     void dump() const;
 
   private:
+    Waveform(QFile* pMappedFile, const WaveformData* pMappedData);
+
     void readByteArray(const QByteArray& data);
     void resize(int size);
     void assign(int size, int value = 0);
+    void allocateLevels();
+    void updateLevels(int completion);
 
     inline WaveformData& at(int i) { return m_data[i];}
     inline unsigned char& low(int i) { return m_data[i].filtered.low;}
@@ -158,6 +203,24 @@ class Waveform {
     // TODO(XXX): In the future we should switch to QVector and use the raw data
     // pointer when performance matters.
     std::vector<WaveformData> m_data;
+    // The data used by all const accessors: either &m_data[0] or the data of
+    // m_pMappedFile. Not allowed to change after the constructor runs.
+    const WaveformData* m_pData;
+    // The number of WaveformData entries at m_pData, including padding.
+    int m_textureSize;
+    // The open file m_pData points into if the Waveform is mapped.
+    QFile* m_pMappedFile;
+    // All levels above 0, coarsest last. Like m_data, not resized after the
+    // constructor runs.
+    std::vector<WaveformData> m_levels;
+    // Either &m_levels[0] or the levels stored in m_pMappedFile.
+    const WaveformData* m_pLevels;
+    // The offset of level i + 1 in m_pLevels, plus one entry for the end of
+    // the last level, so there is one entry per level.
+    QVector<int> m_levelOffsets;
+    // The number of entries of m_pData already added to the levels. Only
+    // used by the thread writing the data.
+    int m_levelCompletion;
     // Not allowed to change after the constructor runs.
     double m_visualSampleRate;
     // Not allowed to change after the constructor runs.
@@ -6,19 +6,38 @@
 // static
 Waveform* WaveformFactory::loadWaveformFromAnalysis(
         const AnalysisDao::AnalysisInfo& analysis) {
-    Waveform* pWaveform = new Waveform(analysis.data);
+    Waveform* pWaveform = NULL;
+    if (isMappedVersion(analysis.version)) {
+        pWaveform = Waveform::mapFile(analysis.dataPath);
+        if (pWaveform == NULL) {
+            return NULL;
+        }
+    } else {
+        pWaveform = new Waveform(analysis.data);
+    }
     pWaveform->setId(analysis.analysisId);
     pWaveform->setVersion(analysis.version);
     pWaveform->setDescription(analysis.description);
     return pWaveform;
 }
 
+// static
+bool WaveformFactory::isMappedVersion(const QString& version) {
+    return version == WAVEFORM_5_VERSION ||
+            version == WAVEFORMSUMMARY_5_VERSION;
+}
+
 // static
 WaveformFactory::VersionClass WaveformFactory::waveformVersionToVersionClass(const QString& version) {
-    if (version == WAVEFORM_4_VERSION) {
+    if (version == WAVEFORM_5_VERSION) {
         return VC_USE;
     }
 
+    if (version == WAVEFORM_4_VERSION) {
+        // Converted to the mapped format, kept for old Mixxx versions
+        return VC_CONVERT;
+    }
+
     if (version == WAVEFORM_2_VERSION) {
         // keep for use with old Mixxx versions
         return VC_KEEP;
@@ -35,10 +54,15 @@ WaveformFactory::VersionClass WaveformFactory::waveformVersionToVersionClass(con
 
 // static
 WaveformFactory::VersionClass WaveformFactory::waveformSummaryVersionToVersionClass(const QString& version) {
-    if (version == WAVEFORMSUMMARY_4_VERSION) {
+    if (version == WAVEFORMSUMMARY_5_VERSION) {
         return VC_USE;
     }
 
+    if (version == WAVEFORMSUMMARY_4_VERSION) {
+        // Converted to the mapped format, kept for old Mixxx versions
+        return VC_CONVERT;
+    }
+
     if (version == WAVEFORMSUMMARY_2_VERSION) {
         // keep for use with old Mixxx versions
         return VC_KEEP;
@@ -55,20 +79,20 @@ WaveformFactory::VersionClass WaveformFactory::waveformSummaryVersionToVersionCl
 
 // static
 QString WaveformFactory::currentWaveformVersion() {
-    return WAVEFORM_4_VERSION;
+    return WAVEFORM_5_VERSION;
 }
 
 // static
 QString WaveformFactory::currentWaveformSummaryVersion() {
-    return WAVEFORMSUMMARY_4_VERSION;
+    return WAVEFORMSUMMARY_5_VERSION;
 }
 
 // static
 QString WaveformFactory::currentWaveformDescription() {
-    return WAVEFORM_4_DESCRIPTION;
+    return WAVEFORM_5_DESCRIPTION;
 }
 
 // static
 QString WaveformFactory::currentWaveformSummaryDescription() {
-    return WAVEFORMSUMMARY_4_DESCRIPTION;
+    return WAVEFORMSUMMARY_5_DESCRIPTION;
 }
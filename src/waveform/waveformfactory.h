@@ -22,17 +22,31 @@ class Waveform;
 #define WAVEFORM_4_DESCRIPTION "Waveform 4.0"
 #define WAVEFORMSUMMARY_4_DESCRIPTION "WaveformSummary 4.0"
 
+// Memory-mapped files written by Waveform::writeFile instead of compressed
+// protobuf messages.
+#define WAVEFORM_5_VERSION "Waveform-5.0"
+#define WAVEFORMSUMMARY_5_VERSION "WaveformSummary-5.0"
+#define WAVEFORM_5_DESCRIPTION "Waveform 5.0"
+#define WAVEFORMSUMMARY_5_DESCRIPTION "WaveformSummary 5.0"
+
 
 class WaveformFactory {
   public:
     enum VersionClass {
         VC_USE,
+        // Only used if there is no analysis of a VC_USE version. It is then
+        // converted to the current version and kept for old Mixxx versions.
+        VC_CONVERT,
         VC_KEEP,
         VC_REMOVE
     };
 
+    // Returns NULL if the analysis could not be loaded.
     static Waveform* loadWaveformFromAnalysis(
             const AnalysisDao::AnalysisInfo& analysis);
+    // True for versions that are stored with Waveform::writeFile and loaded
+    // with Waveform::mapFile instead of being kept in AnalysisInfo::data.
+    static bool isMappedVersion(const QString& version);
     static VersionClass waveformVersionToVersionClass(const QString& version);
     static VersionClass waveformSummaryVersionToVersionClass(const QString& version);
     static QString currentWaveformVersion();
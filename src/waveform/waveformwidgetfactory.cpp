@@ -20,6 +20,7 @@
 #include "waveform/widgets/qtsimplewaveformwidget.h"
 #include "waveform/widgets/glslwaveformwidget.h"
 #include "waveform/widgets/glvsynctestwidget.h"
+#include "waveform/widgets/glbenchmarkwaveformwidget.h"
 #include "waveform/widgets/waveformwidgetabstract.h"
 #include "widget/wwaveformviewer.h"
 #include "waveform/vsyncthread.h"
@@ -67,6 +68,7 @@ WaveformWidgetFactory::WaveformWidgetFactory() :
         m_overviewNormalized(false),
         m_openGLAvailable(false),
         m_openGLShaderAvailable(false),
+        m_openGLSoftwareRendering(false),
         m_vsyncThread(NULL),
         m_frameCnt(0),
         m_actualFrameRate(0),
@@ -142,6 +144,21 @@ WaveformWidgetFactory::WaveformWidgetFactory() :
         QGLWidget* glWidget = new QGLWidget(); // create paint device
         // QGLShaderProgram::hasOpenGLShaderPrograms(); valgind error
         m_openGLShaderAvailable = QGLShaderProgram::hasOpenGLShaderPrograms(glWidget->context());
+
+        glWidget->makeCurrent();
+        const GLubyte* renderer = glGetString(GL_RENDERER);
+        if (renderer != NULL) {
+            m_openGLRenderer = QString::fromLatin1(
+                    reinterpret_cast<const char*>(renderer));
+        }
+        m_openGLSoftwareRendering =
+                m_openGLRenderer.contains("llvmpipe", Qt::CaseInsensitive) ||
+                m_openGLRenderer.contains("softpipe", Qt::CaseInsensitive) ||
+                m_openGLRenderer.contains("Software Rasterizer", Qt::CaseInsensitive) ||
+                m_openGLRenderer.contains("GDI Generic", Qt::CaseInsensitive);
+        qDebug() << "OpenGL renderer:" << m_openGLRenderer
+                 << (m_openGLSoftwareRendering ? "(software)" : "");
+        glWidget->doneCurrent();
         delete glWidget;
     }
 
@@ -510,7 +527,10 @@ void WaveformWidgetFactory::swap() {
 WaveformWidgetType::Type WaveformWidgetFactory::autoChooseWidgetType() const {
     //default selection
     if (m_openGLAvailable) {
-        if (m_openGLShaderAvailable) {
+        // The GLSL widgets render into a frame buffer four times the size of
+        // the widget, which is too much work for a CPU. The vertex buffer
+        // based GL widgets are cheapest there.
+        if (m_openGLShaderAvailable && !m_openGLSoftwareRendering) {
             return WaveformWidgetType::GLSLRGBWaveform;
         } else {
             return WaveformWidgetType::GLRGBWaveform;
@@ -602,6 +622,12 @@ void WaveformWidgetFactory::evaluateWidgets() {
             useOpenGLShaders = GLRGBWaveformWidget::useOpenGLShaders();
             developerOnly = GLRGBWaveformWidget::developerOnly();
             break;
+        case WaveformWidgetType::GLBenchmarkWaveform:
+            widgetName = GLBenchmarkWaveformWidget::getWaveformWidgetName();
+            useOpenGl = GLBenchmarkWaveformWidget::useOpenGl();
+            useOpenGLShaders = GLBenchmarkWaveformWidget::useOpenGLShaders();
+            developerOnly = GLBenchmarkWaveformWidget::developerOnly();
+            break;
         default:
             continue;
         }
@@ -676,6 +702,9 @@ WaveformWidgetAbstract* WaveformWidgetFactory::createWaveformWidget(
         case WaveformWidgetType::GLVSyncTest:
             widget = new GLVSyncTestWidget(viewer->getGroup(), viewer);
             break;
+        case WaveformWidgetType::GLBenchmarkWaveform:
+            widget = new GLBenchmarkWaveformWidget(viewer->getGroup(), viewer);
+            break;
         default:
         //case WaveformWidgetType::SoftwareSimpleWaveform: TODO: (vrince)
         //case WaveformWidgetType::EmptyWaveform:
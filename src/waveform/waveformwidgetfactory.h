@@ -75,6 +75,9 @@ class WaveformWidgetFactory : public QObject, public Singleton<WaveformWidgetFac
     QString getOpenGLVersion() const { return m_openGLVersion;}
 
     bool isOpenGlShaderAvailable() const { return m_openGLShaderAvailable;}
+    // True if OpenGL is rendered on the CPU, e.g. by Mesa's llvmpipe.
+    bool isOpenGLSoftwareRendering() const { return m_openGLSoftwareRendering;}
+    QString getOpenGLRenderer() const { return m_openGLRenderer;}
 
     bool setWidgetType(WaveformWidgetType::Type type);
     bool setWidgetTypeFromHandle(int handleIndex);
@@ -147,6 +150,8 @@ class WaveformWidgetFactory : public QObject, public Singleton<WaveformWidgetFac
     bool m_openGLAvailable;
     QString m_openGLVersion;
     bool m_openGLShaderAvailable;
+    bool m_openGLSoftwareRendering;
+    QString m_openGLRenderer;
 
     VSyncThread* m_vsyncThread;
 
@@ -0,0 +1,146 @@
+#include "glbenchmarkwaveformwidget.h"
+
+#include <QPainter>
+#include <QtDebug>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+
+#include "sharedglcontext.h"
+
+#include "waveform/renderers/waveformwidgetrenderer.h"
+#include "waveform/renderers/waveformrenderbackground.h"
+#include "waveform/renderers/glwaveformrendererrgb.h"
+#include "waveform/renderers/waveformrendererpreroll.h"
+#include "waveform/renderers/waveformrendermark.h"
+#include "waveform/renderers/waveformrendermarkrange.h"
+#include "waveform/renderers/waveformrendererendoftrack.h"
+#include "waveform/renderers/waveformrenderbeat.h"
+
+namespace {
+
+// How often the statistics are updated.
+const qint64 kPeriodNs = 1000 * 1000 * 1000;
+
+// Returns the CPU time used by all threads of Mixxx so far, including the
+// rendering threads of a software GL driver. std::clock() can't be used for
+// this since it returns the wall time on Windows.
+qint64 processCpuTimeNs() {
+#if defined(Q_OS_WIN)
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime,
+                         &kernelTime, &userTime)) {
+        return 0;
+    }
+    ULARGE_INTEGER kernel, user;
+    kernel.LowPart = kernelTime.dwLowDateTime;
+    kernel.HighPart = kernelTime.dwHighDateTime;
+    user.LowPart = userTime.dwLowDateTime;
+    user.HighPart = userTime.dwHighDateTime;
+    // FILETIMEs count 100 ns intervals.
+    return static_cast<qint64>(kernel.QuadPart + user.QuadPart) * 100;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return (static_cast<qint64>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)
+            * 1000000 + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000;
+#endif
+}
+
+}  // namespace
+
+GLBenchmarkWaveformWidget::GLBenchmarkWaveformWidget(const char* group,
+                                                     QWidget* parent)
+        : QGLWidget(parent, SharedGLContext::getWidget()),
+          WaveformWidgetAbstract(group),
+          m_periodStartCpuNs(0),
+          m_periodFrames(0),
+          m_periodFrameNs(0) {
+
+    addRenderer<WaveformRenderBackground>();
+    addRenderer<WaveformRendererEndOfTrack>();
+    addRenderer<WaveformRendererPreroll>();
+    addRenderer<WaveformRenderMarkRange>();
+    addRenderer<GLWaveformRendererRGB>();
+    addRenderer<WaveformRenderBeat>();
+    addRenderer<WaveformRenderMark>();
+
+    setAttribute(Qt::WA_NoSystemBackground);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+
+    setAutoBufferSwap(false);
+
+    if (QGLContext::currentContext() != context()) {
+        makeCurrent();
+    }
+    m_initSuccess = init();
+
+    m_periodTimer.start();
+    m_periodStartCpuNs = processCpuTimeNs();
+}
+
+GLBenchmarkWaveformWidget::~GLBenchmarkWaveformWidget() {
+    // The renderers delete their vertex buffers, which needs our context.
+    if (QGLContext::currentContext() != context()) {
+        makeCurrent();
+    }
+}
+
+void GLBenchmarkWaveformWidget::castToQWidget() {
+    m_widget = static_cast<QWidget*>(static_cast<QGLWidget*>(this));
+}
+
+void GLBenchmarkWaveformWidget::paintEvent(QPaintEvent* event) {
+    Q_UNUSED(event);
+}
+
+int GLBenchmarkWaveformWidget::render() {
+    PerformanceTimer timer;
+    int t1;
+    timer.start();
+    // QPainter makes QGLContext::currentContext() == context()
+    // this may delayed until previous buffer swap finished
+    QPainter painter(this);
+    t1 = timer.restart();
+    draw(&painter, NULL);
+    // Wait for the driver, so a software renderer's work is measured too.
+    glFinish();
+    updateStatistics(timer.elapsed());
+
+    painter.setPen(Qt::white);
+    painter.drawText(rect().adjusted(4, 2, -4, -2),
+                     Qt::AlignTop | Qt::AlignLeft, m_statistics);
+    return t1 / 1000; // return timer for painter setup
+}
+
+void GLBenchmarkWaveformWidget::updateStatistics(qint64 frameNs) {
+    ++m_periodFrames;
+    m_periodFrameNs += frameNs;
+
+    const qint64 periodNs = m_periodTimer.elapsed();
+    if (periodNs < kPeriodNs) {
+        return;
+    }
+
+    const qint64 cpuNsNow = processCpuTimeNs();
+    const double cpuSeconds = (cpuNsNow - m_periodStartCpuNs) / 1e9;
+    const double periodSeconds = periodNs / 1e9;
+
+    m_statistics = QString("%1 fps, %2 ms per frame, %3% CPU (%4)")
+            .arg(m_periodFrames / periodSeconds, 0, 'f', 1)
+            .arg(m_periodFrameNs / 1e6 / m_periodFrames, 0, 'f', 2)
+            .arg(100.0 * cpuSeconds / periodSeconds, 0, 'f', 0)
+            .arg(getGroup());
+    qDebug() << "GLBenchmarkWaveformWidget" << m_statistics;
+
+    m_periodTimer.start();
+    m_periodStartCpuNs = cpuNsNow;
+    m_periodFrames = 0;
+    m_periodFrameNs = 0;
+}
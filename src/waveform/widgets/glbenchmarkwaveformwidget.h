@@ -0,0 +1,46 @@
+#ifndef GLBENCHMARKWAVEFORMWIDGET_H
+#define GLBENCHMARKWAVEFORMWIDGET_H
+
+#include <QGLWidget>
+#include <QString>
+
+#include "waveformwidgetabstract.h"
+#include "util/performancetimer.h"
+
+// Draws like GLRGBWaveformWidget, and shows how many frames per second it
+// draws, how long a frame takes including the GL driver and how much CPU time
+// Mixxx uses. Like the VSync test, it is meant for developers comparing
+// renderers and drivers, e.g. Mesa's software renderer against a GPU.
+class GLBenchmarkWaveformWidget : public QGLWidget, public WaveformWidgetAbstract {
+    Q_OBJECT
+  public:
+    GLBenchmarkWaveformWidget(const char* group, QWidget* parent);
+    virtual ~GLBenchmarkWaveformWidget();
+
+    virtual WaveformWidgetType::Type getType() const { return WaveformWidgetType::GLBenchmarkWaveform; }
+
+    static inline QString getWaveformWidgetName() { return tr("RGB Benchmark"); }
+    static inline bool useOpenGl() { return true; }
+    static inline bool useOpenGLShaders() { return false; }
+    static inline bool developerOnly() { return true; }
+
+  protected:
+    virtual void castToQWidget();
+    virtual void paintEvent(QPaintEvent* event);
+    virtual int render();
+
+  private:
+    void updateStatistics(qint64 frameNs);
+
+    // Measures the period the statistics are collected over.
+    PerformanceTimer m_periodTimer;
+    // The CPU time of the process at the start of the period.
+    qint64 m_periodStartCpuNs;
+    int m_periodFrames;
+    qint64 m_periodFrameNs;
+    QString m_statistics;
+
+    friend class WaveformWidgetFactory;
+};
+
+#endif // GLBENCHMARKWAVEFORMWIDGET_H
@@ -40,7 +40,10 @@ GLRGBWaveformWidget::GLRGBWaveformWidget(const char* group, QWidget* parent)
 }
 
 GLRGBWaveformWidget::~GLRGBWaveformWidget() {
-
+    // The renderers delete their vertex buffers, which needs our context.
+    if (QGLContext::currentContext() != context()) {
+        makeCurrent();
+    }
 }
 
 void GLRGBWaveformWidget::castToQWidget() {
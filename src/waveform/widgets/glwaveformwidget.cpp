@@ -42,6 +42,10 @@ GLWaveformWidget::GLWaveformWidget(const char* group, QWidget* parent)
 }
 
 GLWaveformWidget::~GLWaveformWidget() {
+    // The renderers delete their vertex buffers, which needs our context.
+    if (QGLContext::currentContext() != context()) {
+        makeCurrent();
+    }
 }
 
 void GLWaveformWidget::castToQWidget() {
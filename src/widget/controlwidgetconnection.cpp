@@ -8,7 +8,8 @@
 
 ControlWidgetConnection::ControlWidgetConnection(WBaseWidget* pBaseWidget,
                                                  ControlObjectSlave* pControl,
-                                                 ValueTransformer* pTransformer)
+                                                 ValueTransformer* pTransformer,
+                                                 bool onGuiTick)
         : m_pWidget(pBaseWidget),
           m_pControl(pControl),
           m_pValueTransformer(pTransformer) {
@@ -18,7 +19,13 @@ ControlWidgetConnection::ControlWidgetConnection(WBaseWidget* pBaseWidget,
     DEBUG_ASSERT_AND_HANDLE(!m_pControl.isNull()) {
         m_pControl.reset(new ControlObjectSlave());
     }
-    m_pControl->connectValueChanged(this, SLOT(slotControlValueChanged(double)));
+    if (onGuiTick) {
+        m_pControl->connectValueChangedOnGuiTick(
+                this, SLOT(slotControlValueChanged(double)));
+    } else {
+        m_pControl->connectValueChanged(
+                this, SLOT(slotControlValueChanged(double)));
+    }
 }
 
 ControlWidgetConnection::~ControlWidgetConnection() {
@@ -51,8 +58,10 @@ ControlParameterWidgetConnection::ControlParameterWidgetConnection(WBaseWidget*
                                                                    ControlObjectSlave* pControl,
                                                                    ValueTransformer* pTransformer,
                                                                    DirectionOption directionOption,
-                                                                   EmitOption emitOption)
-        : ControlWidgetConnection(pBaseWidget, pControl, pTransformer),
+                                                                   EmitOption emitOption,
+                                                                   bool onGuiTick)
+        : ControlWidgetConnection(pBaseWidget, pControl, pTransformer,
+                                  onGuiTick),
           m_directionOption(directionOption),
           m_emitOption(emitOption) {
 }
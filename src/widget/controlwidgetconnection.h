@@ -14,10 +14,13 @@ class ValueTransformer;
 class ControlWidgetConnection : public QObject {
     Q_OBJECT
   public:
-    // Takes ownership of pControl and pTransformer.
+    // Takes ownership of pControl and pTransformer. If onGuiTick is true, the
+    // widget gets the latest value once per GuiTick instead of every change,
+    // see ControlObjectSlave::connectValueChangedOnGuiTick().
     ControlWidgetConnection(WBaseWidget* pBaseWidget,
                             ControlObjectSlave* pControl,
-                            ValueTransformer* pTransformer);
+                            ValueTransformer* pTransformer,
+                            bool onGuiTick = false);
     virtual ~ControlWidgetConnection();
 
     double getControlParameter() const;
@@ -95,7 +98,8 @@ class ControlParameterWidgetConnection : public ControlWidgetConnection {
                                      ControlObjectSlave* pControl,
                                      ValueTransformer* pTransformer,
                                      DirectionOption directionOption,
-                                     EmitOption emitOption);
+                                     EmitOption emitOption,
+                                     bool onGuiTick = false);
     virtual ~ControlParameterWidgetConnection();
 
     void Init();
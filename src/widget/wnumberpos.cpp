@@ -4,6 +4,7 @@
 
 #include "widget/wnumberpos.h"
 #include "controlobject.h"
+#include "controlobjectslave.h"
 #include "controlobjectthread.h"
 #include "util/math.h"
 #include "util/time.h"
@@ -24,9 +25,11 @@ WNumberPos::WNumberPos(const char* group, QWidget* parent)
     // normalization done by the widget system used to be unusable for this
     // because the range of playposition was -0.14 to 1.14 in 1.11.x. As a
     // result, the <Connection> parameter is no longer necessary in skin
-    // definitions, but leaving it in is harmless.
-    m_pVisualPlaypos = new ControlObjectThread(group, "playposition");
-    m_pVisualPlaypos->connectValueChanged(this, SLOT(slotSetValue(double)));
+    // definitions, but leaving it in is harmless. The position changes on
+    // every engine callback, but the display only needs it once per frame.
+    m_pVisualPlaypos = new ControlObjectSlave(group, "playposition", this);
+    m_pVisualPlaypos->connectValueChangedOnGuiTick(
+            this, SLOT(slotSetValue(double)));
 
     m_pTrackSamples = new ControlObjectThread(
             group, "track_samples");
@@ -52,7 +55,6 @@ WNumberPos::WNumberPos(const char* group, QWidget* parent)
 WNumberPos::~WNumberPos() {
     delete m_pTrackSampleRate;
     delete m_pTrackSamples;
-    delete m_pVisualPlaypos;
     delete m_pShowTrackTimeRemaining;
 }
 
@@ -7,6 +7,7 @@
 
 #include "wnumber.h"
 
+class ControlObjectSlave;
 class ControlObjectThread;
 
 class WNumberPos : public WNumber {
@@ -37,7 +38,7 @@ class WNumberPos : public WNumber {
     bool m_bRemain;
     ControlObjectThread* m_pShowTrackTimeRemaining;
     // Pointer to control object for position, rate, and track info
-    ControlObjectThread* m_pVisualPlaypos;
+    ControlObjectSlave* m_pVisualPlaypos;
     ControlObjectThread* m_pTrackSamples;
     ControlObjectThread* m_pTrackSampleRate;
 };
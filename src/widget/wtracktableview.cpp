@@ -1609,14 +1609,8 @@ void WTrackTableView::slotReloadCoverArt() {
     if (trackModel == NULL) {
         return;
     }
-    QList<TrackPointer> selectedTracks;
-    QModelIndexList selection = selectionModel()->selectedRows();
-    foreach (QModelIndex index, selection) {
-        TrackPointer pTrack = trackModel->getTrack(index);
-        if (pTrack) {
-            selectedTracks.append(pTrack);
-        }
-    }
+    QList<TrackPointer> selectedTracks =
+            trackModel->getTracks(selectionModel()->selectedRows());
     CoverArtCache* pCache = CoverArtCache::instance();
     if (pCache) {
         pCache->requestGuessCovers(selectedTracks);